@@ -42,11 +42,20 @@
 #include <BLEDevice.h>
 #include <BLERemoteService.h>
 #include <BLE2902.h>
+#include <Preferences.h>
+#include "esp_gattc_api.h"
 #include <time.h>
 #include <sys/time.h>
 #include <BMSPacketHandler.h>
 #include <ControllerPacketHandler.h>
+#include <TelemetryStore.h>
+#include <SpiBusArbiter.h>
+#include <DisplayScene.h>
+#include <LoraPacketCodec.h>
 #include <MPU9250_Impact.h>
+#include <ImpactCapture.h>
+#include <InputTrace.h>
+#include <SpanTrace.h>
 #include <L76.h>
 #include <TinyGPS++.h>
 #include <lmic.h>
@@ -59,7 +68,21 @@
 #include "endian.h"
 #include "xbm.h"
 #include <array>
+#include <algorithm>
 #include "freertos/task.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "soc/rtc.h"
+#if __has_include("esp32/clk.h")
+#include "esp32/clk.h"
+#else
+#include "esp_clk.h"
+#endif
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#include "esp_pm.h"
+#endif
 
 #if defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
@@ -84,6 +107,29 @@
 #if DISPLAY_AVAIL > 0
 /* U8G2 class definition, U8G2_16BIT in u8g2.h should be enable for the used display size */
 U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI u8g2(U8G2_R1, /* cs=*/ 15, /* dc=*/ 2, /* reset=*/ U8X8_PIN_NONE);
+
+/* the frame is rendered into the u8g2 buffer and copied with its damaged tiles to the flush buffer */
+#define DISPLAY_BUFFER_SIZE		(32 * 8 * 8)			// 256x64 pixel, 1 bit per pixel, same as the u8g2 full buffer
+#define DISPLAY_TILE_ROWS		8
+uint8_t abDisplayBuffer[DISPLAY_BUFFER_SIZE];			// frame which is flushed
+uint32_t aulDisplayDamage[DISPLAY_TILE_ROWS];			// tiles of the flushed frame which have to be sent
+volatile bool isDisplayFlushBusy = false;
+bool isDisplayDataSent = false;							// pixel data has been sent since the last command
+
+/* retained display content, only changed widgets are redrawn and sent (user coordinates, rotated) */
+DisplayScene displayScene(u8g2);
+TextWidget dispVbmsLabel(0, 16, 0, u8g2_font_helvR12_tr, "Vbms: ");
+NumberWidget dispVbms(0, 32, 50, u8g2_font_helvR12_tr, "%.2f");
+TextWidget dispVbmsUnit(52, 32, 0, u8g2_font_helvR12_tr, "V");
+TextWidget dispSessionLabel(0, 56, 0, u8g2_font_helvR12_tr, "Session:");
+NumberWidget dispSession(0, 72, 36, u8g2_font_helvR12_tr, "%03d");
+TextWidget dispSessionUnit(37, 72, 0, u8g2_font_helvR12_tr, "min");
+TextWidget dispTime(8, 104, 56, u8g2_font_helvR12_tr);
+TextWidget dispAmPm(18, 120, 0, u8g2_font_helvR12_tr);
+NumberWidget dispBpm(2, 152, 30, u8g2_font_helvR12_tr, "%3d");
+TextWidget dispBpmUnit(0, 172, 0, u8g2_font_helvR12_tr, "bpm");
+IconWidget dispHeart(34, 145, heart_full_width, heart_full_height);
+IconWidget dispLock(0, 180, lock_width, lock_height);
 #endif
 
 struct tm *pTmDisplay;
@@ -130,8 +176,19 @@ ControllerPacketHandler controller;
 /************************************************************************************************************************/
 ImpactDetector IMU = ImpactDetector(100, 2000, 0.1, 2.0, 4.0, 0x68, SDA, SCL);
 const uint8_t mpuIntPin = 39;
+// output data rate of the IMU FIFO, the i2c task is woken by the data ready interrupt every IMU_BATCH_SAMPLES samples
+const uint16_t IMU_ODR_HZ = 200;
+const uint8_t IMU_BATCH_SAMPLES = 10;
+// the i2c task polls the GPS at least this often, also without IMU interrupts
+const uint32_t I2C_TASK_MAX_WAIT_MS = 100;
 bool isImuConnected = false;
 bool isCrashDetected = false;
+// raw samples around an impact, fed and triggered by the i2c task, stored and uploaded by the main task
+ImpactCapture impactCapture;
+int16_t captureUploadSlot = -1;						// slot of the capture in upload, -1 if none
+uint32_t captureUploadSequence = 0;
+uint16_t captureUploadOffset = 0;
+uint16_t captureUploadTotal = 0;
 std::array<float, 3> afImpact;
 std::array<float, 3> afValues;
 
@@ -150,6 +207,17 @@ std::array<float, 3> afValues;
 I2CGPS L76;
 TinyGPSPlus gps;
 boolean isGpsConnected = false;
+// fix interval of the L76, only RMC (time, position) and GGA (altitude) are output
+const uint16_t GPS_FIX_INTERVAL_MS = 1000;
+// period of the log of the i2c bus time taken by the GPS reads
+const uint32_t GPS_BUS_LOG_INTERVAL_MS = 10000;
+// bytes handed to the NMEA parser at once
+const uint8_t GPS_ENCODE_CHUNK = 64;
+// set by the parser for every RMC/GGA sentence with a fix, cleared by the location update
+volatile bool isGpsFixAvailable = false;
+uint32_t gpsBusLogTime = 0;
+uint32_t gpsBusTimeUs = 0;
+uint32_t gpsBusBytes = 0;
 
 /************************************************************************************************************************/
 /*!
@@ -165,9 +233,25 @@ boolean isGpsConnected = false;
 /************************************************************************************************************************/
 // Schedule TX every this many seconds (might become longer due to duty cycle limitations).
 const unsigned TX_INTERVAL = 20;
+// the ttn task sleeps until the next lmic job, but wakes at least this often to alert the watchdog
+const uint32_t TTN_MAX_SLEEP_MS = 1000;
+// period of rendering a new display frame
+const uint32_t DISPLAY_INTERVAL_MS = 500;
 bool isLoraSessionKeyAvailable = false;
 bool isLoraTaskSet = false;
 bool isLoraPacketSent = false;
+bool isLoraUplinkPending = false;		// the oldest record of the lora store is queued in LMIC
+bool isLoraUplinkConfirmed = false;		// the queued uplink asks for an acknowledge
+bool isLoraLinkUp = true;				// last confirmed uplink has been acknowledged
+uint8_t loraUplinkCount = 0;			// live uplinks since the last confirmed one
+LoraPacketCodec loraCodec;				// key/delta frames of the live samples
+LoraPacketBatch loraBatch;				// samples packed into the next uplink
+uint8_t loraUplinkRecords = 0;			// samples in the queued uplink
+uint32_t loraPayloadBytes = 0;			// payload of all queued uplinks, every port
+uint32_t loraPayloadSamples = 0;		// samples in these uplinks
+
+// frame limit per data rate of the band plan, not exported by lmic.h
+extern "C" uint8_t LMICeu868_maxFrameLen(uint8_t dr);
 
 #warning "Don't forget to update the eui and key from the LoraPacketHandler.h for OTAA function"
 // get the eui and key from the LoraPacketHandler.h
@@ -176,6 +260,7 @@ void os_getDevEui(u1_t* buf) { memcpy_P(buf, DEVEUI, 8); }
 void os_getDevKey(u1_t* buf) { memcpy_P(buf, APPKEY, 16); }
 
 osjob_t sendjob;
+osjob_t samplejob;
 
 char nwkKeyBuffer[100];		// buffer for saving network session key, use for printing
 char artKeyBuffer[100];		// buffer for saving application session key, use for printing
@@ -215,9 +300,6 @@ struct tm gpstm;
 
 uint32_t ttnGetKeyTime;
 
-uint32_t loopStartTime, loopFinishTime, loopTime, lastLoopTime = 0;
-uint32_t bmsTaskTime, heartyTaskTime, controllerTaskTime, serverTaskTime, gpsTaskTime, displayTaskTime = 0;
-
 time_t rawTime;
 uint32_t lastConfigTime = 0;
 bool isSessionTimeCountEnable = false;
@@ -240,11 +322,17 @@ TaskHandle_t xTaskTtn;													// task handler for TTN task (display include
 TaskHandle_t xTaskI2c;													// task handler for I2c task (GPS, IMU)
 TaskHandle_t xTaskMain;													// task handler for main task
 TaskHandle_t xTaskWatchdog;												// task handler for watchdog task
+TaskHandle_t xTaskDisplay = NULL;										// task handler for display render task
+TaskHandle_t xTaskDisplayFlush = NULL;									// task handler for display flush task
 
 /* Semaphore for the task */
 SemaphoreHandle_t xSemaphoreI2c;										// semaphore handle for i2c 
-SemaphoreHandle_t xSemaphoreSpi;										// semaphore handle for spi 
-SemaphoreHandle_t xSemaphoreBLE;										// semaphore handle for BLE task (if needed)
+SpiBusArbiter spiBus;													// spi bus shared by lora radio and display
+SemaphoreHandle_t xSemaphoreBLE;										// semaphore handle for the connect tasks of the BLE sessions
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+esp_pm_lock_handle_t xPmLockLora;										// no light sleep while a lora tx/rx is running
+bool isPmLockLoraTaken = false;
+#endif
 EventGroupHandle_t xWatchdogEvent;										// FreeRTOS event handle for watchdog task
 
 /* Task ID for the watchdog event function */
@@ -282,6 +370,7 @@ bool isMainTaskStopResponding, isTtnTaskStopResponding, isI2cTaskStopResponding
 /************************************************************************************************************************/
 /* Packet for LORAWAN */
 LORA_DATA_PACKET_T				loraPacket = { 0 };					// packet for lorawan data
+static_assert(sizeof(LORA_DATA_PACKET_T) == LORA_CODEC_PACKET_LEN, "lora packet layout differs from the codec");
 
 /* Packet for BLE Client */
 BLE_BMS_MOTOR_PACKET_T  		bmsMotorServerPacket = { 0 };		// packet for bms and motor controller data
@@ -293,6 +382,90 @@ BLE_MPU_PACKET_T				mpuServerPacket = { 0 };			// packet for imu data
 BLE_ONWRITE_PACKET_T			onWritePacket = { 0 };				// packet for onWrite data from BLE server
 BMS_PACKET_STRUCT_T				bmsPacket = { 0 };					// packet for incoming bms data
 
+/* Store-and-forward buffers, samples are kept until the uplink or the ESP server has taken them */
+TelemetryStore					loraStore;							// lora samples, owned by the ttn task
+TelemetryStore					bleStore;							// records for the ESP server, owned by the main task
+uint32_t						lastBacklogTime = 0;				// last time records have been stored for the ESP server
+
+/* Input trace, recorded by the tasks consuming the inputs, written to flash by the main task */
+InputTrace						inputTrace;
+
+/* Span trace of the tasks, dumped as Chrome trace JSON on request over the serial port */
+typedef enum SPAN_ID_Etag {
+	SPAN_MAIN_LOOP,									// one cycle of the main task
+	SPAN_BLE_SESSION,								// service of a BLE session, arg: session index
+	SPAN_BLE_CONNECT,								// connect of a BLE session, arg: session index
+	SPAN_GATT_DISCOVERY,							// service/characteristic lookup
+	SPAN_NOTIFY_BMS,								// notify callbacks
+	SPAN_NOTIFY_CONTROLLER,
+	SPAN_NOTIFY_HEARTY,
+	SPAN_LMIC_RUNLOOP,								// os_runloop_once()
+	SPAN_LMIC_EVENT,								// instant, arg: LMIC event
+	SPAN_DISPLAY_RENDER,
+	SPAN_DISPLAY_FLUSH,
+	SPAN_I2C_IMU,									// FIFO read and detection of the IMU samples
+	SPAN_I2C_GPS,									// read and decoding of the GPS bytes
+	SPAN_IMPACT,									// instant, arg: G-force x10 of a detected impact
+	SPAN_WAIT_I2C,									// wait for xSemaphoreI2c
+	SPAN_WAIT_SPI,									// wait for the spi bus, arg: SPI_BUS_CLASS_E
+	SPAN_ID_MAX,
+} SPAN_ID_E;
+
+const char * const spanNames[SPAN_ID_MAX] = {
+	"main loop", "ble session", "ble connect", "gatt discovery", "notify bms", "notify controller", "notify hearty",
+	"lmic runloop", "lmic event", "display render", "display flush", "i2c imu", "i2c gps", "impact", "wait i2c", "wait spi",
+};
+SpanTrace						spanTrace;
+const char						SPAN_TRACE_DUMP_COMMAND = 't';		// serial input which starts a dump
+
+/* Parked mode, the state which is kept in the RTC memory over the deep sleep */
+typedef struct PARK_RTC_STATE_Ttag {
+	uint32_t				ulMagic;					// PARK_RTC_MAGIC while the state belongs to a deep sleep
+	uint32_t				ulParkCount;				// deep sleeps since the power on
+	uint32_t				ulSleepTime;				// epoch time of the start of the deep sleep
+	uint32_t				ulConfigTime;				// last time set by the ESP server
+	uint64_t				ullWakeTimerTicks;			// RTC slow clock tick of the programmed timer wakeup
+	uint32_t				ulBootMs;					// timer wakeup to the start of the application, last timer wakeup
+	uint32_t				ulLastWakeLatencyMs;		// wakeup to full operation, last wakeup
+	uint32_t				ulMaxWakeLatencyMs;			// wakeup to full operation, slowest wakeup
+	uint8_t					bTelemetryDirty;			// records not pushed to the ESP server yet
+	bool					isLockStateKnown;
+	BLE_BMS_MOTOR_PACKET_T	tBmsMotor;
+	BLE_LOCK_PACKET_T		tLock;
+	BLE_TIME_PACKET_T		tTimeInfo;
+	BLE_HEARTRATE_PACKET_T	tHeartRate;
+	BLE_LOCATION_PACKET_T	tLocation;
+	BLE_MPU_PACKET_T		tMpu;
+	float					afAccelBias[3];				// accel calibration, a wakeup does not calibrate again
+	float					afAccelScale[3];
+	bool					isLoraSessionValid;			// joined, the wakeup continues the session without a join
+	u4_t					netid;
+	devaddr_t				devaddr;
+	u1_t					nwkKey[16];
+	u1_t					artKey[16];
+	u4_t					seqnoUp;
+	u4_t					seqnoDn;
+	dr_t					datarate;
+	s1_t					adrTxPow;
+	u1_t					rxDelay;
+	u1_t					rx1DrOffset;
+	dr_t					dn2Dr;
+	u4_t					dn2Freq;
+#if CFG_LMIC_EU_like
+	u4_t					channelFreq[MAX_CHANNELS];	// channels of the join accept and of the network commands
+	u2_t					channelDrMap[MAX_CHANNELS];
+	u2_t					channelMap;
+#endif
+} PARK_RTC_STATE_T;
+
+RTC_DATA_ATTR PARK_RTC_STATE_T	parkState;							// state of the last deep sleep
+bool							isWakeFromPark = false;				// this start is a wakeup from the parked mode
+bool							isWakeLatencyPending = false;		// full operation not yet reached after the wakeup
+bool							isTimerWakeup = false;				// the wakeup was the timer of the parked mode
+bool							isLockStateKnown = false;			// lock state has been received from the ESP server
+volatile uint32_t				lastMotionTime = 0;					// millis() of the last motion seen by the i2c task
+uint32_t						parkInactivityMs = PARK_INACTIVITY_MS;	// time without motion before the parked mode
+
 /************************************************************************************************************************/
 /*!
 									  88b           d88 88  ad88888ba    ,ad8888ba,
@@ -305,8 +478,47 @@ BMS_PACKET_STRUCT_T				bmsPacket = { 0 };					// packet for incoming bms data
 									  88     `8'     88 88  "Y88888P"    `"Y8888Y"'
 */
 /************************************************************************************************************************/
-int connectCounter = 0;		// BLE connection tries counter
+bool bmsWriteInfoStatus();
+bool heartyPatchService();
+bool espServerService();
+bool updateValue();
+
+uint32_t lastScanTime = 0;	// last time a scan for missing devices has been started
+
+/* BLE sessions handled by the connection manager, all links are kept open and serviced every cycle. The connect task
+ * only connects, discovers and subscribes, the first action on the link is done by the main task */
+BLE_SESSION_T bleSessions[] = {
+	{ "BMS",			&pBmsDevice,			&pBmsClient,			&isBmsFound,			&isBmsConnected,			bmsWriteInfoStatus,	bmsWriteInfoStatus },
+	{ "HeartyPatch",	&pHeartyPatchDevice,	&pHeartyPatchClient,	&isHeartyFound,			&isHeartyConnected,			heartyPatchService,	heartyPatchService },
+	{ "Controller",		&pControllerDevice,		&pControllerClient,		&isControllerFound,		&isControllerConnected,		nullptr,			nullptr },
+	{ "ESP Server",		&pEspServerDevice,		&pEspServerClient,		&isEspServerFound,		&isEspServerConnected,		espServerService,	updateValue },
+};
+const uint8_t bleSessionCount = sizeof(bleSessions) / sizeof(bleSessions[0]);
+#define BLE_SESSION_ESP_SERVER			3			// index of the ESP server in bleSessions
+
+/* attributes of the ESP server, written and read by their cached handle */
+const GATT_CACHE_ATTR_T espServerAttr[GATT_ATTR_MAX] = {
+	{ TIME_INFO_SRV_SERVICE,	TIME_SET_SRV_CHAR,			false },
+	{ TIME_INFO_SRV_SERVICE,	TIME_LORA_INFO_SRV_CHAR,	false },
+	{ TIME_INFO_SRV_SERVICE,	TIME_ESPTIME_SRV_CHAR,		false },
+	{ HEART_RATE_SRV_SERVICE,	HEART_RATE_SRV_CHAR,		false },
+	{ BMS_MOTOR_SRV_SERVICE,	BMS_MOTOR_SRV_CHAR,			false },
+	{ LOCATION_SRV_SERVICE,		LOCATION_SRV_CHAR,			false },
+	{ MPU_SRV_SERVICE,			MPU_SRV_CHAR,				false },
+	{ TELEMETRY_SRV_SERVICE,	TELEMETRY_SRV_CHAR,			true },
+	{ MPU_SRV_SERVICE,			IMPACT_CAPTURE_SRV_CHAR,	true },
+	{ ILOCKIT_SRV_SERVICE,		LOCK_CONTROL_SRV_CHAR,		true },
+};
+
+volatile uint16_t bleConnMtu[BLE_CONN_ID_MAX] = { 0 };	// result of the MTU exchange per connection id, 0 while pending
+uint8_t telemetryDirty = 0;							// telemetry records changed since the last push, see TELEMETRY_DIRTY()
 
+// filled by the connect task, used by the main task once isEspServerReady()
+GATT_HANDLE_CACHE_T espServerHandleCache = { 0 };	// handles of the connected ESP server
+bool isEspServerCacheValid = false;					// handles are filled for the current connection
+volatile bool isGattCacheInvalidated = false;		// set from the BT stack on service changed or a failed read
+esp_gatt_if_t espServerGattcIf;						// GATT interface of the ESP server connection
+uint16_t espServerConnId;							// connection id of the ESP server connection
 
 
 /************************************************************************************************************************/
@@ -369,10 +581,7 @@ class BMSClientCallbacks : public BLEClientCallbacks {
 		
 		isBmsConnected = false;
 
-		// free the allocated memory and calls destructor for the pClient
-		// COMMENT this if it bring to stack error
-		delete pClient;
-
+		// the client is freed by the connection manager in the main task before the next attempt
 	}
 };
 class HeartyPatchClientCallbacks : public BLEClientCallbacks {
@@ -386,9 +595,7 @@ class HeartyPatchClientCallbacks : public BLEClientCallbacks {
 		
 		isHeartyConnected = false;
 
-		// free the allocated memory and calls destructor for the pClient
-		// COMMENT this if it bring to stack error
-		delete pClient;
+		// the client is freed by the connection manager in the main task before the next attempt
 	}
 };
 class ControllerClientCallbacks : public BLEClientCallbacks {
@@ -402,9 +609,7 @@ class ControllerClientCallbacks : public BLEClientCallbacks {
 		
 		isControllerConnected = false;
 
-		// free the allocated memory and calls destructor for the pClient
-		// COMMENT this if it bring to stack error
-		delete pClient;
+		// the client is freed by the connection manager in the main task before the next attempt
 	}
 };
 class EspServerClientCallbacks : public BLEClientCallbacks {
@@ -418,11 +623,16 @@ class EspServerClientCallbacks : public BLEClientCallbacks {
 		
 		isEspServerConnected = false;
 
-		// free the allocated memory and calls destructor for the pClient
-		delete pClient;
+		// the client is freed by the connection manager in the main task before the next attempt
 	}
 };
 
+// the callbacks are shared by every client created for the same device
+BMSClientCallbacks bmsClientCallbacks;
+HeartyPatchClientCallbacks heartyPatchClientCallbacks;
+ControllerClientCallbacks controllerClientCallbacks;
+EspServerClientCallbacks espServerClientCallbacks;
+
 /************************************************************************************************************************/
 /*!
 								 +-+-+-+ +-+-+-+-+-+-+ +-+-+-+-+-+-+ +-+-+-+-+-+-+-+-+
@@ -430,34 +640,42 @@ class EspServerClientCallbacks : public BLEClientCallbacks {
 								 +-+-+-+ +-+-+-+-+-+-+ +-+-+-+-+-+-+ +-+-+-+-+-+-+-+-+
 */
 /************************************************************************************************************************/
-void bmsNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
+void bmsInfoStatusCallback(const BMS_INFO_STATUS_READ_STRUCT_T *tInfoStatus) {
 
-	BMS_PACKET_STRUCT_T rPacket = { 0 };
+	ESP_LOGI(LOG_TAG, "Get BMS packet");
 
-	// read, verify and decode the incoming packet from BMS BLE server
-	if (bms.bmsReadInfoStatus(&rPacket, pData, length)) {
-		ESP_LOGI(LOG_TAG, "Get BMS packet");
+	// copy the validated info status into the bms packet
+	memcpy(&bmsPacket.tInfoStatus, tInfoStatus, sizeof(bmsPacket.tInfoStatus));
 
-		// copy the incoming data into the bms packet
-		memcpy(&bmsPacket.tInfoStatus, &rPacket.tInfoStatus, sizeof(rPacket.tInfoStatus));
-		
-		// since all the BMS packet in big endian, swapping is not needed
-		bmsMotorServerPacket.tPacket.usBmsTotalVoltage = bmsPacket.tInfoStatus.usTotalVoltage;
-		bmsMotorServerPacket.tPacket.bBatPercentage = bmsPacket.tInfoStatus.bRelStateOfCharge;
+	// since all the BMS packet in big endian, swapping is not needed
+	bmsMotorServerPacket.tPacket.usBmsTotalVoltage = bmsPacket.tInfoStatus.usTotalVoltage;
+	bmsMotorServerPacket.tPacket.bBatPercentage = bmsPacket.tInfoStatus.bRelStateOfCharge;
 
-		// get the current time
-		time(&rawTime);
-		bmsMotorServerPacket.tPacket.ulBmsTime = bswap32((uint32_t)rawTime);	// swap the time into big-endian as required for the server
+	// get the current time
+	time(&rawTime);
+	bmsMotorServerPacket.tPacket.ulBmsTime = bswap32((uint32_t)rawTime);	// swap the time into big-endian as required for the server
 
-		ESP_LOGI(LOG_TAG, "BMS Voltage: %d, RSOC: %d%%, ulBmsTime: %d\n", bswap16(bmsMotorServerPacket.tPacket.usBmsTotalVoltage), bmsMotorServerPacket.tPacket.bBatPercentage, bswap32(bmsMotorServerPacket.tPacket.ulBmsTime));
+	ESP_LOGI(LOG_TAG, "BMS Voltage: %d, RSOC: %d%%, ulBmsTime: %d\n", bswap16(bmsMotorServerPacket.tPacket.usBmsTotalVoltage), bmsMotorServerPacket.tPacket.bBatPercentage, bswap32(bmsMotorServerPacket.tPacket.ulBmsTime));
 
-		isBmsNotifyAvailable = true;
-	}
+	isBmsNotifyAvailable = true;
+}
+
+void bmsNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
+
+	SpanScope span(spanTrace, SPAN_NOTIFY_BMS);
+
+	inputTrace.record(INPUT_TRACE_SOURCE_BMS_NOTIFY, pData, length);
+
+	// feed the fragment into the BMS stream parser, every complete frame ends up in bmsInfoStatusCallback()
+	bms.bmsReadInfoStatus(pData, length);
 }
 
 void controllerNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
 
 	CONTROLLER_PACKET_STRUCT_T controllerPacket = { 0 };
+	SpanScope span(spanTrace, SPAN_NOTIFY_CONTROLLER);
+
+	inputTrace.record(INPUT_TRACE_SOURCE_CONTROLLER_NOTIFY, pData, length);
 
 	// read, verify and decode the incoming packet from Motor Controller BLE server
 	if (controller.readParsePacket(&controllerPacket, pData, length)) {
@@ -480,6 +698,23 @@ void controllerNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic,
 	}
 }
 
+void heartyNotifyCallback(BLERemoteCharacteristic* pBLERemoteCharacteristic, uint8_t* pData, size_t length, bool isNotify) {
+
+	SpanScope span(spanTrace, SPAN_NOTIFY_HEARTY);
+
+	// heart rate measurement: flags, heart rate value (uint8 format)
+	if (length < 2) return;
+
+	heartRateServerPacket.tPacket.bHeartRate = pData[1];
+
+	// get the current time
+	time(&rawTime);
+	heartRateServerPacket.tPacket.ulHeartyTime = bswap32((uint32_t)rawTime);	// swap the time into big-endian as required for the server
+
+	isHeartRateAvailable = true;
+}
+
+
 
 
 /************************************************************************************************************************/
@@ -514,38 +749,112 @@ void updateLoraPacket() {
 
 /************************************************************************************************************************/
 /*!
-* @brief		set the serial packet
-* @param[in]	*tSerialWritePacket	pointer to the serial packet to be set
-* @param[in]	len					payload length
-* @param[in]	cmdID				command ID
-* @param[in]	*val				payload value in byte array
-* @retval		packet size
+* @brief		take a sample of the lora packet into the lora store every TX_INTERVAL, independent of the uplink
+* @param[in]	j					LMIC job
+* @retval		none
+*/
+/************************************************************************************************************************/
+void do_sample(osjob_t* j) {
+
+	time(&rawTime);
+	updateLoraPacket();
+
+	if (!loraStore.push(LORA_RECORD_SAMPLE, (uint32_t)rawTime, loraPacket.abPacket, sizeof(loraPacket.abPacket))) {
+		ESP_LOGE(LOG_TAG, "Lora sample not stored");
+	}
+
+	os_setTimedCallback(&samplejob, os_getTime() + sec2osticks(TX_INTERVAL), do_sample);
+
+	if (!isLoraUplinkPending) do_send(&sendjob);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		largest uplink payload at the current data rate
+* @retval		payload limit in bytes
+*/
+/************************************************************************************************************************/
+size_t loraPayloadLimit() {
+
+	return loraPayloadLimitOf(LMICeu868_maxFrameLen(LMIC.datarate), MAX_LEN_FRAME);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		queue the oldest samples of the lora store as uplink, they are removed from the store after
+*				EV_TXCOMPLETE. The frame is selected by loraSelectUplink(), a batch of several samples, a single live
+*				sample as key/delta frame or a single old sample with its sample time. While the link is lost only a
+*				confirmed probe of the oldest samples is sent every TX_INTERVAL.
+* @param[in]	j					LMIC job
+* @retval		none
 */
 /************************************************************************************************************************/
 void do_send(osjob_t* j) {
+
+	TELEMETRY_RECORD_T atRecords[LORA_BATCH_MAX_RECORDS];
+	uint8_t abFrame[sizeof(uint32_t) + TELEMETRY_STORE_DATA_LEN];
+	LORA_UPLINK_T tUplink;
+	uint16_t records;
+
 	// Check if there is not a current TX/RX job running
 	if (LMIC.opmode & OP_TXRXPEND) {
 		ESP_LOGI(LOG_TAG, "OP_TXRXPEND, not sending");
+		return;
+	}
+
+	if (isLoraUplinkPending) return;
+
+	records = loraStore.peek(atRecords, LORA_BATCH_MAX_RECORDS);
 
+	time(&rawTime);
+	if (!loraSelectUplink(atRecords, records, (uint32_t)rawTime, isLoraLinkUp, loraPayloadLimit(), loraCodec, loraBatch,
+		abFrame, &tUplink)) return;
+
+	loraUplinkRecords = tUplink.bRecords;
+	loraPayloadBytes += tUplink.len;
+	loraPayloadSamples += tUplink.bRecords;
+	ESP_LOGI(LOG_TAG, "Lora average payload: %d bytes per sample", loraPayloadBytes / loraPayloadSamples);
+
+	isLoraUplinkConfirmed = !isLoraLinkUp || (++loraUplinkCount >= LORA_CONFIRM_INTERVAL);
+	if (isLoraUplinkConfirmed) loraUplinkCount = 0;
+
+	// Prepare upstream data transmission at the next possible time, LMIC delays it until the duty cycle allows it.
+	// Without a session this starts OTAA and the uplink follows the join.
+	LMIC_setTxData2(tUplink.bPort, (xref2u1_t)tUplink.pFrame, tUplink.len, isLoraUplinkConfirmed ? 1 : 0);
+	isLoraUplinkPending = true;
+	ESP_LOGI(LOG_TAG, "Lora Packet queued on port %d, %d bytes, %d of %d samples\n", tUplink.bPort, tUplink.len, loraUplinkRecords,
+		loraStore.count());
+
+	if (isLoraSessionKeyAvailable) {
+		time(&rawTime);
+		timeInfoServerPacket.tLoraLastSendPackageTime.ulValue = bswap32((uint32_t)rawTime);
+		isLoraPacketSent = true;
 	}
-	else {
-		if (isLoraSessionKeyAvailable) {
-			time(&rawTime);
-			timeInfoServerPacket.tLoraLastSendPackageTime.ulValue = bswap32((uint32_t)rawTime);
-			updateLoraPacket();
+}
 
-			// Prepare upstream data transmission at the next possible time.
-			LMIC_setTxData2(1, loraPacket.abPacket, sizeof(loraPacket.abPacket), 0);
-			ESP_LOGI(LOG_TAG, "Lora Packet queued\n");
+/************************************************************************************************************************/
+/*!
+* @brief		record a LMIC event with the received downlink, payload: event, txrxFlags, dataLen, downlink bytes
+* @param[in]	ev					LMIC event
+* @retval		none
+*/
+/************************************************************************************************************************/
+void traceLmicEvent(ev_t ev) {
+	uint8_t abEvent[3 + MAX_LEN_FRAME];
+	uint16_t len = 3;
 
-			isLoraPacketSent = true;
-		}
+	if (!inputTrace.isEnabled(INPUT_TRACE_SOURCE_LMIC_EVENT)) return;
 
-		else {
-			LMIC_setTxData2(1, loraPacket.abPacket, sizeof(loraPacket.abPacket), 0);
-		}
+	abEvent[0] = (uint8_t)ev;
+	abEvent[1] = LMIC.txrxFlags;
+	abEvent[2] = LMIC.dataLen;
+
+	if (ev == EV_TXCOMPLETE && LMIC.dataLen > 0) {
+		memcpy(&abEvent[len], &LMIC.frame[LMIC.dataBeg], LMIC.dataLen);
+		len += LMIC.dataLen;
 	}
-	// Next TX is scheduled after TX_COMPLETE event.
+
+	inputTrace.record(INPUT_TRACE_SOURCE_LMIC_EVENT, abEvent, len);
 }
 
 /************************************************************************************************************************/
@@ -559,6 +868,10 @@ void do_send(osjob_t* j) {
 */
 /************************************************************************************************************************/
 void onEvent(ev_t ev) {
+
+	spanTrace.instant(SPAN_LMIC_EVENT, ev);
+	traceLmicEvent(ev);
+
 	switch (ev) {
 	case EV_JOINING:
 		ESP_LOGI(LOG_TAG, "%d: EV_JOINING", os_getTime());
@@ -574,6 +887,9 @@ void onEvent(ev_t ev) {
 
 			isLoraSessionKeyAvailable = true;
 
+			// the frame counter starts again, the next sample is a key frame
+			loraCodec.reset();
+
 			sprintf(
 				nwkKeyBuffer,
 				"%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X,%.2X",
@@ -613,8 +929,24 @@ void onEvent(ev_t ev) {
 		if (LMIC.dataLen)
 			ESP_LOGI(LOG_TAG, "Received %d bytes of payload", LMIC.dataLen);
 
-		// Schedule next transmission
-		os_setTimedCallback(&sendjob, os_getTime() + sec2osticks(TX_INTERVAL), do_send);
+		if (isLoraUplinkPending) {
+			isLoraUplinkPending = false;
+
+			// an unacknowledged confirmed uplink means lost link, the samples are kept until it is back
+			if (!isLoraUplinkConfirmed || (LMIC.txrxFlags & TXRX_ACK)) {
+				loraStore.pop(loraUplinkRecords);
+				if (isLoraUplinkConfirmed) isLoraLinkUp = true;
+			}
+			else {
+				ESP_LOGW(LOG_TAG, "Lora link lost, %d samples stored", loraStore.count());
+				isLoraLinkUp = false;
+				loraCodec.reset();
+			}
+		}
+
+		// drain the backlog right away, the next uplink is held back by LMIC until the duty cycle allows it.
+		// New samples are taken by the sample job.
+		if (isLoraLinkUp && !loraStore.isEmpty()) os_setCallback(&sendjob, do_send);
 		break;
 	case EV_LOST_TSYNC:
 		ESP_LOGI(LOG_TAG, "%d: EV_LOST_TSYNC", os_getTime());
@@ -653,7 +985,9 @@ void setupBLEScanner() {
 	pScan->setInterval(100);
 	pScan->setWindow(99);
 	pScan->setActiveScan(true);
-	pScan->start(5, true);														// start the BLE scan
+
+	// the first scan blocks the setup, after a wakeup from the parked mode the connection manager scans instead
+	if (!isWakeFromPark) pScan->start(5, true);									// start the BLE scan
 }
 
 
@@ -706,15 +1040,62 @@ void setupIMU() {
 		ESP_LOGI(LOG_TAG, "IMU connected");
 		isImuConnected = true;
 
-		// calibrate the IMU
-		while (!IMU.calibrateAccel()) {};
+		// calibrate the IMU, a wakeup from the parked mode takes the calibration from the RTC memory
+		if (isWakeFromPark) {
+			IMU.setAccelCalX(parkState.afAccelBias[0], parkState.afAccelScale[0]);
+			IMU.setAccelCalY(parkState.afAccelBias[1], parkState.afAccelScale[1]);
+			IMU.setAccelCalZ(parkState.afAccelBias[2], parkState.afAccelScale[2]);
+		}
+		else {
+			while (!IMU.calibrateAccel()) {};
+		}
 		
 		// set the range for accelerometer and gyrometer
 		IMU.setAccelRange(IMU.ACCEL_RANGE_16G);
 		IMU.setGyroRange(IMU.GYRO_RANGE_500DPS);
+
+		// sample accel and gyro into the IMU FIFO at a fixed rate, the data ready interrupt wakes the i2c task
+		int result = IMU.enableSampling(mpuIntPin, IMU_ODR_HZ, IMU_BATCH_SAMPLES);
+		if (result < 0) {
+			ESP_LOGE(LOG_TAG, "IMU sampling setup failed: %d", result);
+		}
+		else {
+			ESP_LOGI(LOG_TAG, "IMU sampling at %d Hz", IMU.getSampleRate());
+
+			// keep the raw samples for the capture of the impact waveform
+			impactCapture.begin(IMPACT_CAPTURE_PARTITION, IMU.getSampleRate(), IMPACT_CAPTURE_PRE_MS, IMPACT_CAPTURE_POST_MS, IMU.getAccelScale(), IMU.getGyroScale());
+			IMU.setSampleHandler(imuSampleHandler);
+
+			// the raw FIFO is only handed out if it is recorded
+			if (inputTrace.isEnabled(INPUT_TRACE_SOURCE_IMU_FIFO)) IMU.setFifoHandler(imuFifoHandler);
+		}
 	}
 }
 
+/************************************************************************************************************************/
+/*!
+* @brief		raw IMU sample from the FIFO, called by the detector in the i2c task
+* @param[in]	sample					running number of the sample
+* @param[in]	counts					ax, ay, az, gx, gy, gz in sensor counts
+* @retval		none
+*/
+/************************************************************************************************************************/
+void imuSampleHandler(uint32_t sample, const int16_t* counts) {
+	impactCapture.push(sample, counts);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		raw burst read from the IMU FIFO, called by the detector in the i2c task
+* @param[in]	frames					FIFO frames as read from the sensor
+* @param[in]	len						length of the frames in bytes
+* @retval		none
+*/
+/************************************************************************************************************************/
+void imuFifoHandler(const uint8_t* frames, size_t len) {
+	inputTrace.record(INPUT_TRACE_SOURCE_IMU_FIFO, frames, len);
+}
+
 /************************************************************************************************************************/
 /*!
 * @brief		setup the GPS
@@ -723,21 +1104,28 @@ void setupIMU() {
 /************************************************************************************************************************/
 void setupGPS() {
 
-	// setup the GPS i2c communication
-	isGpsConnected = L76.begin(Wire, I2C_SPEED_STANDARD, SDA, SCL);
+	// setup the GPS i2c communication, fast mode like the IMU on the same bus
+	isGpsConnected = L76.begin(Wire, I2C_SPEED_FAST, SDA, SCL);
 
 	if (!isGpsConnected) ESP_LOGI(LOG_TAG, "GPS failed to connect");
 
 	else {
 		ESP_LOGI(LOG_TAG, "GPS connected");
 
+		// any command ends the standby of the parked mode
+		if (isWakeFromPark) L76.sendMTKpacket(L76.createMTKpacket(0, ""));
+
+		// only the sentences which are parsed, every other sentence would be read over i2c for nothing
+		if (!L76.setNmeaOutput(1, 1) || !L76.setFixInterval(GPS_FIX_INTERVAL_MS)) {
+			ESP_LOGE(LOG_TAG, "GPS output configuration failed");
+		}
+
+		gps.setFixHandler(gpsFixHandler);
+
 		// check if there is valid data from GPS
 		if (L76.available()) {
 			ESP_LOGI(LOG_TAG, "Check and encode GPS data");
-			while (L76.available()) {
-				// encode the incoming data from gps
-				gps.encode(L76.read());
-			}
+			encodeGPS();
 
 			// setup gps time as current system time if the time data is valid
 			if (gps.time.isValid()) {
@@ -749,6 +1137,69 @@ void setupGPS() {
 	}
 }
 
+/************************************************************************************************************************/
+/*!
+* @brief		feed all bytes read from the GPS to the NMEA parser, chunk by chunk
+* @retval		none
+*/
+/************************************************************************************************************************/
+void encodeGPS() {
+	char buffer[GPS_ENCODE_CHUNK];
+
+	while (L76.available()) {
+		uint8_t len = L76.read(buffer, sizeof(buffer));
+		inputTrace.record(INPUT_TRACE_SOURCE_GPS, buffer, len);
+		gps.encode(buffer, len);
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		called by the NMEA parser for every valid RMC/GGA sentence with a fix
+* @param		gps			parser holding the new fix
+* @retval		none
+*/
+/************************************************************************************************************************/
+void gpsFixHandler(TinyGPSPlus &gps) {
+	isGpsFixAvailable = true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		convert micro degrees to float degrees without a double operation
+* @param		microdegrees	signed micro degrees
+* @retval		degrees
+*/
+/************************************************************************************************************************/
+float microdegreesToFloat(int32_t microdegrees) {
+	// integer and fractional part are converted separately to keep the resolution of the float
+	return (float)(microdegrees / 1000000) + (float)(microdegrees % 1000000) * 1e-6f;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		log the share of the i2c bus taken by the GPS reads every GPS_BUS_LOG_INTERVAL_MS
+* @retval		none
+*/
+/************************************************************************************************************************/
+void logGpsBusTime() {
+
+	uint32_t elapsed = millis() - gpsBusLogTime;
+
+	if (!isGpsConnected || elapsed < GPS_BUS_LOG_INTERVAL_MS) return;
+
+	uint32_t busTimeUs = L76.getBusTimeUs();
+	uint32_t busBytes = L76.getBytesRead();
+
+	ESP_LOGI(LOG_TAG, "GPS i2c bus time: %d us/s, %d bytes/s",
+		(uint32_t)((uint64_t)(busTimeUs - gpsBusTimeUs) * 1000 / elapsed),
+		(uint32_t)((uint64_t)(busBytes - gpsBusBytes) * 1000 / elapsed));
+
+	gpsBusLogTime += elapsed;
+	gpsBusTimeUs = busTimeUs;
+	gpsBusBytes = busBytes;
+}
+
 /************************************************************************************************************************/
 /*!
 * @brief		update the display frame
@@ -762,48 +1213,134 @@ void setupGPS() {
 /************************************************************************************************************************/
 void disp_frame(uint16_t *totalVoltage, uint16_t *sessionCount, struct tm *timeInfo, uint8_t *bpmCount, uint8_t lcState) {
 #if DISPLAY_AVAIL > 0
+	char acTime[DISPLAY_WIDGET_TEXT_LEN + 1];
+
 	//ESP_LOGI(LOG_TAG, "update display");
-	u8g2.clearBuffer();								/** clear the internal memory */
-	u8g2.setFont(u8g2_font_helvR12_tr);				/** choose font */
-	u8g2.setFontRefHeightAll();  					/* this will add some extra space for the text inside the buttons */
-	u8g2.setCursor(0, 16);
-	u8g2.printf("Vbms: ");
-	u8g2.setCursor(0, 32);
-	u8g2.printf("%.2f", bswap16(*totalVoltage) / 100.0);	/** BMS voltage */
-	u8g2.drawStr(52, 32, "V");
-	u8g2.drawStr(0, 56, "Session:");
-	u8g2.setCursor(0, 72);
-	u8g2.printf("%03d", *sessionCount);						/** session time */
-	u8g2.drawStr(37, 72, "min");
-	u8g2.setCursor(8, 104);
+	dispVbms.setValue(bswap16(*totalVoltage) / 100.0);							/** BMS voltage */
+	dispSession.setValue((int32_t)*sessionCount);								/** session time */
+
 	if (timeInfo->tm_hour > 12) {
-		u8g2.printf("%02d:%02d", timeInfo->tm_hour - 12, timeInfo->tm_min);		/** time */
-		u8g2.drawStr(18, 120, "pm");
+		snprintf(acTime, sizeof(acTime), "%02d:%02d", timeInfo->tm_hour - 12, timeInfo->tm_min);	/** time */
+		dispAmPm.setText("pm");
 	}
 	else {
-		u8g2.printf("%02d:%02d", timeInfo->tm_hour, timeInfo->tm_min);			/** time */
-		u8g2.drawStr(18, 120, "am");
+		snprintf(acTime, sizeof(acTime), "%02d:%02d", timeInfo->tm_hour, timeInfo->tm_min);		/** time */
+		dispAmPm.setText("am");
 	}
+	dispTime.setText(acTime);
 
-	u8g2.setCursor(2, 152);
-	u8g2.printf("%3d", *bpmCount);												/** heart rate */
-	u8g2.drawStr(0, 172, "bpm");
+	dispBpm.setValue((int32_t)*bpmCount);										/** heart rate */
 
 	if (heartIconCycle) {
-		u8g2.drawXBMP(34, 145, heart_ekg_width, heart_ekg_height, heart_ekg_bits);
+		dispHeart.setIcon(heart_ekg_width, heart_ekg_height, heart_ekg_bits);
 		heartIconCycle = false;
 	}
 	else {
-		u8g2.drawXBMP(34, 145, heart_full_width, heart_full_height, heart_full_bits);
+		dispHeart.setIcon(heart_full_width, heart_full_height, heart_full_bits);
 		heartIconCycle = true;
 	}
 
-	u8g2.drawXBMP(0, 180, lock_width, lock_height, lock_bits);
+	dispLock.setIcon(lock_width, lock_height, lock_bits);
 
-	u8g2.sendBuffer();								// transfer internal memory to the display
+	spanTrace.beginSpan(SPAN_DISPLAY_RENDER);
+	displayScene.render();							// redraw the changed widgets only
+	spanTrace.endSpan(SPAN_DISPLAY_RENDER);
+	sendDisplayBuffer();							// hand the frame over to the display flush task
 #endif
 }
 
+#if DISPLAY_AVAIL > 0
+/************************************************************************************************************************/
+/*!
+* @brief		u8x8 byte callback of the display, the arduino hw spi callback with the spi bus arbitration added. A
+*				transfer (one tile row) pauses between two tiles when the lora radio waits for the bus.
+* @retval		result of the arduino hw spi callback
+*/
+/************************************************************************************************************************/
+uint8_t displayByteCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
+	uint8_t result;
+
+	switch (msg) {
+	case U8X8_MSG_BYTE_START_TRANSFER:
+		spanTrace.beginSpan(SPAN_WAIT_SPI, SPI_BUS_CLASS_DISPLAY);
+		spiBus.acquire(SPI_BUS_CLASS_DISPLAY, portMAX_DELAY);
+		spanTrace.endSpan(SPAN_WAIT_SPI);
+		isDisplayDataSent = false;
+		break;
+
+	case U8X8_MSG_BYTE_SET_DC:
+		// a command after pixel data starts the next tile, the controller does not care about a pause there
+		if (arg_int == 0 && isDisplayDataSent && spiBus.isPreemptRequested(SPI_BUS_CLASS_DISPLAY)) {
+			u8x8_byte_arduino_hw_spi(u8x8, U8X8_MSG_BYTE_END_TRANSFER, 0, NULL);
+			spiBus.yield(SPI_BUS_CLASS_DISPLAY);
+			u8x8_byte_arduino_hw_spi(u8x8, U8X8_MSG_BYTE_START_TRANSFER, 0, NULL);
+		}
+		isDisplayDataSent = (arg_int != 0);
+		break;
+	}
+
+	result = u8x8_byte_arduino_hw_spi(u8x8, msg, arg_int, arg_ptr);
+
+	if (msg == U8X8_MSG_BYTE_END_TRANSFER) spiBus.release(SPI_BUS_CLASS_DISPLAY);
+
+	return result;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		transfer the damaged tiles of a frame to the display, every run of damaged tiles in a tile row with one
+*				u8x8_DrawTile()
+* @param[in]	pFrame				pointer to the frame in the u8g2 full buffer layout
+* @param[in]	pulDamage			damaged tiles, one mask per tile row
+* @retval		none
+*/
+/************************************************************************************************************************/
+void flushDisplay(uint8_t *pFrame, const uint32_t *pulDamage) {
+	u8x8_t *pU8x8 = u8g2.getU8x8();
+	uint8_t bTileWidth = u8g2.getBufferTileWidth();
+
+	for (uint8_t row = 0; row < DISPLAY_TILE_ROWS; row++) {
+		uint8_t col = 0;
+
+		while (col < bTileWidth) {
+			if (!(pulDamage[row] & (1UL << col))) {
+				col++;
+				continue;
+			}
+
+			uint8_t first = col;
+			while (col < bTileWidth && (pulDamage[row] & (1UL << col))) col++;
+
+			u8x8_DrawTile(pU8x8, first, row, col - first, pFrame + ((uint16_t)row * bTileWidth + first) * 8);
+		}
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		hand the damaged tiles of the rendered frame over to the display flush task. If the previous frame is
+*				still being flushed the damage stays in the scene and goes out with the next frame.
+* @retval		none
+*/
+/************************************************************************************************************************/
+void sendDisplayBuffer() {
+
+	if (!displayScene.isDamaged() || isDisplayFlushBusy) return;
+
+	displayScene.takeDamage(aulDisplayDamage, DISPLAY_TILE_ROWS);
+	memcpy(abDisplayBuffer, u8g2.getBufferPtr(), DISPLAY_BUFFER_SIZE);
+
+	// before the tasks are started (setup) the frame is sent right away
+	if (xTaskDisplayFlush == NULL) {
+		flushDisplay(abDisplayBuffer, aulDisplayDamage);
+		return;
+	}
+
+	isDisplayFlushBusy = true;
+	xTaskNotifyGive(xTaskDisplayFlush);
+}
+#endif
+
 /************************************************************************************************************************/
 /*!
 * @brief		update the display
@@ -838,8 +1375,26 @@ void updateDisplay() {
 void setupDisplay() {
 #if DISPLAY_AVAIL > 0
 
+	// the display shares the spi bus with the lora radio
+	u8g2.getU8x8()->byte_cb = displayByteCallback;
+
 	// begin the communication with the display
 	u8g2.begin();
+	u8g2.setFontRefHeightAll();  					/* this will add some extra space for the text inside the buttons */
+
+	// widgets in drawing order, the first render() draws all of them
+	displayScene.add(dispVbmsLabel);
+	displayScene.add(dispVbms);
+	displayScene.add(dispVbmsUnit);
+	displayScene.add(dispSessionLabel);
+	displayScene.add(dispSession);
+	displayScene.add(dispSessionUnit);
+	displayScene.add(dispTime);
+	displayScene.add(dispAmPm);
+	displayScene.add(dispBpm);
+	displayScene.add(dispBpmUnit);
+	displayScene.add(dispHeart);
+	displayScene.add(dispLock);
 
 	// update the display
 	updateDisplay();
@@ -848,63 +1403,378 @@ void setupDisplay() {
 
 /************************************************************************************************************************/
 /*!
-* @brief		setup the BLE client
+* @brief		setup automatic light sleep while all tasks are blocked, only if the core is built with power management
+*				and tickless idle. The radio interrupt is an edge on a gpio which can not wake the chip, so light sleep is
+*				locked while a lora tx/rx is running (updatePowerLock()), the lmic deadlines are timer wakeups. With
+*				the stock Arduino-ESP32 core the chip stays awake, see the warning at startup.
 * @retval		none
 */
 /************************************************************************************************************************/
-void setupBLEClient() {
-
-	ESP_LOGI(LOG_TAG, "Initialise the BLE Clients");
+void setupPowerManagement() {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
 
-	// Bms client
-	pBmsClient = BLEDevice::createClient();
-	pBmsClient->setClientCallbacks(new BMSClientCallbacks());
+	esp_pm_config_esp32_t pmConfig;
+	pmConfig.max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+	pmConfig.min_freq_mhz = 80;
+	pmConfig.light_sleep_enable = true;
 
-	// HeartyPatch client
-	pHeartyPatchClient = BLEDevice::createClient();
-	pHeartyPatchClient->setClientCallbacks(new HeartyPatchClientCallbacks());
+	if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "lora", &xPmLockLora) != ESP_OK ||
+		esp_pm_configure(&pmConfig) != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "Automatic light sleep not available");
+	}
+#else
+	// the prebuilt sdk of the Arduino core has both disabled, the idle time of hal_waitForEvent() saves no power then
+	ESP_LOGW(LOG_TAG, "Core built without CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE, no light sleep");
+#endif
+}
 
-	// Motor controller clinet
-	pControllerClient = BLEDevice::createClient();
-	pControllerClient->setClientCallbacks(new ControllerClientCallbacks());
+/************************************************************************************************************************/
+/*!
+* @brief		keep the chip awake while lmic has a tx/rx in progress
+* @retval		none
+*/
+/************************************************************************************************************************/
+void updatePowerLock() {
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
 
-	// ESP Server client
-	pEspServerClient = BLEDevice::createClient();
-	pEspServerClient->setClientCallbacks(new EspServerClientCallbacks());
+	bool isRadioBusy = (LMIC.opmode & OP_TXRXPEND) != 0;
 
+	if (isRadioBusy != isPmLockLoraTaken) {
+		if (isRadioBusy) esp_pm_lock_acquire(xPmLockLora);
+		else esp_pm_lock_release(xPmLockLora);
+		isPmLockLoraTaken = isRadioBusy;
+	}
+#endif
 }
 
 /************************************************************************************************************************/
 /*!
-* @brief		check the availability of the ble service, characteristic needed
-* @param[in]	pClient					pointer to the BLE client object
-* @param[in]	pRemoteService			pointer to the BLE remote service object
-* @param[in]	pRemoteCharacteristic	pointer to the BLE remote characteristic object
-* @param[in]	remoteServiceUUID		remote service UUID
-* @param[in]	remoteCharUUID			remote characteristic UUID
-* @retval		true, if all available, false if one of them not available
+* @brief		take over the state of the RTC memory if this start is a wakeup from the parked mode, the system time
+*				has been kept by the RTC
+* @retval		true if the state has been restored, false on a power on or reset
 */
 /************************************************************************************************************************/
-bool checkServiceCharacteristic(BLEClient* &pClient,
-								BLERemoteService* &pRemoteService,
-								BLERemoteCharacteristic* &pRemoteCharacteristic,
-								BLEUUID remoteServiceUUID,
-								BLEUUID remoteCharUUID) 
-{
-	ESP_LOGI(LOG_TAG, "Check Service Characteristic");
+bool restoreParkState() {
 
-	if (pClient == nullptr) {
-		ESP_LOGE(LOG_TAG, "pClient is null pointer");
-		return false;
-	}
+	esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
 
-	// check if connected to the ble server
-	if (!pClient->isConnected()) {
+	isWakeFromPark = (parkState.ulMagic == PARK_RTC_MAGIC) &&
+		(wakeCause == ESP_SLEEP_WAKEUP_EXT0 || wakeCause == ESP_SLEEP_WAKEUP_TIMER);
+
+	if (!isWakeFromPark) {
+		memset(&parkState, 0, sizeof(parkState));
 		return false;
 	}
 
-	// get the remote service of the BLE client object based on the given UUID
-	pRemoteService = pClient->getService(remoteServiceUUID);
+	// the state belongs to this wakeup only, a later reset starts over
+	parkState.ulMagic = 0;
+	isWakeLatencyPending = true;
+	isTimerWakeup = (wakeCause == ESP_SLEEP_WAKEUP_TIMER);
+
+	setupTime(time(NULL));
+	lastConfigTime = parkState.ulConfigTime;
+
+	bmsMotorServerPacket = parkState.tBmsMotor;
+	ilockitServerPacket = parkState.tLock;
+	timeInfoServerPacket = parkState.tTimeInfo;
+	heartRateServerPacket = parkState.tHeartRate;
+	locationServerPacket = parkState.tLocation;
+	mpuServerPacket = parkState.tMpu;
+	telemetryDirty = parkState.bTelemetryDirty;
+	isLockStateKnown = parkState.isLockStateKnown;
+
+	// a timer wakeup only sends the periodic uplink and parks again, motion gets the full inactivity time
+	parkInactivityMs = (wakeCause == ESP_SLEEP_WAKEUP_TIMER) ? PARK_TIMER_AWAKE_MS : PARK_INACTIVITY_MS;
+
+	ESP_LOGI(LOG_TAG, "Wakeup from parked mode by %s after %d s", (wakeCause == ESP_SLEEP_WAKEUP_EXT0) ? "motion" : "timer",
+		(uint32_t)time(NULL) - parkState.ulSleepTime);
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		continue the lora session of the parked mode without a new join, called by the ttn task after
+*				LMIC_reset()
+* @retval		none
+*/
+/************************************************************************************************************************/
+void restoreLoraSession() {
+
+	if (!isWakeFromPark || !parkState.isLoraSessionValid) return;
+
+	LMIC_setSession(parkState.netid, parkState.devaddr, parkState.nwkKey, parkState.artKey);
+
+#if CFG_LMIC_EU_like
+	memcpy(LMIC.channelFreq, parkState.channelFreq, sizeof(LMIC.channelFreq));
+	memcpy(LMIC.channelDrMap, parkState.channelDrMap, sizeof(LMIC.channelDrMap));
+	LMIC.channelMap = parkState.channelMap;
+#endif
+
+	// the network server drops frames with a frame counter it has already seen
+	LMIC.seqnoUp = parkState.seqnoUp;
+	LMIC.seqnoDn = parkState.seqnoDn;
+	LMIC.rxDelay = parkState.rxDelay;
+	LMIC.rx1DrOffset = parkState.rx1DrOffset;
+	LMIC.dn2Dr = parkState.dn2Dr;
+	LMIC.dn2Freq = parkState.dn2Freq;
+	LMIC_setDrTxpow(parkState.datarate, parkState.adrTxPow);
+
+	isLoraSessionKeyAvailable = true;
+
+	// the codec state is gone, the next sample is a key frame
+	loraCodec.reset();
+
+	ESP_LOGI(LOG_TAG, "Lora session restored, seqnoUp: %d", LMIC.seqnoUp);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		keep the lora session in the RTC memory, the caller holds the radio on the spi bus
+* @retval		none
+*/
+/************************************************************************************************************************/
+void saveLoraSession() {
+
+	parkState.isLoraSessionValid = isLoraSessionKeyAvailable && (LMIC.devaddr != 0);
+
+	if (!parkState.isLoraSessionValid) return;
+
+	LMIC_getSessionKeys(&parkState.netid, &parkState.devaddr, parkState.nwkKey, parkState.artKey);
+
+#if CFG_LMIC_EU_like
+	memcpy(parkState.channelFreq, LMIC.channelFreq, sizeof(parkState.channelFreq));
+	memcpy(parkState.channelDrMap, LMIC.channelDrMap, sizeof(parkState.channelDrMap));
+	parkState.channelMap = LMIC.channelMap;
+#endif
+
+	parkState.seqnoUp = LMIC.seqnoUp;
+	parkState.seqnoDn = LMIC.seqnoDn;
+	parkState.datarate = LMIC.datarate;
+	parkState.adrTxPow = LMIC.adrTxPow;
+	parkState.rxDelay = LMIC.rxDelay;
+	parkState.rx1DrOffset = LMIC.rx1DrOffset;
+	parkState.dn2Dr = LMIC.dn2Dr;
+	parkState.dn2Freq = LMIC.dn2Freq;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		end of the wakeup from the parked mode, called with the first IMU samples after the wakeup. The RTC timer
+*				runs on through the deep sleep: a timer wakeup is counted from its programmed tick, ROM and bootloader
+*				included. A motion wakeup is not timestamped, it is counted from the start of the application plus
+*				the ROM and bootloader time of the last timer wakeup.
+* @retval		none
+*/
+/************************************************************************************************************************/
+void reportWakeLatency() {
+
+	isWakeLatencyPending = false;
+
+	uint32_t ulAppMs = (uint32_t)(esp_timer_get_time() / 1000);
+	uint32_t ulLatencyMs;
+
+	if (isTimerWakeup) {
+		// the few ticks late are converted with the calibration of this start
+		uint64_t ullNowTicks = rtc_time_get();
+		uint64_t ullLateTicks = (ullNowTicks > parkState.ullWakeTimerTicks) ? ullNowTicks - parkState.ullWakeTimerTicks : 0;
+
+		ulLatencyMs = (uint32_t)(rtc_time_slowclk_to_us(ullLateTicks, esp_clk_slowclk_cal_get()) / 1000);
+		parkState.ulBootMs = (ulLatencyMs > ulAppMs) ? ulLatencyMs - ulAppMs : 0;
+	}
+	else {
+		ulLatencyMs = parkState.ulBootMs + ulAppMs;
+	}
+
+	parkState.ulLastWakeLatencyMs = ulLatencyMs;
+	if (ulLatencyMs > parkState.ulMaxWakeLatencyMs) parkState.ulMaxWakeLatencyMs = ulLatencyMs;
+
+	if (ulLatencyMs > PARK_WAKE_LATENCY_MAX_MS) {
+		ESP_LOGW(LOG_TAG, "Wake latency %d ms exceeds %d ms", ulLatencyMs, PARK_WAKE_LATENCY_MAX_MS);
+	}
+	ESP_LOGI(LOG_TAG, "Wake latency: %d ms, max %d ms over %d parked periods", ulLatencyMs, parkState.ulMaxWakeLatencyMs,
+		parkState.ulParkCount);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		enter the parked mode if the bike is locked and has not been moved for parkInactivityMs
+* @retval		none
+*/
+/************************************************************************************************************************/
+void checkParkedMode() {
+
+	// without the lock state or the IMU to wake up again the gateway stays awake
+	if (!isImuConnected || !isLockStateKnown || ilockitServerPacket.tPacket.bLockState != LOCK_CLOSE) return;
+
+	if (millis() - lastMotionTime < parkInactivityMs) return;
+
+	// a running impact evaluation or a capture which is not stored yet would be lost
+	if (IMU.isImpactPending() || impactCapture.isFrozen()) return;
+
+	// a connect task in the stack would be left running while the stack is disabled, wait for its result
+	for (uint8_t i = 0; i < bleSessionCount; i++) {
+		if (bleSessions[i].eState == BLE_SESSION_CONNECTING) return;
+	}
+
+	enterParkedMode();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		stop scanning, GPS standby, keep the state in the RTC memory and deep sleep until the IMU detects motion
+*				or the wakeup timer expires. Called by the main task, returns only if a lora tx/rx is running.
+* @retval		none
+*/
+/************************************************************************************************************************/
+void enterParkedMode() {
+
+	ESP_LOGI(LOG_TAG, "Enter parked mode");
+
+#if DISPLAY_AVAIL > 0
+	// before the radio is taken, the display callback acquires the spi bus itself
+	u8g2.setPowerSave(1);
+#endif
+
+	// from here on the ttn task is stopped between two lmic jobs, the bus is held until the deep sleep
+	spanTrace.beginSpan(SPAN_WAIT_SPI, SPI_BUS_CLASS_RADIO);
+	spiBus.acquire(SPI_BUS_CLASS_RADIO, portMAX_DELAY);
+	spanTrace.endSpan(SPAN_WAIT_SPI);
+
+	if (LMIC.opmode & OP_TXRXPEND) {
+		spiBus.release(SPI_BUS_CLASS_RADIO);
+#if DISPLAY_AVAIL > 0
+		u8g2.setPowerSave(0);
+#endif
+		return;
+	}
+
+	// the i2c task stops after its current batch
+	spanTrace.beginSpan(SPAN_WAIT_I2C);
+	xSemaphoreTake(xSemaphoreI2c, portMAX_DELAY);
+	spanTrace.endSpan(SPAN_WAIT_I2C);
+
+	// stop scanning and close the links, the peers see a regular disconnect
+	pScan->stop();
+	for (uint8_t i = 0; i < bleSessionCount; i++) {
+		if (*bleSessions[i].pIsConnected && *bleSessions[i].ppClient != nullptr) (*bleSessions[i].ppClient)->disconnect();
+	}
+
+	// GPS standby, the next command wakes it up
+	if (isGpsConnected) L76.sendMTKpacket(L76.createMTKpacket(161, ",0"));
+
+	// records which have not been forwarded are kept in flash anyway
+	bleStore.flush();
+	loraStore.flush();
+	inputTrace.flush();
+
+	// state for the wakeup
+	parkState.ulParkCount++;
+	parkState.ulSleepTime = (uint32_t)time(NULL);
+	parkState.ulConfigTime = lastConfigTime;
+	parkState.tBmsMotor = bmsMotorServerPacket;
+	parkState.tLock = ilockitServerPacket;
+	parkState.tTimeInfo = timeInfoServerPacket;
+	parkState.tHeartRate = heartRateServerPacket;
+	parkState.tLocation = locationServerPacket;
+	parkState.tMpu = mpuServerPacket;
+	parkState.bTelemetryDirty = telemetryDirty;
+	parkState.isLockStateKnown = isLockStateKnown;
+	parkState.afAccelBias[0] = IMU.getAccelBiasX_mss();
+	parkState.afAccelBias[1] = IMU.getAccelBiasY_mss();
+	parkState.afAccelBias[2] = IMU.getAccelBiasZ_mss();
+	parkState.afAccelScale[0] = IMU.getAccelScaleFactorX();
+	parkState.afAccelScale[1] = IMU.getAccelScaleFactorY();
+	parkState.afAccelScale[2] = IMU.getAccelScaleFactorZ();
+	saveLoraSession();
+
+	// the interrupt pin of the IMU stays high after a motion until the wakeup
+	int result = IMU.enableMotionWake(PARK_WOM_THRESHOLD_MG, IMU.LP_ACCEL_ODR_15_63HZ);
+	if (result < 0) {
+		ESP_LOGE(LOG_TAG, "IMU wake on motion setup failed: %d, timer wakeup only", result);
+	}
+	else {
+		esp_sleep_enable_ext0_wakeup((gpio_num_t)mpuIntPin, 1);
+	}
+	esp_sleep_enable_timer_wakeup((uint64_t)PARK_WAKE_TIMER_S * 1000000ULL);
+
+	// the links have been closed, the controller has to be off for the deep sleep
+	delay(100);
+	esp_bluedroid_disable();
+	esp_bt_controller_disable();
+
+	ESP_LOGI(LOG_TAG, "Deep sleep, parked period %d", parkState.ulParkCount);
+	Serial.flush();
+
+	// the sleep converts the timer period with the same calibration, its start is a few us after this one
+	parkState.ullWakeTimerTicks = rtc_time_get() +
+		rtc_time_us_to_slowclk((uint64_t)PARK_WAKE_TIMER_S * 1000000ULL, esp_clk_slowclk_cal_get());
+	parkState.ulMagic = PARK_RTC_MAGIC;
+
+	esp_deep_sleep_start();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		setup the BLE client
+* @retval		none
+*/
+/************************************************************************************************************************/
+void setupBLEClient() {
+
+	ESP_LOGI(LOG_TAG, "Initialise the BLE Clients");
+
+	// Bms client
+	pBmsClient = BLEDevice::createClient();
+	pBmsClient->setClientCallbacks(&bmsClientCallbacks);
+
+	// HeartyPatch client
+	pHeartyPatchClient = BLEDevice::createClient();
+	pHeartyPatchClient->setClientCallbacks(&heartyPatchClientCallbacks);
+
+	// Motor controller clinet
+	pControllerClient = BLEDevice::createClient();
+	pControllerClient->setClientCallbacks(&controllerClientCallbacks);
+
+	// ESP Server client
+	pEspServerClient = BLEDevice::createClient();
+	pEspServerClient->setClientCallbacks(&espServerClientCallbacks);
+
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		check the availability of the ble service, characteristic needed
+* @param[in]	pClient					pointer to the BLE client object
+* @param[in]	pRemoteService			pointer to the BLE remote service object
+* @param[in]	pRemoteCharacteristic	pointer to the BLE remote characteristic object
+* @param[in]	remoteServiceUUID		remote service UUID
+* @param[in]	remoteCharUUID			remote characteristic UUID
+* @retval		true, if all available, false if one of them not available
+*/
+/************************************************************************************************************************/
+bool checkServiceCharacteristic(BLEClient* &pClient,
+								BLERemoteService* &pRemoteService,
+								BLERemoteCharacteristic* &pRemoteCharacteristic,
+								BLEUUID remoteServiceUUID,
+								BLEUUID remoteCharUUID) 
+{
+	SpanScope span(spanTrace, SPAN_GATT_DISCOVERY);
+
+	ESP_LOGI(LOG_TAG, "Check Service Characteristic");
+
+	if (pClient == nullptr) {
+		ESP_LOGE(LOG_TAG, "pClient is null pointer");
+		return false;
+	}
+
+	// check if connected to the ble server
+	if (!pClient->isConnected()) {
+		return false;
+	}
+
+	// get the remote service of the BLE client object based on the given UUID
+	pRemoteService = pClient->getService(remoteServiceUUID);
 
 	if (pRemoteService == nullptr) {
 		ESP_LOGE(LOG_TAG, "pRemoteService is null pointer");
@@ -912,23 +1782,354 @@ bool checkServiceCharacteristic(BLEClient* &pClient,
 		return false;
 	}
 
-	// get the remote characteristic of the BLE remote service object based on the given UUID
-	pRemoteCharacteristic = pRemoteService->getCharacteristic(remoteCharUUID);
+	// get the remote characteristic of the BLE remote service object based on the given UUID
+	pRemoteCharacteristic = pRemoteService->getCharacteristic(remoteCharUUID);
+
+	if (pRemoteCharacteristic == nullptr) {
+		ESP_LOGE(LOG_TAG, "pRemoteCharacteristic is null pointer");
+		pClient->disconnect();
+		return false;
+	}
+
+	ESP_LOGI(LOG_TAG, "Finish check service characteristics");
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		hash over the UUIDs of the ESP server attribute table (FNV-1a)
+* @retval		hash value, stored with the handles to detect a changed attribute table
+*/
+/************************************************************************************************************************/
+uint32_t gattCacheAttrHash() {
+
+	uint32_t ulHash = 2166136261UL;
+
+	for (uint8_t i = 0; i < GATT_ATTR_MAX; i++) {
+		std::string uuids = espServerAttr[i].serviceUUID.toString() + espServerAttr[i].charUUID.toString();
+		for (size_t j = 0; j < uuids.length(); j++) {
+			ulHash ^= (uint8_t)uuids[j];
+			ulHash *= 16777619UL;
+		}
+	}
+
+	return ulHash;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		NVS key of a peer, the MAC address without separators (12 characters)
+* @param[in]	devAddress				MAC address of the peer
+* @retval		NVS key
+*/
+/************************************************************************************************************************/
+std::string gattCacheKey(BLEAddress devAddress) {
+
+	std::string key = devAddress.toString();
+	key.erase(std::remove(key.begin(), key.end(), ':'), key.end());
+
+	return key;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		load the handles of a peer from NVS
+* @param[in]	devAddress				MAC address of the peer
+* @param[out]	pCache					pointer to the handle cache
+* @retval		true if valid handles for the current attribute table have been found
+*/
+/************************************************************************************************************************/
+bool gattCacheLoad(BLEAddress devAddress, GATT_HANDLE_CACHE_T *pCache) {
+
+	Preferences prefs;
+	bool isLoaded = false;
+
+	if (!prefs.begin(GATT_CACHE_NVS_NAMESPACE, true)) return false;
+
+	std::string key = gattCacheKey(devAddress);
+
+	if (prefs.getBytesLength(key.c_str()) == sizeof(GATT_HANDLE_CACHE_T)) {
+		prefs.getBytes(key.c_str(), pCache, sizeof(GATT_HANDLE_CACHE_T));
+		isLoaded = (pCache->ulAttrHash == gattCacheAttrHash());
+	}
+
+	prefs.end();
+
+	return isLoaded;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		store the handles of a peer in NVS
+* @param[in]	devAddress				MAC address of the peer
+* @param[in]	pCache					pointer to the handle cache
+* @retval		none
+*/
+/************************************************************************************************************************/
+void gattCacheStore(BLEAddress devAddress, const GATT_HANDLE_CACHE_T *pCache) {
+
+	Preferences prefs;
+
+	if (!prefs.begin(GATT_CACHE_NVS_NAMESPACE, false)) return;
+
+	prefs.putBytes(gattCacheKey(devAddress).c_str(), pCache, sizeof(GATT_HANDLE_CACHE_T));
+	prefs.end();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		remove the stored handles of a peer, the next connection discovers the services again
+* @param[in]	devAddress				MAC address of the peer
+* @retval		none
+*/
+/************************************************************************************************************************/
+void gattCacheErase(BLEAddress devAddress) {
+
+	Preferences prefs;
+
+	if (!prefs.begin(GATT_CACHE_NVS_NAMESPACE, false)) return;
+
+	prefs.remove(gattCacheKey(devAddress).c_str());
+	prefs.end();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		discover all attributes of the ESP server once and take over their handles
+* @param[in]	pClient					pointer to the BLE client object
+* @param[out]	pCache					pointer to the handle cache
+* @retval		true if all attributes have been found
+*/
+/************************************************************************************************************************/
+bool gattCacheDiscover(BLEClient* &pClient, GATT_HANDLE_CACHE_T *pCache) {
+
+	BLERemoteService *pRemoteService = nullptr;
+	BLERemoteCharacteristic *pRemoteCharacteristic = nullptr;
+
+	SpanScope span(spanTrace, SPAN_GATT_DISCOVERY);
+
+	ESP_LOGI(LOG_TAG, "Discover ESP server attribute handles");
+
+	pCache->usLockControlCccdHandle = 0;
+
+	for (uint8_t i = 0; i < GATT_ATTR_MAX; i++) {
+		pCache->ausHandle[i] = 0;
+
+		// optional attributes are looked up without dropping the connection if missing
+		if (espServerAttr[i].isOptional) {
+			pRemoteService = pClient->getService(espServerAttr[i].serviceUUID);
+			pRemoteCharacteristic = (pRemoteService != nullptr) ? pRemoteService->getCharacteristic(espServerAttr[i].charUUID) : nullptr;
+			if (pRemoteCharacteristic == nullptr) continue;
+
+			pCache->ausHandle[i] = pRemoteCharacteristic->getHandle();
+
+			if (i == GATT_ATTR_LOCK_CONTROL) {
+				BLERemoteDescriptor *pCccd = pRemoteCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902));
+				pCache->usLockControlCccdHandle = (pCccd != nullptr) ? pCccd->getHandle() : 0;
+			}
+			continue;
+		}
+
+		if (!checkServiceCharacteristic(pClient, pRemoteService, pRemoteCharacteristic, espServerAttr[i].serviceUUID, espServerAttr[i].charUUID)) {
+			return false;
+		}
+
+		pCache->ausHandle[i] = pRemoteCharacteristic->getHandle();
+
+		if (i == GATT_ATTR_TIME_SET) {
+			BLERemoteDescriptor *pCccd = pRemoteCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902));
+			pCache->usTimeSetCccdHandle = (pCccd != nullptr) ? pCccd->getHandle() : 0;
+		}
+	}
+
+	pCache->ulAttrHash = gattCacheAttrHash();
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		check if the main task has taken over the ESP server link, until then the connect task owns the handle
+*				cache and the connection data of the ESP server
+* @retval		true if the link is ready for the main task
+*/
+/************************************************************************************************************************/
+bool isEspServerReady() {
+
+	return bleSessions[BLE_SESSION_ESP_SERVER].eState == BLE_SESSION_READY && isEspServerConnected;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		fill the handle cache of the ESP server after connect, from NVS if available, else by discovery
+* @param[in]	pClient					pointer to the connected BLE client object
+* @param[in]	devAddress				MAC address of the ESP server
+* @retval		true if the handles are available
+*/
+/************************************************************************************************************************/
+bool gattCacheOpen(BLEClient* &pClient, BLEAddress devAddress) {
+
+	espServerGattcIf = pClient->getGattcIf();
+	espServerConnId = pClient->getConnId();
+	isGattCacheInvalidated = false;
+
+	if (gattCacheLoad(devAddress, &espServerHandleCache)) {
+		ESP_LOGI(LOG_TAG, "ESP server handles loaded from NVS");
+	}
+	else if (gattCacheDiscover(pClient, &espServerHandleCache)) {
+		gattCacheStore(devAddress, &espServerHandleCache);
+	}
+	else {
+		isEspServerCacheValid = false;
+		return false;
+	}
+
+	isEspServerCacheValid = true;
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		write a value to an ESP server characteristic by its cached handle, one request without discovery
+* @param[in]	attr					attribute of the ESP server
+* @param[in]	pData					pointer to the value
+* @param[in]	length					length of the value
+* @param[in]	writeType				ESP_GATT_WRITE_TYPE_NO_RSP, or ESP_GATT_WRITE_TYPE_RSP which also allows values
+*										longer than the MTU (long write)
+* @retval		true if the write has been queued
+*/
+/************************************************************************************************************************/
+bool gattCacheWrite(GATT_CACHE_ATTR_E attr, uint8_t *pData, size_t length, esp_gatt_write_type_t writeType) {
+
+	if (!isEspServerReady() || !isEspServerCacheValid || espServerHandleCache.ausHandle[attr] == 0) {
+		return false;
+	}
+
+	esp_err_t errRc = esp_ble_gattc_write_char(espServerGattcIf, espServerConnId, espServerHandleCache.ausHandle[attr],
+		length, pData, writeType, ESP_GATT_AUTH_REQ_NONE);
+
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gattc_write_char: rc=%d", errRc);
+		return false;
+	}
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		read and subscribe an ESP server characteristic by its cached handle, the value arrives in
+*				bleGattcHandler
+* @param[in]	attr					attribute of the ESP server
+* @param[in]	usCccdHandle			handle of the client characteristic configuration descriptor, 0 to read only
+* @param[in]	devAddress				MAC address of the ESP server
+* @retval		true if the requests have been queued
+*/
+/************************************************************************************************************************/
+bool gattCacheSubscribe(GATT_CACHE_ATTR_E attr, uint16_t usCccdHandle, BLEAddress devAddress) {
+
+	uint16_t usHandle = espServerHandleCache.ausHandle[attr];
+
+	if (esp_ble_gattc_read_char(espServerGattcIf, espServerConnId, usHandle, ESP_GATT_AUTH_REQ_NONE) != ESP_OK) {
+		return false;
+	}
+
+	if (usCccdHandle == 0) return true;
 
-	if (pRemoteCharacteristic == nullptr) {
-		ESP_LOGE(LOG_TAG, "pRemoteCharacteristic is null pointer");
-		pClient->disconnect();
+	if (esp_ble_gattc_register_for_notify(espServerGattcIf, *devAddress.getNative(), usHandle) != ESP_OK) {
 		return false;
 	}
 
-	ESP_LOGI(LOG_TAG, "Finish check service characteristics");
+	return esp_ble_gattc_write_char_descr(espServerGattcIf, espServerConnId, usCccdHandle,
+		sizeof(notificationOn), (uint8_t*)notificationOn, ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE) == ESP_OK;
+}
 
-	return true;
+/************************************************************************************************************************/
+/*!
+* @brief		take over a value of a subscribed ESP server characteristic, it is applied by espServerService()
+* @param[in]	usHandle				value handle of the characteristic
+* @param[in]	pValue					pointer to the value
+* @param[in]	usLength				length of the value
+* @retval		none
+*/
+/************************************************************************************************************************/
+void gattCacheValueReceived(uint16_t usHandle, const uint8_t *pValue, uint16_t usLength) {
+
+	if (usHandle == espServerHandleCache.ausHandle[GATT_ATTR_TIME_SET]) {
+		if (usLength >= sizeof(onWritePacket.abTimeSet)) {
+			memcpy(onWritePacket.abTimeSet, pValue, sizeof(onWritePacket.abTimeSet));
+			isConfigTimeNotifyAvailable = true;
+		}
+	}
+	// a lock control which was never written by the phone is empty, the lock state stays unknown
+	else if (usHandle == espServerHandleCache.ausHandle[GATT_ATTR_LOCK_CONTROL]) {
+		if (usLength >= sizeof(onWritePacket.bLockControlValue)) {
+			onWritePacket.bLockControlValue = pValue[0];
+			isLockControlNotifyAvailable = true;
+		}
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		GATT client events of the BT stack handled outside of the BLE library: MTU exchange and the attributes
+*				accessed by their cached handle
+* @param[in]	event					GATT client event
+* @param[in]	gattc_if				GATT interface
+* @param[in]	param					event parameter
+* @retval		none
+*/
+/************************************************************************************************************************/
+void bleGattcHandler(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t *param) {
+
+	uint16_t usTimeSetHandle = espServerHandleCache.ausHandle[GATT_ATTR_TIME_SET];
+	uint16_t usLockControlHandle = espServerHandleCache.ausHandle[GATT_ATTR_LOCK_CONTROL];
+
+	switch (event) {
+	case ESP_GATTC_CFG_MTU_EVT: {
+		// a rejected exchange leaves the connection at the default MTU
+		if (param->cfg_mtu.conn_id < BLE_CONN_ID_MAX) {
+			bleConnMtu[param->cfg_mtu.conn_id] = (param->cfg_mtu.status == ESP_GATT_OK) ? param->cfg_mtu.mtu : BLE_MTU_DEFAULT;
+		}
+		break;
+	}
+	case ESP_GATTC_SRVC_CHG_EVT: {
+		// attribute database of the server has changed, the handles are no longer valid
+		if (BLEAddress(param->srvc_chg.remote_bda).equals(ESP_SERVER_MAC)) {
+			isGattCacheInvalidated = true;
+		}
+		break;
+	}
+	case ESP_GATTC_READ_CHAR_EVT: {
+		if (!isEspServerCacheValid || param->read.conn_id != espServerConnId) break;
+		if (param->read.handle != usTimeSetHandle && param->read.handle != usLockControlHandle) break;
+
+		// a failed read of a cached handle means the stored handles are stale
+		if (param->read.status != ESP_GATT_OK) {
+			isGattCacheInvalidated = true;
+		}
+		else {
+			gattCacheValueReceived(param->read.handle, param->read.value, param->read.value_len);
+		}
+		break;
+	}
+	case ESP_GATTC_NOTIFY_EVT: {
+		if (!isEspServerCacheValid || param->notify.conn_id != espServerConnId) break;
+
+		gattCacheValueReceived(param->notify.handle, param->notify.value, param->notify.value_len);
+		break;
+	}
+	default:
+		break;
+	}
 }
 
 /************************************************************************************************************************/
 /*!
-* @brief		connect to the server and handle all the required action with the server
+* @brief		connect to the server, discover and subscribe, runs in the connect task of the session. The globals used
+*				by the main task are left to the first action of the session, see BLE_SESSION_T::pfReady
 * @param[in]	pDevice					pointer to the BLE device object
 * @param[in]	pClient					pointer to the BLE client object
 * @retval		true if all the action required has been done, false if something wrong happened in the middle of the action
@@ -955,21 +2156,21 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 
 		// set the client callbacks based on the mac address of the device
 		if (devAddress.equals(HEARTYPATCH_MAC)) {
-			pClient->setClientCallbacks(new HeartyPatchClientCallbacks());
+			pClient->setClientCallbacks(&heartyPatchClientCallbacks);
 
 		}
 
 		else if (devAddress.equals(BMS_MAC)) {
-			pClient->setClientCallbacks(new BMSClientCallbacks());
+			pClient->setClientCallbacks(&bmsClientCallbacks);
 
 		}
 
 		else if (devAddress.equals(CONTROLLER_MAC)) {
-			pClient->setClientCallbacks(new ControllerClientCallbacks());
+			pClient->setClientCallbacks(&controllerClientCallbacks);
 		}
 
 		else if (devAddress.equals(ESP_SERVER_MAC)) {
-			pClient->setClientCallbacks(new EspServerClientCallbacks());
+			pClient->setClientCallbacks(&espServerClientCallbacks);
 		}
 
 		else {
@@ -1002,30 +2203,23 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 
 		// check the availability of the client, remote service, and the remote characteristic
 		if (checkServiceCharacteristic(pClient, pHeartyPatchRemoteService, pHeartyPatchRemoteCharacteristic, HEART_RATE_SERVICE_UUID, HEART_RATE_MEASUREMENT_CHAR_UUID)) {
-			if (pHeartyPatchRemoteCharacteristic->canRead()) {
-				ESP_LOGI(LOG_TAG, "Read the heart rate characteristic");
-				if (pClient->isConnected()) {
-					// read the heart rate value
-					std::string value = pHeartyPatchRemoteCharacteristic->readValue();
-					
-					delay(10);
-					
-					ESP_LOGI(LOG_TAG, "Finish read value");
-					
-					// assign the heart rate value to the heart rate packet
-					heartRateServerPacket.tPacket.bHeartRate = value[1];
-
-					// get the current time
-					time(&rawTime);
+			// the heart rate measurement is pushed by the HeartyPatch as long as the link stays up
+			if (pHeartyPatchRemoteCharacteristic->canNotify()) {
+				ESP_LOGI(LOG_TAG, "Register for heart rate notification");
 
-					// save the current time into the heart rate packet
-					heartRateServerPacket.tPacket.ulHeartyTime = bswap32(rawTime);
+				// this task delay needed for reliable register for notify callback
+				delay(100);
 
-					ESP_LOGI(LOG_TAG, "Heart Rate: %d bpm (0x%.2X)\n", value[1], value[1]);
+				pHeartyPatchRemoteCharacteristic->registerForNotify(heartyNotifyCallback);
+				pHeartyPatchRemoteCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902))->writeValue((uint8_t*)notificationOn, 2, true);
 
-					return true;
-				}
-				else return false;
+				ESP_LOGI(LOG_TAG, "Heart rate client notification turned on");
+				return true;
+			}
+
+			// fall back to polling the value in heartyPatchService() by the main task
+			else if (pHeartyPatchRemoteCharacteristic->canRead()) {
+				return true;
 			}
 			else return false;
 		}
@@ -1052,7 +2246,8 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 
 		// check the availability of the client, remote service, and the remote characteristic
 		if (checkServiceCharacteristic(pClient, pBmsRemoteService, pBmsRemoteCharacteristic, BMS_RW_SERVICE_UUID, BMS_RX_CHAR_UUID)) {
-			// notify function is needed because BMS send two packet at the same time, can't request bigger MTU size with the used BLE dongle
+			// notify function is needed because the BMS answers with notifications, the used BLE dongle stays at the
+			// default MTU and splits a frame into two, the handler reassembles it only in that case
 			if (pBmsRemoteCharacteristic->canNotify()) {
 				ESP_LOGI(LOG_TAG, "Register for BMS RX notification");
 
@@ -1066,16 +2261,7 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 				// turn on the BMS RX client notification
 				pBmsRemoteCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902))->writeValue((uint8_t*)notificationOn, 2, true);
 				
-				delay(10);
-
-				while (isBmsConnected && !isBmsNotifyAvailable) {
-					// write info status read command to the bms
-					if (bmsWriteInfoStatus()) {
-						// wait for the incoming packet from the notification
-						delay(500);
-					}
-				};
-
+				// the main task requests the info status once the session is ready and every service cycle after
 				return true;
 			}
 
@@ -1118,13 +2304,6 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 				ESP_LOGI(LOG_TAG, "Motor Controller RX client notification turned on");
 				pControllerRemoteCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902))->writeValue((uint8_t*)notificationOn, 2, true);
 				
-				delay(10);
-
-				// wait for incoming data from callback
-				while (isControllerConnected && !isControllerNotifyAvailable) {
-					delay(150);
-				};
-
 				return true;
 			}
 			else return false;
@@ -1149,43 +2328,152 @@ bool connectToServer(BLEAdvertisedDevice* &pDevice, BLEClient* &pClient) {
 			}
 		}
 
-		// check the availability of the client, remote service, and the remote characteristic
-		if (checkServiceCharacteristic(pClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, TIME_INFO_SRV_SERVICE, TIME_SET_SRV_CHAR)) {
-			if (pClient->isConnected() && pEspServerRemoteCharacteristic->canRead()) {
-				// check if system time need to be configured from the server
-				onWritePacket.ulTimeSet = pEspServerRemoteCharacteristic->readUInt32();
-				if (lastConfigTime != onWritePacket.ulTimeSet && onWritePacket.ulTimeSet != 0) {
-					lastConfigTime = onWritePacket.ulTimeSet;
-
-					ESP_LOGI(LOG_TAG, "Set ESP32 time");
-					timeInfoServerPacket.tConfigCurrentTime.ulValue = onWritePacket.ulTimeSet;
-					time(&rawTime);
-					setupTime(onWritePacket.ulTimeSet);
-
-					if (onWritePacket.ulTimeSet >= rawTime) {
-						lock_lastTime += (onWritePacket.ulTimeSet - rawTime);
-						ilockitServerPacket.tPacket.ulLockChangeTime = bswap32(bswap32(ilockitServerPacket.tPacket.ulLockChangeTime) + (onWritePacket.ulTimeSet - rawTime));
-					}
-					else {
-						lock_lastTime -= (rawTime - timeInfoServerPacket.tConfigCurrentTime.ulValue);
-						ilockitServerPacket.tPacket.ulLockChangeTime = bswap32(bswap32(ilockitServerPacket.tPacket.ulLockChangeTime) - (rawTime - onWritePacket.ulTimeSet));
-					}
+		// take the attribute handles from NVS, the services are only discovered if nothing valid is stored
+		if (!gattCacheOpen(pClient, devAddress)) return false;
 
-				}
-				ESP_LOGI(LOG_TAG, "onWritePacket.ulTimeSet : %d", onWritePacket.ulTimeSet);
-			}
+		// read the time set and subscribe to every new time set, the result is applied by espServerService()
+		if (!gattCacheSubscribe(GATT_ATTR_TIME_SET, espServerHandleCache.usTimeSetCccdHandle, devAddress)) {
+			ESP_LOGE(LOG_TAG, "ESP Server time set subscription failed");
 		}
-		else return false;
 
-		// update the the related value to the server
-		updateValue();
+		// the lock state decides about the parked mode, older servers don't provide it
+		if (espServerHandleCache.ausHandle[GATT_ATTR_LOCK_CONTROL] != 0 &&
+			!gattCacheSubscribe(GATT_ATTR_LOCK_CONTROL, espServerHandleCache.usLockControlCccdHandle, devAddress)) {
+			ESP_LOGE(LOG_TAG, "ESP Server lock control subscription failed");
+		}
 
+		// the values are pushed by the main task once it has taken over the link
 		return true;
 	}
 
 	else return false;
 }
 
+/************************************************************************************************************************/
+/*!
+* @brief		apply the time configured on the BLE server as system time
+* @param[in]	ulTimeSet			epoch time from the time set characteristic
+* @retval		none
+*/
+/************************************************************************************************************************/
+void applyConfigTime(uint32_t ulTimeSet) {
+
+	onWritePacket.ulTimeSet = ulTimeSet;
+
+	if (lastConfigTime != onWritePacket.ulTimeSet && onWritePacket.ulTimeSet != 0) {
+		lastConfigTime = onWritePacket.ulTimeSet;
+
+		ESP_LOGI(LOG_TAG, "Set ESP32 time");
+		timeInfoServerPacket.tConfigCurrentTime.ulValue = onWritePacket.ulTimeSet;
+		time(&rawTime);
+		setupTime(onWritePacket.ulTimeSet);
+
+		if (onWritePacket.ulTimeSet >= rawTime) {
+			lock_lastTime += (onWritePacket.ulTimeSet - rawTime);
+			ilockitServerPacket.tPacket.ulLockChangeTime = bswap32(bswap32(ilockitServerPacket.tPacket.ulLockChangeTime) + (onWritePacket.ulTimeSet - rawTime));
+		}
+		else {
+			lock_lastTime -= (rawTime - timeInfoServerPacket.tConfigCurrentTime.ulValue);
+			ilockitServerPacket.tPacket.ulLockChangeTime = bswap32(bswap32(ilockitServerPacket.tPacket.ulLockChangeTime) - (rawTime - onWritePacket.ulTimeSet));
+		}
+
+	}
+	ESP_LOGI(LOG_TAG, "onWritePacket.ulTimeSet : %d", onWritePacket.ulTimeSet);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		apply the lock state set on the ESP server, the session time counts while the lock is open
+* @param[in]	bLockState			LOCK_OPEN or LOCK_CLOSE
+* @retval		none
+*/
+/************************************************************************************************************************/
+void applyLockState(uint8_t bLockState) {
+
+	bool isChanged = !isLockStateKnown || (ilockitServerPacket.tPacket.bLockState != bLockState);
+
+	isLockStateKnown = true;
+
+	if (!isChanged) return;
+
+	ESP_LOGI(LOG_TAG, "Lock state: %s", (bLockState == LOCK_OPEN) ? "open" : "closed");
+
+	time(&rawTime);
+	ilockitServerPacket.tPacket.bLockState = bLockState;
+	ilockitServerPacket.tPacket.ulLockChangeTime = bswap32((uint32_t)rawTime);
+
+	isSessionTimeCountEnable = (bLockState == LOCK_OPEN);
+	if (isSessionTimeCountEnable) lock_lastTime = rawTime;
+
+	// the inactivity time for the parked mode starts with the lock change
+	lastMotionTime = millis();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		read the heart rate value, used only if the HeartyPatch does not support notification
+* @retval		true if success, false if failed
+*/
+/************************************************************************************************************************/
+bool heartyPatchService() {
+
+	if (!isHeartyConnected || pHeartyPatchRemoteCharacteristic == nullptr) return false;
+
+	// notification is registered, nothing to poll
+	if (pHeartyPatchRemoteCharacteristic->canNotify()) return true;
+
+	ESP_LOGI(LOG_TAG, "Read the heart rate characteristic");
+
+	// read the heart rate value
+	std::string value = pHeartyPatchRemoteCharacteristic->readValue();
+
+	if (value.length() < 2) return false;
+
+	// assign the heart rate value to the heart rate packet
+	heartRateServerPacket.tPacket.bHeartRate = value[1];
+
+	// get the current time
+	time(&rawTime);
+
+	// save the current time into the heart rate packet
+	heartRateServerPacket.tPacket.ulHeartyTime = bswap32(rawTime);
+
+	ESP_LOGI(LOG_TAG, "Heart Rate: %d bpm (0x%.2X)\n", value[1], value[1]);
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		apply pending time configuration and update all values on the ESP server
+* @retval		true if success, false if failed
+*/
+/************************************************************************************************************************/
+bool espServerService() {
+
+	// drop the stale handles and reconnect, the connection manager discovers the services again
+	if (isGattCacheInvalidated) {
+		ESP_LOGI(LOG_TAG, "ESP Server attribute handles invalidated");
+		isGattCacheInvalidated = false;
+		isEspServerCacheValid = false;
+		gattCacheErase(ESP_SERVER_MAC);
+		if (pEspServerClient != nullptr) pEspServerClient->disconnect();
+		return false;
+	}
+
+	if (isConfigTimeNotifyAvailable) {
+		isConfigTimeNotifyAvailable = false;
+		applyConfigTime(onWritePacket.ulTimeSet);
+	}
+
+	if (isLockControlNotifyAvailable) {
+		isLockControlNotifyAvailable = false;
+		applyLockState(onWritePacket.bLockControlValue);
+	}
+
+	return updateValue();
+}
+
 /************************************************************************************************************************/
 /*!
 * @brief		update the GPS info into the location packet
@@ -1205,11 +2493,11 @@ void updateGPSInfo() {
 	// check if gps location is valid
 	if (gps.location.isValid())
 	{
-		locationServerPacket.tPacket.fLatitude = (float)gps.location.lat();
+		locationServerPacket.tPacket.fLatitude = microdegreesToFloat(gps.location.latMicrodegrees());
 		ESP_LOGI(LOG_TAG, "Latitude: %.6f", locationServerPacket.tPacket.fLatitude);
 		locationServerPacket.tPacket.ulLatitude = bswap32(locationServerPacket.tPacket.ulLatitude);
 
-		locationServerPacket.tPacket.fLongitude = (float)gps.location.lng();
+		locationServerPacket.tPacket.fLongitude = microdegreesToFloat(gps.location.lngMicrodegrees());
 		ESP_LOGI(LOG_TAG, "Longitude: %.6f", locationServerPacket.tPacket.fLongitude);
 		locationServerPacket.tPacket.ulLongitude = bswap32(locationServerPacket.tPacket.ulLongitude);
 
@@ -1220,7 +2508,7 @@ void updateGPSInfo() {
 
 	// check if gps altitude is valid
 	if (gps.altitude.isValid()) {
-		locationServerPacket.tPacket.fElevation = (float)gps.altitude.meters();
+		locationServerPacket.tPacket.fElevation = gps.altitude.value() / 100.0f;
 		ESP_LOGI(LOG_TAG, "Altitude: %.6f m", locationServerPacket.tPacket.fElevation);
 		locationServerPacket.tPacket.ulElevation = bswap32(locationServerPacket.tPacket.ulElevation);
 	}
@@ -1237,18 +2525,10 @@ void updateGPSInfo() {
 /************************************************************************************************************************/
 bool sendHeartRatePacket() {
 	ESP_LOGI(LOG_TAG, "Send heart rate packet");
-	if (isEspServerConnected) {
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, HEART_RATE_SRV_SERVICE, HEART_RATE_SRV_CHAR)) {
-			ESP_LOGI(LOG_TAG, "Check true");
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				ESP_LOGI(LOG_TAG, "Heart rate can write");
-				pEspServerRemoteCharacteristic->writeValue(heartRateServerPacket.abPacket, sizeof(heartRateServerPacket.tPacket), false);
-				delay(10);
-				ESP_LOGI(LOG_TAG, "Send heart rate packet success");
-				return true;
-			}
-		}
-		else return false;
+	if (gattCacheWrite(GATT_ATTR_HEART_RATE, heartRateServerPacket.abPacket, sizeof(heartRateServerPacket.tPacket), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+		delay(10);
+		ESP_LOGI(LOG_TAG, "Send heart rate packet success");
+		return true;
 	}
 	return false;
 }
@@ -1260,15 +2540,9 @@ bool sendHeartRatePacket() {
 */
 /************************************************************************************************************************/
 bool sendBmsMotorPacket() {
-	if (isEspServerConnected) {
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, BMS_MOTOR_SRV_SERVICE, BMS_MOTOR_SRV_CHAR)) {
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				pEspServerRemoteCharacteristic->writeValue(bmsMotorServerPacket.abPacket, sizeof(bmsMotorServerPacket.tPacket), false);
-				delay(10);
-				return true;
-			}
-		}
-		else return false;
+	if (gattCacheWrite(GATT_ATTR_BMS_MOTOR, bmsMotorServerPacket.abPacket, sizeof(bmsMotorServerPacket.tPacket), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+		delay(10);
+		return true;
 	}
 	return false;
 }
@@ -1280,18 +2554,11 @@ bool sendBmsMotorPacket() {
 */
 /************************************************************************************************************************/
 bool sendLocationInfoPacket() {
-	if (isEspServerConnected) {
-		ESP_LOGI(LOG_TAG, "Send location info packet");
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, LOCATION_SRV_SERVICE, LOCATION_SRV_CHAR)) {
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				ESP_LOGI(LOG_TAG, "Write location info packet into char");
-				pEspServerRemoteCharacteristic->writeValue(locationServerPacket.abPacket, sizeof(locationServerPacket.tPacket), false);
-				delay(10);
-				ESP_LOGI(LOG_TAG, "Write success");
-				return true;
-			}
-		}
-		else return false;
+	ESP_LOGI(LOG_TAG, "Send location info packet");
+	if (gattCacheWrite(GATT_ATTR_LOCATION, locationServerPacket.abPacket, sizeof(locationServerPacket.tPacket), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+		delay(10);
+		ESP_LOGI(LOG_TAG, "Write success");
+		return true;
 	}
 	return false;
 }
@@ -1303,18 +2570,10 @@ bool sendLocationInfoPacket() {
 */
 /************************************************************************************************************************/
 bool sendLoraInfoPacket() {
-	if (isEspServerConnected) {
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, TIME_INFO_SRV_SERVICE, TIME_LORA_INFO_SRV_CHAR)) {
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				ESP_LOGI(LOG_TAG, "Write value to lora info char");
-				pEspServerRemoteCharacteristic->writeValue(timeInfoServerPacket.tLoraLastSendPackageTime.abValue, sizeof(timeInfoServerPacket.tLoraLastSendPackageTime.abValue), false);
-				delay(10);
-				ESP_LOGI(LOG_TAG, "Write success");
-				return true;
-			}
-			else ESP_LOGI(LOG_TAG, "Can't write value to char");
-		}
-		else return false;
+	if (gattCacheWrite(GATT_ATTR_TIME_LORA_INFO, timeInfoServerPacket.tLoraLastSendPackageTime.abValue, sizeof(timeInfoServerPacket.tLoraLastSendPackageTime.abValue), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+		delay(10);
+		ESP_LOGI(LOG_TAG, "Write success");
+		return true;
 	}
 	return false;
 }
@@ -1331,39 +2590,274 @@ bool sendEspCurrentTimePacket() {
 		ESP_LOGI(LOG_TAG, "Update ESP32 current time on the server");
 		time(&rawTime);
 		timeInfoServerPacket.tEspCurrentTime.ulValue = bswap32((uint32_t)rawTime);
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, TIME_INFO_SRV_SERVICE, TIME_ESPTIME_SRV_CHAR)) {
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				pEspServerRemoteCharacteristic->writeValue(timeInfoServerPacket.tEspCurrentTime.abValue, sizeof(timeInfoServerPacket.tEspCurrentTime.abValue), false);
-				delay(10);
-				return true;
-			}
-			else ESP_LOGE(LOG_TAG, "Current time update failed");
+		if (gattCacheWrite(GATT_ATTR_TIME_ESPTIME, timeInfoServerPacket.tEspCurrentTime.abValue, sizeof(timeInfoServerPacket.tEspCurrentTime.abValue), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+			delay(10);
+			return true;
 		}
-		else return false;
+		else ESP_LOGE(LOG_TAG, "Current time update failed");
+	}
+	return false;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		upload the oldest stored impact capture to the ESP server, at most BLE_CAPTURE_CHUNKS_PER_CYCLE chunks
+*				per call. Servers without the capture characteristic keep the captures in flash.
+* @retval		true if all captures have been uploaded
+*/
+/************************************************************************************************************************/
+bool sendImpactCapture() {
+
+	uint8_t abFrame[IMPACT_CAPTURE_FRAME_MAX_LEN];
+	IMPACT_CAPTURE_CHUNK_HEADER_T *pHeader = (IMPACT_CAPTURE_CHUNK_HEADER_T*)abFrame;
+	IMPACT_CAPTURE_HEADER_T tCapture;
+	size_t len;
+
+	if (espServerHandleCache.ausHandle[GATT_ATTR_IMPACT_CAPTURE] == 0) return false;
+
+	if (captureUploadSlot < 0) {
+		captureUploadSlot = impactCapture.findPending(&tCapture);
+		if (captureUploadSlot < 0) return true;
+
+		captureUploadSequence = tCapture.ulSequence;
+		captureUploadTotal = sizeof(tCapture) + tCapture.usLength;
+		captureUploadOffset = 0;
+	}
+
+	// same write type and chunk limit as the telemetry snapshot
+	uint16_t usMtu = pEspServerClient->getMTU();
+	bool isLongWrite = (usMtu <= BLE_MTU_DEFAULT);
+	esp_gatt_write_type_t writeType = isLongWrite ? ESP_GATT_WRITE_TYPE_RSP : ESP_GATT_WRITE_TYPE_NO_RSP;
+	size_t frameLimit = isLongWrite ? sizeof(abFrame) : (size_t)(usMtu - 3);
+	if (frameLimit > sizeof(abFrame)) frameLimit = sizeof(abFrame);
+
+	pHeader->bVersion = IMPACT_CAPTURE_FRAME_VERSION;
+	pHeader->ulSequence = captureUploadSequence;
+	pHeader->usTotal = captureUploadTotal;
+
+	for (uint8_t i = 0; i < BLE_CAPTURE_CHUNKS_PER_CYCLE && captureUploadOffset < captureUploadTotal; i++) {
+
+		len = frameLimit - sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T);
+		if (len > (size_t)(captureUploadTotal - captureUploadOffset)) len = captureUploadTotal - captureUploadOffset;
+
+		if (impactCapture.read(captureUploadSlot, captureUploadOffset, &abFrame[sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T)], len) != len) {
+			ESP_LOGE(LOG_TAG, "Impact capture %u not readable, skipped", captureUploadSequence);
+			captureUploadOffset = captureUploadTotal;
+			break;
+		}
+
+		pHeader->usOffset = captureUploadOffset;
+		if (!gattCacheWrite(GATT_ATTR_IMPACT_CAPTURE, abFrame, sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T) + len, writeType)) return false;
+		captureUploadOffset += len;
+	}
+
+	if (captureUploadOffset < captureUploadTotal) return false;
+
+	ESP_LOGI(LOG_TAG, "Impact capture %u uploaded, %d bytes", captureUploadSequence, captureUploadTotal);
+	impactCapture.markUploaded(captureUploadSlot);
+	captureUploadSlot = -1;
+
+	return !impactCapture.hasPending();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		send mpu crash packet to the BLE server
+* @retval		true if success, false if failed
+*/
+/************************************************************************************************************************/
+bool sendMpuCrashPacket() {
+	if (gattCacheWrite(GATT_ATTR_MPU, mpuServerPacket.abPacket, sizeof(mpuServerPacket.abPacket), ESP_GATT_WRITE_TYPE_NO_RSP)) {
+		delay(10);
+		ESP_LOGI(LOG_TAG, "Write MPU crash packet success");
+		return true;
+	}
+	return false;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the value of a telemetry record, the bytes are the same as written to the legacy characteristic
+* @param[in]	bType					telemetry record type
+* @param[out]	pValue					pointer to the value
+* @param[out]	bLength					length of the value
+* @retval		true if the type is known
+*/
+/************************************************************************************************************************/
+bool getTelemetryRecord(uint8_t bType, uint8_t* &pValue, uint8_t &bLength) {
+
+	switch (bType) {
+	case TELEMETRY_TLV_HEART_RATE:
+		pValue = heartRateServerPacket.abPacket; bLength = sizeof(heartRateServerPacket.tPacket); return true;
+	case TELEMETRY_TLV_BMS_MOTOR:
+		pValue = bmsMotorServerPacket.abPacket; bLength = sizeof(bmsMotorServerPacket.tPacket); return true;
+	case TELEMETRY_TLV_LOCATION:
+		pValue = locationServerPacket.abPacket; bLength = sizeof(locationServerPacket.tPacket); return true;
+	case TELEMETRY_TLV_LORA_TIME:
+		pValue = timeInfoServerPacket.tLoraLastSendPackageTime.abValue; bLength = sizeof(timeInfoServerPacket.tLoraLastSendPackageTime.abValue); return true;
+	case TELEMETRY_TLV_ESP_TIME:
+		pValue = timeInfoServerPacket.tEspCurrentTime.abValue; bLength = sizeof(timeInfoServerPacket.tEspCurrentTime.abValue); return true;
+	case TELEMETRY_TLV_MPU:
+		pValue = mpuServerPacket.abPacket; bLength = sizeof(mpuServerPacket.abPacket); return true;
+	default:
+		return false;
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		send all dirty telemetry records to the BLE server in as few snapshot frames as the MTU allows
+* @retval		true if all dirty records have been sent
+*/
+/************************************************************************************************************************/
+bool sendTelemetrySnapshot() {
+
+	uint8_t abFrame[TELEMETRY_FRAME_MAX_LEN];
+	TELEMETRY_FRAME_HEADER_T *pHeader = (TELEMETRY_FRAME_HEADER_T*)abFrame;
+	uint8_t *pValue;
+	uint8_t bLength;
+	uint8_t pending = 0;
+	size_t idx = sizeof(TELEMETRY_FRAME_HEADER_T);
+
+	// a frame has to fit into one write, the ATT header takes 3 bytes of the MTU. Peers stuck at the default MTU get
+	// the whole snapshot as one long write, the stack splits it into prepared writes.
+	uint16_t usMtu = pEspServerClient->getMTU();
+	bool isLongWrite = (usMtu <= BLE_MTU_DEFAULT);
+	esp_gatt_write_type_t writeType = isLongWrite ? ESP_GATT_WRITE_TYPE_RSP : ESP_GATT_WRITE_TYPE_NO_RSP;
+	size_t frameLimit = isLongWrite ? sizeof(abFrame) : (size_t)(usMtu - 3);
+	if (frameLimit > sizeof(abFrame)) frameLimit = sizeof(abFrame);
+
+	pHeader->bVersion = TELEMETRY_FRAME_VERSION;
+
+	for (uint8_t bType = TELEMETRY_TLV_HEART_RATE; bType < TELEMETRY_TLV_MAX; bType++) {
+
+		if (!(telemetryDirty & TELEMETRY_DIRTY(bType)) || !getTelemetryRecord(bType, pValue, bLength)) continue;
+
+		// flush the frame if the record does not fit anymore
+		if (idx + sizeof(TELEMETRY_TLV_HEADER_T) + bLength > frameLimit && pending) {
+			pHeader->bLength = idx - sizeof(TELEMETRY_FRAME_HEADER_T);
+			if (!gattCacheWrite(GATT_ATTR_TELEMETRY, abFrame, idx, writeType)) return false;
+			telemetryDirty &= ~pending;
+			pending = 0;
+			idx = sizeof(TELEMETRY_FRAME_HEADER_T);
+		}
+
+		abFrame[idx++] = bType;
+		abFrame[idx++] = bLength;
+		memcpy(&abFrame[idx], pValue, bLength);
+		idx += bLength;
+		pending |= TELEMETRY_DIRTY(bType);
+	}
+
+	if (pending) {
+		pHeader->bLength = idx - sizeof(TELEMETRY_FRAME_HEADER_T);
+		if (!gattCacheWrite(GATT_ATTR_TELEMETRY, abFrame, idx, writeType)) return false;
+		telemetryDirty &= ~pending;
+	}
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		send all dirty telemetry records one by one to the legacy characteristics, for servers without the
+*				telemetry snapshot characteristic
+* @retval		true if all dirty records have been sent
+*/
+/************************************************************************************************************************/
+bool sendTelemetryLegacy() {
+
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_HEART_RATE)) && sendHeartRatePacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_HEART_RATE);
+	}
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_BMS_MOTOR)) && sendBmsMotorPacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_BMS_MOTOR);
+	}
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_LOCATION)) && sendLocationInfoPacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_LOCATION);
+	}
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_LORA_TIME)) && sendLoraInfoPacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_LORA_TIME);
+	}
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_ESP_TIME)) && sendEspCurrentTimePacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_ESP_TIME);
+	}
+	if ((telemetryDirty & TELEMETRY_DIRTY(TELEMETRY_TLV_MPU)) && sendMpuCrashPacket()) {
+		telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_MPU);
+	}
+
+	return telemetryDirty == 0;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		keep the dirty telemetry records in the BLE store while the ESP server is not connected, at most every
+*				BLE_BACKLOG_INTERVAL_MS. The esp current time is not stored, it is part of every live push.
+* @retval		none
+*/
+/************************************************************************************************************************/
+void storeTelemetryBacklog() {
+
+	uint8_t *pValue;
+	uint8_t bLength;
+
+	if (millis() - lastBacklogTime < BLE_BACKLOG_INTERVAL_MS) return;
+	lastBacklogTime = millis();
+
+	time(&rawTime);
+	telemetryDirty &= ~TELEMETRY_DIRTY(TELEMETRY_TLV_ESP_TIME);
+
+	for (uint8_t bType = TELEMETRY_TLV_HEART_RATE; bType < TELEMETRY_TLV_MAX; bType++) {
+
+		if (!(telemetryDirty & TELEMETRY_DIRTY(bType)) || !getTelemetryRecord(bType, pValue, bLength)) continue;
+
+		bleStore.push(bType, (uint32_t)rawTime, pValue, bLength);
+		telemetryDirty &= ~TELEMETRY_DIRTY(bType);
 	}
-	return false;
 }
 
 /************************************************************************************************************************/
 /*!
-* @brief		send mpu crash packet to the BLE server
-* @retval		true if success, false if failed
+* @brief		forward the oldest stored records to the ESP server, each record goes with its record time in one frame.
+*				Servers without the snapshot characteristic only get the live values, the backlog is dropped.
+* @retval		true if the backlog is empty
 */
 /************************************************************************************************************************/
-bool sendMpuCrashPacket() {
-	if (isEspServerConnected) {
-		if (checkServiceCharacteristic(pEspServerClient, pEspServerRemoteService, pEspServerRemoteCharacteristic, MPU_SRV_SERVICE, MPU_SRV_CHAR)) {
-			if (pEspServerRemoteCharacteristic->canWrite()) {
-				ESP_LOGI(LOG_TAG, "Write MPU crash packet to characteristic");
-				pEspServerRemoteCharacteristic->writeValue(mpuServerPacket.abPacket, sizeof(mpuServerPacket.abPacket), false);
-				delay(10);
-				ESP_LOGI(LOG_TAG, "Write success");
-				return true;
-			}
-		}
-		else return false;
+bool sendTelemetryBacklog() {
+
+	uint8_t abFrame[TELEMETRY_FRAME_MAX_LEN];
+	TELEMETRY_FRAME_HEADER_T *pHeader = (TELEMETRY_FRAME_HEADER_T*)abFrame;
+	TELEMETRY_RECORD_T tRecord;
+	size_t idx;
+
+	if (espServerHandleCache.ausHandle[GATT_ATTR_TELEMETRY] == 0) {
+		while (bleStore.peek(&tRecord)) bleStore.pop();
+		return true;
 	}
-	return false;
+
+	esp_gatt_write_type_t writeType = (pEspServerClient->getMTU() <= BLE_MTU_DEFAULT) ? ESP_GATT_WRITE_TYPE_RSP : ESP_GATT_WRITE_TYPE_NO_RSP;
+
+	pHeader->bVersion = TELEMETRY_FRAME_VERSION;
+
+	for (uint8_t i = 0; i < BLE_BACKLOG_DRAIN_RECORDS && bleStore.peek(&tRecord); i++) {
+
+		idx = sizeof(TELEMETRY_FRAME_HEADER_T);
+		abFrame[idx++] = TELEMETRY_TLV_RECORD_TIME;
+		abFrame[idx++] = sizeof(uint32_t);
+		*(uint32_t*)&abFrame[idx] = bswap32(tRecord.ulTime);
+		idx += sizeof(uint32_t);
+		abFrame[idx++] = tRecord.bType;
+		abFrame[idx++] = tRecord.bLength;
+		memcpy(&abFrame[idx], tRecord.abData, tRecord.bLength);
+		idx += tRecord.bLength;
+		pHeader->bLength = idx - sizeof(TELEMETRY_FRAME_HEADER_T);
+
+		if (!gattCacheWrite(GATT_ATTR_TELEMETRY, abFrame, idx, writeType)) return false;
+
+		bleStore.pop();
+	}
+
+	return bleStore.isEmpty();
 }
 
 /************************************************************************************************************************/
@@ -1384,54 +2878,68 @@ bool updateValue() {
 		ilockitServerPacket.tPacket.usLockSessionTime = bswap16(lock_diffTimeInMinutes);
 	}
 
-	// send heart rate packet to the server
-	sendHeartRatePacket();
+	// collect the changed values, they are pushed together in one snapshot
+	if (isHeartRateAvailable) {
+		isHeartRateAvailable = false;
+		telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_HEART_RATE);
+	}
 
 	// if there is any new data from bms or controller
 	if (isBmsNotifyAvailable || isControllerNotifyAvailable) {
-		ESP_LOGI(LOG_TAG, "Update bms and controller packet on the server");
-
-		// send the bms motor packet to the server
-		if (sendBmsMotorPacket()) {
-			ESP_LOGI(LOG_TAG, "Bms/Controller packet sent!");
-			if (isBmsNotifyAvailable) isBmsNotifyAvailable = false;
-			if (isControllerNotifyAvailable) isControllerNotifyAvailable = false;
-		}
-		else ESP_LOGE(LOG_TAG, "Bms/Controller packet failed to sent!");
+		isBmsNotifyAvailable = false;
+		isControllerNotifyAvailable = false;
+		telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_BMS_MOTOR);
 	}
 
 	//Check to see if new GPS info is available
-	if (isGpsConnected) {
-		if (gps.time.isUpdated())
-		{
-			ESP_LOGI(LOG_TAG, "Update GPS packet on the server");
-			updateGPSInfo();
-			if (sendLocationInfoPacket()) ESP_LOGI(LOG_TAG, "GPS packet sent!");
-			else ESP_LOGE(LOG_TAG, "GPS packet failed to sent!");
-		}
+	if (isGpsConnected && isGpsFixAvailable) {
+		isGpsFixAvailable = false;
+		updateGPSInfo();
+		telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_LOCATION);
 	}
 
 	// if there is any lora packet sent
 	if (isLoraPacketSent) {
-		ESP_LOGI(LOG_TAG, "Update Lora info packet on the server");
-		if (sendLoraInfoPacket()) {
-			ESP_LOGI(LOG_TAG, "Lora info packet sent!");
-			isLoraPacketSent = false;
-		}
-		else ESP_LOGE(LOG_TAG, "Lora info packet failed to sent!");
+		isLoraPacketSent = false;
+		telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_LORA_TIME);
 	}
 
-	// send the esp current time packet
-	sendEspCurrentTimePacket();
+	// the esp current time is part of every push
+	time(&rawTime);
+	timeInfoServerPacket.tEspCurrentTime.ulValue = bswap32((uint32_t)rawTime);
+	telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_ESP_TIME);
 
 	if (isCrashDetected) {
-		ESP_LOGI(LOG_TAG, "Update MPU crash packet on the server");
-		if (sendMpuCrashPacket()) {
-			ESP_LOGI(LOG_TAG, "MPU crash packet sent!");
-			isCrashDetected = false;
-		}
-		else ESP_LOGE(LOG_TAG, "MPU crash packet failed to sent!");
-		delay(10);
+		isCrashDetected = false;
+		telemetryDirty |= TELEMETRY_DIRTY(TELEMETRY_TLV_MPU);
+	}
+
+	if (!isEspServerReady()) {
+		storeTelemetryBacklog();
+		// the server drops a partial capture, the upload starts over after the reconnect
+		captureUploadSlot = -1;
+		return false;
+	}
+
+	// the backlog goes first, the live values follow so the server ends up with the latest values
+	if (!bleStore.isEmpty() && !sendTelemetryBacklog()) {
+		ESP_LOGI(LOG_TAG, "Telemetry backlog: %d records left", bleStore.count());
+	}
+
+	// stored impact captures are uploaded in chunks over several cycles
+	if (impactCapture.hasPending() || captureUploadSlot >= 0) {
+		sendImpactCapture();
+	}
+
+	// servers without the snapshot characteristic get the values one by one
+	if (espServerHandleCache.ausHandle[GATT_ATTR_TELEMETRY] == 0) {
+		if (!sendTelemetryLegacy()) ESP_LOGE(LOG_TAG, "Telemetry update incomplete");
+		return true;
+	}
+
+	if (!sendTelemetrySnapshot()) {
+		ESP_LOGE(LOG_TAG, "Telemetry snapshot failed to sent!");
+		return false;
 	}
 
 	return true;
@@ -1454,8 +2962,217 @@ void checkBLEConnection() {
 	if (!isControllerFound)	ESP_LOGE(LOG_TAG, "Rescan needed for Mot. Controller");
 	if (!isEspServerFound)	ESP_LOGE(LOG_TAG, "Rescan needed for ESP Server");
 	if (!isEspServerFound || !isHeartyFound || !isBmsFound || !isControllerFound) {
-		ESP_LOGI(LOG_TAG, "Scan start");
-		pScan->start(2, true);
+		// the scan blocks the main task, so don't repeat it every cycle while the other links are serviced
+		// scan and connection establishment exclude each other, skip the scan while a connect task holds the stack
+		if (millis() - lastScanTime >= BLE_RESCAN_INTERVAL_MS && xSemaphoreTake(xSemaphoreBLE, 0) == pdTRUE) {
+			ESP_LOGI(LOG_TAG, "Scan start");
+			pScan->start(2, true);
+			lastScanTime = millis();
+			xSemaphoreGive(xSemaphoreBLE);
+		}
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		schedule the next connection attempt of a session with exponential backoff
+* @param[in]	pSession			pointer to the BLE session
+* @retval		none
+*/
+/************************************************************************************************************************/
+void scheduleReconnect(BLE_SESSION_T *pSession) {
+
+	if (pSession->ulBackoffTime == 0) pSession->ulBackoffTime = BLE_RECONNECT_BACKOFF_MIN_MS;
+	else pSession->ulBackoffTime = min(pSession->ulBackoffTime * 2, (uint32_t)BLE_RECONNECT_BACKOFF_MAX_MS);
+
+	pSession->ulNextAttemptTime = millis() + pSession->ulBackoffTime;
+	pSession->eState = BLE_SESSION_BACKOFF;
+
+	ESP_LOGI(LOG_TAG, "%s reconnect in %d ms", pSession->pName, pSession->ulBackoffTime);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		load the MTU remembered for a peer
+* @param[in]	devAddress				MAC address of the peer
+* @retval		MTU of the peer, 0 if unknown
+*/
+/************************************************************************************************************************/
+uint16_t bleMtuLoad(BLEAddress devAddress) {
+
+	Preferences prefs;
+
+	if (!prefs.begin(BLE_MTU_NVS_NAMESPACE, true)) return 0;
+
+	uint16_t usMtu = prefs.getUShort(gattCacheKey(devAddress).c_str(), 0);
+	prefs.end();
+
+	return usMtu;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		remember the MTU of a peer
+* @param[in]	devAddress				MAC address of the peer
+* @param[in]	usMtu					MTU of the peer
+* @retval		none
+*/
+/************************************************************************************************************************/
+void bleMtuStore(BLEAddress devAddress, uint16_t usMtu) {
+
+	Preferences prefs;
+
+	if (!prefs.begin(BLE_MTU_NVS_NAMESPACE, false)) return;
+
+	prefs.putUShort(gattCacheKey(devAddress).c_str(), usMtu);
+	prefs.end();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		start the MTU exchange of a new connection, peers known to stay at the default MTU are not asked again
+* @param[in]	pSession				pointer to the BLE session
+* @retval		none
+*/
+/************************************************************************************************************************/
+void bleRequestMtu(BLE_SESSION_T *pSession) {
+
+	BLEClient *pClient = *pSession->ppClient;
+	uint16_t connId = pClient->getConnId();
+
+	if (pSession->usMtu == 0) pSession->usMtu = bleMtuLoad((*pSession->ppDevice)->getAddress());
+
+	if (connId < BLE_CONN_ID_MAX) bleConnMtu[connId] = 0;
+
+	if (pSession->usMtu == BLE_MTU_DEFAULT) {
+		ESP_LOGI(LOG_TAG, "%s stays at the default MTU", pSession->pName);
+		return;
+	}
+
+	esp_err_t errRc = esp_ble_gattc_send_mtu_req(pClient->getGattcIf(), connId);
+	if (errRc != ESP_OK) ESP_LOGE(LOG_TAG, "esp_ble_gattc_send_mtu_req: rc=%d", errRc);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		take over the result of the MTU exchange and remember it for the peer
+* @param[in]	pSession				pointer to the BLE session
+* @retval		none
+*/
+/************************************************************************************************************************/
+void bleUpdateMtu(BLE_SESSION_T *pSession) {
+
+	uint16_t connId = (*pSession->ppClient)->getConnId();
+
+	if (connId >= BLE_CONN_ID_MAX || bleConnMtu[connId] == 0 || bleConnMtu[connId] == pSession->usMtu) return;
+
+	pSession->usMtu = bleConnMtu[connId];
+	bleMtuStore((*pSession->ppDevice)->getAddress(), pSession->usMtu);
+
+	ESP_LOGI(LOG_TAG, "%s MTU: %d", pSession->pName, pSession->usMtu);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		connect task of a BLE session, connects, discovers and subscribes, then deletes itself
+* @param[in]	parameter			pointer to the BLE session
+*/
+/************************************************************************************************************************/
+void bleConnectTask(void * parameter) {
+
+	BLE_SESSION_T *pSession = (BLE_SESSION_T*)parameter;
+	uint8_t index = (uint8_t)(pSession - bleSessions);
+
+	// the stack handles one pending connection at a time, the tasks of the other sessions wait here
+	xSemaphoreTake(xSemaphoreBLE, portMAX_DELAY);
+
+	spanTrace.beginSpan(SPAN_BLE_CONNECT, index);
+	pSession->isConnectReady = connectToServer(*pSession->ppDevice, *pSession->ppClient) && *pSession->pIsConnected;
+	spanTrace.endSpan(SPAN_BLE_CONNECT);
+
+	xSemaphoreGive(xSemaphoreBLE);
+
+	// hand the session back to the main task, it takes over the result in its next cycle
+	pSession->isConnecting = false;
+	vTaskDelete(NULL);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		service one BLE session, (re)connect if needed or run the periodic action of the open link
+* @param[in]	pSession			pointer to the BLE session
+* @retval		none
+*/
+/************************************************************************************************************************/
+void serviceBLESession(BLE_SESSION_T *pSession) {
+
+	uint8_t index = (uint8_t)(pSession - bleSessions);
+	SpanScope span(spanTrace, SPAN_BLE_SESSION, index);
+
+	switch (pSession->eState) {
+	case BLE_SESSION_IDLE:
+	case BLE_SESSION_BACKOFF: {
+		if (!*pSession->pIsFound) break;
+		if ((int32_t)(millis() - pSession->ulNextAttemptTime) < 0) break;
+
+		// a disconnect after a failed discovery is still pending, wait for the callback
+		if (*pSession->pIsConnected) break;
+
+		// free the client of the previous link, connectToServer creates a fresh one
+		if (*pSession->ppClient != nullptr) {
+			delete *pSession->ppClient;
+			*pSession->ppClient = nullptr;
+		}
+
+		ESP_LOGI(LOG_TAG, "Connect to %s", pSession->pName);
+
+		// connect, discovery and subscription block up to the link establishment timeout of the stack, they run in
+		// a task of the session so the main task keeps servicing the other links
+		pSession->isConnecting = true;
+		pSession->eState = BLE_SESSION_CONNECTING;
+		if (xTaskCreatePinnedToCore(bleConnectTask, "bleConnTask", BLE_CONNECT_TASK_STACK, pSession, 1, NULL, 1) != pdPASS) {
+			ESP_LOGE(LOG_TAG, "%s connect task not created", pSession->pName);
+			pSession->isConnecting = false;
+			scheduleReconnect(pSession);
+		}
+		break;
+	}
+	case BLE_SESSION_CONNECTING: {
+		if (pSession->isConnecting) break;
+
+		if (pSession->isConnectReady) {
+			ESP_LOGI(LOG_TAG, "%s session ready", pSession->pName);
+			bleRequestMtu(pSession);
+			pSession->eState = BLE_SESSION_READY;
+			pSession->ulBackoffTime = 0;
+
+			// the link is owned by the main task from here on
+			if (pSession->pfReady != nullptr && !pSession->pfReady()) {
+				ESP_LOGE(LOG_TAG, "%s first action failed", pSession->pName);
+			}
+		}
+		else {
+			// drop a half open link, it is reconnected after the backoff
+			if (*pSession->pIsConnected && *pSession->ppClient != nullptr) (*pSession->ppClient)->disconnect();
+			scheduleReconnect(pSession);
+		}
+		break;
+	}
+	case BLE_SESSION_READY: {
+		// link lost, the other sessions are not affected
+		if (!*pSession->pIsConnected) {
+			ESP_LOGW(LOG_TAG, "%s disconnected", pSession->pName);
+			scheduleReconnect(pSession);
+			break;
+		}
+
+		bleUpdateMtu(pSession);
+
+		if (pSession->pfService != nullptr && !pSession->pfService()) {
+			ESP_LOGE(LOG_TAG, "%s service failed", pSession->pName);
+		}
+		break;
+	}
 	}
 }
 
@@ -1500,8 +3217,14 @@ void setup() {
 	//while (!Serial);
 
 
-	// setup the system time with epoch time of 0
-	setupTime(0);
+	// a wakeup from the parked mode keeps the system time and the state of the RTC memory, else start with epoch time 0
+	if (!restoreParkState()) setupTime(0);
+
+	// record the inputs from here on, before the first one arrives
+	inputTrace.begin(INPUT_TRACE_PARTITION, INPUT_TRACE_SOURCES);
+
+	// trace the spans of the tasks, the last events are dumped on request
+	spanTrace.begin(spanNames, SPAN_ID_MAX);
 
 	// setup the GPS
 	setupGPS();
@@ -1509,18 +3232,34 @@ void setup() {
 	// setup the IMU
 	setupIMU();
 
+	// spi bus of the lora radio and the display
+	spiBus.begin();
+
 	// setup the display
 	setupDisplay();
 
+	// sleep while all tasks wait
+	setupPowerManagement();
+
+	// records for the ESP server which were not forwarded before the last reset
+	bleStore.begin(TELEMETRY_PARTITION, TELEMETRY_BLE_FIRST_SECTOR, TELEMETRY_BLE_SECTORS);
+
+	// decoded BMS frames are delivered by the stream parser
+	bms.setInfoStatusCallback(bmsInfoStatusCallback);
 
 	// assign the semaphore for the mutex
 	xSemaphoreI2c = xSemaphoreCreateMutex();
-	xSemaphoreSpi = xSemaphoreCreateMutex();
 	xSemaphoreBLE = xSemaphoreCreateMutex();
 
 	// initialise the BLE controller
 	BLEDevice::init("ZESYS_BB");
 
+	// offer the largest MTU to every peer, peers stuck at the default fall back to long writes
+	BLEDevice::setMTU(BLE_MTU_MAX);
+
+	// handle the GATT client events of the MTU exchange and of attributes accessed by their cached handle
+	BLEDevice::setCustomGattcHandler(bleGattcHandler);
+
 	// setup the BLE scanner
 	setupBLEScanner();
 
@@ -1530,11 +3269,15 @@ void setup() {
 	// create and start the ttn task (spi task) on core 1 with priority 2
 	xTaskCreatePinnedToCore(ttnTask, "ttnTask", 4096, (void*)1, 2, &xTaskTtn, 1);
 
+#if DISPLAY_AVAIL > 0
+	// create and start the display flush and render tasks on core 1 with priority 1
+	xTaskCreatePinnedToCore(displayFlushTask, "dispFlushTask", 2048, (void*)1, 1, &xTaskDisplayFlush, 1);
+	xTaskCreatePinnedToCore(displayTask, "displayTask", 4096, (void*)1, 1, &xTaskDisplay, 1);
+#endif
+
 	// create and start i2c task on core 1 with priority 1
 	xTaskCreatePinnedToCore(i2cTask, "i2cTask", 4096, (void*)1, 1, &xTaskI2c, 1);
 
-	lastLoopTime = millis();
-
 	// create and start the main task on core 1 with priority 1
 	xTaskCreatePinnedToCore(mainTask, "mainTask", 81920, (void*)1, 1, &xTaskMain, 1);
 
@@ -1587,34 +3330,45 @@ void wdTask(void * parameter) {
 
 /************************************************************************************************************************/
 /*!
-* @brief		ttn task (or spi task), handle all task required for lora and display (both use SPI HW resource)
+* @brief		ttn task, handle all task required for lora, the radio has the highest priority on the shared spi bus
 */
 /************************************************************************************************************************/
 void ttnTask(void * parameter) {
 	
 	ESP_LOGI(LOG_TAG, "Start TTN task...");
 
+	spiBus.acquire(SPI_BUS_CLASS_RADIO, portMAX_DELAY);
+
 	// LMIC init
 	os_init();
+	// radio interrupts wake this task from hal_waitForEvent()
+	Arduino_LMIC::hal_set_irq_task(xTaskGetCurrentTaskHandle());
 	// Reset the MAC state. Session and pending data transfers will be discarded.
 	LMIC_reset();
 
+	// after a wakeup from the parked mode the session is continued, else the first uplink joins
+	restoreLoraSession();
+
+	// samples which were not sent before the last reset
+	loraStore.begin(TELEMETRY_PARTITION, TELEMETRY_LORA_FIRST_SECTOR, TELEMETRY_LORA_SECTORS);
+
 	// Start job (sending automatically starts OTAA too)
-	do_send(&sendjob);
+	do_sample(&samplejob);
 
-	xSemaphoreGive(xSemaphoreSpi);
+	spiBus.release(SPI_BUS_CLASS_RADIO);
 
 	ttnGetKeyTime = millis();
-	displayTaskTime = millis();
 	for (;;) {
 
-		if (xSemaphoreTake(xSemaphoreSpi, 10 / portTICK_RATE_MS) == pdTRUE) {
+		spanTrace.beginSpan(SPAN_WAIT_SPI, SPI_BUS_CLASS_RADIO);
+		bool isBusAcquired = spiBus.acquire(SPI_BUS_CLASS_RADIO, 10 / portTICK_RATE_MS);
+		spanTrace.endSpan(SPAN_WAIT_SPI);
+
+		if (isBusAcquired) {
+			spanTrace.beginSpan(SPAN_LMIC_RUNLOOP);
 			os_runloop_once();
-			
-			if (millis() - displayTaskTime > 500) {
-				updateDisplay();
-				displayTaskTime = millis();
-			}
+			spanTrace.endSpan(SPAN_LMIC_RUNLOOP);
+			updatePowerLock();
 
 			if (isLoraSessionKeyAvailable || (millis() - ttnGetKeyTime > 10000)) {
 				if (!isLoraTaskSet) {
@@ -1627,22 +3381,60 @@ void ttnTask(void * parameter) {
 				xEventGroupSetBits(xWatchdogEvent, ttnTaskId);
 
 				ttnGetKeyTime = millis();
-
-				xSemaphoreGive(xSemaphoreSpi);
-
-				delay(1);
-
 			}
 
 			else {
 				// set bits to alert watchdog that the task still responsive
 				xEventGroupSetBits(xWatchdogEvent, ttnTaskId);
-				xSemaphoreGive(xSemaphoreSpi);
 			}
+
+			spiBus.release(SPI_BUS_CLASS_RADIO);
+
+			// sleep until the next lmic job or a radio interrupt (tx done, rx done, rx timeout), without holding the
+			// spi bus
+			Arduino_LMIC::hal_waitForEvent(TTN_MAX_SLEEP_MS);
 		}
 	}
 }
 
+#if DISPLAY_AVAIL > 0
+/************************************************************************************************************************/
+/*!
+* @brief		display task, render a new frame every DISPLAY_INTERVAL_MS, the frame is flushed by displayFlushTask
+*/
+/************************************************************************************************************************/
+void displayTask(void * parameter) {
+
+	ESP_LOGI(LOG_TAG, "Start display task...");
+
+	TickType_t xLastWakeTime = xTaskGetTickCount();
+	for (;;) {
+		updateDisplay();
+
+		vTaskDelayUntil(&xLastWakeTime, DISPLAY_INTERVAL_MS / portTICK_PERIOD_MS);
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		display flush task, transfer the frame handed over by sendDisplayBuffer() in the background, the transfer
+*				gives way to the lora radio between two tiles
+*/
+/************************************************************************************************************************/
+void displayFlushTask(void * parameter) {
+
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		spanTrace.beginSpan(SPAN_DISPLAY_FLUSH);
+		flushDisplay(abDisplayBuffer, aulDisplayDamage);
+		spanTrace.endSpan(SPAN_DISPLAY_FLUSH);
+
+		isDisplayFlushBusy = false;
+	}
+}
+#endif
+
 /************************************************************************************************************************/
 /*!
 * @brief		i2c task, handle all task required for imu and gps (both use I2C HW resource)
@@ -1651,12 +3443,40 @@ void ttnTask(void * parameter) {
 void i2cTask(void * parameter) {
 	ESP_LOGI(LOG_TAG, "Start I2C task...");
 
+	// the IMU data ready interrupt wakes this task
+	IMU.setNotifyTask(xTaskGetCurrentTaskHandle());
+
 	for (;;) {
 
-		if (xSemaphoreTake(xSemaphoreI2c, 10 / portTICK_RATE_MS) == pdTRUE) {
+		// wait for a batch of IMU samples, the FIFO keeps the samples while the bus is busy
+		ulTaskNotifyTake(pdTRUE, I2C_TASK_MAX_WAIT_MS / portTICK_RATE_MS);
+
+		spanTrace.beginSpan(SPAN_WAIT_I2C);
+		bool isI2cTaken = (xSemaphoreTake(xSemaphoreI2c, 10 / portTICK_RATE_MS) == pdTRUE);
+		spanTrace.endSpan(SPAN_WAIT_I2C);
+
+		if (isI2cTaken) {
 			if (isImuConnected) {
-				// check if there is any crash happened
-				if (IMU.detector() == true) {
+				// run the detection over all samples in the IMU FIFO
+				spanTrace.beginSpan(SPAN_I2C_IMU);
+				bool isImpact = IMU.detector();
+				spanTrace.endSpan(SPAN_I2C_IMU);
+
+				// sampling again after a wakeup from the parked mode
+				if (isWakeLatencyPending) reportWakeLatency();
+
+				// any motion delays the parked mode
+				afValues = IMU.getCurrentValues();
+				if (fabs(afValues[0] - 1.0) > PARK_MOTION_G || afValues[2] > PARK_MOTION_GYRO) {
+					lastMotionTime = millis();
+				}
+
+				// the raw samples around the onset are kept while the impact is evaluated, only confirmed ones are stored
+				if (isImpact || IMU.isImpactPending()) {
+					impactCapture.trigger(IMU.getImpactOnsetSample());
+				}
+
+				if (isImpact == true) {
 					afImpact = IMU.getLastImpact();
 					ESP_LOGW(LOG_TAG, "Impact detected!");
 					ESP_LOGW(LOG_TAG, "[Impact]: G-Force=%f, AbsAccel=%f , AbsGyro=%f", afImpact[0], afImpact[1], afImpact[2]);
@@ -1665,6 +3485,11 @@ void i2cTask(void * parameter) {
 					mpuServerPacket.tPacket.bCrashDetect = 0x01;
 					mpuServerPacket.tPacket.sbDetectedForced = (int8_t)(afImpact[0] * 10.0);
 					isCrashDetected = true;
+					impactCapture.confirm((uint32_t)rawTime);
+					spanTrace.instant(SPAN_IMPACT, (uint16_t)(afImpact[0] * 10.0));
+				}
+				else if (!IMU.isImpactPending()) {
+					impactCapture.cancel();
 				}
 				else {
 					//ESP_LOGI(LOG_TAG, "[Values]: G-Force=%f, AbsAccel=%f, AbsGyro=%f", IMU.getCurrentValues()[0], IMU.getCurrentValues()[1], IMU.getCurrentValues()[2]);
@@ -1672,14 +3497,16 @@ void i2cTask(void * parameter) {
 			}
 
 			if (isGpsConnected) {
+				spanTrace.beginSpan(SPAN_I2C_GPS);
+
 				// check if any gps data available
 				if (L76.available()) {
 					ESP_LOGI(LOG_TAG, "Check and encode gps data if available..");
 
-					while (L76.available()) {
-						gps.encode(L76.read()); //Feed the GPS parser
-					}
+					encodeGPS(); //Feed the GPS parser
 				}
+
+				spanTrace.endSpan(SPAN_I2C_GPS);
 			}
 
 			xSemaphoreGive(xSemaphoreI2c);
@@ -1688,150 +3515,61 @@ void i2cTask(void * parameter) {
 			xEventGroupSetBits(xWatchdogEvent, i2cTaskId);
 
 		}
-
-
-		delay(1);
 	}
 }
 
 void mainTask(void * parameter) {
 	ESP_LOGI(LOG_TAG, "Start main task...");
 
-	for (;;) {
-
-		ESP_LOGI(LOG_TAG, "Free Heap: %d", ESP.getFreeHeap());
-		ESP_LOGI(LOG_TAG, "System loop time: %f s", (millis() - lastLoopTime) / 1000.0);
-
-		loopStartTime = millis();
-
-
-		// connect to the BMS and get the data
-		if (!isBmsConnected && isBmsFound) {
-			while (!isBmsConnected && connectCounter < 5) {
-				ESP_LOGI(LOG_TAG, "isBmsConnected: %d, cntr: %d", isBmsConnected, connectCounter);
-				isBmsConnected = connectToServer(pBmsDevice, pBmsClient);
-				connectCounter++;
-				delay(100);
-			}
-			connectCounter = 0;
-
-			if (isBmsConnected) {
-				// disconnect from bms
-				pBmsClient->disconnect();
-
-				// wait until the disconnection is finished
-				while (isBmsConnected) {
-					delay(1);
-				};
-				
-				pBmsClient = nullptr;
-				delay(250);
-			}
-		}
-
-		bmsTaskTime = millis();
-
-		// connect to the heartypatch and get the heart rate data
-		if (!isHeartyConnected && isHeartyFound) {
-			while (!isHeartyConnected && connectCounter < 5) {
-				ESP_LOGI(LOG_TAG, "isHeartyConnected: %d, cntr: %d", isHeartyConnected, connectCounter);
-				isHeartyConnected = connectToServer(pHeartyPatchDevice, pHeartyPatchClient);
-				connectCounter++;
-				delay(100);
-			}
-
-			connectCounter = 0;
-
-			if (isHeartyConnected) {
-				// disconnect from hearty patch
-				pHeartyPatchClient->disconnect();
-
-				// wait until the disconnection is finished
-				while (isHeartyConnected) {
-					delay(1);
-				};
-
-				pHeartyPatchClient = nullptr;
-				delay(250);
-
-			}
-		}
-
-		heartyTaskTime = millis();
-
-		// connect to motor controller and get the motor controller data
-		if (!isControllerConnected && isControllerFound) {
-			while (!isControllerConnected && connectCounter < 5) {
-				ESP_LOGI(LOG_TAG, "isControllerConnected: %d, cntr: %d", isControllerConnected, connectCounter);
-				isControllerConnected = connectToServer(pControllerDevice, pControllerClient);
-				connectCounter++;
-				delay(100);
-			}
+	TickType_t xLastWakeTime = xTaskGetTickCount();
 
-			connectCounter = 0;
+	for (;;) {
 
-			if (isControllerConnected) {
+		// the time of every part of the cycle is in the span trace
+		spanTrace.beginSpan(SPAN_MAIN_LOOP);
 
-				// disconnect from motor controller
-				pControllerClient->disconnect();
+		ESP_LOGI(LOG_TAG, "Free Heap: %d", ESP.getFreeHeap());
 
-				// wait until the disconnection is finished
-				while (isControllerConnected) {
-					delay(1);
-				};
-				pControllerClient = nullptr;
-				delay(250);
-			}
+		// service all sessions, open links only cost the periodic action, data arrives via notifications
+		for (uint8_t i = 0; i < bleSessionCount; i++) {
+			serviceBLESession(&bleSessions[i]);
 		}
 
-		controllerTaskTime = millis();
+		// store a confirmed impact capture, the i2c task records the next one once the ring is released
+		impactCapture.process();
 
-		// connect to esp server and then get and write the related data from/to the server characteristics 
-		if (!isEspServerConnected && isEspServerFound) {
-			while (!isEspServerConnected && connectCounter < 5) {
-				ESP_LOGI(LOG_TAG, "isEspServerConnected: %d, cntr: %d", isEspServerConnected, connectCounter);
-				isEspServerConnected = connectToServer(pEspServerDevice, pEspServerClient);
-				connectCounter++;
-				delay(100);
-			}
-			connectCounter = 0;
-
-			if (isEspServerConnected) {
-
-				// disconnect from esp server
-				pEspServerClient->disconnect();
-
-				// wait until the disconnection is finished
-				while (isEspServerConnected) {
-					delay(1);
-				};
-
-				pEspServerClient = nullptr;
-				delay(250);
-			}
-		}
+		// write the recorded inputs
+		inputTrace.process();
 
-		serverTaskTime = millis();
-
-		loopFinishTime = millis();
-		ESP_LOGI(LOG_TAG, "loopStartTime: %d\n", loopStartTime);
-		ESP_LOGI(LOG_TAG, "loopFinishTime : %d\n", loopFinishTime);
-		ESP_LOGI(LOG_TAG, "diff loop time : %d\n", loopFinishTime - loopStartTime);
-		ESP_LOGI(LOG_TAG, "bmsTask time : %d\n", bmsTaskTime - loopStartTime);
-		ESP_LOGI(LOG_TAG, "heartyTask time : %d\n", heartyTaskTime - bmsTaskTime);
-		ESP_LOGI(LOG_TAG, "controllerTask time : %d\n", controllerTaskTime - heartyTaskTime);
-		ESP_LOGI(LOG_TAG, "serverTask time : %d\n", serverTaskTime - controllerTaskTime);
+		// keep collecting the telemetry while the ESP server is away, it is forwarded after the reconnect
+		if (!isEspServerReady()) updateValue();
 
 		// check BLE connection to scan any missing devices
 		checkBLEConnection();
 
+		// i2c bus occupancy of the GPS reads
+		logGpsBusTime();
+
+		// deep sleep while the bike is locked and not moved, does not return if the parked mode is entered
+		checkParkedMode();
+
 		// set bits to alert watchdog that the task still responsive
 		xEventGroupSetBits(xWatchdogEvent, mainTaskId);
+
+		spanTrace.endSpan(SPAN_MAIN_LOOP);
+
+		// keep a fixed telemetry refresh period, reconnects of a single device only delay its own session
+		vTaskDelayUntil(&xLastWakeTime, BLE_TELEMETRY_CYCLE_MS / portTICK_RATE_MS);
 	}
 }
 
 void loop() {
 
+	// the span trace of the last seconds as Chrome trace JSON
+	if (Serial.available() > 0 && Serial.read() == SPAN_TRACE_DUMP_COMMAND) {
+		spanTrace.dump(Serial);
+	}
+
 	// if the main task stop responding
 	if (isMainTaskStopResponding) {
 		isMainTaskStopResponding = false;
@@ -1864,8 +3602,8 @@ void loop() {
 	if (isTtnTaskStopResponding) {
 		isTtnTaskStopResponding = false;
 
-		// release the semaphore for spi related functions (on TTN ask)
-		xSemaphoreGive(xSemaphoreSpi);
+		// release the spi bus (on TTN ask)
+		spiBus.release(SPI_BUS_CLASS_RADIO);
 
 		// delete the TTN task
 		vTaskDelete(xTaskTtn);
@@ -1884,6 +3622,9 @@ void loop() {
 		// release the semaphore for i2c related functions
 		xSemaphoreGive(xSemaphoreI2c);
 
+		// stop notifying the old task from the IMU interrupt
+		IMU.setNotifyTask(NULL);
+
 		// delete the i2c task
 		vTaskDelete(xTaskI2c);
 
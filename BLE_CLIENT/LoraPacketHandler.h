@@ -14,6 +14,9 @@
 #include "WProgram.h"
 #endif
 
+#include <TelemetryStore.h>
+#include <LoraPacketCodec.h>
+
 typedef __PACKED_PRE struct LORA_DATA_STRUCT_Ttag {
 	union {
 		float		fGpsLatitude;
@@ -42,6 +45,88 @@ typedef union LORA_DATA_PACKET_Ttag {
 	LORA_DATA_STRUCT_T tPacket;
 }LORA_DATA_PACKET_T;
 
+/* uplink ports, backlog frames carry the sample time (epoch, big endian) in front of the packet. Key and delta
+ * frames are described in LoraPacketCodec.h */
+#define LORA_PORT_LIVE					1			// LORA_DATA_PACKET_T of the current sample, key frame of the codec
+#define LORA_PORT_DELTA					2			// current sample as delta frame against the last key frame
+#define LORA_PORT_BACKLOG				3			// sample time + LORA_DATA_PACKET_T of a stored sample
+#define LORA_RECORD_SAMPLE				1			// record type of a sample in the telemetry store
+#define LORA_CONFIRM_INTERVAL			8			// every n-th live uplink is confirmed to detect a lost link
+#define LORA_LIVE_MAX_AGE_S				120			// older samples are sent as backlog frame with their sample time
+
+/* batching of several samples into one uplink, see LoraPacketBatch */
+#define LORA_PORT_BATCH					4			// batch frame of several samples
+#define LORA_BATCH_MAX_AGE_S			60			// a batch is sent at the latest when its oldest sample is this old
+#define LORA_BATCH_MAX_BYTES			115			// upper limit of a batch payload, the data rate may limit it further
+#define LORA_BATCH_MAX_RECORDS			8			// upper limit of samples per batch
+#define LORA_FRAME_OVERHEAD				13			// MHDR, FHDR without options, FPort and MIC
+#define LORA_MAC_RESERVE				2			// room for MAC answers piggybacked by LMIC
+
+/* largest uplink payload of a data rate: maxFrameLen is LMICeu868_maxFrameLen() of the data rate (0xFF if the band plan
+ * has no limit of its own), frameBufferLen the frame buffer of LMIC (MAX_LEN_FRAME) */
+static inline size_t loraPayloadLimitOf(uint8_t maxFrameLen, size_t frameBufferLen) {
+
+	size_t frameLen = (maxFrameLen > frameBufferLen) ? frameBufferLen : maxFrameLen;
+
+	frameLen -= LORA_FRAME_OVERHEAD + LORA_MAC_RESERVE;
+
+	return (frameLen < LORA_BATCH_MAX_BYTES) ? frameLen : LORA_BATCH_MAX_BYTES;
+}
+
+/* uplink selected by loraSelectUplink() */
+typedef struct LORA_UPLINK_Ttag {
+	uint8_t			bPort;
+	const uint8_t	*pFrame;
+	size_t			len;
+	uint8_t			bRecords;					// samples in the frame, removed from the store after EV_TXCOMPLETE
+} LORA_UPLINK_T;
+
+/* select the uplink of the oldest stored samples: ptRecords are the oldest records of the store (at most
+ * LORA_BATCH_MAX_RECORDS), pFrame a buffer of sizeof(uint32_t) + TELEMETRY_STORE_DATA_LEN bytes for a single sample.
+ * Samples are collected into one batch until the batch is full for the payload limit or its oldest sample is
+ * LORA_BATCH_MAX_AGE_S old, while the link is lost nothing is held back. A sample sent alone is a key/delta frame of the
+ * codec, or a backlog frame with its sample time if it is older than the live stream. Every frame of another format
+ * counts as uplink in the codec, a key frame follows only at the end of the key interval.
+ * returns false while the samples are held back */
+static inline bool loraSelectUplink(const TELEMETRY_RECORD_T *ptRecords, uint16_t records, uint32_t ulNow, bool isLinkUp,
+	size_t payloadLimit, LoraPacketCodec &codec, LoraPacketBatch &batch, uint8_t *pFrame, LORA_UPLINK_T *ptUplink) {
+
+	if (records == 0) return false;
+
+	batch.begin(payloadLimit);
+	for (uint16_t i = 0; i < records && batch.add(ptRecords[i].ulTime, ptRecords[i].abData); i++);
+
+	// wait for more samples while the batch has room and its oldest sample is not due
+	if (isLinkUp && batch.count() == records && records < LORA_BATCH_MAX_RECORDS &&
+		ulNow - ptRecords[0].ulTime < LORA_BATCH_MAX_AGE_S) return false;
+
+	if (batch.count() > 1) {
+		ptUplink->bPort = LORA_PORT_BATCH;
+		ptUplink->pFrame = batch.data();
+		ptUplink->len = batch.length();
+		ptUplink->bRecords = batch.count();
+		codec.skip();
+	}
+	else if (ulNow - ptRecords[0].ulTime >= LORA_LIVE_MAX_AGE_S) {
+		ptUplink->bPort = LORA_PORT_BACKLOG;
+		for (uint8_t i = 0; i < sizeof(uint32_t); i++) pFrame[i] = (uint8_t)(ptRecords[0].ulTime >> (24 - 8 * i));
+		memcpy(&pFrame[sizeof(uint32_t)], ptRecords[0].abData, ptRecords[0].bLength);
+		ptUplink->pFrame = pFrame;
+		ptUplink->len = sizeof(uint32_t) + ptRecords[0].bLength;
+		ptUplink->bRecords = 1;
+		codec.skip();
+	}
+	else {
+		bool isKeyFrame;
+		ptUplink->len = codec.encode(ptRecords[0].abData, pFrame, isKeyFrame);
+		ptUplink->bPort = isKeyFrame ? LORA_PORT_LIVE : LORA_PORT_DELTA;
+		ptUplink->pFrame = pFrame;
+		ptUplink->bRecords = 1;
+	}
+
+	return true;
+}
+
 // This EUI must be in little-endian format, so least-significant-byte first. When copying an EUI from ttnctl output,
 // this means to reverse the bytes. For TTN issued EUIs the last bytes should be 0xD5, 0xB3, 0x70. 
 //static const uint8_t PROGMEM APPEUI[8] = { 0xE9, 0x63, 0x01, 0xD0, 0x7E, 0xD5, 0xB3, 0x70 };
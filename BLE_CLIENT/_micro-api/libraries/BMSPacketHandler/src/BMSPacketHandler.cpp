@@ -23,7 +23,7 @@
 #if defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
 #define LOG_TAG ""
-#else
+#elif defined(ESP_PLATFORM)
 #include "esp_log.h"
 static const char* LOG_TAG = "BLEDevice";
 #endif
@@ -32,17 +32,32 @@ static const char* LOG_TAG = "BLEDevice";
 #include "byteswap.h"
 
 
-BMSPacketHandler::BMSPacketHandler()
+/** map the decoder result onto the BMS error codes */
+static BMS_ERROR_E toBmsError(SERIAL_FRAME_RESULT_E eResult)
 {
-	blPacket2Parse = false;
+	switch (eResult) {
+	case FRAME_OK:				return ERR_BMS_OK;
+	case FRAME_IDLE:			return ERR_BMS_NO_DATA_AVAIL;
+	case FRAME_PENDING:			return ERR_BMS_SHORT_DATA;
+	case FRAME_ERR_PREAMBLE:	return ERR_BMS_DETECTED;
+	case FRAME_ERR_CHECKSUM:	return ERR_BMS_CHECKSUM;
+	case FRAME_ERR_SUFFIX:		return ERR_BMS_SUFFIX;
+	default:					return ERR_BMS_SHORT_DATA;
+	}
+}
 
+BMSPacketHandler::BMSPacketHandler() : _rxDecoder(&_rxPacket)
+{
+	_serPort = nullptr;
+	_infoStatusCallback = nullptr;
+	_inPlaceFrameCount = 0;
 }
 
-BMSPacketHandler::BMSPacketHandler(HardwareSerial *port)
+BMSPacketHandler::BMSPacketHandler(HardwareSerial *port) : _rxDecoder(&_rxPacket)
 {
 	_serPort = port;
-	blPacket2Parse = false;
-
+	_infoStatusCallback = nullptr;
+	_inPlaceFrameCount = 0;
 }
 
 BMSPacketHandler::~BMSPacketHandler()
@@ -74,6 +89,7 @@ uint8_t BMSPacketHandler::setSerialPacket(BMS_PACKET_STRUCT_T * tSerialWritePack
 	return (uint8_t)(sizeof(tSerialWritePacket->bHeader) + sizeof(tSerialWritePacket->tRequestMode) + sizeof(tSerialWritePacket->bLength) + len + sizeof(tCheckSum) + 1);
 }
 
+#if defined(ARDUINO)
 void BMSPacketHandler::sendSerialPacket(BMS_PACKET_STRUCT_T * tSerialWritePacket, uint8_t len)
 {
 	uint8_t abSendPacket[30] = { 0 };
@@ -87,339 +103,121 @@ void BMSPacketHandler::sendSerialPacket(BMS_PACKET_STRUCT_T * tSerialWritePacket
 
 BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket)
 {
-	uint8_t temp = 0, index = 0;
-	bool readSuffix = false;
-
-	SERIAL_BMS_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	BMS_CHECKSUM_PACKET_T tCheckSum = { 0 };
-	BMS_ERROR_E bRet = ERR_BMS_OK;
+	BMSFrameDecoder decoder(tSerialReadPacket);
+	SERIAL_FRAME_RESULT_E eResult;
 
 	if (!_serPort->available()) return ERR_BMS_NO_DATA_AVAIL;
-	else {
-		while (_serPort->available()) {
-			temp = _serPort->read();
-			//ESP_LOGD(LOG_TAG, "%d ", temp);
-
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == bmsHeader) {									/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_REGISTER;
-				}
-				break;
-			}
-			case SP_STATE_READ_REGISTER: {
-				tSerialReadPacket->tResponseMode.bCmdID = temp;				/** read the command ID register */
-				processState = SP_STATE_CHECK_ERROR;
-				break;
-			}
-			case SP_STATE_CHECK_ERROR: {
-				tSerialReadPacket->tResponseMode.bStatus = temp;			/** read the error status */
-				if (!temp) processState = SP_STATE_READ_PAYLOAD_LENGTH;		/** if no error */
-				else {
-					bRet = BMS_ERROR_E(temp);								/** if error occured, exit the while condition */
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD_LENGTH: {
-				tSerialReadPacket->bLength = temp;							/** read the payload length */
-				tCheckSum.checkSum = temp;									/** transfer the data to checksum buffer */
-				if (!temp) {												/** if payload length is 0 */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** go directly to check checksum state */
-				}
-				else processState = SP_STATE_READ_PAYLOAD;					/** else go to read payload state */
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the data into payload buffer */
-				tCheckSum.checkSum += temp;									/** accumulate the data into checksum buffer */
-				if (index == tSerialReadPacket->bLength) {					/** when all payload has been read */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** and go to check checksum state */
-				}
-				break;
-			}
-			case SP_STATE_MSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum MSB) into read packet */
-				if (tCheckSum.abCheckSum[1] == temp) processState = SP_STATE_LSB_CHECKSUM;	/** if checksum MSB is correct, go to LSB checksum state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_LSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum LSB) into read packet */
-				if (tCheckSum.abCheckSum[0] == temp) processState = SP_STATE_READ_SUFFIX;	/** if checksum LSB is correct, go to the read suffix state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == bmsSuffix) {
-					readSuffix = true;
-					//ESP_LOGD(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_BMS_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
 
-			if (ERR_BMS_OK != bRet) break;
-		}
+	/** single shot decode of one frame, stop at the first complete frame or error */
+	while (_serPort->available()) {
+		eResult = decoder.parseByte(_serPort->read());
+		if (FRAME_OK == eResult) return ERR_BMS_OK;
+		if (FRAME_IDLE != eResult && FRAME_PENDING != eResult) return toBmsError(eResult);
 	}
 
-	if (!readSuffix) return ERR_BMS_SHORT_DATA;
-	else return bRet;
+	return ERR_BMS_SHORT_DATA;
 }
+#endif
 
-BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket, uint8_t *data, uint8_t len)
+BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket, const uint8_t *data, size_t len)
 {
-	uint8_t temp = 0, index = 0, idx = 0;
-	bool readSuffix = false;
-	uint8_t dataSize = len;
-	SERIAL_BMS_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	BMS_CHECKSUM_PACKET_T tCheckSum = { 0 };
-	BMS_ERROR_E bRet = ERR_BMS_OK;
-
-	//ESP_LOGD(LOG_TAG, "dataSize: %d", dataSize);
-
-	if (!dataSize) return ERR_BMS_NO_DATA_AVAIL;
-	else {
-		while (dataSize--) {
-
-			temp = (uint8_t)data[idx++];
-			//ESP_LOGD(LOG_TAG, "data[%d]: 0x%02X", idx - 1, temp);
-
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == bmsHeader) {									/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_REGISTER;
-				}
-				break;
-			}
-			case SP_STATE_READ_REGISTER: {
-				tSerialReadPacket->tResponseMode.bCmdID = temp;				/** read the command ID register */
-				processState = SP_STATE_CHECK_ERROR;
-				break;
-			}
-			case SP_STATE_CHECK_ERROR: {
-				tSerialReadPacket->tResponseMode.bStatus = temp;			/** read the error status */
-				if (!temp) processState = SP_STATE_READ_PAYLOAD_LENGTH;		/** if no error */
-				else {
-					bRet = BMS_ERROR_E(temp);								/** if error occured, exit the while condition */
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD_LENGTH: {
-				tSerialReadPacket->bLength = temp;							/** read the payload length */
-				tCheckSum.checkSum = temp;									/** transfer the data to checksum buffer */
-				if (!temp) {												/** if payload length is 0 */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** go directly to check checksum state */
-				}
-				else processState = SP_STATE_READ_PAYLOAD;					/** else go to read payload state */
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the data into payload buffer */
-				tCheckSum.checkSum += temp;									/** accumulate the data into checksum buffer */
-				if (index == tSerialReadPacket->bLength) {					/** when all payload has been read */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** and go to check checksum state */
-				}
-				break;
-			}
-			case SP_STATE_MSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum MSB) into read packet */
-				if (tCheckSum.abCheckSum[1] == temp) processState = SP_STATE_LSB_CHECKSUM;	/** if checksum MSB is correct, go to LSB checksum state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_LSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum LSB) into read packet */
-				if (tCheckSum.abCheckSum[0] == temp) processState = SP_STATE_READ_SUFFIX;	/** if checksum LSB is correct, go to the read suffix state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == bmsSuffix) {
-					readSuffix = true;
-					//ESP_LOGD(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_BMS_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
-
-			if (ERR_BMS_OK != bRet) break;
-		}
-	}
-
-	if (!readSuffix) return ERR_BMS_SHORT_DATA;
-	else return bRet;
+	return readSerialPacket(tSerialReadPacket, ByteSpan(data, len));
 }
 
-BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket, std::string data)
+BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket, const std::string &data)
 {
-	uint8_t temp = 0, index = 0, idx = 0;
-	bool readSuffix = false;
-	uint8_t dataSize = data.length();
-	SERIAL_BMS_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	BMS_CHECKSUM_PACKET_T tCheckSum = { 0 };
-	BMS_ERROR_E bRet = ERR_BMS_OK;
-
-	//ESP_LOGD(LOG_TAG, "dataSize: 0x%02X", dataSize);
-
-	if (!dataSize) return ERR_BMS_NO_DATA_AVAIL;
-	else {
-		while (dataSize--) {
+	return readSerialPacket(tSerialReadPacket, ByteSpan(data));
+}
 
-			temp = (uint8_t)data[idx++];
-			//ESP_LOGD(LOG_TAG, "data[%d]: 0x%02X", idx - 1, temp);
+BMS_ERROR_E BMSPacketHandler::readSerialPacket(BMS_PACKET_STRUCT_T * tSerialReadPacket, ByteSpan data)
+{
+	BMSFrameDecoder decoder(tSerialReadPacket);
+	SERIAL_FRAME_RESULT_E eResult;
 
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == bmsHeader) {									/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_REGISTER;
-				}
-				break;
-			}
-			case SP_STATE_READ_REGISTER: {
-				tSerialReadPacket->tResponseMode.bCmdID = temp;				/** read the command ID register */
-				processState = SP_STATE_CHECK_ERROR;
-				break;
-			}
-			case SP_STATE_CHECK_ERROR: {
-				tSerialReadPacket->tResponseMode.bStatus = temp;			/** read the error status */
-				if (!temp) processState = SP_STATE_READ_PAYLOAD_LENGTH;		/** if no error */
-				else {
-					bRet = BMS_ERROR_E(temp);								/** if error occured, exit the while condition */
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD_LENGTH: {
-				tSerialReadPacket->bLength = temp;							/** read the payload length */
-				tCheckSum.checkSum = temp;									/** transfer the data to checksum buffer */
-				if (!temp) {												/** if payload length is 0 */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** go directly to check checksum state */
-				}
-				else processState = SP_STATE_READ_PAYLOAD;					/** else go to read payload state */
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the data into payload buffer */
-				tCheckSum.checkSum += temp;									/** accumulate the data into checksum buffer */
-				if (index == tSerialReadPacket->bLength) {					/** when all payload has been read */
-					tCheckSum.checkSum = ~tCheckSum.checkSum + 1;			/** calculate the checksum */
-					processState = SP_STATE_MSB_CHECKSUM;					/** and go to check checksum state */
-				}
-				break;
-			}
-			case SP_STATE_MSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum MSB) into read packet */
-				if (tCheckSum.abCheckSum[1] == temp) processState = SP_STATE_LSB_CHECKSUM;	/** if checksum MSB is correct, go to LSB checksum state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_LSB_CHECKSUM: {
-				tSerialReadPacket->abData[index++] = temp;					/** save the received data (checksum LSB) into read packet */
-				if (tCheckSum.abCheckSum[0] == temp) processState = SP_STATE_READ_SUFFIX;	/** if checksum LSB is correct, go to the read suffix state */
-				else bRet = ERR_BMS_CHECKSUM;									/** else return the checksum error */
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == bmsSuffix) {
-					readSuffix = true;
-					//ESP_LOGD(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_BMS_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
+	if (!data.len) return ERR_BMS_NO_DATA_AVAIL;
 
-			if (ERR_BMS_OK != bRet) break;
-		}
+	/** single shot decode of one frame, stop at the first complete frame or error */
+	for (size_t i = 0; i < data.len; i++) {
+		eResult = decoder.parseByte(data.data[i]);
+		if (FRAME_OK == eResult) return ERR_BMS_OK;
+		if (FRAME_IDLE != eResult && FRAME_PENDING != eResult) return toBmsError(eResult);
 	}
 
-	if (!readSuffix) return ERR_BMS_SHORT_DATA;
-	else return bRet;
+	return ERR_BMS_SHORT_DATA;
 }
 
-void BMSPacketHandler::bmsReadInfoStatus(uint8_t *pData, uint8_t len) {
+void BMSPacketHandler::setInfoStatusCallback(BMS_INFO_STATUS_CALLBACK_T callback)
+{
+	_infoStatusCallback = callback;
+}
 
-	BMS_PACKET_STRUCT_T rSerialPacket = { 0 };
-	BMS_ERROR_E bRet = ERR_BMS_OK;
+void BMSPacketHandler::resetParser()
+{
+	_rxDecoder.reset();
+}
 
-	if (blPacket2Parse) {
+BMS_ERROR_E BMSPacketHandler::parseByte(uint8_t data)
+{
+	return toBmsError(_rxDecoder.parseByte(data));
+}
 
-		uint8_t totalLength = lastPacketLength + len;
+uint8_t BMSPacketHandler::bmsReadInfoStatus(const uint8_t *pData, size_t len)
+{
+	uint8_t frameCount = 0;
 
-		for (uint8_t i = 0; i < len; i++) {
-			abBMSReadPacket[lastPacketLength + i] = pData[i];
-		}
+	/** fast path: a notification with a large enough MTU carries the whole frame, use it in place */
+	if (_rxDecoder.isIdle() && BMSFrameDecoder::isCompleteFrame(pData, len)) {
+		const BMS_PACKET_STRUCT_T *pFrame = (const BMS_PACKET_STRUCT_T*)pData;
 
-		if (ERR_BMS_OK != (bRet = readSerialPacket(&rSerialPacket, abBMSReadPacket, totalLength))) {
-			//ESP_LOGD(LOG_TAG, "bRet: %d", bRet);
+		if (pFrame->tResponseMode.bCmdID != BMSRegister::BMS_REG_INFO_STATUS) {
+			_inPlaceFrameCount++;
+			return 0;
 		}
 
-		//ESP_LOGD(LOG_TAG, "Total voltage: %d", __bswap_16(rSerialPacket.tInfoStatus.usTotalVoltage));
-		
-		Serial.printf("Total voltage: %d", __bswap_16(rSerialPacket.tInfoStatus.usTotalVoltage));
-
-		blPacket2Parse = false;
-	}
-
-	else {
-		if (ERR_BMS_OK != (bRet = readSerialPacket(&rSerialPacket, pData, len))) {
-			//ESP_LOGD(LOG_TAG, "bRet: %d", bRet);
-
-			if (bRet == ERR_BMS_SHORT_DATA) {
-				memcpy(abBMSReadPacket, &rSerialPacket, len);
-				lastPacketLength = len;
-				blPacket2Parse = true;
-			}
+		/** the info status is only handed out in place if the frame covers the whole struct */
+		if (pFrame->bLength >= sizeof(BMS_INFO_STATUS_READ_STRUCT_T)) {
+			_inPlaceFrameCount++;
+			if (_infoStatusCallback != nullptr) _infoStatusCallback(&pFrame->tInfoStatus);
+			return 1;
 		}
 	}
-}
-
-bool BMSPacketHandler::bmsReadInfoStatus(BMS_PACKET_STRUCT_T *tPacket, uint8_t *pData, uint8_t len) {
 
-	BMS_ERROR_E bRet = ERR_BMS_OK;
+	/** fragments, several frames or a short info status are reassembled by the decoder */
 
-	if (blPacket2Parse) {
+	_rxDecoder.feed(ByteSpan(pData, len), [&](const BMS_PACKET_STRUCT_T &tFrame) {
+		if (tFrame.tResponseMode.bCmdID != BMSRegister::BMS_REG_INFO_STATUS) return;
 
-		uint8_t totalLength = lastPacketLength + len;
+		frameCount++;
+		if (_infoStatusCallback == nullptr) return;
 
-		for (uint8_t i = 0; i < len; i++) {
-			abBMSReadPacket[lastPacketLength + i] = pData[i];
+		/** hand the info status straight out of the receive packet, a short one without the stale bytes behind it */
+		if (tFrame.bLength >= sizeof(BMS_INFO_STATUS_READ_STRUCT_T)) {
+			_infoStatusCallback(&tFrame.tInfoStatus);
 		}
-
-		if (ERR_BMS_OK != (bRet = readSerialPacket(tPacket, abBMSReadPacket, totalLength))) {
-			//ESP_LOGD(LOG_TAG, "bRet: %d", bRet);
+		else {
+			BMS_INFO_STATUS_READ_STRUCT_T tInfoStatus;
+			memset(&tInfoStatus, 0, sizeof(tInfoStatus));
+			memcpy(&tInfoStatus, &tFrame.tInfoStatus, tFrame.bLength);
+			_infoStatusCallback(&tInfoStatus);
 		}
+	});
 
-		blPacket2Parse = false;
-
-		return true;
-	}
+	return frameCount;
+}
 
-	else {
-		if (ERR_BMS_OK != (bRet = readSerialPacket(tPacket, pData, len))) {
-			//ESP_LOGD(LOG_TAG, "bRet: %d", bRet);
+bool BMSPacketHandler::bmsReadInfoStatus(BMS_PACKET_STRUCT_T *tPacket, const uint8_t *pData, size_t len)
+{
+	bool isFrameComplete = false;
 
-			if (bRet == ERR_BMS_SHORT_DATA) {
-				memcpy(abBMSReadPacket, tPacket, len);
-				lastPacketLength = len;
-				blPacket2Parse = true;
+	_rxDecoder.feed(ByteSpan(pData, len), [&](const BMS_PACKET_STRUCT_T &tFrame) {
+		if (tFrame.tResponseMode.bCmdID == BMSRegister::BMS_REG_INFO_STATUS) {
+			memcpy(tPacket, &tFrame, sizeof(tFrame));
+			if (tFrame.bLength < sizeof(BMS_INFO_STATUS_READ_STRUCT_T)) {
+				memset((uint8_t*)&tPacket->tInfoStatus + tFrame.bLength, 0, sizeof(BMS_INFO_STATUS_READ_STRUCT_T) - tFrame.bLength);
 			}
-
-			return false;
+			isFrameComplete = true;
 		}
+	});
 
-		else return true;
-	}
+	return isFrameComplete;
 }
@@ -0,0 +1,270 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			stream_parser_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test and fuzz of the streaming info status parser of BMSPacketHandler
+* @details		A frame has to come out of bmsReadInfoStatus(pData, len) exactly once whichever way the notifications
+*				split it, the parser has to resync on 0xDD after a damaged frame. The fuzz feeds a million frames
+*				with noise and truncated frames in between, cut into fragments of random size. An info status shorter
+*				than the struct comes out with the missing fields zero, not with the bytes of the frame before.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <vector>
+#include <BMSPacketHandler.h>
+#include "HostTest.h"
+
+#define FUZZ_FRAMES			1000000
+#define FUZZ_BLOCK_FRAMES	1000
+
+static std::vector<BMS_INFO_STATUS_READ_STRUCT_T> aReceived;
+
+static void infoStatusCallback(const BMS_INFO_STATUS_READ_STRUCT_T *tInfoStatus)
+{
+	aReceived.push_back(*tInfoStatus);
+}
+
+/** info status response, the payload bytes are seed, seed + 1, ... */
+static void appendFrame(std::vector<uint8_t> &stream, uint8_t seed, uint8_t cmdID = BMSRegister::BMS_REG_INFO_STATUS,
+	uint8_t len = sizeof(BMS_INFO_STATUS_READ_STRUCT_T))
+{
+	uint16_t sum = len;
+
+	stream.push_back(0xDD);
+	stream.push_back(cmdID);
+	stream.push_back(0x00);
+	stream.push_back(len);
+	for (uint8_t i = 0; i < len; i++) {
+		stream.push_back((uint8_t)(seed + i));
+		sum += (uint8_t)(seed + i);
+	}
+	sum = ~sum + 1;
+	stream.push_back((uint8_t)(sum >> 8));
+	stream.push_back((uint8_t)sum);
+	stream.push_back(0x77);
+}
+
+static bool isFrameOf(const BMS_INFO_STATUS_READ_STRUCT_T &tInfoStatus, uint8_t seed)
+{
+	const uint8_t *pData = (const uint8_t*)&tInfoStatus;
+
+	for (uint8_t i = 0; i < sizeof(tInfoStatus); i++) {
+		if (pData[i] != (uint8_t)(seed + i)) return false;
+	}
+
+	return true;
+}
+
+static void testWholeFrame()
+{
+	BMSPacketHandler bms;
+	std::vector<uint8_t> frame;
+
+	appendFrame(frame, 0x10);
+	bms.setInfoStatusCallback(infoStatusCallback);
+	aReceived.clear();
+
+	CHECK_EQ(bms.bmsReadInfoStatus(frame.data(), frame.size()), 1);
+	CHECK_EQ(aReceived.size(), 1);
+	CHECK(isFrameOf(aReceived[0], 0x10));
+	CHECK_EQ(bms.getInPlaceFrameCount(), 1);
+	CHECK_EQ(bms.getErrorCount(), 0);
+}
+
+/** every split into two and three fragments, the three way split lost the frame before the streaming parser */
+static void testSplits()
+{
+	BMSPacketHandler bms;
+	std::vector<uint8_t> frame;
+	uint32_t expected = 0;
+
+	appendFrame(frame, 0x40);
+	bms.setInfoStatusCallback(infoStatusCallback);
+	aReceived.clear();
+
+	for (size_t a = 1; a < frame.size(); a++) {
+		for (size_t b = a; b < frame.size(); b++) {
+			bms.bmsReadInfoStatus(frame.data(), a);
+			bms.bmsReadInfoStatus(frame.data() + a, b - a);
+			bms.bmsReadInfoStatus(frame.data() + b, frame.size() - b);
+			expected++;
+		}
+	}
+
+	CHECK_EQ(aReceived.size(), expected);
+	for (size_t i = 0; i < aReceived.size(); i++) CHECK(isFrameOf(aReceived[i], 0x40));
+	CHECK_EQ(bms.getErrorCount(), 0);
+
+	/** byte by byte */
+	aReceived.clear();
+	for (size_t i = 0; i < frame.size(); i++) bms.bmsReadInfoStatus(&frame[i], 1);
+	CHECK_EQ(aReceived.size(), 1);
+}
+
+static void testDamagedFrames()
+{
+	BMSPacketHandler bms;
+	std::vector<uint8_t> stream;
+	std::vector<uint8_t> frame;
+
+	bms.setInfoStatusCallback(infoStatusCallback);
+	aReceived.clear();
+
+	/** checksum, suffix and status errors, each followed by a valid frame */
+	appendFrame(frame, 0x01);
+	frame[frame.size() - 2] ^= 0x01;
+	stream.insert(stream.end(), frame.begin(), frame.end());
+	appendFrame(stream, 0x02);
+
+	frame.clear();
+	appendFrame(frame, 0x03);
+	frame.back() = 0x78;
+	stream.insert(stream.end(), frame.begin(), frame.end());
+	appendFrame(stream, 0x04);
+
+	frame.clear();
+	appendFrame(frame, 0x05);
+	frame[2] = 0x80;
+	stream.insert(stream.end(), frame.begin(), frame.end());
+	appendFrame(stream, 0x06);
+
+	/** a response of another register is valid but no info status */
+	appendFrame(stream, 0x07, BMSRegister::BMS_REG_BATT_VOLTAGE);
+	appendFrame(stream, 0x08);
+
+	CHECK_EQ(bms.bmsReadInfoStatus(stream.data(), stream.size()), 4);
+	CHECK_EQ(aReceived.size(), 4);
+	if (aReceived.size() == 4) {
+		CHECK(isFrameOf(aReceived[0], 0x02));
+		CHECK(isFrameOf(aReceived[1], 0x04));
+		CHECK(isFrameOf(aReceived[2], 0x06));
+		CHECK(isFrameOf(aReceived[3], 0x08));
+	}
+	CHECK_EQ(bms.getErrorCount(), 3);
+	CHECK_EQ(bms.getFrameCount(), 5);
+}
+
+/** a short info status after a whole one, the decoder buffer still holds the tail of the whole one */
+static void testShortFrame()
+{
+	const uint8_t shortLen = 10;
+	BMSPacketHandler bms;
+	BMS_PACKET_STRUCT_T tPacket;
+	std::vector<uint8_t> frame;
+	std::vector<uint8_t> shortFrame;
+
+	appendFrame(frame, 0x30);
+	appendFrame(shortFrame, 0x50, BMSRegister::BMS_REG_INFO_STATUS, shortLen);
+	bms.setInfoStatusCallback(infoStatusCallback);
+	aReceived.clear();
+
+	/** split, the whole frame goes through the decoder too */
+	CHECK_EQ(bms.bmsReadInfoStatus(frame.data(), 7), 0);
+	CHECK_EQ(bms.bmsReadInfoStatus(&frame[7], frame.size() - 7), 1);
+	CHECK_EQ(bms.bmsReadInfoStatus(shortFrame.data(), shortFrame.size()), 1);
+
+	CHECK_EQ(aReceived.size(), 2);
+	if (aReceived.size() == 2) {
+		const uint8_t *pData = (const uint8_t*)&aReceived[1];
+
+		CHECK(isFrameOf(aReceived[0], 0x30));
+		for (uint8_t i = 0; i < sizeof(BMS_INFO_STATUS_READ_STRUCT_T); i++) {
+			CHECK_EQ(pData[i], (i < shortLen) ? (uint8_t)(0x50 + i) : 0);
+		}
+	}
+	CHECK_EQ(bms.getInPlaceFrameCount(), 0);
+	CHECK_EQ(bms.getErrorCount(), 0);
+
+	/** the same for the packet of the caller */
+	memset(&tPacket, 0xFF, sizeof(tPacket));
+	CHECK(bms.bmsReadInfoStatus(&tPacket, frame.data(), frame.size()));
+	CHECK(bms.bmsReadInfoStatus(&tPacket, shortFrame.data(), shortFrame.size()));
+
+	const uint8_t *pData = (const uint8_t*)&tPacket.tInfoStatus;
+	for (uint8_t i = 0; i < sizeof(BMS_INFO_STATUS_READ_STRUCT_T); i++) {
+		CHECK_EQ(pData[i], (i < shortLen) ? (uint8_t)(0x50 + i) : 0);
+	}
+}
+
+/** random frames with noise and truncated frames in between, cut into random fragments */
+static void testFuzz()
+{
+	BMSPacketHandler bms;
+	std::vector<uint8_t> stream;
+	std::vector<uint8_t> aSeed;
+	uint32_t truncated = 0;
+	uint32_t received = 0;
+	uint32_t mismatches = 0;
+
+	randomSeed(2);
+	bms.setInfoStatusCallback(infoStatusCallback);
+
+	for (uint32_t block = 0; block < FUZZ_FRAMES / FUZZ_BLOCK_FRAMES; block++) {
+		stream.clear();
+		aSeed.clear();
+		aReceived.clear();
+
+		for (uint32_t k = 0; k < FUZZ_BLOCK_FRAMES; k++) {
+			switch (random(8)) {
+			case 0:
+				/** noise between the frames, never a header */
+				for (long n = random(1, 6); n > 0; n--) stream.push_back((uint8_t)random(0xDD));
+				break;
+			case 1:
+				/** start of a frame cut off by the dongle, the next header ends it as a status error */
+				stream.push_back(0xDD);
+				stream.push_back(BMSRegister::BMS_REG_INFO_STATUS);
+				truncated++;
+				break;
+			default:
+				break;
+			}
+
+			aSeed.push_back((uint8_t)random(256));
+			appendFrame(stream, aSeed.back());
+		}
+
+		for (size_t i = 0; i < stream.size();) {
+			size_t len = (size_t)random(1, 41);
+
+			if (len > stream.size() - i) len = stream.size() - i;
+			bms.bmsReadInfoStatus(&stream[i], len);
+			i += len;
+		}
+
+		received += aReceived.size();
+		for (size_t k = 0; k < aReceived.size() && k < aSeed.size(); k++) {
+			if (!isFrameOf(aReceived[k], aSeed[k])) mismatches++;
+		}
+	}
+
+	printf("fuzz: %u frames, %u received, %u truncated, %u errors\n", FUZZ_FRAMES, received, truncated, bms.getErrorCount());
+
+	CHECK_EQ(received, FUZZ_FRAMES);
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(bms.getErrorCount(), truncated);
+}
+
+int main()
+{
+	testWholeFrame();
+	testSplits();
+	testDamagedFrames();
+	testShortFrame();
+	testFuzz();
+
+	return HOST_TEST_RESULT();
+}
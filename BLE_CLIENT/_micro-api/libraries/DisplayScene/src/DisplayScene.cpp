@@ -0,0 +1,306 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			DisplayScene.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		retained widgets with dirty tile tracking on top of U8g2
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "DisplayScene.h"
+
+DisplayWidget::DisplayWidget()
+{
+	_isDirty = true;
+	_pNext = nullptr;
+}
+
+TextWidget::TextWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, const uint8_t *pFont, const char *pText)
+{
+	_x = x;
+	_y = y;
+	_width = width;
+	_lastWidth = 0;
+	_pFont = pFont;
+	_acText[0] = '\0';
+	setText(pText);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the text, the widget is only redrawn if the text changed
+* @param[in]	pText					text, cut to DISPLAY_WIDGET_TEXT_LEN characters
+* @retval		none
+*/
+/************************************************************************************************************************/
+void TextWidget::setText(const char *pText)
+{
+	if (strncmp(_acText, pText, DISPLAY_WIDGET_TEXT_LEN) == 0) return;
+
+	strncpy(_acText, pText, DISPLAY_WIDGET_TEXT_LEN);
+	_acText[DISPLAY_WIDGET_TEXT_LEN] = '\0';
+	_isDirty = true;
+}
+
+void TextWidget::draw(U8G2 &u8g2, u8g2_uint_t &x, u8g2_uint_t &y, u8g2_uint_t &w, u8g2_uint_t &h)
+{
+	u8g2.setFont(_pFont);
+
+	int8_t ascent = u8g2.getAscent();
+	int8_t descent = u8g2.getDescent();
+	u8g2_uint_t textWidth = u8g2.getStrWidth(_acText);
+
+	/** without a fixed width the box covers the old and the new text */
+	x = _x;
+	y = (_y > ascent) ? (_y - ascent) : 0;
+	h = _y - y - descent;
+	w = _width ? _width : ((textWidth > _lastWidth) ? textWidth : _lastWidth);
+	_lastWidth = textWidth;
+
+	u8g2.setDrawColor(0);
+	u8g2.drawBox(x, y, w, h);
+	u8g2.setDrawColor(1);
+	u8g2.drawStr(_x, _y, _acText);
+}
+
+NumberWidget::NumberWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, const uint8_t *pFont, const char *pFormat)
+	: TextWidget(x, y, width, pFont)
+{
+	_pFormat = pFormat;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the value, the widget is only redrawn if the formatted value changed
+* @param[in]	value					value, the format has to be an integer format
+* @retval		none
+*/
+/************************************************************************************************************************/
+void NumberWidget::setValue(int32_t value)
+{
+	char acText[DISPLAY_WIDGET_TEXT_LEN + 1];
+
+	snprintf(acText, sizeof(acText), _pFormat, value);
+	setText(acText);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the value, the widget is only redrawn if the formatted value changed
+* @param[in]	value					value, the format has to be a floating point format
+* @retval		none
+*/
+/************************************************************************************************************************/
+void NumberWidget::setValue(double value)
+{
+	char acText[DISPLAY_WIDGET_TEXT_LEN + 1];
+
+	snprintf(acText, sizeof(acText), _pFormat, value);
+	setText(acText);
+}
+
+IconWidget::IconWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, u8g2_uint_t height)
+{
+	_x = x;
+	_y = y;
+	_width = width;
+	_height = height;
+	_iconWidth = 0;
+	_iconHeight = 0;
+	_pBits = nullptr;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the icon, the widget is only redrawn if another icon is set
+* @param[in]	width					icon width, at most the width of the widget
+* @param[in]	height					icon height, at most the height of the widget
+* @param[in]	pBits					XBM bitmap in PROGMEM, nullptr to show no icon
+* @retval		none
+*/
+/************************************************************************************************************************/
+void IconWidget::setIcon(u8g2_uint_t width, u8g2_uint_t height, const uint8_t *pBits)
+{
+	if (pBits == _pBits && width == _iconWidth && height == _iconHeight) return;
+
+	_iconWidth = (width < _width) ? width : _width;
+	_iconHeight = (height < _height) ? height : _height;
+	_pBits = pBits;
+	_isDirty = true;
+}
+
+void IconWidget::draw(U8G2 &u8g2, u8g2_uint_t &x, u8g2_uint_t &y, u8g2_uint_t &w, u8g2_uint_t &h)
+{
+	x = _x;
+	y = _y;
+	w = _width;
+	h = _height;
+
+	u8g2.setDrawColor(0);
+	u8g2.drawBox(x, y, w, h);
+	u8g2.setDrawColor(1);
+	if (_pBits != nullptr) u8g2.drawXBMP(_x, _y, _iconWidth, _iconHeight, _pBits);
+}
+
+DisplayScene::DisplayScene(U8G2 &u8g2) : _u8g2(u8g2)
+{
+	_pWidgets = nullptr;
+	_isCleared = false;
+	_damagedTiles = 0;
+	memset(_aulDamage, 0, sizeof(_aulDamage));
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add a widget to the scene, widgets are drawn in the order they are added
+* @param[in]	widget					widget, has to exist as long as the scene
+* @retval		none
+*/
+/************************************************************************************************************************/
+void DisplayScene::add(DisplayWidget &widget)
+{
+	DisplayWidget **ppNext = &_pWidgets;
+
+	while (*ppNext != nullptr) ppNext = &(*ppNext)->_pNext;
+
+	widget._pNext = nullptr;
+	widget._isDirty = true;
+	*ppNext = &widget;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		clear the buffer and redraw all widgets with the next render(), e.g. after the display was cleared
+* @retval		none
+*/
+/************************************************************************************************************************/
+void DisplayScene::invalidate()
+{
+	_isCleared = false;
+
+	for (DisplayWidget *pWidget = _pWidgets; pWidget != nullptr; pWidget = pWidget->_pNext) pWidget->_isDirty = true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		draw the changed widgets into the u8g2 buffer and add their tiles to the damage mask
+* @retval		true if any tile has to be sent to the panel
+*/
+/************************************************************************************************************************/
+bool DisplayScene::render()
+{
+	u8g2_uint_t x, y, w, h;
+
+	if (!_isCleared) {
+		_u8g2.clearBuffer();
+		damageAll();
+		_isCleared = true;
+	}
+
+	for (DisplayWidget *pWidget = _pWidgets; pWidget != nullptr; pWidget = pWidget->_pNext) {
+		if (!pWidget->_isDirty) continue;
+
+		pWidget->draw(_u8g2, x, y, w, h);
+		pWidget->_isDirty = false;
+		damage(x, y, w, h);
+	}
+
+	return isDamaged();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get and clear the damage mask
+* @param[out]	pulRows					one mask per tile row, bit n set if tile n of the row has to be sent
+* @param[in]	rows					number of elements of pulRows
+* @retval		number of tile rows of the panel
+*/
+/************************************************************************************************************************/
+uint8_t DisplayScene::takeDamage(uint32_t *pulRows, uint8_t rows)
+{
+	uint8_t tileRows = _u8g2.getU8x8()->display_info->tile_height;
+
+	if (tileRows > DISPLAY_SCENE_MAX_TILE_ROWS) tileRows = DISPLAY_SCENE_MAX_TILE_ROWS;
+	if (tileRows > rows) tileRows = rows;
+
+	memcpy(pulRows, _aulDamage, tileRows * sizeof(uint32_t));
+	memset(_aulDamage, 0, sizeof(_aulDamage));
+	_damagedTiles = 0;
+
+	return tileRows;
+}
+
+void DisplayScene::damageAll()
+{
+	const u8x8_display_info_t *pInfo = _u8g2.getU8x8()->display_info;
+	uint32_t ulRowMask = (pInfo->tile_width >= 32) ? 0xFFFFFFFF : ((1UL << pInfo->tile_width) - 1);
+
+	for (uint8_t row = 0; row < pInfo->tile_height && row < DISPLAY_SCENE_MAX_TILE_ROWS; row++) _aulDamage[row] = ulRowMask;
+
+	_damagedTiles = (uint16_t)pInfo->tile_width * pInfo->tile_height;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add the tiles covered by a box in user coordinates to the damage mask
+* @retval		none
+*/
+/************************************************************************************************************************/
+void DisplayScene::damage(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+	const u8g2_cb_t *pRotation = _u8g2.getU8g2()->cb;
+	u8g2_uint_t width = _u8g2.getDisplayWidth();
+	u8g2_uint_t height = _u8g2.getDisplayHeight();
+	u8g2_uint_t x1, y1, px0, px1, py0, py1;
+
+	if (w == 0 || h == 0 || x >= width || y >= height) return;
+
+	x1 = (x + w - 1 < width) ? (x + w - 1) : (width - 1);
+	y1 = (y + h - 1 < height) ? (y + h - 1) : (height - 1);
+
+	/** same mapping as the u8g2_draw_l90_rX functions */
+	if (pRotation == U8G2_R0) {
+		px0 = x;				px1 = x1;
+		py0 = y;				py1 = y1;
+	}
+	else if (pRotation == U8G2_R1) {
+		px0 = height - 1 - y1;	px1 = height - 1 - y;
+		py0 = x;				py1 = x1;
+	}
+	else if (pRotation == U8G2_R2) {
+		px0 = width - 1 - x1;	px1 = width - 1 - x;
+		py0 = height - 1 - y1;	py1 = height - 1 - y;
+	}
+	else if (pRotation == U8G2_R3) {
+		px0 = y;				px1 = y1;
+		py0 = width - 1 - x1;	py1 = width - 1 - x;
+	}
+	else {
+		/** mirrored, the whole panel */
+		damageAll();
+		return;
+	}
+
+	for (u8g2_uint_t row = py0 / 8; row <= py1 / 8 && row < DISPLAY_SCENE_MAX_TILE_ROWS; row++) {
+		for (u8g2_uint_t col = px0 / 8; col <= px1 / 8 && col < 32; col++) {
+			if (_aulDamage[row] & (1UL << col)) continue;
+			_aulDamage[row] |= 1UL << col;
+			_damagedTiles++;
+		}
+	}
+}
@@ -0,0 +1,142 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			DisplayScene.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		retained widgets with dirty tile tracking on top of U8g2
+* @details		The u8g2 full buffer is not cleared between frames. Every widget owns a box, remembers the value it
+*				rendered last and is only redrawn (box cleared and drawn again) when the value changes. The scene maps the
+*				box of every redrawn widget through the display rotation to the 8x8 pixel tiles of the panel and collects
+*				them in a damage mask, so only these tiles have to be sent with u8x8_DrawTile().
+*
+*				Widget coordinates are u8g2 user coordinates (rotated), text widgets are positioned at their baseline
+*				like u8g2.drawStr().
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	widgets must not overlap, a redrawn widget clears its whole box
+*	-	drawing into the buffer outside of the scene has to be followed by invalidate()
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __DISPLAY_SCENE_PUBLIC_H
+#define __DISPLAY_SCENE_PUBLIC_H
+
+#include <U8g2lib.h>
+
+#define DISPLAY_SCENE_MAX_TILE_ROWS		16			//!< panel height up to 128 pixel, the width is limited to 32 tiles
+#define DISPLAY_WIDGET_TEXT_LEN			16			//!< longest text of a text or number widget
+
+class DisplayScene;
+
+class DisplayWidget
+{
+public:
+
+	DisplayWidget();
+	virtual ~DisplayWidget() {}
+
+	void invalidate() { _isDirty = true; }
+	bool isDirty() const { return _isDirty; }
+
+protected:
+	friend class DisplayScene;
+
+	/**
+	* clear the box of the widget and draw the current value
+	* @param[out]	box of the widget in user coordinates
+	*/
+	virtual void draw(U8G2 &u8g2, u8g2_uint_t &x, u8g2_uint_t &y, u8g2_uint_t &w, u8g2_uint_t &h) = 0;
+
+	bool			_isDirty;
+	DisplayWidget	*_pNext;
+};
+
+class TextWidget : public DisplayWidget
+{
+public:
+
+	TextWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, const uint8_t *pFont, const char *pText = "");
+
+	void setText(const char *pText);
+	const char *getText() const { return _acText; }
+
+protected:
+	virtual void draw(U8G2 &u8g2, u8g2_uint_t &x, u8g2_uint_t &y, u8g2_uint_t &w, u8g2_uint_t &h);
+
+	u8g2_uint_t		_x;
+	u8g2_uint_t		_y;								//!< baseline
+	u8g2_uint_t		_width;							//!< 0: width of the text
+	u8g2_uint_t		_lastWidth;						//!< width of the text drawn last
+	const uint8_t	*_pFont;
+	char			_acText[DISPLAY_WIDGET_TEXT_LEN + 1];
+};
+
+class NumberWidget : public TextWidget
+{
+public:
+
+	NumberWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, const uint8_t *pFont, const char *pFormat);
+
+	void setValue(int32_t value);
+	void setValue(double value);
+
+private:
+	const char		*_pFormat;						//!< printf format of the value, %d or %f style
+};
+
+class IconWidget : public DisplayWidget
+{
+public:
+
+	IconWidget(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t width, u8g2_uint_t height);
+
+	void setIcon(u8g2_uint_t width, u8g2_uint_t height, const uint8_t *pBits);
+
+protected:
+	virtual void draw(U8G2 &u8g2, u8g2_uint_t &x, u8g2_uint_t &y, u8g2_uint_t &w, u8g2_uint_t &h);
+
+	u8g2_uint_t		_x;
+	u8g2_uint_t		_y;
+	u8g2_uint_t		_width;							//!< box, the largest icon shown by the widget
+	u8g2_uint_t		_height;
+	u8g2_uint_t		_iconWidth;
+	u8g2_uint_t		_iconHeight;
+	const uint8_t	*_pBits;						//!< XBM in PROGMEM, nullptr for none
+};
+
+class DisplayScene
+{
+public:
+
+	DisplayScene(U8G2 &u8g2);
+
+	void add(DisplayWidget &widget);
+	void invalidate();
+	bool render();
+
+	bool isDamaged() const { return _damagedTiles != 0; }
+	uint16_t getDamagedTiles() const { return _damagedTiles; }
+	uint8_t takeDamage(uint32_t *pulRows, uint8_t rows);
+
+private:
+	void damage(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+	void damageAll();
+
+	U8G2			&_u8g2;
+	DisplayWidget	*_pWidgets;
+	bool			_isCleared;						//!< buffer has been cleared since invalidate()
+	uint32_t		_aulDamage[DISPLAY_SCENE_MAX_TILE_ROWS];	//!< bit n of row r: tile n of tile row r changed
+	uint16_t		_damagedTiles;
+};
+
+#endif
@@ -0,0 +1,458 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			ImpactCapture.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		pre/post-trigger capture of the raw IMU samples around an impact
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#if defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#elif defined(ESP_PLATFORM)
+#include "esp_log.h"
+static const char* LOG_TAG = "ImpactCapture";
+#else
+#include <stdio.h>
+static const char* LOG_TAG = "ImpactCapture";
+#define ESP_LOGE(tag, format, ...)	fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)	fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+#endif
+
+#include "ImpactCapture.h"
+
+#define RING_MASK			(IMPACT_CAPTURE_RING_SAMPLES - 1)
+#define VARINT_MAX_LEN		3			// a zigzag encoded int16 difference has up to 17 bits
+
+
+ImpactCapture::ImpactCapture()
+{
+	_state = CAPTURE_IDLE;
+	_isConfirmed = false;
+	_isGap = true;
+	_hasTrigger = false;
+	_head = 0;
+	_validFrom = 0;
+	_trigger = 0;
+	_windowStart = 0;
+	_windowSamples = 0;
+	_time = 0;
+	_odrHz = 0;
+	_preSamples = 0;
+	_postSamples = 0;
+	_accelScale = 0.0f;
+	_gyroScale = 0.0f;
+#if defined(ESP32)
+	_partition = nullptr;
+#endif
+	_slotCount = 0;
+	_writeSlot = 0;
+	_sequence = 0;
+	_pendingCount = 0;
+	_storedCount = 0;
+	_droppedCount = 0;
+}
+
+ImpactCapture::~ImpactCapture()
+{
+
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the capture window and attach the flash slots
+* @param[in]	partitionLabel			label of the data partition
+* @param[in]	odrHz					sample rate of the pushed samples
+* @param[in]	preMs					length of the window before the trigger sample
+* @param[in]	postMs					length of the window from the trigger sample on
+* @param[in]	accelScale				m/s^2 per accel count, stored with every capture
+* @param[in]	gyroScale				rad/s per gyro count, stored with every capture
+* @retval		true if the flash slots are available, else confirmed captures are dropped
+*/
+/************************************************************************************************************************/
+bool ImpactCapture::begin(const char *partitionLabel, uint16_t odrHz, uint16_t preMs, uint16_t postMs, float accelScale, float gyroScale)
+{
+	_odrHz = odrHz;
+	_accelScale = accelScale;
+	_gyroScale = gyroScale;
+	_preSamples = (uint32_t)preMs * odrHz / 1000;
+	_postSamples = (uint32_t)postMs * odrHz / 1000;
+
+	/** the trigger sample is always part of the window, the pre-trigger part is shortened first */
+	if (_postSamples == 0) _postSamples = 1;
+	if (_postSamples > IMPACT_CAPTURE_MAX_SAMPLES) _postSamples = IMPACT_CAPTURE_MAX_SAMPLES;
+	if (_preSamples + _postSamples > IMPACT_CAPTURE_MAX_SAMPLES) _preSamples = IMPACT_CAPTURE_MAX_SAMPLES - _postSamples;
+
+	_slotCount = 0;
+	_pendingCount = 0;
+
+#if defined(ESP32)
+	_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel);
+
+	if (_partition == nullptr || _partition->size < IMPACT_CAPTURE_SLOT_SIZE) {
+		ESP_LOGE(LOG_TAG, "Partition %s not usable, captures are dropped", partitionLabel);
+		return false;
+	}
+
+	_slotCount = _partition->size / IMPACT_CAPTURE_SLOT_SIZE;
+
+	mount();
+
+	ESP_LOGI(LOG_TAG, "%s: %d of %d slots not uploaded", partitionLabel, _pendingCount, _slotCount);
+
+	return true;
+#else
+	(void)partitionLabel;
+	return false;
+#endif
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add a raw sample, skipped while the ring is frozen
+* @param[in]	sample					running number of the sample
+* @param[in]	counts					ax, ay, az, gx, gy, gz in sensor counts
+* @retval		none
+*/
+/************************************************************************************************************************/
+void ImpactCapture::push(uint32_t sample, const int16_t *counts)
+{
+	if (_state == CAPTURE_FROZEN) {
+		_isGap = true;
+		return;
+	}
+
+	/** the ring content in front of a gap does not belong to the following samples */
+	if (_isGap) {
+		_validFrom = sample;
+		_isGap = false;
+	}
+
+	memcpy(_ring[sample & RING_MASK], counts, sizeof(_ring[0]));
+	_head = sample + 1;
+
+	if (_state == CAPTURE_ARMED && (int32_t)(_head - (_trigger + _postSamples)) >= 0) freeze();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		arm the capture around a trigger sample, e.g. the onset of a potential impact. The trigger of a not yet
+*				confirmed capture is moved, a confirmed capture is kept until it is stored. Every trigger sample is
+*				captured once, repeated calls with the same sample are ignored.
+* @param[in]	sample					running number of the trigger sample
+* @retval		none
+*/
+/************************************************************************************************************************/
+void ImpactCapture::trigger(uint32_t sample)
+{
+	if (_hasTrigger && sample == _trigger) return;
+	if (_state != CAPTURE_IDLE && _isConfirmed) return;
+
+	_isConfirmed = false;
+	_hasTrigger = true;
+	_trigger = sample;
+	_state = CAPTURE_ARMED;
+
+	/** late trigger, the post-trigger samples are already in the ring */
+	if ((int32_t)(_head - (_trigger + _postSamples)) >= 0) freeze();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		confirm the armed capture, it is stored by the consumer task once it is frozen
+* @param[in]	ulTime					time of the impact (epoch)
+* @retval		none
+*/
+/************************************************************************************************************************/
+void ImpactCapture::confirm(uint32_t ulTime)
+{
+	if (_state == CAPTURE_IDLE || _isConfirmed) return;
+
+	_time = ulTime;
+	_isConfirmed = true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		drop the armed capture if it is not confirmed, e.g. the potential impact stayed below the threshold
+* @retval		none
+*/
+/************************************************************************************************************************/
+void ImpactCapture::cancel()
+{
+	if (_state != CAPTURE_IDLE && !_isConfirmed) _state = CAPTURE_IDLE;
+}
+
+void ImpactCapture::freeze()
+{
+	uint32_t end = _trigger + _postSamples;
+	uint32_t start = _trigger - _preSamples;
+
+	/** clip the pre-trigger part to the samples in the ring */
+	if ((int32_t)(_validFrom - start) > 0) start = _validFrom;
+	if ((int32_t)(_head - IMPACT_CAPTURE_RING_SAMPLES - start) > 0) start = _head - IMPACT_CAPTURE_RING_SAMPLES;
+
+	if ((int32_t)(_trigger - start) < 0) {
+		/** the trigger sample is gone */
+		_state = CAPTURE_IDLE;
+		return;
+	}
+
+	_windowStart = start;
+	_windowSamples = (uint16_t)(end - start);
+	_state = CAPTURE_FROZEN;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		store a frozen and confirmed capture and hand the ring back to the sampling task
+* @retval		true if a capture has been stored
+*/
+/************************************************************************************************************************/
+bool ImpactCapture::process()
+{
+	if (_state != CAPTURE_FROZEN || !_isConfirmed) return false;
+
+	bool isStored = store();
+
+	if (!isStored) _droppedCount++;
+
+	_state = CAPTURE_IDLE;
+
+	return isStored;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the oldest capture which has not been uploaded
+* @param[out]	pHeader					header of the capture
+* @retval		slot of the capture, -1 if there is none
+*/
+/************************************************************************************************************************/
+int16_t ImpactCapture::findPending(IMPACT_CAPTURE_HEADER_T *pHeader)
+{
+	IMPACT_CAPTURE_HEADER_T tHeader;
+	int16_t pending = -1;
+
+	if (_pendingCount == 0) return -1;
+
+	for (uint16_t slot = 0; slot < _slotCount; slot++) {
+		if (!flashRead(slotAddress(slot), &tHeader, sizeof(tHeader))) continue;
+		if (tHeader.ulMagic != IMPACT_CAPTURE_MAGIC || tHeader.bState != IMPACT_CAPTURE_STORED) continue;
+
+		if (pending < 0 || (int32_t)(tHeader.ulSequence - pHeader->ulSequence) < 0) {
+			memcpy(pHeader, &tHeader, sizeof(tHeader));
+			pending = slot;
+		}
+	}
+
+	if (pending < 0) _pendingCount = 0;
+
+	return pending;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		read a part of a stored capture, offset 0 is the start of the header
+* @param[in]	slot					slot of the capture
+* @param[in]	offset					offset within the slot
+* @param[out]	pData					pointer to the data
+* @param[in]	len						number of bytes
+* @retval		number of bytes read
+*/
+/************************************************************************************************************************/
+size_t ImpactCapture::read(uint16_t slot, uint32_t offset, void *pData, size_t len)
+{
+	if (slot >= _slotCount || offset >= IMPACT_CAPTURE_SLOT_SIZE) return 0;
+	if (offset + len > IMPACT_CAPTURE_SLOT_SIZE) len = IMPACT_CAPTURE_SLOT_SIZE - offset;
+
+	return flashRead(slotAddress(slot) + offset, pData, len) ? len : 0;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		mark a capture as uploaded, it is kept until its slot is reused
+* @param[in]	slot					slot of the capture
+* @retval		true if the state has been written
+*/
+/************************************************************************************************************************/
+bool ImpactCapture::markUploaded(uint16_t slot)
+{
+	uint8_t bState = IMPACT_CAPTURE_UPLOADED;
+
+	if (slot >= _slotCount) return false;
+
+	/** clearing the state byte needs no erase */
+	if (!flashWrite(slotAddress(slot) + offsetof(IMPACT_CAPTURE_HEADER_T, bState), &bState, sizeof(bState))) return false;
+
+	if (_pendingCount) _pendingCount--;
+
+	return true;
+}
+
+bool ImpactCapture::store()
+{
+	IMPACT_CAPTURE_HEADER_T tHeader;
+	uint8_t abPage[IMPACT_CAPTURE_PAGE_SIZE];
+	int16_t asLast[IMPACT_CAPTURE_CHANNELS] = { 0 };
+	size_t pageLen = 0;
+	uint32_t length = 0;
+	uint32_t address = slotAddress(_writeSlot) + sizeof(tHeader);
+	uint16_t crc = 0xFFFF;
+
+	if (_slotCount == 0) return false;
+
+	/** the oldest slot is reused, a capture in it which has not been uploaded is lost */
+	if (flashRead(slotAddress(_writeSlot), &tHeader, sizeof(tHeader)) && tHeader.ulMagic == IMPACT_CAPTURE_MAGIC && tHeader.bState == IMPACT_CAPTURE_STORED) {
+		ESP_LOGE(LOG_TAG, "Capture %u overwritten before the upload", tHeader.ulSequence);
+		_droppedCount++;
+		if (_pendingCount) _pendingCount--;
+	}
+
+	if (!flashErase(slotAddress(_writeSlot), IMPACT_CAPTURE_SLOT_SIZE)) return false;
+
+	for (uint16_t i = 0; i < _windowSamples; i++) {
+		const int16_t *pSample = _ring[(_windowStart + i) & RING_MASK];
+
+		for (uint8_t ch = 0; ch < IMPACT_CAPTURE_CHANNELS; ch++) {
+			pageLen += writeVarint(&abPage[pageLen], zigzag((int32_t)pSample[ch] - asLast[ch]));
+			asLast[ch] = pSample[ch];
+		}
+
+		/** write the page before the next sample could overflow it */
+		if (pageLen > sizeof(abPage) - IMPACT_CAPTURE_CHANNELS * VARINT_MAX_LEN || i == _windowSamples - 1) {
+			if (!flashWrite(address + length, abPage, pageLen)) return false;
+			crc = crc16(crc, abPage, pageLen);
+			length += pageLen;
+			pageLen = 0;
+		}
+	}
+
+	/** the header is written last, a torn capture has no valid header */
+	tHeader.ulMagic = IMPACT_CAPTURE_MAGIC;
+	tHeader.bState = IMPACT_CAPTURE_STORED;
+	tHeader.bChannels = IMPACT_CAPTURE_CHANNELS;
+	tHeader.usOdrHz = _odrHz;
+	tHeader.ulSequence = _sequence;
+	tHeader.ulTime = _time;
+	tHeader.usPreSamples = (uint16_t)(_trigger - _windowStart);
+	tHeader.usPostSamples = (uint16_t)(_windowSamples - tHeader.usPreSamples);
+	tHeader.usLength = (uint16_t)length;
+	tHeader.usCrc = crc;
+	tHeader.fAccelScale = _accelScale;
+	tHeader.fGyroScale = _gyroScale;
+
+	if (!flashWrite(slotAddress(_writeSlot), &tHeader, sizeof(tHeader))) return false;
+
+	ESP_LOGI(LOG_TAG, "Capture %u stored in slot %d: %d samples, %u bytes", _sequence, _writeSlot, _windowSamples, length);
+
+	_sequence++;
+	_writeSlot = (_writeSlot + 1) % _slotCount;
+	_pendingCount++;
+	_storedCount++;
+
+	return true;
+}
+
+void ImpactCapture::mount()
+{
+	IMPACT_CAPTURE_HEADER_T tHeader;
+	bool isFound = false;
+
+	_sequence = 0;
+	_writeSlot = 0;
+	_pendingCount = 0;
+
+	/** the slot after the highest sequence number is the oldest one */
+	for (uint16_t slot = 0; slot < _slotCount; slot++) {
+		if (!flashRead(slotAddress(slot), &tHeader, sizeof(tHeader))) continue;
+		if (tHeader.ulMagic != IMPACT_CAPTURE_MAGIC) continue;
+
+		if (tHeader.bState == IMPACT_CAPTURE_STORED) _pendingCount++;
+
+		if (!isFound || (int32_t)(tHeader.ulSequence - _sequence) >= 0) {
+			_sequence = tHeader.ulSequence;
+			_writeSlot = slot;
+			isFound = true;
+		}
+	}
+
+	if (isFound) {
+		_sequence++;
+		_writeSlot = (_writeSlot + 1) % _slotCount;
+	}
+}
+
+bool ImpactCapture::flashRead(uint32_t address, void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_read(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool ImpactCapture::flashWrite(uint32_t address, const void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_write(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool ImpactCapture::flashErase(uint32_t address, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_erase_range(_partition, address, len) == ESP_OK;
+#else
+	(void)address;
+	(void)len;
+	return false;
+#endif
+}
+
+size_t ImpactCapture::writeVarint(uint8_t *p, uint32_t value)
+{
+	size_t len = 0;
+
+	while (value >= 0x80) {
+		p[len++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	p[len++] = (uint8_t)value;
+
+	return len;
+}
+
+uint16_t ImpactCapture::crc16(uint16_t crc, const uint8_t *pData, size_t len)
+{
+	while (len--) {
+		crc ^= (uint16_t)(*pData++) << 8;
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+
+	return crc;
+}
@@ -17,6 +17,8 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
   Update: This library has been updated for L76 GPS use case.
+  Update: reads only as many bytes as the module has (idle filler), NMEA output and
+  fix rate configuration, I2C bus time statistics, bulk read of the buffered bytes.
 
 */
 #ifndef _L76_h
@@ -39,6 +41,10 @@
 #define I2C_SPEED_STANDARD        100000
 #define I2C_SPEED_FAST            400000
 
+#define L76_READ_CHUNK            32 //Bytes per I2C read, an idle poll costs one chunk
+#define L76_MAX_CHUNKS            (MAX_PACKET_SIZE / L76_READ_CHUNK) //Upper limit of chunks per check()
+#define L76_IDLE_FILLER           0x0A //Sent by the module once its buffer is empty
+
 class I2CGPS {
 public:
 
@@ -48,6 +54,7 @@ public:
 	void check(); //Checks module for new data
 	uint8_t available(); //Returns available number of bytes. Will call check() if zero is available.
 	uint8_t read(); //Returns the next available byte
+	uint8_t read(char *buffer, uint8_t len); //Copies up to len available bytes, returns the number copied
 
 	void enableDebugging(Stream &debugPort = Serial); //Output various extra messages to help with debug
 	void disableDebugging();
@@ -56,6 +63,13 @@ public:
 	String createMTKpacket(uint16_t packetType, String dataField);
 	String calcCRCforMTK(String sentence); //XORs all bytes between $ and *
 
+	boolean setNmeaOutput(uint8_t rmcRate, uint8_t ggaRate); //Output RMC/GGA every n-th fix, all other sentences off
+	boolean setFixInterval(uint16_t intervalMs); //Position fix interval, 100..10000ms
+
+	uint32_t getBusTimeUs() { return _busTimeUs; } //Time spent in I2C reads since begin()
+	uint32_t getBytesRead() { return _bytesRead; } //Bytes read from the module since begin(), filler included
+	uint32_t getReadCount() { return _readCount; } //I2C reads since begin()
+
 	boolean sendPGCMDpacket(String command);
 	String createPGCMDpacket(uint16_t packetType, String dataField);
 	// Uses MTK CRC
@@ -64,6 +78,8 @@ public:
 	uint8_t gpsData[MAX_PACKET_SIZE]; //The place to store valid incoming gps data
 
 private:
+	uint8_t count(); //Bytes in the gpsData array, without polling the module
+
 	//Variables
 	TwoWire *_i2cPort; //The generic connection to user's chosen I2C hardware
 	uint8_t _i2caddr;
@@ -74,6 +90,11 @@ private:
 
 	uint8_t _head; //Location of next available spot in the gpsData array. Limited to 255.
 	uint8_t _tail; //Location of last spot read from gpsData array. Limited to 255.
+	uint8_t _lastByte; //Last byte received, a line feed after a carriage return ends a sentence
+
+	uint32_t _busTimeUs;
+	uint32_t _bytesRead;
+	uint32_t _readCount;
 };
 
 #endif
@@ -0,0 +1,100 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @file			lora_decode.cpp
+* @brief		host reference decoder of the lora uplinks for the backend
+* @details		Reads one uplink per line from stdin, "<fcnt> <port> <payload hex>", and prints one CSV line per
+*				decoded packet. Delta frames are only decoded if their key frame has been received.
+*
+*	Build:	g++ -std=c++11 -O2 -I../src lora_decode.cpp ../src/LoraPacketCodec.cpp -o lora_decode
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "LoraPacketCodec.h"
+
+#define PORT_BACKLOG		3			// sample time (epoch, big endian) + raw packet
+
+static uint32_t be(const uint8_t *p, uint8_t size)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < size; i++) value = (value << 8) | p[i];
+	return value;
+}
+
+static float beFloat(const uint8_t *p)
+{
+	uint32_t raw = be(p, 4);
+	float value;
+	memcpy(&value, &raw, sizeof(value));
+	return value;
+}
+
+static void printPacket(unsigned long fcnt, int port, uint32_t sampleTime, const uint8_t *p)
+{
+	printf("%lu,%d,%u,%.6f,%.6f,%.1f,%u,%u,%u,%u,%u,%u,%u,%u\n", fcnt, port, sampleTime,
+		beFloat(&p[0]), beFloat(&p[4]), beFloat(&p[8]), be(&p[12], 2), be(&p[14], 2), p[16], be(&p[17], 2),
+		be(&p[19], 4), p[23], p[24], be(&p[25], 4));
+}
+
+int main()
+{
+	char line[512];
+	uint8_t abKey[LORA_CODEC_PACKET_LEN];
+	uint8_t abPacket[LORA_CODEC_PACKET_LEN];
+	uint8_t abFrame[128];
+	unsigned long keyFcnt = 0;
+	bool isKeyValid = false;
+
+	printf("fcnt,port,time,lat,lon,alt,bms_mv,ctrl_mv,speed,distance,session,bpm,mpu_flags,crash_time\n");
+
+	while (fgets(line, sizeof(line), stdin)) {
+		unsigned long fcnt;
+		int port, offset;
+		char hex[300];
+		size_t len = 0;
+
+		if (sscanf(line, "%lu %d %299s%n", &fcnt, &port, hex, &offset) != 3) continue;
+
+		for (const char *p = hex; p[0] && p[1] && len < sizeof(abFrame); p += 2) {
+			char byte[3] = { p[0], p[1], 0 };
+			abFrame[len++] = (uint8_t)strtoul(byte, nullptr, 16);
+		}
+
+		if (port == LORA_CODEC_PORT_KEY && len == LORA_CODEC_PACKET_LEN) {
+			memcpy(abKey, abFrame, LORA_CODEC_PACKET_LEN);
+			keyFcnt = fcnt;
+			isKeyValid = true;
+			printPacket(fcnt, port, 0, abKey);
+		}
+		else if (port == LORA_CODEC_PORT_DELTA) {
+			uint8_t bKeyOffset;
+
+			if (!isKeyValid || !LoraPacketCodec::decodeDelta(abKey, abFrame, len, abPacket, &bKeyOffset)) {
+				fprintf(stderr, "fcnt %lu: invalid delta frame\n", fcnt);
+			}
+			else if (fcnt - bKeyOffset != keyFcnt) {
+				fprintf(stderr, "fcnt %lu: key frame %lu missing\n", fcnt, fcnt - bKeyOffset);
+			}
+			else {
+				printPacket(fcnt, port, 0, abPacket);
+			}
+		}
+		else if (port == LORA_CODEC_PORT_BATCH) {
+			if (!LoraPacketBatch::decode(abFrame, len, [&](uint32_t ulTime, const uint8_t *pPacket) { printPacket(fcnt, port, ulTime, pPacket); })) {
+				fprintf(stderr, "fcnt %lu: invalid batch frame\n", fcnt);
+			}
+		}
+		else if (port == PORT_BACKLOG && len == 4 + LORA_CODEC_PACKET_LEN) {
+			printPacket(fcnt, port, be(abFrame, 4), &abFrame[4]);
+		}
+		else {
+			fprintf(stderr, "fcnt %lu: unknown frame on port %d\n", fcnt, port);
+		}
+	}
+
+	return 0;
+}
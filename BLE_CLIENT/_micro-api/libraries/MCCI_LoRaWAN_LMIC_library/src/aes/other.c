@@ -25,6 +25,12 @@
  *
  *  That takes a single 16-byte buffer and encrypts it wit the given
  *  16-byte key.
+ *
+ *  This is the interface of all AES backends except the original one,
+ *  selected in config.h: USE_IDEETRON_AES (aes/ideetron, small tables)
+ *  or USE_TTABLE_AES (aes/ttable, 32-bit tables and cached key
+ *  schedules). A backend is called with the same few keys over and
+ *  over, so it may cache whatever it derives from a key.
  */
 
 #include "../lmic/oslmic.h"
@@ -50,16 +56,55 @@ static void shift_left(xref2u1_t buf, u1_t len) {
     }
 }
 
+// CMAC subkeys K1 and K2 of the last key used for a MIC. Deriving them
+// costs a full block encryption, the key only changes with the session.
+static u1_t cmac_key[16];
+static u1_t cmac_k1[16];
+static u1_t cmac_k2[16];
+static u1_t cmac_valid;
+
+// Derive a CMAC subkey (RFC4493 doubling in GF(2^128))
+static void cmac_double(xref2u1_t dst, const u1_t *src) {
+    u1_t msb = src[0] & 0x80;
+    memcpy(dst, src, 16);
+    shift_left(dst, 16);
+    if (msb)
+        dst[15] ^= 0x87;
+}
+
+static void cmac_subkeys(void) {
+    if (cmac_valid && memcmp(cmac_key, AESkey, 16) == 0)
+        return;
+
+    u1_t l[16];
+    memset(l, 0, sizeof(l));
+    lmic_aes_encrypt(l, AESkey);
+    cmac_double(cmac_k1, l);
+    cmac_double(cmac_k2, cmac_k1);
+    memcpy(cmac_key, AESkey, 16);
+    cmac_valid = 1;
+}
+
 // Apply RFC4493 CMAC, using AESKEY as the key. If prepend_aux is true,
 // AESAUX is prepended to the message. AESAUX is used as working memory
 // in any case. The CMAC result is returned in AESAUX as well.
 static void os_aes_cmac(xref2u1_t buf, u2_t len, u1_t prepend_aux) {
-    if (prepend_aux)
+    if (prepend_aux) {
+        if (len == 0) {
+            // AESAUX alone is the complete final block
+            cmac_subkeys();
+            for (u1_t i = 0; i < 16; ++i)
+                AESaux[i] ^= cmac_k1[i];
+            lmic_aes_encrypt(AESaux, AESkey);
+            return;
+        }
         lmic_aes_encrypt(AESaux, AESkey);
+    }
     else
         memset (AESaux, 0, 16);
 
-    while (len > 0) {
+    // an empty message is a single padded block
+    do {
         u1_t need_padding = 0;
         for (u1_t i = 0; i < 16; ++i, ++buf, --len) {
             if (len == 0) {
@@ -74,34 +119,16 @@ static void os_aes_cmac(xref2u1_t buf, u2_t len, u1_t prepend_aux) {
         }
 
         if (len == 0) {
-            // Final block, xor with K1 or K2. K1 and K2 are calculated
-            // by encrypting the all-zeroes block and then applying some
-            // shifts and xor on that.
-            u1_t final_key[16];
-            memset(final_key, 0, sizeof(final_key));
-            lmic_aes_encrypt(final_key, AESkey);
-
-            // Calculate K1
-            u1_t msb = final_key[0] & 0x80;
-            shift_left(final_key, sizeof(final_key));
-            if (msb)
-                final_key[sizeof(final_key)-1] ^= 0x87;
-
-            // If the final block was not complete, calculate K2 from K1
-            if (need_padding) {
-                msb = final_key[0] & 0x80;
-                shift_left(final_key, sizeof(final_key));
-                if (msb)
-                    final_key[sizeof(final_key)-1] ^= 0x87;
-            }
-
-            // Xor with K1 or K2
-            for (u1_t i = 0; i < sizeof(final_key); ++i)
+            // Final block, xor with K1, or K2 if the final block was not
+            // complete
+            cmac_subkeys();
+            const u1_t *final_key = need_padding ? cmac_k2 : cmac_k1;
+            for (u1_t i = 0; i < 16; ++i)
                 AESaux[i] ^= final_key[i];
         }
 
         lmic_aes_encrypt(AESaux, AESkey);
-    }
+    } while (len > 0);
 }
 
 // Run AES-CTR using the key in AESKEY and using AESAUX as the
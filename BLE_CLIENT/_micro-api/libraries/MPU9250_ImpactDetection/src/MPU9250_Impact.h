@@ -11,8 +11,20 @@
 #define GyroVector std::array<float,3>
 #define LastImpact std::array<float,3>
 
+#define IMPACT_FIFO_SIZE			512		// FIFO size of the MPU9250 in bytes
+#define IMPACT_FIFO_FRAME_SIZE		12		// accel + gyro, 6 bytes each
+#define IMPACT_FIFO_BURST_FRAMES	10		// frames per I2C read, limited by the 128 byte Wire buffer
+#define IMPACT_INT_STATUS			0x3A	// interrupt status register, cleared by reading it
+#define IMPACT_INT_LATCH_EN			0x20	// INT_PIN_CFG: hold the interrupt level until INT_STATUS is read
 
-class ImpactDetector : public MPU9250
+// called for every FIFO sample with its running number and ax, ay, az, gx, gy, gz in sensor counts
+typedef void (*ImpactSampleHandler)(uint32_t sample, const int16_t* counts);
+
+// called for every burst read from the FIFO with the raw frames as read from the sensor
+typedef void (*ImpactFifoHandler)(const uint8_t* frames, size_t len);
+
+
+class ImpactDetector : public MPU9250FIFO
 {
 	// public methods
 public:
@@ -20,7 +32,19 @@ public:
 	ImpactDetector(int pollRate, int duration, float lowGThreshold, float highGThreshold, float extremeGThreshold);
 	ImpactDetector(int pollRate, int duration, float lowGThreshold, float highGThreshold, float extremeGThreshold, uint8_t address, uint8_t sda, uint8_t scl);
 
+	int enableSampling(uint8_t intPin, uint16_t odrHz, uint8_t batchSamples);
+	void setNotifyTask(TaskHandle_t task);
+	void setSampleHandler(ImpactSampleHandler handler);
+	void setFifoHandler(ImpactFifoHandler handler);
+	int enableMotionWake(float womThresh_mg, LpAccelOdr odr);
 	bool detector();
+	bool isImpactPending(void);
+	uint32_t getImpactOnsetSample(void);
+	float getAccelScale(void);
+	float getGyroScale(void);
+	uint16_t getSampleRate(void);
+	uint32_t getSampleCount(void);
+	uint32_t getFifoOverflowCount(void);
 	std::array<float, 3> getCurrentValues();
 	std::array<float, 3> getLastValues();
 	std::array<float, 3> getLastImpact();
@@ -40,10 +64,28 @@ private:
 	float calcAbsAccel(AccelVector);
 	float calcAbsGyro(GyroVector);
 	float calcAbsGravityForce(float);
+	int resetFifo();
+	bool detectSample(const int16_t* counts);
+	static void dataReadyIsr();
 
 	// private member attrib
 private:
-	int _tick;
+	static ImpactDetector* _isrInstance;
+	TaskHandle_t _notifyTask = NULL;
+	ImpactSampleHandler _sampleHandler = NULL;
+	ImpactFifoHandler _fifoHandler = NULL;
+	int8_t _intPin = -1;
+	volatile uint8_t _pendingSamples = 0;
+	uint8_t _batchSamples = 1;
+	uint16_t _odrHz = 0;
+	uint32_t _samplePeriodUs = 0;
+	uint32_t _sampleTimeUs = 0;
+	uint32_t _sampleCount = 0;
+	uint32_t _impactOnsetSample = 0;
+	uint32_t _fifoOverflowCount = 0;
+	uint8_t _fifoBurst[IMPACT_FIFO_BURST_FRAMES * IMPACT_FIFO_FRAME_SIZE];
+
+	uint32_t _tick;
 	float _impactAccel;
 	bool _potImpact;
 	int _pollRate;
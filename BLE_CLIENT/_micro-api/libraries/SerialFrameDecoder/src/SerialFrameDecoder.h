@@ -0,0 +1,271 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SerialFrameDecoder.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		header-only decoder for header/suffix delimited serial frames
+* @details		The decoder is configured at compile time by a traits struct:
+*
+*	Member					| Description
+*	------------------------|---------------------------------------------------------------------------------
+*	header, suffix			| first and last byte of a frame
+*	preambleLength			| number of bytes between header and length field / payload
+*	hasLengthField			| true if a one byte payload length follows the preamble
+*	payloadLength			| fixed payload length, or the maximum payload length if hasLengthField is true
+*	Checksum				| checksum policy over length field and payload (NoChecksum, TwosComplementSum16)
+*	isPreambleValid()		| verify the preamble, e.g. the status byte of a response
+*
+*	The decoded frame is written in wire order straight into the frame struct given to the constructor, so
+*	a packed packet struct with the same layout can be used without any further copy.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __SERIAL_FRAME_DECODER_PUBLIC_H
+#define __SERIAL_FRAME_DECODER_PUBLIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+
+typedef enum SERIAL_FRAME_RESULT_Etag {
+	FRAME_OK,								//!< complete and valid frame
+	FRAME_IDLE,								//!< waiting for the header
+	FRAME_PENDING,							//!< frame in progress
+	FRAME_ERR_PREAMBLE,						//!< preamble rejected by the traits
+	FRAME_ERR_LENGTH,						//!< payload length does not fit into the frame
+	FRAME_ERR_CHECKSUM,						//!< checksum mismatch
+	FRAME_ERR_SUFFIX,						//!< suffix mismatch
+} SERIAL_FRAME_RESULT_E;
+
+/** non-owning view on received bytes, no copy of the data is made */
+struct ByteSpan {
+	const uint8_t	*data;
+	size_t			len;
+
+	ByteSpan(const uint8_t *pData, size_t length) : data(pData), len(length) {}
+	ByteSpan(const std::string &str) : data((const uint8_t*)str.data()), len(str.length()) {}
+};
+
+/** checksum policy for frames without checksum */
+struct NoChecksum {
+	static const uint8_t size = 0;
+
+	void reset() {}
+	void add(uint8_t) {}
+	uint8_t expected(uint8_t) const { return 0; }
+};
+
+/** 16 bit two's complement of the byte sum, transmitted MSB first */
+struct TwosComplementSum16 {
+	static const uint8_t size = 2;
+
+	uint16_t sum;
+
+	void reset() { sum = 0; }
+	void add(uint8_t data) { sum += data; }
+	uint8_t expected(uint8_t idx) const {
+		uint16_t checkSum = ~sum + 1;
+		return (idx == 0) ? (uint8_t)(checkSum >> 8) : (uint8_t)checkSum;
+	}
+};
+
+template <class Traits, class FrameT>
+class SerialFrameDecoder
+{
+public:
+	static const uint8_t payloadOffset = 1 + Traits::preambleLength + (Traits::hasLengthField ? 1 : 0);
+	static const uint8_t maxFrameLength = payloadOffset + Traits::payloadLength + Traits::Checksum::size + 1;
+
+	static_assert(sizeof(FrameT) >= maxFrameLength, "frame struct is smaller than the largest frame");
+
+	SerialFrameDecoder(FrameT *pFrame) : _abFrame((uint8_t*)pFrame), _frameCount(0), _errorCount(0) { reset(); }
+
+	void reset() {
+		_state = STATE_HEADER;
+		_index = 0;
+		_payloadLength = 0;
+		_checksum.reset();
+	}
+
+	/** true while no frame is in progress */
+	bool isIdle() const { return _state == STATE_HEADER; }
+
+	/** advance the decoder by one byte */
+	SERIAL_FRAME_RESULT_E parseByte(uint8_t data) {
+
+		SERIAL_FRAME_RESULT_E eRet = FRAME_PENDING;
+
+		switch (_state) {
+		case STATE_HEADER: {
+			if (data != Traits::header) return FRAME_IDLE;
+			_abFrame[0] = data;
+			_index = 1;
+			_checksum.reset();
+			_payloadLength = Traits::payloadLength;
+			_state = (Traits::preambleLength > 0) ? STATE_PREAMBLE : nextAfterPreamble();
+			return eRet;
+		}
+		case STATE_PREAMBLE: {
+			_abFrame[_index++] = data;
+			if (_index < 1 + Traits::preambleLength) return eRet;
+			if (!Traits::isPreambleValid(&_abFrame[1])) {
+				eRet = FRAME_ERR_PREAMBLE;
+				break;
+			}
+			_state = nextAfterPreamble();
+			return eRet;
+		}
+		case STATE_LENGTH: {
+			_abFrame[_index++] = data;
+			_checksum.add(data);
+			if (data > Traits::payloadLength) {
+				eRet = FRAME_ERR_LENGTH;
+				break;
+			}
+			_payloadLength = data;
+			_state = (data > 0) ? STATE_PAYLOAD : nextAfterPayload();
+			return eRet;
+		}
+		case STATE_PAYLOAD: {
+			_abFrame[_index++] = data;
+			_checksum.add(data);
+			if (_index == payloadOffset + _payloadLength) _state = nextAfterPayload();
+			return eRet;
+		}
+		case STATE_CHECKSUM: {
+			uint8_t idx = _index - payloadOffset - _payloadLength;
+			_abFrame[_index++] = data;
+			if (data != _checksum.expected(idx)) {
+				eRet = FRAME_ERR_CHECKSUM;
+				break;
+			}
+			if (idx + 1 == Traits::Checksum::size) _state = STATE_SUFFIX;
+			return eRet;
+		}
+		case STATE_SUFFIX: {
+			_abFrame[_index] = data;
+			_state = STATE_HEADER;
+			if (data == Traits::suffix) {
+				_frameCount++;
+				return FRAME_OK;
+			}
+			eRet = FRAME_ERR_SUFFIX;
+			break;
+		}
+		}
+
+		// drop the frame and resync, the offending byte may already be the next header
+		_errorCount++;
+		_state = STATE_HEADER;
+		if (data == Traits::header) parseByte(data);
+
+		return eRet;
+	}
+
+	/**
+	* decode all bytes of the span and call onFrame(const FrameT &) for every complete frame, the payload of a
+	* frame is taken over in one block per call instead of byte by byte
+	* @retval	number of complete frames
+	*/
+	template <class Handler>
+	size_t feed(ByteSpan input, Handler onFrame) {
+
+		size_t frames = 0;
+		const uint8_t *p = input.data;
+		const uint8_t *end = input.data + input.len;
+
+		while (p < end) {
+			if (_state == STATE_PAYLOAD) {
+				size_t count = payloadOffset + _payloadLength - _index;
+				if (count > (size_t)(end - p)) count = end - p;
+
+				memcpy(&_abFrame[_index], p, count);
+				for (size_t i = 0; i < count; i++) _checksum.add(p[i]);
+
+				_index += count;
+				p += count;
+
+				if (_index == payloadOffset + _payloadLength) _state = nextAfterPayload();
+				continue;
+			}
+
+			if (parseByte(*p++) == FRAME_OK) {
+				frames++;
+				onFrame(*(const FrameT*)_abFrame);
+			}
+		}
+
+		return frames;
+	}
+
+	/**
+	* check if the buffer holds exactly one complete and valid frame, so it can be used in place without being
+	* copied through the decoder
+	* @retval	true if the buffer is one valid frame
+	*/
+	static bool isCompleteFrame(const uint8_t *pData, size_t len) {
+
+		typename Traits::Checksum checksum;
+		uint8_t payloadLen = Traits::payloadLength;
+
+		if (len < payloadOffset + Traits::Checksum::size + 1 || len > maxFrameLength) return false;
+		if (pData[0] != Traits::header || pData[len - 1] != Traits::suffix) return false;
+		if (Traits::preambleLength > 0 && !Traits::isPreambleValid(&pData[1])) return false;
+
+		checksum.reset();
+		if (Traits::hasLengthField) {
+			payloadLen = pData[payloadOffset - 1];
+			checksum.add(payloadLen);
+		}
+
+		if (len != (size_t)(payloadOffset + payloadLen + Traits::Checksum::size + 1)) return false;
+
+		for (uint8_t i = 0; i < payloadLen; i++) checksum.add(pData[payloadOffset + i]);
+		for (uint8_t i = 0; i < Traits::Checksum::size; i++) {
+			if (pData[payloadOffset + payloadLen + i] != checksum.expected(i)) return false;
+		}
+
+		return true;
+	}
+
+	const FrameT &frame() const { return *(const FrameT*)_abFrame; }
+
+	uint32_t getFrameCount() const { return _frameCount; }
+	uint32_t getErrorCount() const { return _errorCount; }
+
+private:
+	typedef enum STATE_Etag {
+		STATE_HEADER,
+		STATE_PREAMBLE,
+		STATE_LENGTH,
+		STATE_PAYLOAD,
+		STATE_CHECKSUM,
+		STATE_SUFFIX,
+	} STATE_E;
+
+	static STATE_E nextAfterPreamble() { return Traits::hasLengthField ? STATE_LENGTH : STATE_PAYLOAD; }
+	static STATE_E nextAfterPayload() { return (Traits::Checksum::size > 0) ? STATE_CHECKSUM : STATE_SUFFIX; }
+
+	uint8_t						*_abFrame;
+	STATE_E						_state;
+	uint8_t						_index;
+	uint8_t						_payloadLength;
+	typename Traits::Checksum	_checksum;
+	uint32_t					_frameCount;
+	uint32_t					_errorCount;
+};
+
+#endif
@@ -0,0 +1,307 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			frame_decoder_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of SerialFrameDecoder and of its BMS and controller instantiations
+* @details		Covers the result of every state of the decoder, the resync after an error, the block copy of feed()
+*				against parseByte(), isCompleteFrame() and the readSerialPacket() overloads of both handlers, which
+*				have to give the same result for the same bytes.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string>
+#include <vector>
+#include <BMSPacketHandler.h>
+#include <ControllerPacketHandler.h>
+#include "HostTest.h"
+
+#define FEED_FRAMES			20000
+
+/** BMS response of len payload bytes seed, seed + 1, ... */
+static std::vector<uint8_t> bmsFrame(uint8_t len, uint8_t seed, uint8_t status = 0x00)
+{
+	std::vector<uint8_t> frame = { 0xDD, BMSRegister::BMS_REG_INFO_STATUS, status, len };
+	uint16_t sum = len;
+
+	for (uint8_t i = 0; i < len; i++) {
+		frame.push_back((uint8_t)(seed + i));
+		sum += (uint8_t)(seed + i);
+	}
+	sum = ~sum + 1;
+	frame.push_back((uint8_t)(sum >> 8));
+	frame.push_back((uint8_t)sum);
+	frame.push_back(0x77);
+
+	return frame;
+}
+
+/** controller frame, 10 payload bytes seed, seed + 1, ... */
+static std::vector<uint8_t> controllerFrame(uint8_t seed)
+{
+	std::vector<uint8_t> frame = { 0xAA };
+
+	for (uint8_t i = 0; i < ControllerFrameTraits::payloadLength; i++) frame.push_back((uint8_t)(seed + i));
+	frame.push_back(0x85);
+
+	return frame;
+}
+
+template <class Decoder>
+static SERIAL_FRAME_RESULT_E parseAll(Decoder &decoder, const std::vector<uint8_t> &bytes)
+{
+	SERIAL_FRAME_RESULT_E eResult = FRAME_IDLE;
+
+	for (size_t i = 0; i < bytes.size(); i++) eResult = decoder.parseByte(bytes[i]);
+
+	return eResult;
+}
+
+static void testBmsStates()
+{
+	BMS_PACKET_STRUCT_T tPacket;
+	BMSFrameDecoder decoder(&tPacket);
+	std::vector<uint8_t> frame = bmsFrame(27, 0x30);
+
+	/** noise before the header */
+	CHECK_EQ(decoder.parseByte(0x00), FRAME_IDLE);
+	CHECK_EQ(decoder.parseByte(0x77), FRAME_IDLE);
+	CHECK(decoder.isIdle());
+
+	for (size_t i = 0; i + 1 < frame.size(); i++) CHECK_EQ(decoder.parseByte(frame[i]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame.back()), FRAME_OK);
+	CHECK(decoder.isIdle());
+
+	/** wire order straight in the packet struct */
+	CHECK(memcmp(&tPacket, frame.data(), frame.size()) == 0);
+	CHECK_EQ(tPacket.bLength, 27);
+	CHECK_EQ(tPacket.abData[0], 0x30);
+
+	/** empty payload */
+	CHECK_EQ(parseAll(decoder, bmsFrame(0, 0)), FRAME_OK);
+
+	/** largest payload */
+	CHECK_EQ(parseAll(decoder, bmsFrame(BMSFrameTraits::payloadLength, 0x01)), FRAME_OK);
+	CHECK_EQ(decoder.getFrameCount(), 3);
+	CHECK_EQ(decoder.getErrorCount(), 0);
+}
+
+static void testBmsErrors()
+{
+	BMS_PACKET_STRUCT_T tPacket;
+	BMSFrameDecoder decoder(&tPacket);
+	std::vector<uint8_t> frame;
+
+	/** status byte of an error response */
+	frame = bmsFrame(27, 0, 0x80);
+	CHECK_EQ(decoder.parseByte(frame[0]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame[1]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame[2]), FRAME_ERR_PREAMBLE);
+	CHECK(decoder.isIdle());
+
+	/** length beyond the packet struct */
+	decoder.reset();
+	frame = bmsFrame(27, 0);
+	frame[3] = BMSFrameTraits::payloadLength + 1;
+	CHECK_EQ(decoder.parseByte(frame[0]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame[1]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame[2]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame[3]), FRAME_ERR_LENGTH);
+
+	/** checksum, both bytes */
+	decoder.reset();
+	frame = bmsFrame(27, 0);
+	frame[frame.size() - 3] ^= 0x01;
+	CHECK_EQ(parseAll(decoder, std::vector<uint8_t>(frame.begin(), frame.end() - 2)), FRAME_ERR_CHECKSUM);
+
+	decoder.reset();
+	frame = bmsFrame(27, 0);
+	frame[frame.size() - 2] ^= 0x01;
+	CHECK_EQ(parseAll(decoder, std::vector<uint8_t>(frame.begin(), frame.end() - 1)), FRAME_ERR_CHECKSUM);
+
+	/** suffix */
+	decoder.reset();
+	frame = bmsFrame(27, 0);
+	frame.back() = 0x76;
+	CHECK_EQ(parseAll(decoder, frame), FRAME_ERR_SUFFIX);
+	CHECK_EQ(decoder.getErrorCount(), 5);
+
+	/** the byte that breaks a frame is the header of the next one */
+	decoder.reset();
+	frame = bmsFrame(27, 0x50);
+	std::vector<uint8_t> stream = { 0xDD, BMSRegister::BMS_REG_INFO_STATUS };
+	stream.insert(stream.end(), frame.begin(), frame.end());
+	CHECK_EQ(parseAll(decoder, stream), FRAME_OK);
+	CHECK_EQ(tPacket.abData[0], 0x50);
+	CHECK_EQ(decoder.getErrorCount(), 6);
+	CHECK_EQ(decoder.getFrameCount(), 1);
+}
+
+static void testController()
+{
+	CONTROLLER_PACKET_STRUCT_T tPacket;
+	ControllerFrameDecoder decoder(&tPacket);
+	std::vector<uint8_t> frame = controllerFrame(0x10);
+
+	CHECK_EQ(ControllerFrameDecoder::maxFrameLength, 12);
+
+	for (size_t i = 0; i + 1 < frame.size(); i++) CHECK_EQ(decoder.parseByte(frame[i]), FRAME_PENDING);
+	CHECK_EQ(decoder.parseByte(frame.back()), FRAME_OK);
+	CHECK(memcmp(&tPacket, frame.data(), frame.size()) == 0);
+
+	/** no checksum, a wrong suffix is the only error */
+	frame.back() = 0x77;
+	CHECK_EQ(parseAll(decoder, frame), FRAME_ERR_SUFFIX);
+
+	/** the payload may hold the header byte, there is no length field to lose the frame on */
+	frame = controllerFrame(0xA5);
+	CHECK_EQ(frame[6], 0xAA);
+	CHECK_EQ(parseAll(decoder, frame), FRAME_OK);
+	CHECK_EQ(decoder.getFrameCount(), 2);
+	CHECK_EQ(decoder.getErrorCount(), 1);
+}
+
+static void testCompleteFrame()
+{
+	std::vector<uint8_t> frame = bmsFrame(27, 0x20);
+
+	CHECK(BMSFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+	CHECK(!BMSFrameDecoder::isCompleteFrame(frame.data(), frame.size() - 1));
+	frame.push_back(0x00);
+	CHECK(!BMSFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+
+	frame = bmsFrame(27, 0x20);
+	frame[10] ^= 0x40;
+	CHECK(!BMSFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+
+	frame = bmsFrame(27, 0x20, 0x80);
+	CHECK(!BMSFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+
+	frame = controllerFrame(0x01);
+	CHECK(ControllerFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+	frame.back() = 0x00;
+	CHECK(!ControllerFrameDecoder::isCompleteFrame(frame.data(), frame.size()));
+}
+
+/** feed() takes the payload in blocks, it has to see the same frames and errors as parseByte() */
+static void testFeed()
+{
+	BMS_PACKET_STRUCT_T tBytePacket, tFeedPacket;
+	BMSFrameDecoder byteDecoder(&tBytePacket);
+	BMSFrameDecoder feedDecoder(&tFeedPacket);
+	std::vector<uint8_t> stream;
+	std::vector<uint8_t> aByteSeed, aFeedSeed;
+
+	randomSeed(3);
+	for (uint32_t k = 0; k < FEED_FRAMES; k++) {
+		std::vector<uint8_t> frame = bmsFrame((uint8_t)random(BMSFrameTraits::payloadLength + 1), (uint8_t)random(256));
+
+		/** some damage anywhere in the frame */
+		if (random(6) == 0) frame[random(frame.size())] = (uint8_t)random(256);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+
+	for (size_t i = 0; i < stream.size(); i++) {
+		if (byteDecoder.parseByte(stream[i]) == FRAME_OK) aByteSeed.push_back(tBytePacket.abData[0]);
+	}
+
+	for (size_t i = 0; i < stream.size();) {
+		size_t len = (size_t)random(1, 64);
+
+		if (len > stream.size() - i) len = stream.size() - i;
+		feedDecoder.feed(ByteSpan(&stream[i], len), [&](const BMS_PACKET_STRUCT_T &tFrame) {
+			aFeedSeed.push_back(tFrame.abData[0]);
+		});
+		i += len;
+	}
+
+	CHECK(aByteSeed.size() > FEED_FRAMES / 2);
+	CHECK(aFeedSeed == aByteSeed);
+	CHECK_EQ(feedDecoder.getFrameCount(), byteDecoder.getFrameCount());
+	CHECK_EQ(feedDecoder.getErrorCount(), byteDecoder.getErrorCount());
+}
+
+/** every input overload of the handlers decodes the same bytes the same way */
+static void testHandlerOverloads()
+{
+	BMSPacketHandler bms(&Serial1);
+	ControllerPacketHandler controller(&Serial2);
+	BMS_PACKET_STRUCT_T tPacket;
+	CONTROLLER_PACKET_STRUCT_T tControllerPacket;
+	std::vector<uint8_t> frame = bmsFrame(27, 0x60);
+	std::string str(frame.begin(), frame.end());
+
+	memset(&tPacket, 0, sizeof(tPacket));
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), frame.size()), ERR_BMS_OK);
+	CHECK_EQ(tPacket.abData[0], 0x60);
+
+	memset(&tPacket, 0, sizeof(tPacket));
+	CHECK_EQ(bms.readSerialPacket(&tPacket, str), ERR_BMS_OK);
+	CHECK_EQ(tPacket.abData[0], 0x60);
+
+	memset(&tPacket, 0, sizeof(tPacket));
+	CHECK_EQ(bms.readSerialPacket(&tPacket, ByteSpan(frame.data(), frame.size())), ERR_BMS_OK);
+	CHECK_EQ(tPacket.abData[0], 0x60);
+
+	memset(&tPacket, 0, sizeof(tPacket));
+	Serial1.inject(frame.data(), frame.size());
+	CHECK_EQ(bms.readSerialPacket(&tPacket), ERR_BMS_OK);
+	CHECK_EQ(tPacket.abData[0], 0x60);
+	CHECK_EQ(Serial1.available(), 0);
+
+	/** error mapping */
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), 0), ERR_BMS_NO_DATA_AVAIL);
+	CHECK_EQ(bms.readSerialPacket(&tPacket), ERR_BMS_NO_DATA_AVAIL);
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), frame.size() - 1), ERR_BMS_SHORT_DATA);
+	frame.back() = 0x00;
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), frame.size()), ERR_BMS_SUFFIX);
+	frame = bmsFrame(27, 0x60);
+	frame[5] ^= 0x01;
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), frame.size()), ERR_BMS_CHECKSUM);
+	frame = bmsFrame(27, 0x60, 0x80);
+	CHECK_EQ(bms.readSerialPacket(&tPacket, frame.data(), frame.size()), ERR_BMS_DETECTED);
+
+	frame = controllerFrame(0x70);
+	str.assign(frame.begin(), frame.end());
+
+	memset(&tControllerPacket, 0, sizeof(tControllerPacket));
+	CHECK_EQ(controller.readSerialPacket(&tControllerPacket, frame.data(), frame.size()), ERR_CONTROLLER_OK);
+	CHECK_EQ(tControllerPacket.abData[0], 0x70);
+
+	memset(&tControllerPacket, 0, sizeof(tControllerPacket));
+	CHECK_EQ(controller.readSerialPacket(&tControllerPacket, str), ERR_CONTROLLER_OK);
+	CHECK_EQ(tControllerPacket.abData[0], 0x70);
+
+	memset(&tControllerPacket, 0, sizeof(tControllerPacket));
+	Serial2.inject(frame.data(), frame.size());
+	CHECK_EQ(controller.readSerialPacket(&tControllerPacket), ERR_CONTROLLER_OK);
+	CHECK_EQ(tControllerPacket.abData[0], 0x70);
+
+	frame.back() = 0x00;
+	CHECK_EQ(controller.readSerialPacket(&tControllerPacket, frame.data(), frame.size()), ERR_CONTROLLER_SUFFIX);
+	CHECK_EQ(controller.readSerialPacket(&tControllerPacket, frame.data(), 5), ERR_CONTROLLER_SHORT_DATA);
+}
+
+int main()
+{
+	testBmsStates();
+	testBmsErrors();
+	testController();
+	testCompleteFrame();
+	testFeed();
+	testHandlerOverloads();
+
+	return HOST_TEST_RESULT();
+}
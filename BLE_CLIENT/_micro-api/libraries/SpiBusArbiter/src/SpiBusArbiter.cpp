@@ -0,0 +1,158 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SpiBusArbiter.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		priority arbitration of a shared SPI bus
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include "SpiBusArbiter.h"
+#include "esp_timer.h"
+
+SpiBusArbiter::SpiBusArbiter()
+{
+	_xMutex = NULL;
+	_bOwner = SPI_BUS_CLASS_MAX;
+	vPortCPUInitializeMutex(&_xMux);
+	_ulPreemptCount = 0;
+
+	for (uint8_t i = 0; i < SPI_BUS_CLASS_MAX; i++) {
+		_abWaiting[i] = 0;
+		_aulMaxWaitUs[i] = 0;
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		create the bus mutex, has to be called before the first acquire()
+* @retval		true if successful
+*/
+/************************************************************************************************************************/
+bool SpiBusArbiter::begin()
+{
+	if (_xMutex == NULL) _xMutex = xSemaphoreCreateMutex();
+
+	return _xMutex != NULL;
+}
+
+void SpiBusArbiter::setWaiting(SPI_BUS_CLASS_E busClass, int8_t delta)
+{
+	portENTER_CRITICAL(&_xMux);
+	_abWaiting[busClass] += delta;
+	portEXIT_CRITICAL(&_xMux);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the bus, more important classes which are waiting get it first
+* @param[in]	busClass				priority class of the caller
+* @param[in]	timeout					maximum time to wait in ticks
+* @retval		true if the bus is owned by the caller
+*/
+/************************************************************************************************************************/
+bool SpiBusArbiter::acquire(SPI_BUS_CLASS_E busClass, TickType_t timeout)
+{
+	TickType_t xStart = xTaskGetTickCount();
+	int64_t llStartUs = esp_timer_get_time();
+	bool isAcquired = false;
+
+	setWaiting(busClass, 1);
+
+	for (;;) {
+		TickType_t xElapsed = xTaskGetTickCount() - xStart;
+		TickType_t xRemaining = (xElapsed < timeout) ? (timeout - xElapsed) : 0;
+
+		if (isPreemptRequested(busClass)) {
+			/** a more important class is waiting, let it go first */
+			if (xRemaining == 0) break;
+			vTaskDelay(1);
+			continue;
+		}
+
+		if (xSemaphoreTake(_xMutex, xRemaining) != pdTRUE) break;
+
+		/** a more important class may have started waiting while this one was blocked */
+		if (isPreemptRequested(busClass) && xRemaining > 0) {
+			xSemaphoreGive(_xMutex);
+			continue;
+		}
+
+		isAcquired = true;
+		break;
+	}
+
+	setWaiting(busClass, -1);
+
+	if (isAcquired) {
+		_bOwner = busClass;
+
+		uint32_t ulWaitUs = (uint32_t)(esp_timer_get_time() - llStartUs);
+		if (ulWaitUs > _aulMaxWaitUs[busClass]) _aulMaxWaitUs[busClass] = ulWaitUs;
+	}
+
+	return isAcquired;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		release the bus
+* @param[in]	busClass				priority class of the caller
+* @retval		false if the bus is not owned by the class of the caller, it stays with its owner
+*/
+/************************************************************************************************************************/
+bool SpiBusArbiter::release(SPI_BUS_CLASS_E busClass)
+{
+	if (_bOwner != busClass) return false;
+
+	_bOwner = SPI_BUS_CLASS_MAX;
+
+	return xSemaphoreGive(_xMutex) == pdTRUE;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		check if a more important class is waiting for the bus
+* @param[in]	busClass				priority class of the caller
+* @retval		true if the caller should hand over the bus at its next chunk boundary
+*/
+/************************************************************************************************************************/
+bool SpiBusArbiter::isPreemptRequested(SPI_BUS_CLASS_E busClass) const
+{
+	for (uint8_t i = 0; i < busClass; i++) {
+		if (_abWaiting[i]) return true;
+	}
+
+	return false;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		hand the bus over to a waiting more important class at a chunk boundary and get it back afterwards, the
+*				caller has to end its transaction (chip select) before
+* @param[in]	busClass				priority class of the caller
+* @retval		true if the bus is owned by the caller again
+*/
+/************************************************************************************************************************/
+bool SpiBusArbiter::yield(SPI_BUS_CLASS_E busClass)
+{
+	if (!isPreemptRequested(busClass)) return true;
+
+	_ulPreemptCount++;
+	release(busClass);
+
+	return acquire(busClass, portMAX_DELAY);
+}
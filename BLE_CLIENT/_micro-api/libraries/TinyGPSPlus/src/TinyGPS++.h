@@ -26,8 +26,13 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #if defined(ARDUINO) && ARDUINO >= 100
 #include "Arduino.h"
-#else
+#elif defined(ARDUINO)
 #include "WProgram.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+unsigned long millis(); // supplied by the host build
 #endif
 #include <limits.h>
 
@@ -61,6 +66,8 @@ public:
    const RawDegrees &rawLng()     { updated = false; return rawLngData; }
    double lat();
    double lng();
+   int32_t latMicrodegrees();
+   int32_t lngMicrodegrees();
 
    TinyGPSLocation() : valid(false), updated(false)
    {}
@@ -190,6 +197,10 @@ struct TinyGPSHDOP : TinyGPSDecimal
 };
 
 class TinyGPSPlus;
+
+// called for every validated RMC/GGA sentence with a fix, after all its values are committed
+typedef void (*TinyGPSFixHandler)(TinyGPSPlus &gps);
+
 class TinyGPSCustom
 {
 public:
@@ -221,7 +232,9 @@ class TinyGPSPlus
 public:
   TinyGPSPlus();
   bool encode(char c); // process one character received from GPS
+  bool encode(const char *buf, size_t n); // process a buffer of characters received from GPS
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
+  void setFixHandler(TinyGPSFixHandler handler) { fixHandler = handler; }
 
   TinyGPSLocation location;
   TinyGPSDate date;
@@ -262,6 +275,7 @@ private:
   friend class TinyGPSCustom;
   TinyGPSCustom *customElts;
   TinyGPSCustom *customCandidates;
+  TinyGPSFixHandler fixHandler;
   void insertCustom(TinyGPSCustom *pElt, const char *sentenceName, int index);
 
   // statistics
@@ -272,6 +286,7 @@ private:
 
   // internal utilities
   int fromHex(char a);
+  bool endOfTerm(char c);
   bool endOfTermHandler();
 };
 
@@ -133,6 +133,29 @@
 #define U8G2_WITH_UNICODE
 
 
+/*
+  The following macro enables an index for the glyphs 32 to 127 of the current font.
+  The index is built by u8g2_SetFont() and replaces the linear search through the
+  glyph list. It requires 192 bytes RAM in the u8g2 structure.
+  
+  The glyph cache keeps the last U8G2_GLYPH_CACHE_SIZE decoded glyphs as bitmaps,
+  so that repeated text is drawn without running the RLE decoder again.
+  Glyphs wider than 16 or higher than U8G2_GLYPH_CACHE_MAX_HEIGHT pixel are not cached.
+  The cache requires about U8G2_GLYPH_CACHE_SIZE*(12+2*U8G2_GLYPH_CACHE_MAX_HEIGHT) bytes RAM.
+  
+  Both are only enabled for controllers with enough RAM.
+*/
+#if defined(unix) || defined(__arm__) || defined(__arc__) || defined(ESP8266) || defined(ESP_PLATFORM)
+#define U8G2_WITH_GLYPH_INDEX
+#define U8G2_WITH_GLYPH_CACHE
+#endif
+
+#ifndef U8G2_GLYPH_CACHE_SIZE
+#define U8G2_GLYPH_CACHE_SIZE 16
+#endif
+#ifndef U8G2_GLYPH_CACHE_MAX_HEIGHT
+#define U8G2_GLYPH_CACHE_MAX_HEIGHT 20
+#endif
 
 
 /*==========================================*/
@@ -248,6 +271,28 @@ struct _u8g2_font_decode_t
 };
 typedef struct _u8g2_font_decode_t u8g2_font_decode_t;
 
+#ifdef U8G2_WITH_GLYPH_INDEX
+#define U8G2_GLYPH_INDEX_FIRST 32
+#define U8G2_GLYPH_INDEX_CNT 96
+#define U8G2_GLYPH_INDEX_NONE 0			/* glyph is not part of the font */
+#define U8G2_GLYPH_INDEX_UNKNOWN 0x0ffff	/* glyph is not indexed, use the linear search */
+#endif
+
+#ifdef U8G2_WITH_GLYPH_CACHE
+struct _u8g2_glyph_cache_entry_t
+{
+  const uint8_t *glyph_data;		/* key, NULL for an empty entry */
+  uint16_t last_use;
+  int8_t glyph_width;
+  int8_t glyph_height;
+  int8_t x;
+  int8_t y;
+  int8_t delta_x;
+  uint16_t rows[U8G2_GLYPH_CACHE_MAX_HEIGHT];	/* bit 0 is the leftmost pixel */
+};
+typedef struct _u8g2_glyph_cache_entry_t u8g2_glyph_cache_entry_t;
+#endif
+
 struct _u8g2_kerning_t
 {
   uint16_t first_table_cnt;
@@ -322,6 +367,13 @@ struct u8g2_struct
   u8g2_font_calc_vref_fnptr font_calc_vref;
   u8g2_font_decode_t font_decode;		/* new font decode structure */
   u8g2_font_info_t font_info;			/* new font info structure */
+#ifdef U8G2_WITH_GLYPH_INDEX
+  uint16_t glyph_index[U8G2_GLYPH_INDEX_CNT];	/* glyph offset + 1 for the current font, see u8g2_font_build_glyph_index() */
+#endif
+#ifdef U8G2_WITH_GLYPH_CACHE
+  u8g2_glyph_cache_entry_t glyph_cache[U8G2_GLYPH_CACHE_SIZE];
+  uint16_t glyph_cache_clock;
+#endif
 
 #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
   /* 1 of there is an intersection between user_?? and clip_?? box */
@@ -1137,6 +1189,9 @@ size_t u8g2_GetFontSize(const uint8_t *font_arg);
 #define U8G2_FONT_HEIGHT_MODE_ALL 2
 
 void u8g2_SetFont(u8g2_t *u8g2, const uint8_t  *font);
+#ifdef U8G2_WITH_GLYPH_CACHE
+void u8g2_ClearGlyphCache(u8g2_t *u8g2);
+#endif
 void u8g2_SetFontMode(u8g2_t *u8g2, uint8_t is_transparent);
 
 uint8_t u8g2_IsGlyph(u8g2_t *u8g2, uint16_t requested_encoding);
@@ -82,42 +82,82 @@ static uint8_t u8x8_write_byte_to_16gr_device(u8x8_t *u8x8, uint8_t b)
 
 
 /*
-  input:
-    one tile (8 Bytes)
-  output:
-    Tile for SSD1325 (32 Bytes)
+  Number of tiles which share one column window and one "write to ram" command.
+  The default covers a complete tile row of the 256x64 display (32 tiles, 1024 bytes).
+  The expansion buffer is static, so smaller controllers should reduce this value.
 */
+#ifndef U8X8_SSD1322_BURST_TILES
+#if defined(__AVR__)
+#define U8X8_SSD1322_BURST_TILES 4
+#else
+#define U8X8_SSD1322_BURST_TILES 32
+#endif
+#endif
 
 static uint8_t u8x8_ssd1322_to32_dest_buf[32];
+static uint8_t u8x8_ssd1322_burst_buf[U8X8_SSD1322_BURST_TILES*32];
+
+/* two monochrome pixels (bit 0: left, bit 1: right) per gray scale byte, indexed by one nibble */
+static const uint8_t u8x8_ssd1322_nibble_to_gray[16][2] = {
+  { 0x00, 0x00 }, { 0xf0, 0x00 }, { 0x0f, 0x00 }, { 0xff, 0x00 },
+  { 0x00, 0xf0 }, { 0xf0, 0xf0 }, { 0x0f, 0xf0 }, { 0xff, 0xf0 },
+  { 0x00, 0x0f }, { 0xf0, 0x0f }, { 0x0f, 0x0f }, { 0xff, 0x0f },
+  { 0x00, 0xff }, { 0xf0, 0xff }, { 0x0f, 0xff }, { 0xff, 0xff }
+};
+
+/*
+  input:
+    cnt tiles (8 Bytes each, one byte per column, lsb is the top pixel)
+  output:
+    8 pixel rows with 4*cnt gray scale bytes each, as expected by the
+    SSD1322 for a column window of 2*cnt addresses (32*cnt Bytes)
 
-static uint8_t *u8x8_ssd1322_8to32(U8X8_UNUSED u8x8_t *u8x8, uint8_t *ptr)
+  Each tile is transposed with 32 bit operations (Hacker's Delight, transpose8),
+  so that one byte holds the 8 pixels of one row. Each nibble of this byte is
+  then mapped to two gray scale bytes.
+*/
+static uint8_t *u8x8_ssd1322_8to32_row(U8X8_UNUSED u8x8_t *u8x8, const uint8_t *ptr, uint8_t cnt)
 {
-  uint8_t v;
-  uint8_t a,b;
-  uint8_t i, j;
-  uint8_t *dest;
+  uint32_t x, y, t;
+  uint8_t r[8];
+  uint8_t i;
+  uint16_t stride = (uint16_t)cnt*4;
+  uint8_t *dest = u8x8_ssd1322_burst_buf;
+  uint8_t *d;
   
-  for( j = 0; j < 4; j++ )
+  while( cnt > 0 )
   {
-    dest = u8x8_ssd1322_to32_dest_buf;
-    dest += j;
-    a =*ptr;
-    ptr++;
-    b = *ptr;
-    ptr++;
+    /* column 7 goes to the most significant byte, so that row 0 ends up in bit 0 */
+    x = ((uint32_t)ptr[7]<<24) | ((uint32_t)ptr[6]<<16) | ((uint32_t)ptr[5]<<8) | ptr[4];
+    y = ((uint32_t)ptr[3]<<24) | ((uint32_t)ptr[2]<<16) | ((uint32_t)ptr[1]<<8) | ptr[0];
+    
+    t = (x ^ (x >> 7)) & 0x00AA00AAUL;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAUL;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCCUL;  x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCUL;  y = y ^ t ^ (t << 14);
+    t = (x & 0xF0F0F0F0UL) | ((y >> 4) & 0x0F0F0F0FUL);
+    y = ((x << 4) & 0xF0F0F0F0UL) | (y & 0x0F0F0F0FUL);
+    x = t;
+    
+    r[7] = x >> 24; r[6] = x >> 16; r[5] = x >> 8; r[4] = x;
+    r[3] = y >> 24; r[2] = y >> 16; r[1] = y >> 8; r[0] = y;
+    
+    d = dest;
     for( i = 0; i < 8; i++ )
     {
-      v = 0;
-      if ( a&1 ) v |= 0xf0;
-      if ( b&1 ) v |= 0x0f;
-      *dest = v;
-      dest+=4;
-      a >>= 1;
-      b >>= 1;
+      d[0] = u8x8_ssd1322_nibble_to_gray[r[i] & 15][0];
+      d[1] = u8x8_ssd1322_nibble_to_gray[r[i] & 15][1];
+      d[2] = u8x8_ssd1322_nibble_to_gray[r[i] >> 4][0];
+      d[3] = u8x8_ssd1322_nibble_to_gray[r[i] >> 4][1];
+      d += stride;
     }
+    
+    dest += 4;
+    ptr += 8;
+    cnt--;
   }
   
-  return u8x8_ssd1322_to32_dest_buf;
+  return u8x8_ssd1322_burst_buf;
 }
 
 static uint8_t *u8x8_ssd1322_4to32(U8X8_UNUSED u8x8_t *u8x8, uint8_t *ptr)
@@ -150,8 +190,10 @@ static uint8_t *u8x8_ssd1322_4to32(U8X8_UNUSED u8x8_t *u8x8, uint8_t *ptr)
 uint8_t u8x8_d_ssd1322_common(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
 {
   uint8_t x; 
-  uint8_t y, c;
+  uint8_t y, c, n;
   uint8_t *ptr;
+  uint8_t *data;
+  uint16_t len;
   switch(msg)
   {
     /* U8X8_MSG_DISPLAY_SETUP_MEMORY is handled by the calling function */
@@ -198,17 +240,31 @@ uint8_t u8x8_d_ssd1322_common(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *
 
 	do
 	{
+	  /* one column window and one data burst for up to U8X8_SSD1322_BURST_TILES tiles */
+	  n = c;
+	  if ( n > U8X8_SSD1322_BURST_TILES )
+	    n = U8X8_SSD1322_BURST_TILES;
+	  
 	  u8x8_cad_SendCmd(u8x8, 0x015 );	/* set column address */
 	  u8x8_cad_SendArg(u8x8, x );	/* start */
-	  u8x8_cad_SendArg(u8x8, x+1 );	/* end */
+	  u8x8_cad_SendArg(u8x8, x+2*n-1 );	/* end */
 
 	  u8x8_cad_SendCmd(u8x8, 0x05c );	/* write to ram */
 	  
-	  u8x8_cad_SendData(u8x8, 32, u8x8_ssd1322_8to32(u8x8, ptr));
+	  /* SendData is limited to 255 bytes, but the data stream itself is not interrupted */
+	  data = u8x8_ssd1322_8to32_row(u8x8, ptr, n);
+	  len = (uint16_t)n*32;
+	  while( len > 128 )
+	  {
+	    u8x8_cad_SendData(u8x8, 128, data);
+	    data += 128;
+	    len -= 128;
+	  }
+	  u8x8_cad_SendData(u8x8, (uint8_t)len, data);
 	  
-	  ptr += 8;
-	  x += 2;
-	  c--;
+	  ptr += 8*n;
+	  x += 2*n;
+	  c -= n;
 	} while( c > 0 );
 	
 	//x += 2;
@@ -71,6 +71,105 @@ bool isBmsWriteInfoSuccess, isHeartRateAvailable = false;
 const uint8_t notificationOff[] = { 0x00, 0x00 };
 const uint8_t notificationOn[] = { 0x01, 0x00 };
 
+/* Connection manager */
+#define BLE_TELEMETRY_CYCLE_MS			250			// period of one service cycle over all sessions
+#define BLE_RECONNECT_BACKOFF_MIN_MS	500			// first reconnect delay after a failed attempt or a link loss
+#define BLE_RECONNECT_BACKOFF_MAX_MS	30000		// upper limit of the exponential reconnect backoff
+#define BLE_RESCAN_INTERVAL_MS			10000		// minimum time between two scans for missing devices
+#define BLE_CONNECT_TASK_STACK			8192		// stack of the connect task of a session
+
+/* ATT MTU */
+#define BLE_MTU_DEFAULT					23			// ATT default MTU, every peer supports it
+#define BLE_MTU_MAX						517			// local MTU, the largest MTU requested from every peer
+#define BLE_MTU_NVS_NAMESPACE			"blemtu"	// NVS namespace of the MTU remembered per peer MAC address
+#define BLE_CONN_ID_MAX					10			// number of GATT client connection ids tracked for the MTU exchange
+
+typedef enum BLE_SESSION_STATE_Etag {
+	BLE_SESSION_IDLE,								// device not found yet, nothing to do
+	BLE_SESSION_CONNECTING,							// connect task running, the main task only polls its result
+	BLE_SESSION_READY,								// connected, discovered and subscribed
+	BLE_SESSION_BACKOFF,							// link lost or attempt failed, wait for the next attempt
+} BLE_SESSION_STATE_E;
+
+typedef struct BLE_SESSION_Ttag {
+	const char				*pName;					// device name for logging
+	BLEAdvertisedDevice		**ppDevice;				// advertised device found by the scanner
+	BLEClient				**ppClient;				// client object owned by the session
+	bool					*pIsFound;				// scanner flag of the device
+	bool					*pIsConnected;			// connection flag set by the client callbacks
+	bool					(*pfService)();			// periodic action while the link is up, may be nullptr
+	bool					(*pfReady)();			// first action of the main task on a new link, may be nullptr
+	BLE_SESSION_STATE_E		eState;
+	uint32_t				ulBackoffTime;			// current reconnect delay in ms
+	uint32_t				ulNextAttemptTime;		// millis() of the next connection attempt
+	uint16_t				usMtu;					// MTU of the peer, remembered across reconnects and reboots, 0 if unknown
+	volatile bool			isConnecting;			// set by the main task, cleared by the connect task when it is done
+	volatile bool			isConnectReady;			// result of the connect task, valid once isConnecting is cleared
+} BLE_SESSION_T;
+
+/* Telemetry store */
+#define TELEMETRY_PARTITION				"telemetry"	// data partition of the flash log, see partitions.csv
+#define TELEMETRY_LORA_FIRST_SECTOR		0			// flash log of the lora samples
+#define TELEMETRY_LORA_SECTORS			16
+#define TELEMETRY_BLE_FIRST_SECTOR		16			// flash log of the records for the ESP server
+#define TELEMETRY_BLE_SECTORS			16
+#define BLE_BACKLOG_INTERVAL_MS			5000		// period of storing records while the ESP server is not connected
+#define BLE_BACKLOG_DRAIN_RECORDS		16			// stored records forwarded per service cycle after a reconnect
+
+/* Impact capture */
+#define IMPACT_CAPTURE_PARTITION		"capture"	// data partition of the capture slots, see partitions.csv
+#define IMPACT_CAPTURE_PRE_MS			500			// raw samples kept before the onset of an impact
+#define IMPACT_CAPTURE_POST_MS			1000		// raw samples kept from the onset of an impact on
+#define BLE_CAPTURE_CHUNKS_PER_CYCLE	8			// capture chunks uploaded per service cycle
+
+/* Input trace */
+#define INPUT_TRACE_PARTITION			"trace"		// data partition of the input trace, see partitions.csv
+#define INPUT_TRACE_SOURCES				(INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_BMS_NOTIFY) | \
+										 INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_CONTROLLER_NOTIFY) | \
+										 INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_GPS) | \
+										 INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_LMIC_EVENT))	// the IMU FIFO (2.4 kB/s) would fill the partition within minutes
+
+/* Parked mode */
+#define PARK_INACTIVITY_MS				300000		// no motion for this time while locked enters the parked mode
+#define PARK_TIMER_AWAKE_MS				60000		// time awake after a timer wakeup before parking again
+#define PARK_WAKE_TIMER_S				3600		// timer wakeup for the periodic uplink while parked
+#define PARK_WOM_THRESHOLD_MG			80			// accel change which wakes the gateway from the parked mode
+#define PARK_MOTION_G					0.05		// deviation of the force from 1 g which counts as motion
+#define PARK_MOTION_GYRO				0.2			// rotation in rad/s which counts as motion
+#define PARK_WAKE_LATENCY_MAX_MS		1000		// bound of the time from the wakeup to full operation
+#define PARK_RTC_MAGIC					0x50524B31	// "PRK1", valid state in the RTC memory
+
+/* GATT handle cache */
+#define GATT_CACHE_NVS_NAMESPACE		"gattcache"		// NVS namespace, one blob per peer keyed by the MAC address
+
+typedef enum GATT_CACHE_ATTR_Etag {
+	GATT_ATTR_TIME_SET,								// time set (read, notify)
+	GATT_ATTR_TIME_LORA_INFO,						// last lora package time (write)
+	GATT_ATTR_TIME_ESPTIME,							// esp current time (write)
+	GATT_ATTR_HEART_RATE,							// heart rate packet (write)
+	GATT_ATTR_BMS_MOTOR,							// bms and motor packet (write)
+	GATT_ATTR_LOCATION,								// location packet (write)
+	GATT_ATTR_MPU,									// mpu crash packet (write)
+	GATT_ATTR_TELEMETRY,							// telemetry snapshot (write), missing on older servers
+	GATT_ATTR_IMPACT_CAPTURE,						// impact capture upload (write), missing on older servers
+	GATT_ATTR_LOCK_CONTROL,							// lock control (read, notify), missing on older servers
+	GATT_ATTR_MAX,
+} GATT_CACHE_ATTR_E;
+
+typedef struct GATT_CACHE_ATTR_Ttag {
+	BLEUUID					serviceUUID;
+	BLEUUID					charUUID;
+	bool					isOptional;				// the connection is kept if the server does not provide it
+} GATT_CACHE_ATTR_T;
+
+/* attribute handles of one peer as stored in NVS */
+typedef __PACKED_PRE struct GATT_HANDLE_CACHE_Ttag {
+	uint32_t				ulAttrHash;				// hash over the attribute table UUIDs, a changed table drops the stored handles
+	uint16_t				ausHandle[GATT_ATTR_MAX];	// value handle of every attribute
+	uint16_t				usTimeSetCccdHandle;	// client characteristic configuration descriptor of the time set
+	uint16_t				usLockControlCccdHandle;	// client characteristic configuration descriptor of the lock control
+} __PACKED_POST GATT_HANDLE_CACHE_T;
+
 typedef __PACKED_PRE struct BLE_HEARTRATE_CLIENT_STRUCT_Ttag {
 		uint8_t    bFlag;
 		uint8_t    bHeartRate;
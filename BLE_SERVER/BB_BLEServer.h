@@ -15,6 +15,7 @@
 // Macros
 #define PROP_READ		BLECharacteristic::PROPERTY_READ
 #define PROP_WRITE		BLECharacteristic::PROPERTY_WRITE
+#define PROP_WRITE_NR	BLECharacteristic::PROPERTY_WRITE_NR
 #define PROP_NOTIFY		BLECharacteristic::PROPERTY_NOTIFY
 #define PROP_INDICATE	BLECharacteristic::PROPERTY_INDICATE
 
@@ -44,6 +45,10 @@
 
 #define MPU_SRV_SERVICE					BLEUUID("42425a11-0000-1000-8000-005a45535953")
 #define MPU_SRV_CHAR					BLEUUID("42427a11-0000-1000-8000-005a45535953")
+#define IMPACT_CAPTURE_SRV_CHAR			BLEUUID("42427a13-0000-1000-8000-005a45535953")
+
+#define TELEMETRY_SRV_SERVICE			BLEUUID("42425a12-0000-1000-8000-005a45535953")
+#define TELEMETRY_SRV_CHAR				BLEUUID("42427a12-0000-1000-8000-005a45535953")
 
 BLEServer *pServer;
 BLEService *pBmsService;
@@ -52,6 +57,7 @@ BLEService *pTimeInfoService;
 BLEService *pHeartRateService;
 BLEService *pLocationService;
 BLEService *pMpuService;
+BLEService *pTelemetryService;
 
 BLECharacteristic* pBmsMotorChar;
 BLECharacteristic* pIlockitChar; 
@@ -62,6 +68,8 @@ BLECharacteristic* pEspTimeChar;
 BLECharacteristic* pHeartRateChar;
 BLECharacteristic* pLocationChar;
 BLECharacteristic* pMpuChar;
+BLECharacteristic* pImpactCaptureChar;
+BLECharacteristic* pTelemetryChar;
 
 BLEDescriptor BmsMotorDescriptor(BLEUUID((uint16_t)0x2901));
 BLEDescriptor IlockitDescriptor(BLEUUID((uint16_t)0x2901));
@@ -72,6 +80,8 @@ BLEDescriptor EspTimeDescriptor(BLEUUID((uint16_t)0x2901));
 BLEDescriptor HeartRateDescriptor(BLEUUID((uint16_t)0x2901));
 BLEDescriptor LocationDescriptor(BLEUUID((uint16_t)0x2901));
 BLEDescriptor MpuDescriptor(BLEUUID((uint16_t)0x2901));
+BLEDescriptor ImpactCaptureDescriptor(BLEUUID((uint16_t)0x2901));
+BLEDescriptor TelemetryDescriptor(BLEUUID((uint16_t)0x2901));
 
 BLEAdvertising *pAdvertising;
 
@@ -162,6 +172,58 @@ typedef union BLE_MPU_PACKET_Ttag
     uint8_t abPacket[5];
 }BLE_MPU_PACKET_T;
 
+/* Telemetry snapshot frame
+ * | version | length | type | length | value | type | length | value | ...
+ * the frame length covers all records, every record carries the same bytes as the legacy characteristic of its type.
+ * Records forwarded from the backlog of the client are preceded by a record time, a 4 byte epoch time (big endian).
+ * All records after a record time belong to the backlog, they are never taken over as live values. */
+#define TELEMETRY_FRAME_VERSION			1
+#define TELEMETRY_FRAME_MAX_LEN			128			// upper limit of one frame, the frame is further limited by the MTU
+
+typedef enum TELEMETRY_TLV_TYPE_Etag {
+	TELEMETRY_TLV_HEART_RATE = 1,				// BLE_HEARTRATE_PACKET_T
+	TELEMETRY_TLV_BMS_MOTOR,					// BLE_BMS_MOTOR_PACKET_T
+	TELEMETRY_TLV_LOCATION,						// BLE_LOCATION_PACKET_T
+	TELEMETRY_TLV_LORA_TIME,					// last lora package time
+	TELEMETRY_TLV_ESP_TIME,						// esp current time
+	TELEMETRY_TLV_MPU,							// BLE_MPU_PACKET_T
+	TELEMETRY_TLV_MAX,
+	TELEMETRY_TLV_RECORD_TIME = 0x80,			// time of all following records of the frame, only sent for records from the backlog
+} TELEMETRY_TLV_TYPE_E;
+
+#define TELEMETRY_DIRTY(type)			(1 << (type))
+
+typedef __PACKED_PRE struct TELEMETRY_FRAME_HEADER_Ttag {
+	uint8_t		bVersion;
+	uint8_t		bLength;						// length of all records following the header
+} __PACKED_POST TELEMETRY_FRAME_HEADER_T;
+
+typedef __PACKED_PRE struct TELEMETRY_TLV_HEADER_Ttag {
+	uint8_t		bType;
+	uint8_t		bLength;
+} __PACKED_POST TELEMETRY_TLV_HEADER_T;
+
+/* Impact capture chunk
+ * | version | sequence | offset | total | data |
+ * A capture is the stored IMPACT_CAPTURE_HEADER_T followed by the compressed samples (see ImpactCapture.h), the
+ * client uploads it in order and a chunk with offset 0 starts a new capture. Readers write IMPACT_CAPTURE_READ_T to
+ * select the offset of the chunk in the value of the characteristic. All fields are little endian. */
+#define IMPACT_CAPTURE_FRAME_VERSION	1
+#define IMPACT_CAPTURE_FRAME_MAX_LEN	200			// upper limit of one chunk, the chunk is further limited by the MTU
+#define IMPACT_CAPTURE_MAX_LEN			8192		// upper limit of one capture, a flash slot of ImpactCapture
+
+typedef __PACKED_PRE struct IMPACT_CAPTURE_CHUNK_HEADER_Ttag {
+	uint8_t		bVersion;
+	uint32_t	ulSequence;						// sequence number of the capture
+	uint16_t	usOffset;						// offset of the data within the capture
+	uint16_t	usTotal;						// length of the capture
+} __PACKED_POST IMPACT_CAPTURE_CHUNK_HEADER_T;
+
+typedef __PACKED_PRE struct IMPACT_CAPTURE_READ_Ttag {
+	uint8_t		bVersion;
+	uint16_t	usOffset;						// offset of the chunk for the next read
+} __PACKED_POST IMPACT_CAPTURE_READ_T;
+
 typedef __PACKED_PRE struct BLE_ONWRITE_STRUCT_Ttag {
 	uint8_t	bLockControlValue;
 	union {
@@ -175,5 +237,6 @@ typedef __PACKED_PRE struct BLE_ONWRITE_STRUCT_Ttag {
 
 bool isTimeSetOnWrite = false;
 bool isLockControlOnWrite = false;
+bool isImpactCaptureComplete = false;
 
 #endif
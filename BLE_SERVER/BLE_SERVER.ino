@@ -40,6 +40,7 @@
 #include <sys/time.h>
 #include <BMSPacketHandler.h>
 #include <ControllerPacketHandler.h>
+#include <TelemetryStore.h>
 #include "BBUUID.h"
 #include "BB_BLEServer.h"
 #include "BB_BLEClient.h"
@@ -108,6 +109,17 @@ BLE_MPU_PACKET_T				mpuServerPacket = { 0 };
 BLE_ONWRITE_PACKET_T			onWritePacket = { 0 };
 BMS_PACKET_STRUCT_T				bmsPacket = { 0 };
 
+/* Impact capture uploaded by the client, served to readers chunk by chunk */
+uint8_t							abImpactCapture[IMPACT_CAPTURE_MAX_LEN];
+uint32_t						ulImpactCaptureSequence = 0;
+uint16_t						usImpactCaptureTotal = 0;
+uint16_t						usImpactCaptureReceived = 0;
+uint16_t						usImpactCaptureReadOffset = 0;
+bool							isImpactCaptureValid = false;
+
+/* Backlog records of the client, they never overwrite the live values */
+TelemetryStore					telemetryBacklog;
+
 /* Packet for LORAWAN */
 LORA_DATA_PACKET_T				loraPacket = { 0 };
 
@@ -192,6 +204,191 @@ class TimeSetCharacteristicCallbacks : public BLECharacteristicCallbacks {
 	}
 };
 
+/************************************************************************************************************************/
+/*!
+* @brief		take over a telemetry record into its packet and the legacy characteristic as read-through view
+* @param[in]	bType					telemetry record type
+* @param[in]	pValue					pointer to the value
+* @param[in]	bLength					length of the value
+* @retval		true if the record is known and has the expected length
+*/
+/************************************************************************************************************************/
+bool applyTelemetryRecord(uint8_t bType, const uint8_t *pValue, uint8_t bLength) {
+
+	uint8_t *pPacket;
+	uint8_t bPacketLength;
+	BLECharacteristic *pChar;
+
+	switch (bType) {
+	case TELEMETRY_TLV_HEART_RATE:
+		pPacket = heartRateServerPacket.abPacket; bPacketLength = sizeof(heartRateServerPacket.tPacket); pChar = pHeartRateChar; break;
+	case TELEMETRY_TLV_BMS_MOTOR:
+		pPacket = bmsMotorServerPacket.abPacket; bPacketLength = sizeof(bmsMotorServerPacket.tPacket); pChar = pBmsMotorChar; break;
+	case TELEMETRY_TLV_LOCATION:
+		pPacket = locationServerPacket.abPacket; bPacketLength = sizeof(locationServerPacket.tPacket); pChar = pLocationChar; break;
+	case TELEMETRY_TLV_LORA_TIME:
+		pPacket = timeInfoServerPacket.tLoraLastSendPackageTime.abValue; bPacketLength = 4; pChar = pLoraInfoChar; break;
+	case TELEMETRY_TLV_ESP_TIME:
+		pPacket = timeInfoServerPacket.tEspCurrentTime.abValue; bPacketLength = 4; pChar = pEspTimeChar; break;
+	case TELEMETRY_TLV_MPU:
+		pPacket = mpuServerPacket.abPacket; bPacketLength = sizeof(mpuServerPacket.abPacket); pChar = pMpuChar; break;
+	default:
+		return false;
+	}
+
+	if (bLength != bPacketLength) return false;
+
+	memcpy(pPacket, pValue, bLength);
+	pChar->setValue(pPacket, bLength);
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		keep a telemetry record of the client backlog with its record time, the live packets stay untouched
+* @param[in]	ulTime					record time (epoch)
+* @param[in]	bType					telemetry record type
+* @param[in]	pValue					pointer to the value
+* @param[in]	bLength					length of the value
+* @retval		true if the record is known and fits into the store
+*/
+/************************************************************************************************************************/
+bool storeTelemetryBacklogRecord(uint32_t ulTime, uint8_t bType, const uint8_t *pValue, uint8_t bLength) {
+
+	if (bType == 0 || bType >= TELEMETRY_TLV_MAX || bLength > TELEMETRY_STORE_DATA_LEN) return false;
+
+	ESP_LOGI(LOG_TAG, "Telemetry backlog record %d of time %u", bType, ulTime);
+
+	return telemetryBacklog.push(bType, ulTime, pValue, bLength);
+}
+
+class TelemetryCharacteristicCallbacks : public BLECharacteristicCallbacks {
+	void onWrite(BLECharacteristic *pCharacteristic) {
+
+		std::string frame = pCharacteristic->getValue();
+		const uint8_t *pFrame = (const uint8_t*)frame.data();
+		size_t idx = sizeof(TELEMETRY_FRAME_HEADER_T);
+
+		if (frame.length() < sizeof(TELEMETRY_FRAME_HEADER_T)) return;
+
+		const TELEMETRY_FRAME_HEADER_T *pHeader = (const TELEMETRY_FRAME_HEADER_T*)pFrame;
+
+		if (pHeader->bVersion != TELEMETRY_FRAME_VERSION || sizeof(TELEMETRY_FRAME_HEADER_T) + pHeader->bLength != frame.length()) {
+			ESP_LOGE(LOG_TAG, "Invalid telemetry frame, version: %d, length: %d", pFrame[0], frame.length());
+			return;
+		}
+
+		bool isBacklog = false;
+		uint32_t ulRecordTime = 0;
+		bool isApplied;
+
+		// unknown records are skipped by their length, so newer clients can add types
+		while (idx + sizeof(TELEMETRY_TLV_HEADER_T) <= frame.length()) {
+			const TELEMETRY_TLV_HEADER_T *pRecord = (const TELEMETRY_TLV_HEADER_T*)&pFrame[idx];
+			idx += sizeof(TELEMETRY_TLV_HEADER_T);
+
+			if (idx + pRecord->bLength > frame.length()) break;
+
+			// all records after a record time are from the backlog of the client
+			if (pRecord->bType == TELEMETRY_TLV_RECORD_TIME) {
+				if (pRecord->bLength != sizeof(uint32_t)) {
+					ESP_LOGE(LOG_TAG, "Invalid telemetry record time, length: %d", pRecord->bLength);
+					break;
+				}
+				ulRecordTime = bswap32(*(const uint32_t*)&pFrame[idx]);
+				isBacklog = true;
+				idx += pRecord->bLength;
+				continue;
+			}
+
+			if (isBacklog) {
+				isApplied = storeTelemetryBacklogRecord(ulRecordTime, pRecord->bType, &pFrame[idx], pRecord->bLength);
+			} else {
+				isApplied = applyTelemetryRecord(pRecord->bType, &pFrame[idx], pRecord->bLength);
+			}
+
+			if (!isApplied) {
+				ESP_LOGI(LOG_TAG, "Telemetry record %d skipped", pRecord->bType);
+			}
+			idx += pRecord->bLength;
+		}
+	}
+};
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the value of the impact capture characteristic to the chunk at an offset of the received capture,
+*				the chunk is empty while no complete capture is available
+* @param[in]	usOffset				offset within the capture
+* @retval		none
+*/
+/************************************************************************************************************************/
+void setImpactCaptureChunk(uint16_t usOffset) {
+
+	uint8_t abFrame[IMPACT_CAPTURE_FRAME_MAX_LEN];
+	IMPACT_CAPTURE_CHUNK_HEADER_T *pHeader = (IMPACT_CAPTURE_CHUNK_HEADER_T*)abFrame;
+	size_t len = 0;
+
+	if (isImpactCaptureValid && usOffset < usImpactCaptureTotal) {
+		len = sizeof(abFrame) - sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T);
+		if (len > (size_t)(usImpactCaptureTotal - usOffset)) len = usImpactCaptureTotal - usOffset;
+		memcpy(&abFrame[sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T)], &abImpactCapture[usOffset], len);
+	}
+
+	pHeader->bVersion = IMPACT_CAPTURE_FRAME_VERSION;
+	pHeader->ulSequence = ulImpactCaptureSequence;
+	pHeader->usOffset = usOffset;
+	pHeader->usTotal = isImpactCaptureValid ? usImpactCaptureTotal : 0;
+
+	pImpactCaptureChar->setValue(abFrame, sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T) + len);
+}
+
+class ImpactCaptureCharacteristicCallbacks : public BLECharacteristicCallbacks {
+	void onWrite(BLECharacteristic *pCharacteristic) {
+
+		std::string frame = pCharacteristic->getValue();
+		const uint8_t *pFrame = (const uint8_t*)frame.data();
+		const IMPACT_CAPTURE_CHUNK_HEADER_T *pHeader = (const IMPACT_CAPTURE_CHUNK_HEADER_T*)pFrame;
+		size_t len = frame.length() - sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T);
+
+		// readers select the chunk of the next read by its offset
+		if (frame.length() == sizeof(IMPACT_CAPTURE_READ_T)) {
+			if (pFrame[0] == IMPACT_CAPTURE_FRAME_VERSION) usImpactCaptureReadOffset = ((const IMPACT_CAPTURE_READ_T*)pFrame)->usOffset;
+		}
+		else if (frame.length() < sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T) || pHeader->bVersion != IMPACT_CAPTURE_FRAME_VERSION || pHeader->usTotal > IMPACT_CAPTURE_MAX_LEN) {
+			ESP_LOGE(LOG_TAG, "Invalid impact capture chunk, version: %d, length: %d", pFrame[0], frame.length());
+		}
+		else {
+			// a chunk with offset 0 starts a new capture, the following chunks have to be in order
+			if (pHeader->usOffset == 0) {
+				ulImpactCaptureSequence = pHeader->ulSequence;
+				usImpactCaptureTotal = pHeader->usTotal;
+				usImpactCaptureReceived = 0;
+				usImpactCaptureReadOffset = 0;
+				isImpactCaptureValid = false;
+			}
+
+			if (pHeader->ulSequence != ulImpactCaptureSequence || pHeader->usOffset != usImpactCaptureReceived || usImpactCaptureReceived + len > usImpactCaptureTotal) {
+				ESP_LOGE(LOG_TAG, "Impact capture chunk %d of capture %u dropped", pHeader->usOffset, pHeader->ulSequence);
+			}
+			else {
+				memcpy(&abImpactCapture[usImpactCaptureReceived], &pFrame[sizeof(IMPACT_CAPTURE_CHUNK_HEADER_T)], len);
+				usImpactCaptureReceived += len;
+
+				if (usImpactCaptureReceived == usImpactCaptureTotal) {
+					ESP_LOGI(LOG_TAG, "Impact capture %u received, %d bytes", ulImpactCaptureSequence, usImpactCaptureTotal);
+					isImpactCaptureValid = true;
+					isImpactCaptureComplete = true;
+				}
+			}
+		}
+
+		// the written bytes replace the value, readers get the selected chunk again
+		setImpactCaptureChunk(usImpactCaptureReadOffset);
+	}
+};
+
 void setupBLEServer() {
 	// Initialise the BLE server
 	ESP_LOGI(LOG_TAG, "BLE Server is starting...");
@@ -264,6 +461,19 @@ void setupBLEServer() {
 	pMpuChar->addDescriptor(&MpuDescriptor);
 	pMpuChar->addDescriptor(new BLE2902());
 	pMpuChar->setValue(mpuServerPacket.abPacket, sizeof(mpuServerPacket.abPacket));
+	pImpactCaptureChar = pMpuService->createCharacteristic(IMPACT_CAPTURE_SRV_CHAR, PROP_WRITE | PROP_WRITE_NR | PROP_READ | PROP_NOTIFY);
+	ImpactCaptureDescriptor.setValue("Raw IMU samples around the last impact");
+	pImpactCaptureChar->addDescriptor(&ImpactCaptureDescriptor);
+	pImpactCaptureChar->addDescriptor(new BLE2902());
+	pImpactCaptureChar->setCallbacks(new ImpactCaptureCharacteristicCallbacks());
+	setImpactCaptureChunk(0);
+
+	// configure the telemetry snapshot service and characteristics
+	pTelemetryService = pServer->createService(TELEMETRY_SRV_SERVICE);
+	pTelemetryChar = pTelemetryService->createCharacteristic(TELEMETRY_SRV_CHAR, PROP_WRITE | PROP_WRITE_NR);
+	TelemetryDescriptor.setValue("Telemetry snapshot (TLV)");
+	pTelemetryChar->addDescriptor(&TelemetryDescriptor);
+	pTelemetryChar->setCallbacks(new TelemetryCharacteristicCallbacks());
 
 	// start all services
 	pBmsService->start();
@@ -272,6 +482,7 @@ void setupBLEServer() {
 	pTimeInfoService->start();
 	pLocationService->start();
 	pMpuService->start();
+	pTelemetryService->start();
 
 	// initialise the server advertising 
 	pAdvertising = pServer->getAdvertising();
@@ -293,6 +504,9 @@ void setup() {
 	// initialiser the ble controller
 	BLEDevice::init("ZSY");
 
+	// accept the largest MTU a client asks for, long writes (prepared writes) are handled by the characteristics
+	BLEDevice::setMTU(BLE_MTU_MAX);
+
 	// setup the ble server
 	setupBLEServer();
 
@@ -316,6 +530,12 @@ void loop() {
 			isTimeSetOnWrite = false;
 		}
 
+		// announce a new capture with its first chunk
+		if (isImpactCaptureComplete) {
+			pImpactCaptureChar->notify();
+			isImpactCaptureComplete = false;
+		}
+
 		start_time = millis();
 	}
 
@@ -25,8 +25,12 @@
 
 #if defined(ARDUINO) && ARDUINO >= 100
 #include "arduino.h"
-#else
+#elif defined(ARDUINO)
 #include "WProgram.h"
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #endif
 
 #if defined (__STDC__)
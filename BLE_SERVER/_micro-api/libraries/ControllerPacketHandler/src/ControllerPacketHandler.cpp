@@ -23,7 +23,7 @@
 #if defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
 #define LOG_TAG ""
-#else
+#elif defined(ESP_PLATFORM)
 #include "esp_log.h"
 static const char* LOG_TAG = "BLEDevice";
 #endif
@@ -32,17 +32,27 @@ static const char* LOG_TAG = "BLEDevice";
 #include "byteswap.h"
 
 
-ControllerPacketHandler::ControllerPacketHandler()
+/** map the decoder result onto the controller error codes */
+static CONTROLLER_ERROR_E toControllerError(SERIAL_FRAME_RESULT_E eResult)
 {
-	blPacket2Parse = false;
+	switch (eResult) {
+	case FRAME_OK:				return ERR_CONTROLLER_OK;
+	case FRAME_IDLE:			return ERR_CONTROLLER_NO_DATA_AVAIL;
+	case FRAME_PENDING:			return ERR_CONTROLLER_SHORT_DATA;
+	case FRAME_ERR_CHECKSUM:	return ERR_CONTROLLER_CHECKSUM;
+	case FRAME_ERR_SUFFIX:		return ERR_CONTROLLER_SUFFIX;
+	default:					return ERR_CONTROLLER_DETECTED;
+	}
+}
 
+ControllerPacketHandler::ControllerPacketHandler() : _rxDecoder(&_rxPacket)
+{
+	_serPort = nullptr;
 }
 
-ControllerPacketHandler::ControllerPacketHandler(HardwareSerial *port)
+ControllerPacketHandler::ControllerPacketHandler(HardwareSerial *port) : _rxDecoder(&_rxPacket)
 {
 	_serPort = port;
-	blPacket2Parse = false;
-
 }
 
 ControllerPacketHandler::~ControllerPacketHandler()
@@ -50,230 +60,71 @@ ControllerPacketHandler::~ControllerPacketHandler()
 
 }
 
+#if defined(ARDUINO)
 CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket)
 {
-	uint8_t temp = 0, index = 0;
-	bool readSuffix = false;
-
-	SERIAL_CONTROLLER_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	CONTROLLER_ERROR_E bRet = ERR_CONTROLLER_OK;
+	ControllerFrameDecoder decoder(tSerialReadPacket);
+	SERIAL_FRAME_RESULT_E eResult;
 
 	if (!_serPort->available()) return ERR_CONTROLLER_NO_DATA_AVAIL;
-	else {
-		while (_serPort->available()) {
-			temp = _serPort->read();
-			//ESP_LOGV(LOG_TAG, "%d ", temp);
 
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == controllerHeader) {									/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_PAYLOAD;
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;
-				if (index == 10){
-					processState = SP_STATE_READ_SUFFIX;
-				}				/** read the command ID register */
-				
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == controllerSuffix) {
-					readSuffix = true;
-					//ESP_LOGV(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_CONTROLLER_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
-
-			if (ERR_CONTROLLER_OK != bRet) break;
-		}
+	/** single shot decode of one frame, stop at the first complete frame or error */
+	while (_serPort->available()) {
+		eResult = decoder.parseByte(_serPort->read());
+		if (FRAME_OK == eResult) return ERR_CONTROLLER_OK;
+		if (FRAME_IDLE != eResult && FRAME_PENDING != eResult) return toControllerError(eResult);
 	}
 
-	if (!readSuffix) return ERR_CONTROLLER_SHORT_DATA;
-	else return bRet;
+	return ERR_CONTROLLER_SHORT_DATA;
 }
+#endif
 
-CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket, uint8_t *data, uint8_t len)
+CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket, const uint8_t *data, size_t len)
 {
-	uint8_t temp = 0, index = 0, idx = 0;
-	bool readSuffix = false;
-	uint8_t dataSize = len;
-	SERIAL_CONTROLLER_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	CONTROLLER_ERROR_E bRet = ERR_CONTROLLER_OK;
-
-	//ESP_LOGV(LOG_TAG, "dataSize: %d", dataSize);
-
-	if (!dataSize) return ERR_CONTROLLER_NO_DATA_AVAIL;
-	else {
-		while (dataSize--) {
-
-			temp = (uint8_t)data[idx++];
-			//ESP_LOGV(LOG_TAG, "data[%d]: 0x%02X", idx - 1, temp);
-
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == controllerHeader) {								/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_PAYLOAD;
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;
-				if (index == 10){
-					processState = SP_STATE_READ_SUFFIX;
-				}				/** read the command ID register */
-				
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == controllerSuffix) {
-					readSuffix = true;
-					//ESP_LOGV(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_CONTROLLER_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
-
-			if (ERR_CONTROLLER_OK != bRet) break;
-		}
-	}
-
-	if (!readSuffix) return ERR_CONTROLLER_SHORT_DATA;
-	else return bRet;
+	return readSerialPacket(tSerialReadPacket, ByteSpan(data, len));
 }
 
-CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket, std::string data)
+CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket, const std::string &data)
 {
-	uint8_t temp = 0, index = 0, idx = 0;
-	bool readSuffix = false;
-	uint8_t dataSize = data.length();
-	SERIAL_CONTROLLER_PROCESS_STATE_t processState = SP_STATE_READ_HEADER;
-	CONTROLLER_ERROR_E bRet = ERR_CONTROLLER_OK;
-
-	//ESP_LOGV(LOG_TAG, "dataSize: 0x%02X", dataSize);
-
-	if (!dataSize) return ERR_CONTROLLER_NO_DATA_AVAIL;
-	else {
-		while (dataSize--) {
-
-			temp = (uint8_t)data[idx++];
-			//ESP_LOGV(LOG_TAG, "data[%d]: 0x%02X", idx - 1, temp);
-
-			switch (processState) {
-			case SP_STATE_READ_HEADER: {
-				if (temp == controllerHeader) {									/** header is found */
-					tSerialReadPacket->bHeader = temp;
-					processState = SP_STATE_READ_PAYLOAD;
-				}
-				break;
-			}
-			case SP_STATE_READ_PAYLOAD: {
-				tSerialReadPacket->abData[index++] = temp;
-				if (index == 10){
-					processState = SP_STATE_READ_SUFFIX;
-				}				/** read the command ID register */
-				
-				break;
-			}
-			case SP_STATE_READ_SUFFIX: {
-				tSerialReadPacket->abData[index] = temp;					/** save the received data (suffix) into read packet */
-				if (temp == controllerSuffix) {
-					readSuffix = true;
-					//ESP_LOGV(LOG_TAG, "Suffix found!");
-				}
-				else bRet = ERR_CONTROLLER_SUFFIX;										/** else return the suffix error */
-				break;
-			}
-			}
-
-			if (ERR_CONTROLLER_OK != bRet) break;
-		}
-	}
-
-	if (!readSuffix) return ERR_CONTROLLER_SHORT_DATA;
-	else return bRet;
+	return readSerialPacket(tSerialReadPacket, ByteSpan(data));
 }
 
-void ControllerPacketHandler::readParsePacket(uint8_t *pData, uint8_t len)
+CONTROLLER_ERROR_E ControllerPacketHandler::readSerialPacket(CONTROLLER_PACKET_STRUCT_T * tSerialReadPacket, ByteSpan data)
 {
-	CONTROLLER_PACKET_STRUCT_T rSerialPacket = { 0 };
-	CONTROLLER_ERROR_E bRet = ERR_CONTROLLER_OK;
-
-	if (blPacket2Parse) {
-
-		uint8_t totalLength = lastPacketLength + len;
+	ControllerFrameDecoder decoder(tSerialReadPacket);
+	SERIAL_FRAME_RESULT_E eResult;
 
-		for (uint8_t i = 0; i < len; i++) {
-			abControllerReadPacket[lastPacketLength + i] = pData[i];
-		}
+	if (!data.len) return ERR_CONTROLLER_NO_DATA_AVAIL;
 
-		if (ERR_CONTROLLER_OK != (bRet = readSerialPacket(&rSerialPacket, abControllerReadPacket, totalLength))) {
-			//ESP_LOGV(LOG_TAG, "bRet: %d", bRet);
-		}
-
-		//ESP_LOGV(LOG_TAG, "Total voltage: %f", (rSerialPacket.tPacket.bTotalVoltage / 3.7));
-		
-		blPacket2Parse = false;
+	/** single shot decode of one frame, stop at the first complete frame or error */
+	for (size_t i = 0; i < data.len; i++) {
+		eResult = decoder.parseByte(data.data[i]);
+		if (FRAME_OK == eResult) return ERR_CONTROLLER_OK;
+		if (FRAME_IDLE != eResult && FRAME_PENDING != eResult) return toControllerError(eResult);
 	}
 
-	else {
-		if (ERR_CONTROLLER_OK != (bRet = readSerialPacket(&rSerialPacket, pData, len))) {
-			//ESP_LOGV(LOG_TAG, "bRet: %d", bRet);
-
-			if (bRet == ERR_CONTROLLER_SHORT_DATA) {
-				memcpy(abControllerReadPacket, &rSerialPacket, len);
-				lastPacketLength = len;
-				blPacket2Parse = true;
-			}
-		}
-		else {
-			//ESP_LOGV(LOG_TAG, "Total voltage: %f V", (rSerialPacket.tPacket.bTotalVoltage / 3.7));
-		}
-	}
+	return ERR_CONTROLLER_SHORT_DATA;
 }
 
-bool ControllerPacketHandler::readParsePacket(CONTROLLER_PACKET_STRUCT_T *readPacket, uint8_t * pData, uint8_t len)
+void ControllerPacketHandler::resetParser()
 {
-	CONTROLLER_ERROR_E bRet = ERR_CONTROLLER_OK;
-
-	if (blPacket2Parse) {
-
-		blPacket2Parse = false;
-
-		uint8_t totalLength = lastPacketLength + len;
-
-		for (uint8_t i = 0; i < len; i++) {
-			abControllerReadPacket[lastPacketLength + i] = pData[i];
-		}
+	_rxDecoder.reset();
+}
 
-		if (ERR_CONTROLLER_OK != (bRet = readSerialPacket(readPacket, abControllerReadPacket, totalLength))) {
-			//ESP_LOGV(LOG_TAG, "bRet: %d", bRet);
-			return false;
-		}
-		else return true;
-	}
+void ControllerPacketHandler::readParsePacket(const uint8_t *pData, size_t len)
+{
+	_rxDecoder.feed(ByteSpan(pData, len), [](const CONTROLLER_PACKET_STRUCT_T &) {});
+}
 
-	else {
-		if (ERR_CONTROLLER_OK != (bRet = readSerialPacket(readPacket, pData, len))) {
-			//ESP_LOGV(LOG_TAG, "bRet: %d", bRet);
+bool ControllerPacketHandler::readParsePacket(CONTROLLER_PACKET_STRUCT_T *readPacket, const uint8_t * pData, size_t len)
+{
+	bool isFrameComplete = false;
 
-			if (bRet == ERR_CONTROLLER_SHORT_DATA) {
-				memcpy(abControllerReadPacket, readPacket, len);
-				lastPacketLength = len;
-				blPacket2Parse = true;
-			}
+	/** notifications may split a frame at any byte, the decoder keeps its state across calls */
+	_rxDecoder.feed(ByteSpan(pData, len), [&](const CONTROLLER_PACKET_STRUCT_T &tFrame) {
+		memcpy(readPacket, &tFrame, sizeof(tFrame));
+		isFrameComplete = true;
+	});
 
-			return false;
-		}
-		else return true;
-	}
+	return isFrameComplete;
 }
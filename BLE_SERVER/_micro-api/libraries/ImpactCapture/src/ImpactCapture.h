@@ -0,0 +1,171 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			ImpactCapture.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		pre/post-trigger capture of the raw IMU samples around an impact
+* @details		The sampling task pushes every raw accel/gyro sample into a ring of IMPACT_CAPTURE_RING_SAMPLES
+*				samples. A trigger (onset of a potential impact) arms the capture, once the post-trigger samples are
+*				in the ring it is frozen: the sampling task stops writing the ring (the detection itself goes on) until
+*				the consumer task has stored the window. Only confirmed captures are stored, a cancelled trigger
+*				releases the ring again. Producer and consumer only hand over the ring by the state variable, there
+*				is no lock in the sampling path.
+*
+*				Stored captures are written to slots of a data partition, the oldest slot is overwritten when all
+*				slots are used. A slot holds the header followed by the compressed samples: for every sample and
+*				channel (ax, ay, az, gx, gy, gz in sensor counts) the difference to the same channel of the previous
+*				sample as zigzag varint, the first sample is the difference to zero.
+*
+*	Flash slot layout:
+*
+*	Offset			| Content
+*	----------------|---------------------------------------------------------------------------------------------
+*	0				| IMPACT_CAPTURE_HEADER_T (magic, state, sequence, scales, sample counts)
+*	32				| compressed samples, usLength bytes
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	push(), trigger(), confirm() and cancel() belong to the sampling task, all other methods to one consumer task
+*	-	without a flash partition (or on other platforms) confirmed captures are dropped
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __IMPACT_CAPTURE_PUBLIC_H
+#define __IMPACT_CAPTURE_PUBLIC_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#elif defined(ARDUINO)
+	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+#endif
+
+#if defined (__STDC__)
+#if !defined(__PACKED_PRE) || !defined(__PACKED_POST)
+#define __PACKED_PRE
+#define __PACKED_POST	__attribute__ ((packed))
+#endif
+#endif
+
+#if defined(ESP32)
+#include "esp_partition.h"
+#endif
+
+#define IMPACT_CAPTURE_CHANNELS			6			//!< ax, ay, az, gx, gy, gz
+#define IMPACT_CAPTURE_RING_SAMPLES		512			//!< ring length, power of two (2.5 s at 200 Hz)
+#define IMPACT_CAPTURE_MAX_SAMPLES		384			//!< upper limit of pre + post samples, the worst case compressed window fits a slot
+#define IMPACT_CAPTURE_SECTOR_SIZE		4096		//!< flash erase unit
+#define IMPACT_CAPTURE_SLOT_SIZE		8192		//!< flash space of one capture
+#define IMPACT_CAPTURE_PAGE_SIZE		256			//!< compressed samples are written in pages of this size
+#define IMPACT_CAPTURE_MAGIC			0x494D4331	//!< "IMC1"
+
+typedef enum IMPACT_CAPTURE_STATE_Etag {
+	IMPACT_CAPTURE_ERASED		= 0xFF,				//!< slot not written yet
+	IMPACT_CAPTURE_STORED		= 0xFE,				//!< capture valid and not yet uploaded
+	IMPACT_CAPTURE_UPLOADED		= 0x00,				//!< capture uploaded
+} IMPACT_CAPTURE_STATE_E;
+
+typedef __PACKED_PRE struct IMPACT_CAPTURE_HEADER_Ttag {
+	uint32_t	ulMagic;
+	uint8_t		bState;								//!< flash state, see IMPACT_CAPTURE_STATE_E
+	uint8_t		bChannels;							//!< channels per sample, IMPACT_CAPTURE_CHANNELS
+	uint16_t	usOdrHz;							//!< sample rate
+	uint32_t	ulSequence;							//!< increases with every capture
+	uint32_t	ulTime;								//!< time of the impact (epoch)
+	uint16_t	usPreSamples;						//!< samples before the trigger sample
+	uint16_t	usPostSamples;						//!< samples from the trigger sample on
+	uint16_t	usLength;							//!< length of the compressed samples
+	uint16_t	usCrc;								//!< crc16 (CCITT) of the compressed samples
+	float		fAccelScale;						//!< m/s^2 per count
+	float		fGyroScale;							//!< rad/s per count
+} __PACKED_POST IMPACT_CAPTURE_HEADER_T;
+
+class ImpactCapture
+{
+ public:
+
+	 ImpactCapture();
+	 virtual ~ImpactCapture();
+
+	 bool begin(const char *partitionLabel, uint16_t odrHz, uint16_t preMs, uint16_t postMs, float accelScale, float gyroScale);
+
+	 /** sampling task */
+	 void push(uint32_t sample, const int16_t *counts);
+	 void trigger(uint32_t sample);
+	 void confirm(uint32_t ulTime);
+	 void cancel();
+
+	 /** consumer task */
+	 bool process();
+	 int16_t findPending(IMPACT_CAPTURE_HEADER_T *pHeader);
+	 size_t read(uint16_t slot, uint32_t offset, void *pData, size_t len);
+	 bool markUploaded(uint16_t slot);
+
+	 bool hasPending() const { return _pendingCount > 0; }
+	 bool isFrozen() const { return _state == CAPTURE_FROZEN; }
+	 uint32_t getStoredCount() const { return _storedCount; }
+	 uint32_t getDroppedCount() const { return _droppedCount; }
+
+private:
+	typedef enum CAPTURE_STATE_Etag {
+		CAPTURE_IDLE,								//!< ring written by the sampling task
+		CAPTURE_ARMED,								//!< waiting for the post-trigger samples
+		CAPTURE_FROZEN,								//!< ring owned by the consumer task
+	} CAPTURE_STATE_E;
+
+	 void freeze();
+	 bool store();
+	 void mount();
+	 uint32_t slotAddress(uint16_t slot) const { return (uint32_t)slot * IMPACT_CAPTURE_SLOT_SIZE; }
+	 bool flashRead(uint32_t address, void *pData, size_t len);
+	 bool flashWrite(uint32_t address, const void *pData, size_t len);
+	 bool flashErase(uint32_t address, size_t len);
+	 static size_t writeVarint(uint8_t *p, uint32_t value);
+	 static uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+	 static uint16_t crc16(uint16_t crc, const uint8_t *pData, size_t len);
+
+	/** ring of raw samples, sample n is kept at n % IMPACT_CAPTURE_RING_SAMPLES */
+	int16_t _ring[IMPACT_CAPTURE_RING_SAMPLES][IMPACT_CAPTURE_CHANNELS];
+	volatile uint8_t _state;
+	volatile bool _isConfirmed;
+	bool _isGap;									//!< samples were skipped while the ring was frozen
+	bool _hasTrigger;
+	uint32_t _head;									//!< next sample written to the ring
+	uint32_t _validFrom;							//!< first sample after the last gap
+	uint32_t _trigger;
+	uint32_t _windowStart;
+	uint16_t _windowSamples;
+	uint32_t _time;
+
+	uint16_t _odrHz;
+	uint16_t _preSamples;
+	uint16_t _postSamples;
+	float _accelScale;
+	float _gyroScale;
+
+	/** flash slots */
+#if defined(ESP32)
+	const esp_partition_t *_partition;
+#endif
+	uint16_t _slotCount;
+	uint16_t _writeSlot;
+	uint32_t _sequence;
+	uint16_t _pendingCount;
+
+	uint32_t _storedCount;
+	uint32_t _droppedCount;
+};
+
+#endif
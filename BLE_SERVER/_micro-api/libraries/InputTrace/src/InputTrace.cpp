@@ -0,0 +1,454 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			InputTrace.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		binary trace of the inputs consumed by the gateway, for the replay of a ride off-target
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#if defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#elif defined(ESP_PLATFORM)
+#include "esp_log.h"
+static const char* LOG_TAG = "InputTrace";
+#else
+#include <stdio.h>
+static const char* LOG_TAG = "InputTrace";
+#define ESP_LOGE(tag, format, ...)	fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)	fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+#endif
+
+#include "InputTrace.h"
+
+#define BLOCKS_PER_SECTOR	(INPUT_TRACE_SECTOR_SIZE / INPUT_TRACE_BLOCK_SIZE)
+
+#if defined(ESP32)
+#define TRACE_LOCK()		portENTER_CRITICAL(&_xMux)
+#define TRACE_UNLOCK()		portEXIT_CRITICAL(&_xMux)
+#else
+#define TRACE_LOCK()
+#define TRACE_UNLOCK()
+#endif
+
+
+InputTrace::InputTrace()
+{
+	_used[0] = _used[1] = 0;
+	_dropped[0] = _dropped[1] = 0;
+	_state[0] = BLOCK_FILLING;
+	_state[1] = BLOCK_FREE;
+	_fill = 0;
+	_pendingDropped = 0;
+#if defined(ESP32)
+	vPortCPUInitializeMutex(&_xMux);
+	_partition = nullptr;
+#endif
+	_sourceMask = 0;
+	_blockCount = 0;
+	_writeBlock = 0;
+	_sequence = 0;
+	_recordedCount = 0;
+	_droppedCount = 0;
+	_writtenBlocks = 0;
+}
+
+InputTrace::~InputTrace()
+{
+
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		attach the flash ring and start recording the selected sources
+* @param[in]	partitionLabel			label of the data partition
+* @param[in]	sourceMask				INPUT_TRACE_MASK() of the recorded sources
+* @retval		true if the recording has started, else nothing is recorded
+*/
+/************************************************************************************************************************/
+bool InputTrace::begin(const char *partitionLabel, uint32_t sourceMask)
+{
+	_sourceMask = 0;
+	_blockCount = 0;
+
+#if defined(ESP32)
+	_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel);
+
+	if (_partition == nullptr || _partition->size < 2 * INPUT_TRACE_SECTOR_SIZE) {
+		ESP_LOGE(LOG_TAG, "Partition %s not usable, inputs are not recorded", partitionLabel);
+		return false;
+	}
+
+	/** whole sectors only, the write position moves to the next sector with an erase */
+	_blockCount = (_partition->size / INPUT_TRACE_SECTOR_SIZE) * BLOCKS_PER_SECTOR;
+
+	mount();
+
+	ESP_LOGI(LOG_TAG, "%s: %u blocks, next sequence %u", partitionLabel, _blockCount, _sequence);
+
+	_sourceMask = sourceMask | INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_BOOT);
+	record(INPUT_TRACE_SOURCE_BOOT, NULL, 0);
+
+	return true;
+#else
+	(void)partitionLabel;
+	(void)sourceMask;
+	return false;
+#endif
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add a record with the current time stamp, dropped if both RAM blocks are in use
+* @param[in]	bSource					source of the input, see INPUT_TRACE_SOURCE_E
+* @param[in]	pData					payload
+* @param[in]	usLength				length of the payload, up to INPUT_TRACE_MAX_PAYLOAD
+* @retval		true if the record has been added
+*/
+/************************************************************************************************************************/
+bool InputTrace::record(uint8_t bSource, const void *pData, uint16_t usLength)
+{
+	INPUT_TRACE_RECORD_HEADER_T tRecord;
+	bool isRecorded = false;
+	uint8_t fill;
+
+	if (!isEnabled(bSource)) return false;
+
+	tRecord.ulTimeUs = (uint32_t)micros();
+	tRecord.bSource = bSource;
+	tRecord.bReserved = 0;
+	tRecord.usLength = usLength;
+
+	TRACE_LOCK();
+
+	if (usLength <= INPUT_TRACE_MAX_PAYLOAD) {
+		fill = _fill;
+
+		/** continue in the other block if the consumer has written it already */
+		if (_used[fill] + sizeof(tRecord) + usLength > INPUT_TRACE_BLOCK_DATA) {
+			handOver();
+			fill = _fill;
+		}
+
+		if (_used[fill] + sizeof(tRecord) + usLength <= INPUT_TRACE_BLOCK_DATA) {
+			uint8_t *p = &_block[fill][sizeof(INPUT_TRACE_BLOCK_HEADER_T) + _used[fill]];
+
+			memcpy(p, &tRecord, sizeof(tRecord));
+			if (usLength > 0) memcpy(p + sizeof(tRecord), pData, usLength);
+			_used[fill] += sizeof(tRecord) + usLength;
+			_recordedCount++;
+			isRecorded = true;
+		}
+	}
+
+	if (!isRecorded) {
+		_droppedCount++;
+		if (_pendingDropped < UINT16_MAX) _pendingDropped++;
+	}
+
+	TRACE_UNLOCK();
+
+	return isRecorded;
+}
+
+/* hand the filled block over to the consumer, called with the lock held */
+void InputTrace::handOver()
+{
+	uint8_t fill = _fill;
+
+	if (_used[fill] == 0 || _state[fill ^ 1] != BLOCK_FREE) return;
+
+	_dropped[fill] = _pendingDropped;
+	_pendingDropped = 0;
+	_state[fill] = BLOCK_FULL;
+
+	fill ^= 1;
+	_used[fill] = 0;
+	_state[fill] = BLOCK_FILLING;
+	_fill = fill;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		write a handed over block to flash, to be called periodically by the consumer task
+* @retval		true if a block has been written
+*/
+/************************************************************************************************************************/
+bool InputTrace::process()
+{
+	for (uint8_t block = 0; block < 2; block++) {
+		if (_state[block] != BLOCK_FULL) continue;
+
+		bool isStored = store(block);
+
+		TRACE_LOCK();
+		_state[block] = BLOCK_FREE;
+		TRACE_UNLOCK();
+
+		return isStored;
+	}
+
+	return false;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		write the partly filled block, e.g. before a deep sleep
+* @retval		true if no record is left in RAM
+*/
+/************************************************************************************************************************/
+bool InputTrace::flush()
+{
+	/** a block handed over before has to be written first, then the one being filled */
+	process();
+
+	TRACE_LOCK();
+	handOver();
+	TRACE_UNLOCK();
+
+	process();
+
+	return _used[_fill] == 0;
+}
+
+bool InputTrace::store(uint8_t block)
+{
+	INPUT_TRACE_BLOCK_HEADER_T *pHeader = (INPUT_TRACE_BLOCK_HEADER_T *)_block[block];
+	uint32_t address;
+
+	if (_blockCount == 0) return false;
+
+	pHeader->ulMagic = INPUT_TRACE_MAGIC;
+	pHeader->ulSequence = _sequence;
+	pHeader->ulTime = (uint32_t)time(NULL);
+	pHeader->usLength = _used[block];
+	pHeader->usDropped = _dropped[block];
+
+	address = blockAddress(_writeBlock);
+
+	/** the first block of a sector overwrites the oldest blocks of the ring */
+	if ((_writeBlock % BLOCKS_PER_SECTOR) == 0 && !flashErase(address, INPUT_TRACE_SECTOR_SIZE)) {
+		ESP_LOGE(LOG_TAG, "Erase of block %u failed", _writeBlock);
+		return false;
+	}
+
+	/** the rest of the block stays erased */
+	if (!flashWrite(address, _block[block], sizeof(INPUT_TRACE_BLOCK_HEADER_T) + _used[block])) {
+		ESP_LOGE(LOG_TAG, "Write of block %u failed", _writeBlock);
+		return false;
+	}
+
+	_sequence++;
+	_writeBlock = (_writeBlock + 1) % _blockCount;
+	_writtenBlocks++;
+
+	return true;
+}
+
+void InputTrace::mount()
+{
+	INPUT_TRACE_BLOCK_HEADER_T tHeader;
+	bool isFound = false;
+
+	_sequence = 0;
+	_writeBlock = 0;
+
+	/** continue after the highest sequence number, in the next sector if its sector is partly written */
+	for (uint32_t block = 0; block < _blockCount; block++) {
+		if (!flashRead(blockAddress(block), &tHeader, sizeof(tHeader))) continue;
+		if (tHeader.ulMagic != INPUT_TRACE_MAGIC) continue;
+
+		if (!isFound || (int32_t)(tHeader.ulSequence - _sequence) >= 0) {
+			_sequence = tHeader.ulSequence;
+			_writeBlock = block;
+			isFound = true;
+		}
+	}
+
+	if (isFound) {
+		_sequence++;
+		_writeBlock = ((_writeBlock / BLOCKS_PER_SECTOR + 1) * BLOCKS_PER_SECTOR) % _blockCount;
+	}
+}
+
+bool InputTrace::flashRead(uint32_t address, void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_read(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool InputTrace::flashWrite(uint32_t address, const void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_write(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool InputTrace::flashErase(uint32_t address, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_erase_range(_partition, address, len) == ESP_OK;
+#else
+	(void)address;
+	(void)len;
+	return false;
+#endif
+}
+
+
+InputTraceReader::InputTraceReader()
+{
+	_image = NULL;
+	_blockCount = 0;
+	_blocksLeft = 0;
+	_block = 0;
+	_offset = 0;
+	_length = 0;
+	_sequence = 0;
+	_hasSequence = false;
+	_hasBlock = false;
+	_hasTime = false;
+	_lastTimeUs = 0;
+	_timeUs = 0;
+	_blockTime = 0;
+	_droppedCount = 0;
+	_missingBlocks = 0;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		start at the oldest record of a partition image
+* @param[in]	pImage					image of the trace partition, has to stay valid while reading
+* @param[in]	len						length of the image
+* @retval		true if the image holds at least one block
+*/
+/************************************************************************************************************************/
+bool InputTraceReader::begin(const uint8_t *pImage, size_t len)
+{
+	const INPUT_TRACE_BLOCK_HEADER_T *pHeader;
+	uint32_t newest = 0;
+	bool isFound = false;
+
+	*this = InputTraceReader();
+	_image = pImage;
+	_blockCount = len / INPUT_TRACE_BLOCK_SIZE;
+
+	for (uint32_t block = 0; block < _blockCount; block++) {
+		pHeader = blockHeader(block);
+		if (pHeader == NULL) continue;
+
+		if (!isFound || (int32_t)(pHeader->ulSequence - blockHeader(newest)->ulSequence) >= 0) {
+			newest = block;
+			isFound = true;
+		}
+	}
+
+	if (!isFound) return false;
+
+	/** the blocks following the newest one are the oldest of the ring */
+	_block = newest;
+	_blocksLeft = _blockCount;
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the next record
+* @param[out]	pRecord					header of the record
+* @param[out]	ppData					payload of the record, points into the image
+* @retval		false if there is no record left
+*/
+/************************************************************************************************************************/
+bool InputTraceReader::next(INPUT_TRACE_RECORD_HEADER_T *pRecord, const uint8_t **ppData)
+{
+	for (;;) {
+		if (!_hasBlock || _offset + sizeof(*pRecord) > _length) {
+			if (!loadBlock()) return false;
+			continue;
+		}
+
+		const uint8_t *p = _image + _block * INPUT_TRACE_BLOCK_SIZE + sizeof(INPUT_TRACE_BLOCK_HEADER_T) + _offset;
+
+		memcpy(pRecord, p, sizeof(*pRecord));
+
+		/** a damaged length ends the block */
+		if (_offset + sizeof(*pRecord) + pRecord->usLength > _length) {
+			_hasBlock = false;
+			continue;
+		}
+
+		*ppData = p + sizeof(*pRecord);
+		_offset += sizeof(*pRecord) + pRecord->usLength;
+
+		if (_hasTime && pRecord->bSource != INPUT_TRACE_SOURCE_BOOT) _timeUs += (uint32_t)(pRecord->ulTimeUs - _lastTimeUs);
+		else if (!_hasTime) _timeUs = pRecord->ulTimeUs;
+		_lastTimeUs = pRecord->ulTimeUs;
+		_hasTime = true;
+
+		return true;
+	}
+}
+
+bool InputTraceReader::loadBlock()
+{
+	const INPUT_TRACE_BLOCK_HEADER_T *pHeader;
+
+	while (_blocksLeft > 0) {
+		_blocksLeft--;
+		_block = (_block + 1) % _blockCount;
+		pHeader = blockHeader(_block);
+
+		if (pHeader != NULL) {
+			if (_hasSequence) _missingBlocks += pHeader->ulSequence - _sequence - 1;
+			_hasSequence = true;
+
+			_sequence = pHeader->ulSequence;
+			_length = pHeader->usLength;
+			_blockTime = pHeader->ulTime;
+			_droppedCount += pHeader->usDropped;
+			_offset = 0;
+			_hasBlock = true;
+
+			return true;
+		}
+	}
+
+	_hasBlock = false;
+
+	return false;
+}
+
+const INPUT_TRACE_BLOCK_HEADER_T *InputTraceReader::blockHeader(uint32_t block) const
+{
+	const INPUT_TRACE_BLOCK_HEADER_T *pHeader = (const INPUT_TRACE_BLOCK_HEADER_T *)(_image + block * INPUT_TRACE_BLOCK_SIZE);
+
+	if (pHeader->ulMagic != INPUT_TRACE_MAGIC || pHeader->usLength > INPUT_TRACE_BLOCK_DATA) return NULL;
+
+	return pHeader;
+}
@@ -0,0 +1,199 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			InputTrace.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		binary trace of the inputs consumed by the gateway, for the replay of a ride off-target
+* @details		Every input (BLE notify payload, GPS bytes, IMU FIFO burst, LMIC event) is recorded with its source and
+*				a micro second time stamp. The recording tasks copy the record into one of two RAM blocks under a short
+*				spin lock, a full block is handed over to one consumer task which writes it to a data partition. The
+*				partition is used as a ring of blocks, the sector holding the oldest blocks is erased when the ring
+*				wraps around to it. A record which finds both blocks in use is dropped and counted.
+*
+*				InputTraceReader walks a dump of the partition (e.g. read by esptool) oldest record first, on the
+*				device or on a host. The time stamps of the records are extended to 64 bit by the reader.
+*
+*	Flash block layout:
+*
+*	Offset			| Content
+*	----------------|---------------------------------------------------------------------------------------------
+*	0				| INPUT_TRACE_BLOCK_HEADER_T (magic, sequence, time, length, dropped records)
+*	16				| records: INPUT_TRACE_RECORD_HEADER_T followed by usLength payload bytes, usLength bytes in total
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	record() may be called from any task (not from an ISR), all other methods belong to one consumer task
+*	-	every begin() records an INPUT_TRACE_SOURCE_BOOT record, the time stamps start again from there
+*	-	without a flash partition (or on other platforms) nothing is recorded
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __INPUT_TRACE_PUBLIC_H
+#define __INPUT_TRACE_PUBLIC_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#elif defined(ARDUINO)
+	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+	unsigned long micros(); // supplied by the host build
+#endif
+
+#include <time.h>
+
+#if defined (__STDC__)
+#if !defined(__PACKED_PRE) || !defined(__PACKED_POST)
+#define __PACKED_PRE
+#define __PACKED_POST	__attribute__ ((packed))
+#endif
+#endif
+
+#if defined(ESP32)
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#endif
+
+#define INPUT_TRACE_BLOCK_SIZE			1024		//!< unit of the hand-over to the consumer and of the flash writes
+#define INPUT_TRACE_SECTOR_SIZE			4096		//!< flash erase unit
+#define INPUT_TRACE_MAX_PAYLOAD			256			//!< longest payload of a record, bounds the time in the spin lock
+#define INPUT_TRACE_MAGIC				0x49545231	//!< "ITR1"
+
+typedef enum INPUT_TRACE_SOURCE_Etag {
+	INPUT_TRACE_SOURCE_BOOT,						//!< begin() of the recorder, no payload
+	INPUT_TRACE_SOURCE_BMS_NOTIFY,					//!< notify payload of the BMS
+	INPUT_TRACE_SOURCE_CONTROLLER_NOTIFY,			//!< notify payload of the motor controller
+	INPUT_TRACE_SOURCE_GPS,							//!< raw bytes read from the GPS
+	INPUT_TRACE_SOURCE_IMU_FIFO,					//!< raw frames read from the IMU FIFO
+	INPUT_TRACE_SOURCE_LMIC_EVENT,					//!< LMIC event, see the user of the trace for the payload
+	INPUT_TRACE_SOURCE_MAX,
+} INPUT_TRACE_SOURCE_E;
+
+#define INPUT_TRACE_MASK(source)		(1U << (source))
+#define INPUT_TRACE_MASK_ALL			(INPUT_TRACE_MASK(INPUT_TRACE_SOURCE_MAX) - 1)
+
+typedef __PACKED_PRE struct INPUT_TRACE_BLOCK_HEADER_Ttag {
+	uint32_t	ulMagic;
+	uint32_t	ulSequence;							//!< increases with every written block
+	uint32_t	ulTime;								//!< time the block was written (epoch)
+	uint16_t	usLength;							//!< length of the records in the block
+	uint16_t	usDropped;							//!< records dropped since the previous block
+} __PACKED_POST INPUT_TRACE_BLOCK_HEADER_T;
+
+typedef __PACKED_PRE struct INPUT_TRACE_RECORD_HEADER_Ttag {
+	uint32_t	ulTimeUs;							//!< micros() of the recording
+	uint8_t		bSource;							//!< see INPUT_TRACE_SOURCE_E
+	uint8_t		bReserved;
+	uint16_t	usLength;							//!< length of the payload following the header
+} __PACKED_POST INPUT_TRACE_RECORD_HEADER_T;
+
+#define INPUT_TRACE_BLOCK_DATA			(INPUT_TRACE_BLOCK_SIZE - sizeof(INPUT_TRACE_BLOCK_HEADER_T))
+
+class InputTrace
+{
+ public:
+
+	 InputTrace();
+	 virtual ~InputTrace();
+
+	 bool begin(const char *partitionLabel, uint32_t sourceMask);
+
+	 /** recording tasks */
+	 bool record(uint8_t bSource, const void *pData, uint16_t usLength);
+	 bool isEnabled(uint8_t bSource) const { return (_sourceMask & INPUT_TRACE_MASK(bSource)) != 0; }
+
+	 /** consumer task */
+	 bool process();
+	 bool flush();
+
+	 uint32_t getRecordedCount() const { return _recordedCount; }
+	 uint32_t getDroppedCount() const { return _droppedCount; }
+	 uint32_t getWrittenBlocks() const { return _writtenBlocks; }
+
+private:
+	typedef enum BLOCK_STATE_Etag {
+		BLOCK_FREE,									//!< written to flash, may be filled again
+		BLOCK_FILLING,								//!< records are added by the recording tasks
+		BLOCK_FULL,									//!< owned by the consumer task
+	} BLOCK_STATE_E;
+
+	 void handOver();
+	 bool store(uint8_t block);
+	 void mount();
+	 uint32_t blockAddress(uint32_t block) const { return block * INPUT_TRACE_BLOCK_SIZE; }
+	 bool flashRead(uint32_t address, void *pData, size_t len);
+	 bool flashWrite(uint32_t address, const void *pData, size_t len);
+	 bool flashErase(uint32_t address, size_t len);
+
+	/** RAM blocks, records are added to _fill */
+	uint8_t _block[2][INPUT_TRACE_BLOCK_SIZE];
+	uint16_t _used[2];								//!< bytes of records in the block
+	uint16_t _dropped[2];							//!< records dropped before the block was handed over
+	volatile uint8_t _state[2];
+	uint8_t _fill;
+	uint16_t _pendingDropped;						//!< records dropped since the last hand-over
+#if defined(ESP32)
+	portMUX_TYPE _xMux;
+#endif
+	volatile uint32_t _sourceMask;
+
+	/** flash ring of blocks */
+#if defined(ESP32)
+	const esp_partition_t *_partition;
+#endif
+	uint32_t _blockCount;
+	uint32_t _writeBlock;
+	uint32_t _sequence;
+
+	uint32_t _recordedCount;
+	uint32_t _droppedCount;
+	uint32_t _writtenBlocks;
+};
+
+class InputTraceReader
+{
+ public:
+
+	 InputTraceReader();
+
+	 bool begin(const uint8_t *pImage, size_t len);
+	 bool next(INPUT_TRACE_RECORD_HEADER_T *pRecord, const uint8_t **ppData);
+
+	 uint64_t getTimeUs() const { return _timeUs; }		//!< a boot record continues at the time of the record before
+	 uint32_t getBlockTime() const { return _blockTime; }
+	 uint32_t getDroppedCount() const { return _droppedCount; }
+	 uint32_t getMissingBlocks() const { return _missingBlocks; }
+
+private:
+	 bool loadBlock();
+	 const INPUT_TRACE_BLOCK_HEADER_T *blockHeader(uint32_t block) const;
+
+	const uint8_t *_image;
+	uint32_t _blockCount;
+	uint32_t _blocksLeft;							//!< blocks not visited yet
+	uint32_t _block;								//!< current block, starts at the newest one
+	uint32_t _offset;								//!< next record in the current block
+	uint32_t _length;								//!< length of the records of the current block
+	uint32_t _sequence;								//!< sequence of the current block
+	bool _hasSequence;
+	bool _hasBlock;
+	bool _hasTime;
+	uint32_t _lastTimeUs;
+	uint64_t _timeUs;								//!< extended time stamp of the last record
+	uint32_t _blockTime;
+	uint32_t _droppedCount;
+	uint32_t _missingBlocks;
+};
+
+#endif
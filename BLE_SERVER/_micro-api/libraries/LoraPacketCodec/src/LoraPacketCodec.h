@@ -0,0 +1,165 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			LoraPacketCodec.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		key/delta frame encoder and reference decoder for the 29 byte lora data packet
+* @details		Every LORA_CODEC_KEY_INTERVAL-th uplink is a key frame, the unchanged 29 byte packet. The uplinks in
+*				between are delta frames against the last key frame, so a lost delta frame does not affect the others:
+*
+*	Byte			| Content
+*	----------------|---------------------------------------------------------------------------------------------
+*	0				| key offset, number of uplinks since the key frame (frame counter of the key = FCnt - offset)
+*	1..				| field mask as varint, bit n set if field n (LORA_CODEC_FIELD_E) differs from the key frame
+*	..				| value of every set field in field order: single byte fields raw, all others as zigzag varint
+*					| of the difference to the key frame. Position in micro degree, altitude in decimeter.
+*
+*	Several samples can be packed into one batch frame (LoraPacketBatch), the first sample is a key frame, the others
+*	are delta frames against it, so a batch is decoded without any other uplink:
+*
+*	Byte			| Content
+*	----------------|---------------------------------------------------------------------------------------------
+*	0..3			| time of the first sample (epoch, big endian)
+*	4..				| per sample: zigzag varint of the time difference to the previous sample in seconds, frame
+*					| length, key frame (length LORA_CODEC_PACKET_LEN) or delta frame against the last key frame
+*
+*	Fields equal to the key frame are omitted. Decoded positions are rounded to 1 micro degree, altitudes to 1 dm.
+*	The codec only works on the byte layout of LORA_DATA_PACKET_T (big endian fields), it has no dependency on the
+*	Arduino core and builds on the host for the backend decoder (extras/lora_decode.cpp).
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __LORA_PACKET_CODEC_PUBLIC_H
+#define __LORA_PACKET_CODEC_PUBLIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define LORA_CODEC_PACKET_LEN			29			//!< size of LORA_DATA_PACKET_T
+#define LORA_CODEC_KEY_INTERVAL			8			//!< default number of uplinks per key frame
+#define LORA_CODEC_PORT_KEY				1			//!< key frame, the raw packet
+#define LORA_CODEC_PORT_DELTA			2			//!< delta frame against the last key frame
+#define LORA_CODEC_PORT_BATCH			4			//!< several samples in one batch frame
+#define LORA_BATCH_HEADER_LEN			4			//!< time of the first sample
+#define LORA_BATCH_MAX_LEN				222			//!< largest application payload of all data rates
+
+typedef enum LORA_CODEC_FIELD_Etag {
+	LORA_FIELD_LATITUDE,					//!< float, micro degree
+	LORA_FIELD_LONGITUDE,					//!< float, micro degree
+	LORA_FIELD_SPEED,						//!< raw byte
+	LORA_FIELD_HEART_BPM,					//!< raw byte
+	LORA_FIELD_BMS_VOLTAGE,					//!< uint16
+	LORA_FIELD_CONTROLLER_VOLTAGE,			//!< uint16
+	LORA_FIELD_ALTITUDE,					//!< float, decimeter
+	LORA_FIELD_DISTANCE,					//!< uint16
+	LORA_FIELD_SESSION_TIME,				//!< uint32
+	LORA_FIELD_MPU_FLAGS,					//!< raw byte
+	LORA_FIELD_CRASH_TIME,					//!< uint32
+	LORA_FIELD_MAX,
+} LORA_CODEC_FIELD_E;
+
+class LoraPacketCodec
+{
+public:
+
+	LoraPacketCodec(uint8_t keyInterval = LORA_CODEC_KEY_INTERVAL);
+
+	void reset();
+	void skip();
+	size_t encode(const uint8_t *pPacket, uint8_t *pFrame, bool &isKeyFrame);
+	static bool decodeDelta(const uint8_t *pKey, const uint8_t *pFrame, size_t len, uint8_t *pPacket, uint8_t *pKeyOffset);
+
+	uint32_t getFrameCount() const { return _frameCount; }
+	uint32_t getEncodedBytes() const { return _encodedBytes; }
+
+	static size_t writeVarint(uint8_t *p, uint32_t value);
+	static bool readVarint(const uint8_t *p, size_t len, size_t &idx, uint32_t &value);
+	static uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+	static int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+private:
+	static bool fieldValue(const uint8_t *pPacket, uint8_t field, int32_t &value);
+
+	uint8_t		_abKey[LORA_CODEC_PACKET_LEN];		//!< last key frame, reference of the delta frames
+	uint8_t		_keyInterval;
+	uint8_t		_keyOffset;							//!< uplinks since the key frame
+	bool		_isKeyValid;
+
+	uint32_t	_frameCount;
+	uint32_t	_encodedBytes;
+};
+
+class LoraPacketBatch
+{
+public:
+
+	LoraPacketBatch();
+
+	void begin(size_t maxLength);
+	bool add(uint32_t ulTime, const uint8_t *pPacket);
+
+	const uint8_t *data() const { return _abFrame; }
+	size_t length() const { return _length; }
+	uint8_t count() const { return _count; }
+
+	/**
+	* reference decoder of a batch frame, calls onPacket(uint32_t ulTime, const uint8_t *pPacket) for every sample
+	* @retval	number of samples, 0 if the frame is invalid
+	*/
+	template <class Handler>
+	static uint8_t decode(const uint8_t *pFrame, size_t len, Handler onPacket) {
+
+		uint8_t abKey[LORA_CODEC_PACKET_LEN];
+		uint8_t abPacket[LORA_CODEC_PACKET_LEN];
+		size_t idx = LORA_BATCH_HEADER_LEN;
+		uint32_t ulTime, diff;
+		uint8_t count = 0;
+
+		if (len <= LORA_BATCH_HEADER_LEN) return 0;
+		ulTime = ((uint32_t)pFrame[0] << 24) | ((uint32_t)pFrame[1] << 16) | ((uint32_t)pFrame[2] << 8) | pFrame[3];
+
+		while (idx < len) {
+			if (!LoraPacketCodec::readVarint(pFrame, len, idx, diff) || idx >= len) return 0;
+			size_t frameLen = pFrame[idx++];
+			if (idx + frameLen > len) return 0;
+
+			if (frameLen == LORA_CODEC_PACKET_LEN) {
+				memcpy(abKey, &pFrame[idx], LORA_CODEC_PACKET_LEN);
+				memcpy(abPacket, abKey, LORA_CODEC_PACKET_LEN);
+			}
+			else if (count == 0 || !LoraPacketCodec::decodeDelta(abKey, &pFrame[idx], frameLen, abPacket, nullptr)) {
+				return 0;
+			}
+
+			ulTime += (uint32_t)LoraPacketCodec::unzigzag(diff);
+			onPacket(ulTime, (const uint8_t*)abPacket);
+			idx += frameLen;
+			count++;
+		}
+
+		return count;
+	}
+
+private:
+	LoraPacketCodec	_codec;							//!< key frame of the batch
+	uint8_t			_abFrame[LORA_BATCH_MAX_LEN];
+	size_t			_maxLength;
+	size_t			_length;
+	uint8_t			_count;
+	uint32_t		_lastTime;
+};
+
+#endif
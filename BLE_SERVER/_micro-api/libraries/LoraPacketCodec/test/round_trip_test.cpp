@@ -0,0 +1,321 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			round_trip_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host round trip test of the key/delta frames and the batch frames of LoraPacketCodec
+* @details		Every encoded sample has to come out of the reference decoders as it went in, positions and altitude
+*				at their fixed point resolution: unchanged samples, the largest negative differences of every field,
+*				the key frame after a gap of the link and a batch that fills the payload limit to the last byte.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <math.h>
+#include <vector>
+#include <LoraPacketCodec.h>
+#include "HostTest.h"
+
+/** offsets in LORA_DATA_PACKET_T */
+#define OFFSET_LATITUDE			0
+#define OFFSET_LONGITUDE		4
+#define OFFSET_ALTITUDE			8
+#define OFFSET_BMS_VOLTAGE		12
+#define OFFSET_SPEED			16
+#define OFFSET_SESSION_TIME		19
+#define OFFSET_CRASH_TIME		25
+
+/** payload limits of loraPayloadLimit(), DR0..DR2 and DR4/DR5 of EU868 */
+#define PAYLOAD_LIMIT_SF12		49
+#define PAYLOAD_LIMIT_SF8		113
+
+/** entry of a batch: time difference, frame length, key offset and mask of a delta frame */
+#define ENTRY_LEN_KEY			(1 + 1 + LORA_CODEC_PACKET_LEN)
+#define ENTRY_LEN_ZERO_DELTA	(1 + 1 + 2)
+#define ENTRY_LEN_BYTE_DELTA	(ENTRY_LEN_ZERO_DELTA + 1)
+
+typedef struct SAMPLE_Ttag {
+	uint32_t	ulTime;
+	uint8_t		abPacket[LORA_CODEC_PACKET_LEN];
+} SAMPLE_T;
+
+static void setBigEndian(uint8_t *pPacket, uint8_t offset, uint8_t size, uint32_t value)
+{
+	for (uint8_t i = size; i > 0; i--) {
+		pPacket[offset + i - 1] = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+static uint32_t getBigEndian(const uint8_t *pPacket, uint8_t offset, uint8_t size)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < size; i++) value = (value << 8) | pPacket[offset + i];
+	return value;
+}
+
+static void setFloat(uint8_t *pPacket, uint8_t offset, float fValue)
+{
+	uint32_t raw;
+	memcpy(&raw, &fValue, sizeof(raw));
+	setBigEndian(pPacket, offset, 4, raw);
+}
+
+static long scaledFloat(const uint8_t *pPacket, uint8_t offset, double scale)
+{
+	uint32_t raw = getBigEndian(pPacket, offset, 4);
+	float fValue;
+	memcpy(&fValue, &raw, sizeof(fValue));
+	return lround((double)fValue * scale);
+}
+
+static void makePacket(uint8_t *pPacket, uint8_t seed)
+{
+	for (uint8_t i = 0; i < LORA_CODEC_PACKET_LEN; i++) pPacket[i] = (uint8_t)(seed + 7 * i);
+	setFloat(pPacket, OFFSET_LATITUDE, 50.833717f + seed * 0.0001f);
+	setFloat(pPacket, OFFSET_LONGITUDE, 12.927125f - seed * 0.0001f);
+	setFloat(pPacket, OFFSET_ALTITUDE, 312.4f + seed);
+}
+
+/** equal at the resolution of the codec */
+static bool isSamePacket(const uint8_t *pPacket, const uint8_t *pDecoded)
+{
+	if (scaledFloat(pPacket, OFFSET_LATITUDE, 1e6) != scaledFloat(pDecoded, OFFSET_LATITUDE, 1e6)) return false;
+	if (scaledFloat(pPacket, OFFSET_LONGITUDE, 1e6) != scaledFloat(pDecoded, OFFSET_LONGITUDE, 1e6)) return false;
+	if (scaledFloat(pPacket, OFFSET_ALTITUDE, 10) != scaledFloat(pDecoded, OFFSET_ALTITUDE, 10)) return false;
+
+	return memcmp(&pPacket[OFFSET_BMS_VOLTAGE], &pDecoded[OFFSET_BMS_VOLTAGE], LORA_CODEC_PACKET_LEN - OFFSET_BMS_VOLTAGE) == 0;
+}
+
+/** encode a sample and decode it against the key frame of the receiver */
+static size_t roundTrip(LoraPacketCodec &codec, uint8_t *pKey, const uint8_t *pPacket, bool &isKeyFrame)
+{
+	uint8_t abFrame[LORA_CODEC_PACKET_LEN];
+	uint8_t abDecoded[LORA_CODEC_PACKET_LEN];
+	uint8_t keyOffset = 0;
+	size_t len = codec.encode(pPacket, abFrame, isKeyFrame);
+
+	if (isKeyFrame) {
+		CHECK_EQ(len, LORA_CODEC_PACKET_LEN);
+		CHECK(memcmp(abFrame, pPacket, LORA_CODEC_PACKET_LEN) == 0);
+		memcpy(pKey, abFrame, LORA_CODEC_PACKET_LEN);
+		return len;
+	}
+
+	CHECK(len < LORA_CODEC_PACKET_LEN);
+	CHECK(LoraPacketCodec::decodeDelta(pKey, abFrame, len, abDecoded, &keyOffset));
+	CHECK(keyOffset > 0);
+	CHECK(isSamePacket(pPacket, abDecoded));
+
+	return len;
+}
+
+/** an unchanged sample is the key offset and an empty field mask */
+static void testZeroDelta()
+{
+	LoraPacketCodec codec;
+	uint8_t abKey[LORA_CODEC_PACKET_LEN];
+	uint8_t abPacket[LORA_CODEC_PACKET_LEN];
+	bool isKeyFrame;
+
+	makePacket(abPacket, 1);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(isKeyFrame);
+
+	for (uint8_t i = 0; i < 3; i++) {
+		CHECK_EQ(roundTrip(codec, abKey, abPacket, isKeyFrame), 2);
+		CHECK(!isKeyFrame);
+	}
+}
+
+/** the largest step down of every field kind, one field per delta frame */
+static void testMaxNegativeDelta()
+{
+	LoraPacketCodec codec;
+	uint8_t abKey[LORA_CODEC_PACKET_LEN];
+	uint8_t abFirst[LORA_CODEC_PACKET_LEN];
+	uint8_t abPacket[LORA_CODEC_PACKET_LEN];
+	bool isKeyFrame;
+
+	makePacket(abFirst, 2);
+	setFloat(abFirst, OFFSET_LATITUDE, 90.0f);
+	setFloat(abFirst, OFFSET_LONGITUDE, 180.0f);
+	setFloat(abFirst, OFFSET_ALTITUDE, 100000.0f);
+	setBigEndian(abFirst, OFFSET_BMS_VOLTAGE, 2, 0xFFFF);
+	abFirst[OFFSET_SPEED] = 0xFF;
+	setBigEndian(abFirst, OFFSET_SESSION_TIME, 4, 0x7FFFFFFF);
+	setBigEndian(abFirst, OFFSET_CRASH_TIME, 4, 0);
+
+	roundTrip(codec, abKey, abFirst, isKeyFrame);
+	CHECK(isKeyFrame);
+
+	/** -180 and -360 degree */
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setFloat(abPacket, OFFSET_LATITUDE, -90.0f);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(!isKeyFrame);
+
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setFloat(abPacket, OFFSET_LONGITUDE, -180.0f);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(!isKeyFrame);
+
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setFloat(abPacket, OFFSET_ALTITUDE, -100000.0f);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(!isKeyFrame);
+
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setBigEndian(abPacket, OFFSET_BMS_VOLTAGE, 2, 0);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(!isKeyFrame);
+
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	abPacket[OFFSET_SPEED] = 0;
+	CHECK_EQ(roundTrip(codec, abKey, abPacket, isKeyFrame), 3);
+	CHECK(!isKeyFrame);
+
+	/** INT32_MIN, zigzag 0xFFFFFFFF, the longest varint, behind the key offset and a two byte mask */
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setBigEndian(abPacket, OFFSET_CRASH_TIME, 4, 0x80000000);
+	CHECK_EQ(roundTrip(codec, abKey, abPacket, isKeyFrame), 1 + 2 + 5);
+	CHECK(!isKeyFrame);
+
+	memcpy(abPacket, abFirst, sizeof(abPacket));
+	setBigEndian(abPacket, OFFSET_SESSION_TIME, 4, 0xFFFFFFFF);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(!isKeyFrame);
+
+	/** all of them at once do not fit into a delta frame */
+	setFloat(abPacket, OFFSET_LATITUDE, -90.0f);
+	setFloat(abPacket, OFFSET_LONGITUDE, -180.0f);
+	setFloat(abPacket, OFFSET_ALTITUDE, -100000.0f);
+	setBigEndian(abPacket, OFFSET_BMS_VOLTAGE, 2, 0);
+	abPacket[OFFSET_SPEED] = 0;
+	setBigEndian(abPacket, OFFSET_CRASH_TIME, 4, 0x80000000);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(isKeyFrame);
+}
+
+/** after a gap the sender starts over with a key frame, the deltas refer to it and not to the key before the gap */
+static void testKeyFrameAfterGap()
+{
+	LoraPacketCodec codec;
+	uint8_t abKey[LORA_CODEC_PACKET_LEN];
+	uint8_t abPacket[LORA_CODEC_PACKET_LEN];
+	uint8_t abFrame[LORA_CODEC_PACKET_LEN];
+	uint8_t abDecoded[LORA_CODEC_PACKET_LEN];
+	uint8_t keyOffset;
+	bool isKeyFrame;
+
+	for (uint8_t seed = 0; seed < 3; seed++) {
+		makePacket(abPacket, seed);
+		roundTrip(codec, abKey, abPacket, isKeyFrame);
+		CHECK_EQ(isKeyFrame, seed == 0);
+	}
+
+	/** lost link, the samples of the gap went with their sample time */
+	codec.reset();
+	makePacket(abPacket, 40);
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(isKeyFrame);
+
+	abPacket[OFFSET_SPEED]++;
+	size_t len = codec.encode(abPacket, abFrame, isKeyFrame);
+	CHECK(!isKeyFrame);
+	CHECK(LoraPacketCodec::decodeDelta(abKey, abFrame, len, abDecoded, &keyOffset));
+	CHECK_EQ(keyOffset, 1);
+	CHECK(isSamePacket(abPacket, abDecoded));
+
+	/** the key interval counts from the new key frame */
+	for (uint8_t i = 2; i < LORA_CODEC_KEY_INTERVAL; i++) {
+		roundTrip(codec, abKey, abPacket, isKeyFrame);
+		CHECK(!isKeyFrame);
+	}
+	roundTrip(codec, abKey, abPacket, isKeyFrame);
+	CHECK(isKeyFrame);
+}
+
+/**
+* samples of a batch of exactly limit bytes: the key frame, unchanged samples and samples with one changed byte field,
+* the last sample is one that does not fit anymore
+*/
+static std::vector<SAMPLE_T> fillingSamples(size_t limit)
+{
+	std::vector<SAMPLE_T> samples;
+	SAMPLE_T tSample;
+	size_t rest = limit - LORA_BATCH_HEADER_LEN - ENTRY_LEN_KEY;
+	size_t byteDeltas = 0;
+
+	while ((rest - byteDeltas * ENTRY_LEN_BYTE_DELTA) % ENTRY_LEN_ZERO_DELTA) byteDeltas++;
+	size_t zeroDeltas = (rest - byteDeltas * ENTRY_LEN_BYTE_DELTA) / ENTRY_LEN_ZERO_DELTA;
+
+	tSample.ulTime = 1760000000;
+	makePacket(tSample.abPacket, 3);
+	samples.push_back(tSample);
+
+	for (size_t i = 0; i < byteDeltas + zeroDeltas + 1; i++) {
+		tSample.ulTime += 10;
+		makePacket(tSample.abPacket, 3);
+		if (i < byteDeltas) tSample.abPacket[OFFSET_SPEED] = (uint8_t)(i + 1);
+		samples.push_back(tSample);
+	}
+
+	return samples;
+}
+
+static void testBatchFillsLimit(size_t limit)
+{
+	LoraPacketBatch batch;
+	std::vector<SAMPLE_T> samples = fillingSamples(limit);
+	size_t decoded = 0;
+	bool isDecodedSame = true;
+
+	batch.begin(limit);
+	for (size_t i = 0; i + 1 < samples.size(); i++) CHECK(batch.add(samples[i].ulTime, samples[i].abPacket));
+
+	CHECK_EQ(batch.length(), limit);
+	CHECK_EQ(batch.count(), samples.size() - 1);
+
+	/** not even an unchanged sample fits */
+	CHECK(!batch.add(samples.back().ulTime, samples.back().abPacket));
+	CHECK_EQ(batch.length(), limit);
+
+	CHECK_EQ(LoraPacketBatch::decode(batch.data(), batch.length(), [&](uint32_t ulTime, const uint8_t *pPacket) {
+		if (decoded < samples.size() && (ulTime != samples[decoded].ulTime || !isSamePacket(samples[decoded].abPacket, pPacket))) {
+			isDecodedSame = false;
+		}
+		decoded++;
+	}), samples.size() - 1);
+	CHECK_EQ(decoded, samples.size() - 1);
+	CHECK(isDecodedSame);
+
+	/** one byte less, the last sample goes into the next batch */
+	batch.begin(limit - 1);
+	size_t added = 0;
+	while (added < samples.size() && batch.add(samples[added].ulTime, samples[added].abPacket)) added++;
+	CHECK_EQ(added, samples.size() - 2);
+	CHECK(batch.length() < limit);
+}
+
+int main()
+{
+	testZeroDelta();
+	testMaxNegativeDelta();
+	testKeyFrameAfterGap();
+	testBatchFillsLimit(PAYLOAD_LIMIT_SF12);
+	testBatchFillsLimit(PAYLOAD_LIMIT_SF8);
+
+	return HOST_TEST_RESULT();
+}
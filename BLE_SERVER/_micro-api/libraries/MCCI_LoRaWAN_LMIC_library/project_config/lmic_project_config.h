@@ -6,4 +6,9 @@
 // #define LMIC_COUNTRY_CODE LMIC_COUNTRY_CODE_JP	/* for as923-JP */
 //#define CFG_in866 1
 // #define CFG_sx1276_radio 1
-//#define LMIC_USE_INTERRUPTS
+// dio edges are time stamped by a gpio interrupt instead of polling the pins
+#define LMIC_USE_INTERRUPTS
+// room for batched uplinks at DR3 and above, the frame is limited per data rate by the application
+#define LMIC_MAX_FRAME_LENGTH 128
+// table driven aes with cached key schedules, the crypto runs in the rx window budget
+#define USE_TTABLE_AES
@@ -18,6 +18,9 @@
 #include "hal.h"
 // we may need some things from stdio.
 #include <stdio.h>
+#if defined(ESP32)
+#include "esp_timer.h"
+#endif
 
 // -----------------------------------------------------------------------------
 // I/O
@@ -28,6 +31,13 @@ static Arduino_LMIC::HalConfiguration_t nullHalConig;
 
 static void hal_interrupt_init(); // Fwd declaration
 
+// ISRs and what they call must be in IRAM on ESP32, flash may be busy
+#if defined(ESP32)
+#define HAL_ISR_ATTR IRAM_ATTR
+#else
+#define HAL_ISR_ATTR
+#endif
+
 static void hal_io_init () {
     // NSS and DIO0 are required, DIO1 is required for LoRa, DIO2 for FSK
     ASSERT(plmic_pins->nss != LMIC_UNUSED_PIN);
@@ -108,21 +118,56 @@ static void hal_io_check() {
     }
 }
 
+#if defined(ESP32)
+namespace Arduino_LMIC {
+void hal_set_irq_task(void *pTask) {
+    (void) pTask;
+}
+}; // namespace Arduino_LMIC
+#endif
+
+#else
+// Interrupt handlers. The ISRs only take the time stamp of the edge, the
+// radio is serviced from hal_io_check() in task context (no SPI in ISRs).
+static volatile ostime_t interrupt_time[NUM_DIO] = {0};
+// DIO lines wired to the same pin as a lower DIO, they share its interrupt
+static bool dio_shared[NUM_DIO] = {0};
+
+#if defined(ESP32)
+static TaskHandle_t irq_task = nullptr;
+
+static void HAL_ISR_ATTR hal_isrWakeTask() {
+    BaseType_t woken = pdFALSE;
+    if (irq_task != nullptr) {
+        vTaskNotifyGiveFromISR(irq_task, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+    }
+}
+
+namespace Arduino_LMIC {
+void hal_set_irq_task(void *pTask) {
+    irq_task = (TaskHandle_t) pTask;
+}
+}; // namespace Arduino_LMIC
 #else
-// Interrupt handlers
-static ostime_t interrupt_time[NUM_DIO] = {0};
+static void hal_isrWakeTask() {}
+#endif
 
-static void hal_isrPin0() {
-    ostime_t now = os_getTime();
+static void HAL_ISR_ATTR hal_isrPin0() {
+    ostime_t now = hal_ticks();
     interrupt_time[0] = now ? now : 1;
+    hal_isrWakeTask();
 }
-static void hal_isrPin1() {
-    ostime_t now = os_getTime();
+static void HAL_ISR_ATTR hal_isrPin1() {
+    ostime_t now = hal_ticks();
     interrupt_time[1] = now ? now : 1;
+    hal_isrWakeTask();
 }
-static void hal_isrPin2() {
-    ostime_t now = os_getTime();
+static void HAL_ISR_ATTR hal_isrPin2() {
+    ostime_t now = hal_ticks();
     interrupt_time[2] = now ? now : 1;
+    hal_isrWakeTask();
 }
 
 typedef void (*isr_t)();
@@ -133,6 +178,17 @@ static void hal_interrupt_init() {
       if (plmic_pins->dio[i] == LMIC_UNUSED_PIN)
           continue;
 
+      // boards with all DIOs on one pin get one interrupt for all of them,
+      // the radio handler tells the events apart by the IRQ flags register
+      dio_shared[i] = false;
+      for (uint8_t j = 0; j < i; ++j) {
+          if (plmic_pins->dio[j] == plmic_pins->dio[i])
+              dio_shared[i] = true;
+      }
+      if (dio_shared[i])
+          continue;
+
+      pinMode(plmic_pins->dio[i], INPUT);
       attachInterrupt(digitalPinToInterrupt(plmic_pins->dio[i]), interrupt_fns[i], RISING);
   }
 }
@@ -141,13 +197,20 @@ static void hal_io_check() {
     uint8_t i;
     for (i = 0; i < NUM_DIO; ++i) {
         ostime_t iTime;
-        if (plmic_pins->dio[i] == LMIC_UNUSED_PIN)
+        if (plmic_pins->dio[i] == LMIC_UNUSED_PIN || dio_shared[i])
             continue;
 
         iTime = interrupt_time[i];
         if (iTime) {
             interrupt_time[i] = 0;
             radio_irq_handler_v2(i, iTime);
+
+            // on a shared line a second DIO may have been raised before the
+            // first was cleared, there is no new edge for it
+            if (digitalRead(plmic_pins->dio[i])) {
+                ostime_t now = hal_ticks();
+                interrupt_time[i] = now ? now : 1;
+            }
         }
     }
 }
@@ -208,6 +271,13 @@ static void hal_time_init () {
     // Nothing to do
 }
 
+#if defined(ESP32)
+// the 64 bit esp timer does not overflow, so no overflow tracking is needed
+// and the time can be taken from ISRs as well
+u4_t HAL_ISR_ATTR hal_ticks () {
+    return (u4_t)(esp_timer_get_time() >> US_PER_OSTICK_EXPONENT);
+}
+#else
 u4_t hal_ticks () {
     // Because micros() is scaled down in this function, micros() will
     // overflow before the tick timer should, causing the tick timer to
@@ -252,6 +322,7 @@ u4_t hal_ticks () {
     // micros() unmodified), 8 leaves no room for the overlapping bit.
     static_assert(US_PER_OSTICK_EXPONENT > 0 && US_PER_OSTICK_EXPONENT < 8, "Invalid US_PER_OSTICK_EXPONENT value");
 }
+#endif // ESP32
 
 // Returns the number of ticks until time. Negative values indicate that
 // time has already passed.
@@ -273,10 +344,45 @@ void hal_waitUntil (u4_t time) {
 
 // check and rewind for target time
 u1_t hal_checkTimer (u4_t time) {
-    // No need to schedule wakeup, since we're not sleeping
+    // No need to schedule wakeup, the task blocks outside of the run loop
+    // until the deadline (see hal_waitForEvent())
     return delta_time(time) <= 0;
 }
 
+#if defined(ESP32)
+void Arduino_LMIC::hal_waitForEvent(uint32_t maxWaitMs) {
+    ostime_t deadline;
+    uint32_t waitMs = maxWaitMs;
+
+#if !defined(LMIC_USE_INTERRUPTS)
+    // the DIO pins are polled, never wait longer than a tick
+    if (waitMs > 1)
+        waitMs = 1;
+#endif
+
+    if (os_queryNextDeadline(&deadline)) {
+        s4_t delta = delta_time(deadline);
+        if (delta <= 0)
+            return;
+
+        // rounded down, the job is not started late. The remaining sub ms
+        // part is spun by the run loop, the rx windows are opened by
+        // hal_waitUntil() anyway, RX_RAMPUP after their job.
+        uint32_t ms = (uint32_t) osticks2ms(delta);
+        if (ms < waitMs)
+            waitMs = ms;
+    }
+
+    TickType_t ticks = waitMs / portTICK_PERIOD_MS;
+    if (ticks == 0)
+        return;
+
+    // a notification given while the run loop was busy is still pending
+    // here, so an irq is never missed
+    ulTaskNotifyTake(pdTRUE, ticks);
+}
+#endif // ESP32
+
 static uint8_t irqlevel = 0;
 
 void hal_disableIRQs () {
@@ -301,7 +407,8 @@ void hal_enableIRQs () {
 }
 
 void hal_sleep () {
-    // Not implemented
+    // Called with IRQs disabled, so nothing to do here. Tasks sleep between
+    // run loop calls instead, see hal_waitForEvent().
 }
 
 // -----------------------------------------------------------------------------
@@ -153,13 +153,19 @@
 // byte-oriented ones, making it use a lot less flash space (but it is
 // also about twice as slow as the original).
 // #define USE_IDEETRON_AES
+//
+// This selects a table driven implementation for 32-bit processors
+// (1.3 KB of tables), which expands the key schedule once per key and
+// keeps the schedules of the last two keys (network and application
+// session key).
+// #define USE_TTABLE_AES
 
-#if ! (defined(USE_ORIGINAL_AES) || defined(USE_IDEETRON_AES))
+#if ! (defined(USE_ORIGINAL_AES) || defined(USE_IDEETRON_AES) || defined(USE_TTABLE_AES))
 # define USE_IDEETRON_AES
 #endif
 
-#if defined(USE_ORIGINAL_AES) && defined(USE_IDEETRON_AES)
-# error "You may define at most one of USE_ORIGINAL_AES and USE_IDEETRON_AES"
+#if (defined(USE_ORIGINAL_AES) + defined(USE_IDEETRON_AES) + defined(USE_TTABLE_AES)) > 1
+# error "You may define at most one of USE_ORIGINAL_AES, USE_IDEETRON_AES and USE_TTABLE_AES"
 #endif
 
 // LMIC_DISABLE_DR_LEGACY
@@ -116,6 +116,25 @@ void os_setTimedCallback (osjob_t* job, ostime_t time, osjobcb_t cb) {
     hal_enableIRQs();
 }
 
+// get the time the run loop has to run next, for callers which block
+// between os_runloop_once() calls.
+//   - return 0 if no job is queued at all (wait for a radio irq only)
+//   - otherwise set *pDeadline to the deadline of the next timed job, or to
+//     now if a job is runnable, and return 1
+bit_t os_queryNextDeadline (ostime_t* pDeadline) {
+    bit_t result = 1;
+    hal_disableIRQs();
+    if(OS.runnablejobs) {
+        *pDeadline = os_getTime();
+    } else if(OS.scheduledjobs) {
+        *pDeadline = OS.scheduledjobs->deadline;
+    } else {
+        result = 0;
+    }
+    hal_enableIRQs();
+    return result;
+}
+
 // execute jobs from timer and from run queue
 void os_runloop () {
     while(1) {
@@ -0,0 +1,148 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SpanTrace.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		span and instant event tracing of the FreeRTOS tasks, dumped as Chrome trace JSON
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include "SpanTrace.h"
+#include "esp_timer.h"
+
+#define RING_MASK			(SPAN_TRACE_RING_EVENTS - 1)
+
+SpanTrace::SpanTrace()
+{
+	_pNames = NULL;
+	_bNameCount = 0;
+	_isEnabled = false;
+	_ulOverwrittenCount = 0;
+
+	for (uint8_t core = 0; core < SPAN_TRACE_CORES; core++) {
+		_aulHead[core] = 0;
+	}
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		set the names of the span ids and start recording
+* @param[in]	names					name of every span id, has to stay valid
+* @param[in]	nameCount				number of names
+* @retval		none
+*/
+/************************************************************************************************************************/
+void SpanTrace::begin(const char * const *names, uint8_t nameCount)
+{
+	_pNames = names;
+	_bNameCount = nameCount;
+	_isEnabled = true;
+}
+
+void SpanTrace::add(uint8_t bType, uint8_t bId, uint16_t usArg)
+{
+	uint32_t core = xPortGetCoreID();
+
+	/** reserve the slot, a task preempting this one on the same core takes the next slot */
+	uint32_t slot = __atomic_fetch_add(&_aulHead[core], 1, __ATOMIC_RELAXED) & RING_MASK;
+	SPAN_TRACE_EVENT_T *pEvent = &_atRing[core][slot];
+
+	pEvent->ulTimeUs = (uint32_t)esp_timer_get_time();
+	pEvent->xTask = xTaskGetCurrentTaskHandle();
+	pEvent->bType = bType;
+	pEvent->bId = bId;
+	pEvent->usArg = usArg;
+}
+
+uint8_t SpanTrace::taskIndex(TaskHandle_t xTask, TaskHandle_t *axTasks, uint8_t *pbTaskCount)
+{
+	for (uint8_t i = 0; i < *pbTaskCount; i++) {
+		if (axTasks[i] == xTask) return i;
+	}
+
+	/** all further tasks share the last index */
+	if (*pbTaskCount == SPAN_TRACE_MAX_TASKS) return SPAN_TRACE_MAX_TASKS - 1;
+
+	axTasks[*pbTaskCount] = xTask;
+	return (*pbTaskCount)++;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		write all recorded events as Chrome trace JSON (array format) and empty the rings
+* @param[in]	out						stream of the dump, e.g. Serial
+* @retval		none
+*/
+/************************************************************************************************************************/
+void SpanTrace::dump(Print &out)
+{
+	static const char acPhase[] = { 'B', 'E', 'i' };
+	TaskHandle_t axTasks[SPAN_TRACE_MAX_TASKS];
+	uint8_t bTaskCount = 0;
+	uint32_t ulStartUs = (uint32_t)esp_timer_get_time();
+	bool wasEnabled = _isEnabled;
+	bool isFirst = true;
+
+	_isEnabled = false;
+
+	/** the oldest event is the origin of the time axis, the 32 bit time stamps wrap after 71 minutes */
+	uint32_t ulOriginUs = ulStartUs;
+	for (uint8_t core = 0; core < SPAN_TRACE_CORES; core++) {
+		uint32_t head = _aulHead[core];
+		uint32_t count = (head > SPAN_TRACE_RING_EVENTS) ? SPAN_TRACE_RING_EVENTS : head;
+
+		if (count > 0 && (ulStartUs - _atRing[core][(head - count) & RING_MASK].ulTimeUs) > (ulStartUs - ulOriginUs)) {
+			ulOriginUs = _atRing[core][(head - count) & RING_MASK].ulTimeUs;
+		}
+	}
+
+	out.print("[\n");
+
+	for (uint8_t core = 0; core < SPAN_TRACE_CORES; core++) {
+		uint32_t head = _aulHead[core];
+		uint32_t count = (head > SPAN_TRACE_RING_EVENTS) ? SPAN_TRACE_RING_EVENTS : head;
+
+		if (head > SPAN_TRACE_RING_EVENTS) _ulOverwrittenCount += head - SPAN_TRACE_RING_EVENTS;
+
+		out.printf("%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"core %u\"}}\n", isFirst ? "" : ",", core, core);
+		isFirst = false;
+
+		for (uint32_t i = head - count; i != head; i++) {
+			const SPAN_TRACE_EVENT_T *pEvent = &_atRing[core][i & RING_MASK];
+			const char *pName = (pEvent->bId < _bNameCount) ? _pNames[pEvent->bId] : "?";
+			uint8_t tid = taskIndex(pEvent->xTask, axTasks, &bTaskCount);
+
+			out.printf(",{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%u,\"pid\":%u,\"tid\":%u", pName, acPhase[pEvent->bType % 3], pEvent->ulTimeUs - ulOriginUs, core, tid);
+			if (pEvent->bType == SPAN_TRACE_INSTANT) out.print(",\"s\":\"t\"");
+			if (pEvent->bType != SPAN_TRACE_END) out.printf(",\"args\":{\"arg\":%u}", pEvent->usArg);
+			out.print("}\n");
+		}
+
+		_aulHead[core] = 0;
+	}
+
+	/** the name is read from the task at dump time, a task deleted since its events were recorded has a stale name */
+	for (uint8_t i = 0; i < bTaskCount; i++) {
+		for (uint8_t core = 0; core < SPAN_TRACE_CORES; core++) {
+			out.printf(",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%.*s\"}}\n", core, i,
+				configMAX_TASK_NAME_LEN, pcTaskGetTaskName(axTasks[i]));
+		}
+	}
+
+	out.print("]\n");
+
+	_isEnabled = wasEnabled;
+}
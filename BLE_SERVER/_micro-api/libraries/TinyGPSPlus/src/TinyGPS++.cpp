@@ -26,6 +26,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <math.h>
+
+#if !defined(ARDUINO)
+// Arduino math helpers, the host build has no Arduino.h
+#define TWO_PI 6.283185307179586476925286766559
+#define radians(deg) ((deg) * 0.017453292519943295769236907684886)
+#define degrees(rad) ((rad) * 57.295779513082320876798154814105)
+#define sq(x) ((x) * (x))
+#endif
 
 #define _GPRMCterm   "GPRMC"
 #define _GPGGAterm   "GPGGA"
@@ -41,6 +50,7 @@ TinyGPSPlus::TinyGPSPlus()
   ,  sentenceHasFix(false)
   ,  customElts(0)
   ,  customCandidates(0)
+  ,  fixHandler(0)
   ,  encodedCharCount(0)
   ,  sentencesWithFixCount(0)
   ,  failedChecksumCount(0)
@@ -64,19 +74,7 @@ bool TinyGPSPlus::encode(char c)
   case '\r':
   case '\n':
   case '*':
-    {
-      bool isValidSentence = false;
-      if (curTermOffset < sizeof(term))
-      {
-        term[curTermOffset] = 0;
-        isValidSentence = endOfTermHandler();
-      }
-      ++curTermNumber;
-      curTermOffset = 0;
-      isChecksumTerm = c == '*';
-      return isValidSentence;
-    }
-    break;
+    return endOfTerm(c);
 
   case '$': // sentence begin
     curTermNumber = curTermOffset = 0;
@@ -97,6 +95,67 @@ bool TinyGPSPlus::encode(char c)
   return false;
 }
 
+// Process a buffer of characters, the result is the same as encode(char) for every character
+// Returns true if at least one sentence has passed the checksum test
+// Runs of ordinary characters are handled a word at a time, only words with a character below
+// '-' (0x2D, all delimiters are) go through encode(char). The terms of a sentence which is not
+// parsed are not kept at all, only its parity up to the checksum is computed.
+bool TinyGPSPlus::encode(const char *buf, size_t n)
+{
+  bool isValidSentence = false;
+
+  while (n > 0)
+  {
+    if (n >= sizeof(uint32_t))
+    {
+      uint32_t word;
+      memcpy(&word, buf, sizeof(word));
+
+      bool isSkipped = curSentenceType == GPS_SENTENCE_OTHER && customCandidates == NULL &&
+        curTermNumber > 0 && !isChecksumTerm;
+
+      // nonzero if any byte of the word is below the given value: up to '*' ends the skipped terms
+      // (commas only count for the parity there), below '-' ends an ordinary term
+      if (isSkipped ? ((word - 0x2B2B2B2BUL) & ~word & 0x80808080UL) == 0 :
+                      ((word - 0x2D2D2D2DUL) & ~word & 0x80808080UL) == 0)
+      {
+        if (!isSkipped)
+        {
+          if (curTermOffset + sizeof(word) < sizeof(term))
+          {
+            memcpy(&term[curTermOffset], buf, sizeof(word));
+            curTermOffset += sizeof(word);
+          }
+          else
+          {
+            for (uint8_t i = 0; i < sizeof(word); ++i)
+              if (curTermOffset < sizeof(term) - 1)
+                term[curTermOffset++] = buf[i];
+          }
+        }
+
+        if (!isChecksumTerm)
+        {
+          word ^= word >> 16;
+          word ^= word >> 8;
+          parity ^= (uint8_t)word;
+        }
+
+        encodedCharCount += sizeof(word);
+        buf += sizeof(word);
+        n -= sizeof(word);
+        continue;
+      }
+    }
+
+    if (encode(*buf++))
+      isValidSentence = true;
+    --n;
+  }
+
+  return isValidSentence;
+}
+
 //
 // internal utilities
 //
@@ -110,18 +169,38 @@ int TinyGPSPlus::fromHex(char a)
     return a - '0';
 }
 
+// Finish the current term, c is the terminator
+bool TinyGPSPlus::endOfTerm(char c)
+{
+  bool isValidSentence = false;
+  if (curTermOffset < sizeof(term))
+  {
+    term[curTermOffset] = 0;
+    isValidSentence = endOfTermHandler();
+  }
+  ++curTermNumber;
+  curTermOffset = 0;
+  isChecksumTerm = c == '*';
+  return isValidSentence;
+}
+
+#define _GPS_IS_DIGIT(c) ((uint8_t)((c) - '0') < 10)
+
 // static
 // Parse a (potentially negative) number with up to 2 decimal digits -xxxx.yy
+// NMEA fields have no white space or '+', so the digits are accumulated without atol()
 int32_t TinyGPSPlus::parseDecimal(const char *term)
 {
   bool negative = *term == '-';
   if (negative) ++term;
-  int32_t ret = 100 * (int32_t)atol(term);
-  while (isdigit(*term)) ++term;
-  if (*term == '.' && isdigit(term[1]))
+  int32_t ret = 0;
+  while (_GPS_IS_DIGIT(*term))
+    ret = 10 * ret + (*term++ - '0');
+  ret *= 100;
+  if (*term == '.' && _GPS_IS_DIGIT(term[1]))
   {
     ret += 10 * (term[1] - '0');
-    if (isdigit(term[2]))
+    if (_GPS_IS_DIGIT(term[2]))
       ret += term[2] - '0';
   }
   return negative ? -ret : ret;
@@ -131,18 +210,18 @@ int32_t TinyGPSPlus::parseDecimal(const char *term)
 // Parse degrees in that funny NMEA format DDMM.MMMM
 void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
 {
-  uint32_t leftOfDecimal = (uint32_t)atol(term);
+  uint32_t leftOfDecimal = 0;
+  while (_GPS_IS_DIGIT(*term))
+    leftOfDecimal = 10 * leftOfDecimal + (*term++ - '0');
+
   uint16_t minutes = (uint16_t)(leftOfDecimal % 100);
   uint32_t multiplier = 10000000UL;
   uint32_t tenMillionthsOfMinutes = minutes * multiplier;
 
   deg.deg = (int16_t)(leftOfDecimal / 100);
 
-  while (isdigit(*term))
-    ++term;
-
   if (*term == '.')
-    while (isdigit(*++term))
+    while (_GPS_IS_DIGIT(*++term))
     {
       multiplier /= 10;
       tenMillionthsOfMinutes += (*term - '0') * multiplier;
@@ -159,10 +238,12 @@ void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
 bool TinyGPSPlus::endOfTermHandler()
 {
   // If it's the checksum term, and the checksum checks out, commit
+  // A checksum term of less than two characters fails, term[1] would be a left over of an earlier term
+  // (and of a different one in the bulk decode, which does not keep the terms of skipped sentences)
   if (isChecksumTerm)
   {
-    byte checksum = 16 * fromHex(term[0]) + fromHex(term[1]);
-    if (checksum == parity)
+    uint8_t checksum = 16 * fromHex(term[0]) + fromHex(term[1]);
+    if (term[0] != 0 && term[1] != 0 && checksum == parity)
     {
       passedChecksumCount++;
       if (sentenceHasFix)
@@ -195,6 +276,9 @@ bool TinyGPSPlus::endOfTermHandler()
       // Commit all custom listeners of this sentence type
       for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0; p = p->next)
          p->commit();
+
+      if (sentenceHasFix && curSentenceType != GPS_SENTENCE_OTHER && fixHandler != NULL)
+        fixHandler(*this);
       return true;
     }
 
@@ -366,6 +450,21 @@ double TinyGPSLocation::lng()
    return rawLngData.negative ? -ret : ret;
 }
 
+// Signed micro-degrees in fixed point, without the double of lat()
+int32_t TinyGPSLocation::latMicrodegrees()
+{
+   updated = false;
+   int32_t ret = (int32_t)rawLatData.deg * 1000000L + (int32_t)((rawLatData.billionths + 500UL) / 1000UL);
+   return rawLatData.negative ? -ret : ret;
+}
+
+int32_t TinyGPSLocation::lngMicrodegrees()
+{
+   updated = false;
+   int32_t ret = (int32_t)rawLngData.deg * 1000000L + (int32_t)((rawLngData.billionths + 500UL) / 1000UL);
+   return rawLngData.negative ? -ret : ret;
+}
+
 void TinyGPSDate::commit()
 {
    date = newDate;
@@ -0,0 +1,151 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			bulk_encode_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the bulk encode(const char *, size_t) of TinyGPS++
+* @details		The bulk decode has to give the same result as encode(char) for every character, on clean and on
+*				corrupted NMEA: every value and every statistic, after every chunk of any size.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string>
+#include <TinyGPS++.h>
+#include "HostTest.h"
+
+static void appendSentence(std::string &log, const char *body)
+{
+	uint8_t checksum = 0;
+	char acTail[8];
+
+	for (const char *p = body; *p; p++) checksum ^= (uint8_t)*p;
+	snprintf(acTail, sizeof(acTail), "*%02X\r\n", checksum);
+
+	log += '$';
+	log += body;
+	log += acTail;
+}
+
+/** one second epochs of the L76 default output: GGA, GSA, 3 GSV, RMC, VTG */
+static std::string nmeaLog(uint32_t seconds)
+{
+	std::string log;
+	char acBody[128];
+
+	for (uint32_t s = 0; s < seconds; s++) {
+		uint32_t hh = (s / 3600) % 24, mm = (s / 60) % 60, ss = s % 60;
+		double lat = 5238.4743 + s * 0.0011, lon = 1330.6377 + s * 0.0017;
+
+		snprintf(acBody, sizeof(acBody), "GPGGA,%02u%02u%02u.000,%.4f,N,%09.4f,E,1,10,1.14,%.1f,M,47.0,M,,", hh, mm, ss, lat, lon, 35.0 + (s % 20) * 0.5);
+		appendSentence(log, acBody);
+		appendSentence(log, "GPGSA,A,3,01,02,12,14,17,19,24,25,,,,,1.8,1.0,1.5");
+		appendSentence(log, "GPGSV,3,1,12,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45");
+		appendSentence(log, "GPGSV,3,2,12,17,61,112,42,19,34,270,40,24,10,045,33,25,52,178,47");
+		appendSentence(log, "GPGSV,3,3,12,29,05,320,,31,23,132,38,32,08,021,,33,,,35");
+		snprintf(acBody, sizeof(acBody), "GPRMC,%02u%02u%02u.000,A,%.4f,N,%09.4f,E,%.2f,%.2f,171026,,,A", hh, mm, ss, lat, lon, 12.0 + (s % 7), 54.7);
+		appendSentence(log, acBody);
+		snprintf(acBody, sizeof(acBody), "GPVTG,54.70,T,,M,%.2f,N,%.2f,K,A", 12.0 + (s % 7), (12.0 + (s % 7)) * 1.852);
+		appendSentence(log, acBody);
+	}
+
+	return log;
+}
+
+/** uart noise: flipped, dropped and inserted bytes, with a bias to the delimiters */
+static std::string corrupt(const std::string &log, uint32_t everyNth)
+{
+	static const char acDelimiter[] = ",*$\r\n";
+	std::string out;
+
+	for (size_t i = 0; i < log.size(); i++) {
+		if (random(everyNth) != 0) {
+			out += log[i];
+			continue;
+		}
+
+		switch (random(4)) {
+		case 0:		out += (char)(log[i] ^ (1 << random(8))); break;
+		case 1:		break;
+		case 2:		out += acDelimiter[random(sizeof(acDelimiter) - 1)]; out += log[i]; break;
+		default:	out += (char)random(256); break;
+		}
+	}
+
+	return out;
+}
+
+static bool isSame(TinyGPSPlus &a, TinyGPSPlus &b)
+{
+	return a.charsProcessed() == b.charsProcessed() && a.passedChecksum() == b.passedChecksum() &&
+		a.failedChecksum() == b.failedChecksum() && a.sentencesWithFix() == b.sentencesWithFix() &&
+		a.location.isValid() == b.location.isValid() && a.location.rawLat().deg == b.location.rawLat().deg &&
+		a.location.rawLat().billionths == b.location.rawLat().billionths && a.location.rawLng().deg == b.location.rawLng().deg &&
+		a.location.rawLng().billionths == b.location.rawLng().billionths && a.date.value() == b.date.value() &&
+		a.time.value() == b.time.value() && a.speed.value() == b.speed.value() && a.course.value() == b.course.value() &&
+		a.altitude.value() == b.altitude.value() && a.satellites.value() == b.satellites.value() && a.hdop.value() == b.hdop.value();
+}
+
+/** byte-wise and bulk decode side by side, compared after every chunk */
+static void compare(const std::string &log, size_t chunk)
+{
+	TinyGPSPlus byteWise, bulk;
+	size_t mismatches = 0;
+
+	for (size_t offset = 0; offset < log.size(); offset += chunk) {
+		size_t len = std::min(chunk, log.size() - offset);
+		bool isByteValid = false;
+
+		for (size_t i = 0; i < len; i++) isByteValid |= byteWise.encode(log[offset + i]);
+		if (bulk.encode(&log[offset], len) != isByteValid || !isSame(byteWise, bulk)) mismatches++;
+	}
+
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(bulk.failedChecksum(), byteWise.failedChecksum());
+	CHECK_EQ(bulk.passedChecksum(), byteWise.passedChecksum());
+}
+
+int main()
+{
+	static const size_t aChunk[] = { 1, 3, 4, 5, 7, 64, 200, 4096 };
+	const std::string clean = nmeaLog(300);
+	TinyGPSPlus gps;
+
+	/** clean log: all 7 sentences of every epoch pass */
+	gps.encode(clean.data(), clean.size());
+	CHECK_EQ(gps.passedChecksum(), 7 * 300);
+	CHECK_EQ(gps.failedChecksum(), 0);
+	CHECK_EQ(gps.sentencesWithFix(), 2 * 300);
+
+	for (size_t c = 0; c < sizeof(aChunk) / sizeof(aChunk[0]); c++) compare(clean, aChunk[c]);
+
+	/** corrupted logs, light and heavy noise */
+	randomSeed(22);
+	for (uint32_t everyNth = 8; everyNth <= 512; everyNth *= 4) {
+		const std::string noisy = corrupt(clean, everyNth);
+
+		for (size_t c = 0; c < sizeof(aChunk) / sizeof(aChunk[0]); c++) compare(noisy, aChunk[c]);
+	}
+
+	/** a checksum delimiter right before the line end, the checksum term is empty */
+	std::string empty;
+	for (uint8_t i = 0; i < 64; i++) {
+		char acLine[64];
+		snprintf(acLine, sizeof(acLine), "$GPGSV,3,1,12,%02u,40,083,46,02,17,308,41*\r\n$GPTXT,ab,c%c*\r\n", i, 'A' + (i % 26));
+		empty += acLine;
+	}
+	for (size_t c = 0; c < sizeof(aChunk) / sizeof(aChunk[0]); c++) compare(empty, aChunk[c]);
+
+	return HOST_TEST_RESULT();
+}
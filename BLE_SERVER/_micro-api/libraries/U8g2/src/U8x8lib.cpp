@@ -534,13 +534,20 @@ extern "C" uint8_t u8x8_byte_arduino_4wire_sw_spi(u8x8_t *u8x8, uint8_t msg, uin
 extern "C" uint8_t u8x8_byte_arduino_hw_spi(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
 {
 #ifdef U8X8_HAVE_HW_SPI
+#if !defined(ESP_PLATFORM) && !defined(ARDUINO_ARCH_ESP32)
   uint8_t *data;
+#endif
   uint8_t internal_spi_mode;
  
   switch(msg)
   {
     case U8X8_MSG_BYTE_SEND:
       
+#if defined(ESP_PLATFORM) || defined(ARDUINO_ARCH_ESP32)
+      /* ESP32: writeBytes() fills the SPI FIFO in blocks of 64 bytes and ignores the incoming data, */
+      /* so the buffer of the caller is not modified. This is used by full buffer and page buffer mode. */
+      SPI.writeBytes((uint8_t *)arg_ptr, arg_int);
+#else
       // 1.6.5 offers a block transfer, but the problem is, that the
       // buffer is overwritten with the incoming data
       // so it can not be used...
@@ -553,6 +560,7 @@ extern "C" uint8_t u8x8_byte_arduino_hw_spi(u8x8_t *u8x8, uint8_t msg, uint8_t a
 	data++;
 	arg_int--;
       }
+#endif
   
       break;
     case U8X8_MSG_BYTE_INIT:
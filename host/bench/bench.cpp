@@ -0,0 +1,402 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			bench.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host benchmark of the libraries on the hot paths of the sketches
+* @details		Every case runs its workload several times and prints the best run, host time per operation. The
+*				cases with a bus (impact detector, display) also print the bus time of the virtual clock, which is
+*				what the target spends waiting on I2C/SPI.
+*
+*	Usage:	bench [filter]		runs the cases whose name contains filter
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	the host numbers compare versions of the code on the same machine, they are not target timings
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+#include <BMSPacketHandler.h>
+#include <ControllerPacketHandler.h>
+#include <TinyGPS++.h>
+#include <MPU9250_Impact.h>
+#include <U8g2lib.h>
+#include <DisplayScene.h>
+#include "lmic/lmic.h"
+#include "HostShim.h"
+#include "HostMpu9250.h"
+#include "HostSsd1322.h"
+
+#define BENCH_RUNS			7
+
+static const char *pFilter = "";
+static volatile uint32_t ulSink;
+
+/** best of BENCH_RUNS runs of fn, which does ops operations */
+template <class F>
+static void bench(const char *name, const char *unit, size_t ops, F fn)
+{
+	double best = 1e30;
+
+	if (strstr(name, pFilter) == NULL) return;
+
+	for (int run = 0; run < BENCH_RUNS; run++) {
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		fn();
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+		if (ns < best) best = ns;
+	}
+
+	printf("%-28s %10.1f ns/%s\n", name, best / ops, unit);
+}
+
+static void busTime(const char *name, const char *unit, double us)
+{
+	if (strstr(name, pFilter) == NULL) return;
+
+	printf("%-28s %10.1f us/%s (virtual bus time)\n", name, us, unit);
+}
+
+
+/************************************************************************************************************************/
+/* packet parsers																										*/
+/************************************************************************************************************************/
+
+static void appendBmsFrame(std::vector<uint8_t> &stream, uint8_t seq)
+{
+	const uint8_t len = 27;
+	uint16_t sum = len;
+
+	stream.push_back(0xDD);
+	stream.push_back(0x03);
+	stream.push_back(0x00);
+	stream.push_back(len);
+	for (uint8_t i = 0; i < len; i++) {
+		uint8_t b = (uint8_t)(i * 13 + seq);
+		stream.push_back(b);
+		sum += b;
+	}
+	sum = (uint16_t)(~sum + 1);
+	stream.push_back((uint8_t)(sum >> 8));
+	stream.push_back((uint8_t)sum);
+	stream.push_back(0x77);
+}
+
+static void benchPacketParsers()
+{
+	const size_t frames = 2000;
+	std::vector<uint8_t> bms, controller;
+
+	/** uart reads of 1..24 bytes, as the ble notifications and the uart fifo split the frames */
+	randomSeed(1);
+	for (size_t i = 0; i < frames; i++) appendBmsFrame(bms, (uint8_t)i);
+
+	for (size_t i = 0; i < frames; i++) {
+		const uint8_t frame[12] = { 0xAA, (uint8_t)i, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0x85 };
+		controller.insert(controller.end(), frame, frame + sizeof(frame));
+	}
+
+	std::vector<size_t> chunks;
+	for (size_t i = 0; i < bms.size(); i += chunks.back()) chunks.push_back(1 + random(24));
+
+	bench("bms.frame_fragments", "frame", frames, [&]() {
+		BMSPacketHandler handler;
+		size_t offset = 0;
+
+		for (size_t i = 0; i < chunks.size() && offset < bms.size(); i++) {
+			size_t len = std::min(chunks[i], bms.size() - offset);
+			ulSink += handler.bmsReadInfoStatus(&bms[offset], len);
+			offset += len;
+		}
+		ulSink += handler.getFrameCount();
+	});
+
+	bench("bms.frame_whole", "frame", frames, [&]() {
+		BMSPacketHandler handler;
+		BMS_PACKET_STRUCT_T tPacket;
+
+		for (size_t offset = 0; offset < bms.size(); offset += 34) ulSink += handler.bmsReadInfoStatus(&tPacket, &bms[offset], 34);
+	});
+
+	bench("controller.frame_fragments", "frame", frames, [&]() {
+		ControllerPacketHandler handler;
+		CONTROLLER_PACKET_STRUCT_T tPacket;
+
+		for (size_t offset = 0; offset < controller.size(); offset += 6) ulSink += handler.readParsePacket(&tPacket, &controller[offset], 6);
+	});
+}
+
+
+/************************************************************************************************************************/
+/* NMEA																													*/
+/************************************************************************************************************************/
+
+static void appendSentence(std::string &log, const char *body)
+{
+	uint8_t checksum = 0;
+	char acTail[8];
+
+	for (const char *p = body; *p; p++) checksum ^= (uint8_t)*p;
+	snprintf(acTail, sizeof(acTail), "*%02X\r\n", checksum);
+
+	log += '$';
+	log += body;
+	log += acTail;
+}
+
+/** one second epochs of the L76 default output: GGA, GSA, 3 GSV, RMC, VTG */
+static std::string nmeaLog(uint32_t seconds)
+{
+	std::string log;
+	char acBody[128];
+
+	for (uint32_t s = 0; s < seconds; s++) {
+		uint32_t hh = (s / 3600) % 24, mm = (s / 60) % 60, ss = s % 60;
+		double lat = 5238.4743 + s * 0.0011, lon = 1330.6377 + s * 0.0017;
+
+		snprintf(acBody, sizeof(acBody), "GPGGA,%02u%02u%02u.000,%.4f,N,%09.4f,E,1,10,1.14,%.1f,M,47.0,M,,", hh, mm, ss, lat, lon, 35.0 + (s % 20) * 0.5);
+		appendSentence(log, acBody);
+		appendSentence(log, "GPGSA,A,3,01,02,12,14,17,19,24,25,,,,,1.8,1.0,1.5");
+		appendSentence(log, "GPGSV,3,1,12,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45");
+		appendSentence(log, "GPGSV,3,2,12,17,61,112,42,19,34,270,40,24,10,045,33,25,52,178,47");
+		appendSentence(log, "GPGSV,3,3,12,29,05,320,,31,23,132,38,32,08,021,,33,,,35");
+		snprintf(acBody, sizeof(acBody), "GPRMC,%02u%02u%02u.000,A,%.4f,N,%09.4f,E,%.2f,%.2f,171026,,,A", hh, mm, ss, lat, lon, 12.0 + (s % 7), 54.7);
+		appendSentence(log, acBody);
+		snprintf(acBody, sizeof(acBody), "GPVTG,54.70,T,,M,%.2f,N,%.2f,K,A", 12.0 + (s % 7), (12.0 + (s % 7)) * 1.852);
+		appendSentence(log, acBody);
+	}
+
+	return log;
+}
+
+static void benchNmea()
+{
+	const std::string log = nmeaLog(2000);
+	const size_t chunk = 200;				// bytes per uart read
+
+	bench("nmea.encode_bytewise", "byte", log.size(), [&]() {
+		TinyGPSPlus gps;
+
+		for (size_t i = 0; i < log.size(); i++) gps.encode(log[i]);
+		ulSink += gps.passedChecksum();
+	});
+
+	bench("nmea.encode_bulk", "byte", log.size(), [&]() {
+		TinyGPSPlus gps;
+
+		for (size_t offset = 0; offset < log.size(); offset += chunk) gps.encode(&log[offset], std::min(chunk, log.size() - offset));
+		ulSink += gps.passedChecksum();
+	});
+}
+
+
+/************************************************************************************************************************/
+/* LoRaWAN crypto																										*/
+/************************************************************************************************************************/
+
+static void benchAes()
+{
+	const size_t frames = 20000;
+	u1_t abNwkKey[16], abAppKey[16], abFrame[64];
+
+	for (uint8_t i = 0; i < 16; i++) {
+		abNwkKey[i] = i;
+		abAppKey[i] = (u1_t)(0x40 + i);
+	}
+
+	/** uplink of a 40 byte batch: payload encryption with the app key, MIC with the network key */
+	bench("lmic.aes_ctr_cmac_uplink", "frame", frames, [&]() {
+		u4_t mic = 0;
+
+		for (size_t n = 0; n < frames; n++) {
+			for (uint8_t i = 0; i < 52; i++) abFrame[i] = (u1_t)(i * 7 + n);
+			memcpy(AESkey, abAppKey, 16);
+			memset(AESaux, 0, 16);
+			AESaux[0] = 1;
+			AESaux[15] = 1;
+			os_aes(AES_CTR, abFrame + 9, 40);
+			memcpy(AESkey, abNwkKey, 16);
+			memset(AESaux, 0, 16);
+			AESaux[0] = 0x49;
+			AESaux[15] = 49;
+			mic ^= os_aes(AES_MIC, abFrame, 49);
+		}
+		ulSink += mic;
+	});
+}
+
+
+/************************************************************************************************************************/
+/* impact detector																										*/
+/************************************************************************************************************************/
+
+static void benchImpactDetector()
+{
+	const uint8_t intPin = 39;
+	const uint16_t polls = 500;
+	const uint8_t samplesPerPoll = 30;
+	HostMpu9250 mpu;
+	ImpactDetector imu(100, 2000, 0.1, 2.0, 4.0, 0x68, 21, 22);
+	uint64_t ullBusUs = 0;
+
+	Wire.attach(0x68, &mpu);
+	imu.begin();
+	imu.enableSampling(intPin, 200, 10);
+
+	/** 1 g on z at the 16 g range, one 6 g sample now and then */
+	bench("impact.detector_poll", "sample", (size_t)polls * samplesPerPoll, [&]() {
+		ullBusUs = 0;
+		for (uint16_t p = 0; p < polls; p++) {
+			for (uint8_t s = 0; s < samplesPerPoll; s++) mpu.pushSample(0, 0, (p % 97 == 0 && s == 7) ? 6 * 2048 : 2048, 1, 2, 3);
+
+			uint64_t ullStart = hostGetTimeUs();
+			ulSink += imu.detector();
+			ullBusUs += hostGetTimeUs() - ullStart;
+		}
+	});
+	busTime("impact.detector_poll", "poll", (double)ullBusUs / polls);
+
+	Wire.attach(0x68, NULL);
+}
+
+
+/************************************************************************************************************************/
+/* display																												*/
+/************************************************************************************************************************/
+
+static void benchDisplay()
+{
+	const uint8_t csPin = 15, dcPin = 2;
+	const size_t frames = 200;
+	U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI u8g2(U8G2_R1, csPin, dcPin, U8X8_PIN_NONE);
+	HostSsd1322 panel(csPin, dcPin);
+	uint64_t ullBusUs = 0;
+
+	SPI.attach(&panel);
+	u8g2.begin();
+
+	/** the dashboard of the client sketch, full frame rendered and sent */
+	bench("display.render_send_full", "frame", frames, [&]() {
+		char acText[16];
+
+		ullBusUs = 0;
+		for (size_t f = 0; f < frames; f++) {
+			u8g2.clearBuffer();
+			u8g2.setFont(u8g2_font_helvR12_tr);
+			u8g2.drawStr(0, 16, "Vbms: ");
+			snprintf(acText, sizeof(acText), "%.2f", 38.0 + (f % 40) * 0.05);
+			u8g2.drawStr(0, 32, acText);
+			u8g2.drawStr(52, 32, "V");
+			u8g2.drawStr(0, 56, "Session:");
+			snprintf(acText, sizeof(acText), "%03u", (unsigned)(f / 60));
+			u8g2.drawStr(0, 72, acText);
+			u8g2.drawStr(37, 72, "min");
+			snprintf(acText, sizeof(acText), "12:%02u:%02u", (unsigned)(f / 60) % 60, (unsigned)f % 60);
+			u8g2.drawStr(8, 104, acText);
+			u8g2.drawStr(18, 120, "PM");
+			snprintf(acText, sizeof(acText), "%3u", (unsigned)(60 + f % 40));
+			u8g2.drawStr(2, 152, acText);
+			u8g2.drawStr(0, 172, "bpm");
+
+			uint64_t ullStart = hostGetTimeUs();
+			u8g2.sendBuffer();
+			ullBusUs += hostGetTimeUs() - ullStart;
+		}
+	});
+	busTime("display.render_send_full", "frame", (double)ullBusUs / frames);
+
+	/** same dashboard through the scene, only the damaged tiles are sent */
+	TextWidget vbmsLabel(0, 16, 0, u8g2_font_helvR12_tr, "Vbms: ");
+	NumberWidget vbms(0, 32, 50, u8g2_font_helvR12_tr, "%.2f");
+	TextWidget vbmsUnit(52, 32, 0, u8g2_font_helvR12_tr, "V");
+	TextWidget sessionLabel(0, 56, 0, u8g2_font_helvR12_tr, "Session:");
+	NumberWidget session(0, 72, 36, u8g2_font_helvR12_tr, "%03d");
+	TextWidget sessionUnit(37, 72, 0, u8g2_font_helvR12_tr, "min");
+	TextWidget time(8, 104, 56, u8g2_font_helvR12_tr);
+	TextWidget ampm(18, 120, 0, u8g2_font_helvR12_tr, "PM");
+	NumberWidget bpm(2, 152, 30, u8g2_font_helvR12_tr, "%3d");
+	TextWidget bpmUnit(0, 172, 0, u8g2_font_helvR12_tr, "bpm");
+	DisplayScene scene(u8g2);
+
+	scene.add(vbmsLabel);
+	scene.add(vbms);
+	scene.add(vbmsUnit);
+	scene.add(sessionLabel);
+	scene.add(session);
+	scene.add(sessionUnit);
+	scene.add(time);
+	scene.add(ampm);
+	scene.add(bpm);
+	scene.add(bpmUnit);
+
+	bench("display.scene_send_damage", "frame", frames, [&]() {
+		char acText[16];
+		uint32_t aulDamage[8];
+		u8x8_t *pU8x8 = u8g2.getU8x8();
+		uint8_t bTileWidth = u8g2.getBufferTileWidth();
+
+		ullBusUs = 0;
+		scene.invalidate();
+		for (size_t f = 0; f < frames; f++) {
+			vbms.setValue(38.0 + (f % 40) * 0.05);
+			session.setValue((int32_t)(f / 60));
+			snprintf(acText, sizeof(acText), "12:%02u:%02u", (unsigned)(f / 60) % 60, (unsigned)f % 60);
+			time.setText(acText);
+			bpm.setValue((int32_t)(60 + f % 40));
+			scene.render();
+			scene.takeDamage(aulDamage, 8);
+
+			/** flushDisplay() of the client sketch */
+			uint64_t ullStart = hostGetTimeUs();
+			for (uint8_t row = 0; row < 8; row++) {
+				uint8_t col = 0;
+				while (col < bTileWidth) {
+					if (!(aulDamage[row] & (1UL << col))) {
+						col++;
+						continue;
+					}
+					uint8_t first = col;
+					while (col < bTileWidth && (aulDamage[row] & (1UL << col))) col++;
+					u8x8_DrawTile(pU8x8, first, row, col - first, u8g2.getBufferPtr() + ((uint16_t)row * bTileWidth + first) * 8);
+				}
+			}
+			ullBusUs += hostGetTimeUs() - ullStart;
+		}
+	});
+	busTime("display.scene_send_damage", "frame", (double)ullBusUs / frames);
+
+	SPI.attach(NULL);
+}
+
+
+int main(int argc, char **argv)
+{
+	if (argc > 1) pFilter = argv[1];
+
+	/** the setup of the bus cases only runs if one of their cases is selected */
+	benchPacketParsers();
+	benchNmea();
+	benchAes();
+	if (strstr("impact.detector_poll", pFilter) != NULL) benchImpactDetector();
+	if (strstr("display.render_send_full display.scene_send_damage", pFilter) != NULL) benchDisplay();
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+# Synthetic stand-in for u8g2_font_helvR12_tr of the host build.
+#
+# The U8g2 font data (u8g2_fonts.c) is not part of this repository. This writes a font in the same
+# compressed format with helvR12-like metrics (glyphs 32..126, 12 px high, 3 px descent) and random
+# stroke patterns, so the glyph decoder does the same amount of work as with the real font.
+#
+#   python3 genfont.py > u8g2_font_helvR12_tr.c
+import random
+random.seed(17)
+B0,B1,BW,BH,BX,BY,BD = 4,3,5,5,2,4,5
+class W:
+    def __init__(s): s.bytes=[]; s.pos=0
+    def put(s,v,n):
+        for i in range(n):
+            if s.pos%8==0: s.bytes.append(0)
+            if (v>>i)&1: s.bytes[-1]|=1<<(s.pos%8)
+            s.pos+=1
+def sput(w,v,n): w.put(v+(1<<(n-1)),n)
+glyphs=[]
+for e in range(32,127):
+    if e==32:
+        w,h,x,y,dx=0,0,0,0,4; bm=[]
+    else:
+        w=random.randint(3,11) if not chr(e).isdigit() else 7
+        h=12 if chr(e) not in 'gjpqy' else 12
+        x,y=random.randint(0,1),(-3 if chr(e) in 'gjpqy' else 0); dx=w+2
+        bm=[[0]*w for _ in range(h)]
+        # strokes: outline-ish plus a random bar
+        for r in range(h):
+            bm[r][0]=bm[r][w-1]=1 if random.random()<0.8 else 0
+        for c in range(w):
+            bm[0][c]=bm[h-1][c]=1
+            bm[h//2][c]=1 if random.random()<0.7 else 0
+        for _ in range(4):
+            bm[random.randrange(h)][random.randrange(w)]^=1
+    g=W(); g.put(w,BW); g.put(h,BH); sput(g,x,BX); sput(g,y,BY); sput(g,dx,BD)
+    px=[p for row in bm for p in row]; i=0
+    while i<len(px):
+        z=0
+        while i<len(px) and px[i]==0 and z<(1<<B0)-1: z+=1; i+=1
+        o=0
+        if not (i<len(px) and px[i]==0):
+            while i<len(px) and px[i]==1 and o<(1<<B1)-1: o+=1; i+=1
+        g.put(z,B0); g.put(o,B1); g.put(0,1)
+    glyphs.append([e,len(g.bytes)+2]+g.bytes)
+data=[]; posA=posa=0
+for gl in glyphs:
+    if gl[0]==ord('A'): posA=len(data)
+    if gl[0]==ord('a'): posa=len(data)
+    data+=gl
+data+=[0,0]
+uni=len(data); data+=[0,4,0xff,0xff, 0,0,0]
+hdr=[len(glyphs),0,B0,B1,BW,BH,BX,BY,BD,11,15,0,-3&0xff,12,-3&0xff,12,-3&0xff,posA>>8,posA&255,posa>>8,posa&255,uni>>8,uni&255]
+allb=hdr+data
+print("/* generated by genfont.py, do not edit */")
+print("#include \"u8g2.h\"")
+print("const uint8_t u8g2_font_helvR12_tr[%d] U8G2_FONT_SECTION(\"u8g2_font_helvR12_tr\") = {" % len(allb))
+for i in range(0, len(allb), 24):
+    print("\t" + ",".join(str(b) for b in allb[i:i + 24]) + ",")
+print("};")
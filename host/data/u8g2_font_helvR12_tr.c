@@ -0,0 +1,81 @@
+/* generated by genfont.py, do not edit */
+#include "u8g2.h"
+const uint8_t u8g2_font_helvR12_tr[1828] U8G2_FONT_SECTION("u8g2_font_helvR12_tr") = {
+	95,0,4,3,5,5,2,4,5,11,15,0,253,12,253,12,253,2,119,4,196,7,6,32,
+	5,0,136,20,33,24,139,141,29,14,136,162,36,37,37,229,34,68,34,66,34,36,37,37,
+	69,194,14,10,34,20,137,137,27,40,136,130,226,4,227,228,14,36,226,4,227,34,15,4,
+	35,16,133,141,23,170,98,100,162,98,36,194,70,132,98,12,36,19,137,137,27,14,230,228,
+	228,2,35,67,172,195,194,226,14,34,2,37,20,137,141,27,14,230,228,100,98,228,228,70,
+	42,2,227,226,34,15,4,38,21,139,137,29,44,72,37,69,35,37,35,34,44,228,34,36,
+	37,37,15,10,39,18,132,141,22,42,40,130,66,36,36,66,66,130,66,66,34,8,40,22,
+	138,141,28,14,40,3,37,194,164,66,4,69,34,38,4,67,3,5,39,14,41,18,134,141,
+	24,142,102,132,68,34,194,46,66,132,132,132,38,6,42,21,136,137,26,14,2,195,2,195,
+	226,34,34,34,200,196,100,66,196,42,6,43,21,138,137,28,14,8,5,37,194,226,33,162,
+	72,134,98,4,5,5,41,12,44,22,138,137,28,14,34,4,67,3,3,35,2,15,38,2,
+	5,231,4,35,14,4,45,17,135,141,25,42,194,163,164,164,46,132,164,164,162,34,14,46,
+	17,134,141,24,204,130,194,130,132,40,38,66,164,130,132,14,47,15,132,137,22,74,68,68,
+	68,130,74,68,100,34,12,48,19,135,137,25,238,162,164,164,164,40,36,162,100,66,162,164,
+	34,12,49,19,135,137,57,174,68,66,164,164,164,74,130,66,162,164,164,14,2,50,20,135,
+	141,25,14,162,164,164,130,66,66,66,34,206,162,164,164,14,2,51,20,135,141,57,236,162,
+	164,164,164,34,130,100,34,100,34,164,164,14,2,52,22,135,137,25,14,162,100,34,226,66,
+	66,164,66,34,226,33,66,66,164,14,2,53,18,135,141,25,14,162,196,162,164,226,66,172,
+	162,134,164,14,2,54,20,135,141,25,14,162,68,66,226,162,164,36,36,166,196,162,194,14,
+	2,55,22,135,141,25,14,162,164,196,34,98,164,68,34,34,162,36,98,132,166,14,2,56,
+	18,135,137,25,78,98,163,164,68,66,40,34,164,164,194,73,2,57,18,135,141,57,236,162,
+	164,164,164,42,102,34,226,162,164,44,2,58,19,133,137,23,44,34,36,34,36,34,100,100,
+	36,196,98,100,70,12,59,21,139,137,29,14,42,37,37,227,98,162,34,66,100,46,99,35,
+	99,15,8,60,22,139,141,29,38,142,194,34,37,37,165,98,34,36,34,44,37,69,35,15,
+	10,61,21,136,137,26,42,198,196,36,130,196,196,66,12,35,130,34,194,194,14,4,62,16,
+	133,137,23,108,70,100,100,100,34,70,101,100,38,4,63,19,134,141,24,34,168,132,132,36,
+	66,132,42,132,132,132,132,36,8,64,21,139,137,29,38,14,34,37,37,99,67,69,44,162,
+	98,36,99,35,15,10,65,23,138,137,28,14,8,101,130,4,231,66,35,36,34,34,4,67,
+	3,5,15,36,2,66,19,134,137,24,142,132,194,130,194,40,38,34,36,66,132,132,40,4,
+	67,22,137,141,27,14,228,33,34,229,68,130,34,38,34,134,66,228,34,227,14,6,68,16,
+	133,141,23,108,100,100,6,37,102,100,100,98,34,10,69,20,136,137,26,14,34,162,197,196,
+	196,14,36,194,194,196,34,194,14,2,70,18,136,141,26,36,204,226,196,196,196,44,228,196,
+	196,196,14,4,71,24,139,137,29,14,74,66,98,36,99,131,130,228,34,104,34,34,36,99,
+	35,37,15,10,72,17,134,137,24,142,162,228,33,34,34,36,98,196,130,194,12,73,20,135,
+	137,25,36,36,164,164,134,164,164,104,164,164,68,66,164,14,2,74,15,132,137,22,74,98,
+	98,130,66,102,194,66,68,10,75,21,136,137,26,14,100,66,66,162,194,226,68,98,38,204,
+	196,196,196,14,4,76,16,131,141,21,102,34,36,196,34,34,98,34,36,34,4,77,18,133,
+	137,23,34,104,100,162,98,100,36,104,100,132,66,40,4,78,18,134,137,24,142,132,132,132,
+	132,42,36,66,132,132,194,38,4,79,19,135,137,25,174,165,164,164,68,36,164,164,68,66,
+	100,34,36,10,80,17,135,141,25,14,162,164,162,163,38,234,162,164,134,14,2,81,20,136,
+	141,26,14,226,33,195,196,34,72,196,196,162,66,194,42,36,0,82,21,138,137,28,34,14,
+	4,5,5,5,5,71,36,232,6,5,67,15,34,2,83,19,135,137,25,14,130,166,164,164,
+	196,38,4,163,100,34,164,14,2,84,23,139,137,29,14,42,197,66,36,5,39,67,66,40,
+	36,37,37,69,194,36,14,4,85,17,132,141,22,44,68,68,68,68,40,66,68,68,130,34,
+	4,86,17,133,141,23,138,162,98,100,162,34,66,98,100,100,130,12,87,19,134,137,24,34,
+	138,132,132,164,130,36,38,100,194,130,132,40,4,88,16,132,141,22,42,34,66,130,66,194,
+	70,68,68,68,10,89,16,131,141,21,40,36,98,34,36,134,66,34,36,36,2,90,19,135,
+	137,25,238,162,66,34,35,132,36,68,164,226,162,194,14,2,91,17,134,137,24,204,162,130,
+	162,194,142,132,36,66,132,36,8,92,15,131,137,21,40,98,40,36,34,68,66,36,98,6,
+	93,16,132,137,22,104,98,68,68,68,136,68,68,68,38,2,94,18,132,141,22,34,34,66,
+	68,196,68,34,36,66,68,68,68,10,95,15,133,141,23,78,66,99,100,34,106,100,98,102,
+	12,96,18,135,141,25,34,140,166,164,164,132,102,168,194,164,164,14,2,97,18,132,141,54,
+	72,68,68,38,130,34,70,68,68,68,36,34,0,98,22,135,137,25,14,162,164,164,100,34,
+	36,98,70,66,162,164,98,98,162,14,2,99,18,138,141,28,14,198,195,69,162,66,35,238,
+	161,66,3,15,8,100,15,132,137,22,74,100,34,70,68,138,66,38,68,10,101,21,138,137,
+	28,14,34,4,5,5,5,5,39,44,2,67,2,3,229,14,8,102,19,134,141,24,142,132,
+	132,68,66,34,66,36,138,36,66,132,194,12,103,15,132,93,22,42,102,66,68,130,8,67,
+	38,34,6,104,16,132,141,22,36,68,68,2,67,34,42,98,68,100,8,105,23,139,137,29,
+	14,104,35,69,164,36,37,226,34,40,66,34,34,37,227,225,14,8,106,17,132,89,22,136,
+	66,98,68,100,34,130,68,68,68,38,2,107,15,131,137,21,40,68,34,34,98,42,98,34,
+	66,8,108,21,139,141,29,14,42,5,135,130,36,99,39,70,100,35,227,193,14,34,6,109,
+	23,139,141,29,14,42,37,99,35,37,67,66,40,196,66,36,229,34,100,162,14,10,110,19,
+	136,137,26,14,196,196,196,196,34,41,66,194,194,196,34,45,0,111,22,139,137,29,14,42,
+	5,101,35,69,194,38,136,34,37,69,194,68,194,14,10,112,19,135,93,57,236,34,98,164,
+	164,2,37,36,162,164,164,164,14,2,113,23,139,93,29,14,42,37,227,225,98,162,40,34,
+	34,232,34,36,37,165,98,42,12,114,21,139,141,29,14,42,37,67,37,67,41,68,200,66,
+	36,37,37,37,14,4,115,22,137,141,27,14,230,36,162,36,162,228,228,100,68,228,68,130,
+	34,227,36,14,116,20,138,141,28,14,8,133,98,4,67,3,39,40,6,227,129,66,43,8,
+	117,17,132,137,22,34,40,130,66,68,68,38,98,100,66,68,10,118,19,135,137,25,142,66,
+	194,162,100,34,164,38,170,164,164,134,14,2,119,21,137,137,27,14,36,227,130,163,66,130,
+	42,34,230,34,227,228,34,38,8,120,21,139,141,29,14,42,5,133,194,2,35,34,103,36,
+	40,37,37,37,15,10,121,21,136,93,26,14,196,196,2,195,196,14,34,194,132,34,38,130,
+	194,14,4,122,20,139,137,29,72,44,37,7,69,194,36,37,36,108,35,37,37,15,10,123,
+	18,134,141,24,34,138,132,102,132,132,44,130,162,34,130,130,14,124,16,133,137,23,108,36,
+	194,100,100,34,168,98,100,162,10,125,15,131,141,21,40,36,66,98,34,34,70,34,132,8,
+	126,19,135,137,25,14,162,36,98,164,164,132,68,66,34,162,164,194,15,0,0,0,4,255,
+	255,0,0,0,
+};
@@ -0,0 +1,140 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostMpu9250.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		register model of the MPU9250 on the I2C bus of the host build
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include "HostMpu9250.h"
+
+#define REG_I2C_SLV0_ADDR		0x25
+#define REG_I2C_SLV0_REG		0x26
+#define REG_I2C_SLV0_CTRL		0x27
+#define REG_EXT_SENS_DATA_00	0x49
+#define REG_I2C_SLV0_DO			0x63
+#define REG_USER_CTRL			0x6A
+#define REG_PWR_MGMT_1			0x6B
+#define REG_FIFO_COUNTH			0x72
+#define REG_FIFO_COUNTL			0x73
+#define REG_FIFO_R_W			0x74
+#define REG_WHO_AM_I			0x75
+
+#define I2C_SLV0_EN				0x80
+#define I2C_READ_FLAG			0x80
+#define USER_CTRL_FIFO_RST		0x04
+#define PWR_RESET				0x80
+
+HostMpu9250::HostMpu9250()
+{
+	memset(_abReg, 0, sizeof(_abReg));
+	memset(_abMag, 0, sizeof(_abMag));
+	_abMag[0x00] = 0x48;					// AK8963 WHO_AM_I
+	_pointer = 0;
+	_maxBurst = 0;
+}
+
+void HostMpu9250::pushSample(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy, int16_t gz)
+{
+	const int16_t aValue[6] = { ax, ay, az, gx, gy, gz };
+
+	for (uint8_t i = 0; i < 6; i++) {
+		_fifo.push_back((uint8_t)((uint16_t)aValue[i] >> 8));
+		_fifo.push_back((uint8_t)aValue[i]);
+	}
+
+	while (_fifo.size() > HOST_MPU9250_FIFO_SIZE) _fifo.pop_front();
+}
+
+void HostMpu9250::writeRegister(uint8_t reg, uint8_t data)
+{
+	reg &= 0x7f;
+
+	switch (reg) {
+	case REG_USER_CTRL:
+		if (data & USER_CTRL_FIFO_RST) _fifo.clear();
+		data &= (uint8_t)~USER_CTRL_FIFO_RST;
+		break;
+	case REG_PWR_MGMT_1:
+		data &= (uint8_t)~PWR_RESET;
+		break;
+	case REG_FIFO_R_W:
+		_fifo.push_back(data);
+		return;
+	case REG_I2C_SLV0_CTRL:
+		/** the I2C master transfers at once, reads land in EXT_SENS_DATA */
+		if (data & I2C_SLV0_EN) {
+			uint8_t magReg = _abReg[REG_I2C_SLV0_REG] & 0x1f;
+
+			if (_abReg[REG_I2C_SLV0_ADDR] & I2C_READ_FLAG) {
+				for (uint8_t i = 0; i < (data & 0x0f); i++) _abReg[REG_EXT_SENS_DATA_00 + i] = _abMag[(magReg + i) & 0x1f];
+			}
+			else if (magReg != 0x00) {
+				_abMag[magReg] = _abReg[REG_I2C_SLV0_DO];
+			}
+		}
+		break;
+	default:
+		break;
+	}
+
+	_abReg[reg] = data;
+}
+
+uint8_t HostMpu9250::readRegister(uint8_t reg)
+{
+	switch (reg & 0x7f) {
+	case REG_WHO_AM_I:		return 0x71;
+	case REG_FIFO_COUNTH:	return (uint8_t)(_fifo.size() >> 8);
+	case REG_FIFO_COUNTL:	return (uint8_t)_fifo.size();
+	case REG_FIFO_R_W: {
+		uint8_t data = 0;
+
+		if (!_fifo.empty()) {
+			data = _fifo.front();
+			_fifo.pop_front();
+		}
+		return data;
+	}
+	default:				return _abReg[reg & 0x7f];
+	}
+}
+
+void HostMpu9250::i2cWrite(const uint8_t *pData, size_t len)
+{
+	if (len == 0) return;
+
+	_pointer = pData[0];
+
+	/** burst writes auto increment like the reads */
+	for (size_t i = 1; i < len; i++) {
+		writeRegister(_pointer, pData[i]);
+		if (_pointer != REG_FIFO_R_W) _pointer++;
+	}
+}
+
+void HostMpu9250::i2cRead(uint8_t *pData, size_t len)
+{
+	if (_pointer == REG_FIFO_R_W && len > _maxBurst) _maxBurst = len;
+
+	/** the FIFO port does not increment, everything else does */
+	for (size_t i = 0; i < len; i++) {
+		pData[i] = readRegister(_pointer);
+		if (_pointer != REG_FIFO_R_W) _pointer++;
+	}
+}
@@ -0,0 +1,60 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostMpu9250.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		register model of the MPU9250 on the I2C bus of the host build
+* @details		Enough of the register map for the MPU9250 and ImpactDetector libraries: register read/write with
+*				auto increment, WHO_AM_I, the FIFO (count, read, reset, 512 byte limit) and the AK8963 behind the
+*				I2C master (SLV0 read and write). A sample is pushed as accel and gyro counts, the FIFO frame layout
+*				of the ImpactDetector.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_MPU9250_H
+#define __HOST_MPU9250_H
+
+#include <deque>
+#include "Wire.h"
+
+#define HOST_MPU9250_FIFO_SIZE		512
+
+class HostMpu9250 : public HostI2cDevice
+{
+public:
+	HostMpu9250();
+
+	/** append one FIFO frame, drops the oldest frame bytes when full like the chip */
+	void pushSample(int16_t ax, int16_t ay, int16_t az, int16_t gx, int16_t gy, int16_t gz);
+
+	size_t getFifoLevel() const { return _fifo.size(); }
+	size_t getMaxBurst() const { return _maxBurst; }
+	uint8_t getRegister(uint8_t reg) const { return _abReg[reg & 0x7f]; }
+
+	void i2cWrite(const uint8_t *pData, size_t len);
+	void i2cRead(uint8_t *pData, size_t len);
+
+private:
+	void writeRegister(uint8_t reg, uint8_t data);
+	uint8_t readRegister(uint8_t reg);
+
+	uint8_t _abReg[128];
+	uint8_t _abMag[32];
+	uint8_t _pointer;
+	std::deque<uint8_t> _fifo;
+	size_t _maxBurst;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostSsd1322.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		in-memory SSD1322 panel on the SPI bus of the host build
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include "HostSsd1322.h"
+#include "HostShim.h"
+
+#define CMD_SET_COLUMN		0x15
+#define CMD_WRITE_RAM		0x5C
+#define CMD_SET_ROW			0x75
+
+HostSsd1322::HostSsd1322(uint8_t csPin, uint8_t dcPin, uint8_t columnOffset)
+{
+	_csPin = csPin;
+	_dcPin = dcPin;
+	_columnOffset = columnOffset;
+	memset(_abRam, 0, sizeof(_abRam));
+	_command = 0;
+	_argCount = 0;
+	_columnStart = _column = 0;
+	_columnEnd = HOST_SSD1322_ROW_BYTES / 2 - 1;
+	_rowStart = _row = 0;
+	_rowEnd = HOST_SSD1322_ROWS - 1;
+	_byte = 0;
+	_commandCount = 0;
+	_dataCount = 0;
+}
+
+uint8_t HostSsd1322::getPixel(uint16_t x, uint16_t y) const
+{
+	uint16_t pixel = (uint16_t)(_columnOffset * 4 + x);
+
+	if (y >= HOST_SSD1322_ROWS || pixel >= HOST_SSD1322_ROW_BYTES * 2) return 0;
+
+	/** two pixel per byte, the first pixel in the high nibble */
+	return (pixel & 1) ? (_abRam[y][pixel / 2] & 0x0f) : (_abRam[y][pixel / 2] >> 4);
+}
+
+void HostSsd1322::command(uint8_t data)
+{
+	_command = data;
+	_argCount = 0;
+	_commandCount++;
+
+	if (_command == CMD_WRITE_RAM) {
+		_column = _columnStart;
+		_row = _rowStart;
+		_byte = 0;
+	}
+}
+
+void HostSsd1322::argument(uint8_t data)
+{
+	switch (_command) {
+	case CMD_SET_COLUMN:
+		if (_argCount == 0) _columnStart = data % (HOST_SSD1322_ROW_BYTES / 2);
+		else if (_argCount == 1) _columnEnd = data % (HOST_SSD1322_ROW_BYTES / 2);
+		break;
+	case CMD_SET_ROW:
+		if (_argCount == 0) _rowStart = data % HOST_SSD1322_ROWS;
+		else if (_argCount == 1) _rowEnd = data % HOST_SSD1322_ROWS;
+		break;
+	case CMD_WRITE_RAM:
+		/** horizontal address increment inside the window, wraps to the start like the controller */
+		_abRam[_row][_column * 2 + _byte] = data;
+		_dataCount++;
+		if (++_byte == 2) {
+			_byte = 0;
+			if (_column == _columnEnd) {
+				_column = _columnStart;
+				_row = (_row == _rowEnd) ? _rowStart : (uint8_t)((_row + 1) % HOST_SSD1322_ROWS);
+			}
+			else {
+				_column = (uint8_t)((_column + 1) % (HOST_SSD1322_ROW_BYTES / 2));
+			}
+		}
+		return;
+	default:
+		break;
+	}
+
+	_argCount++;
+}
+
+uint8_t HostSsd1322::spiTransfer(uint8_t data)
+{
+	if (hostGetPin(_csPin) != LOW) return 0xff;
+
+	if (hostGetPin(_dcPin) == LOW) command(data);
+	else argument(data);
+
+	return 0xff;
+}
@@ -0,0 +1,64 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostSsd1322.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		in-memory SSD1322 panel on the SPI bus of the host build
+* @details		Decodes the 4-wire SPI stream of the controller (D/C and CS pins read from the shim) into the
+*				480x128 4 bit display RAM. Only the commands the U8g2 driver uses for drawing are interpreted:
+*				column address (0x15), row address (0x75) and write RAM (0x5C), everything else is counted.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_SSD1322_H
+#define __HOST_SSD1322_H
+
+#include "SPI.h"
+
+#define HOST_SSD1322_ROWS			128
+#define HOST_SSD1322_ROW_BYTES		240			// 120 column addresses of 4 pixel, 2 bytes each
+
+class HostSsd1322 : public HostSpiDevice
+{
+public:
+	HostSsd1322(uint8_t csPin, uint8_t dcPin, uint8_t columnOffset = 0x1c);
+
+	/** gray level 0..15 of a pixel of the visible area, x counted from the column offset */
+	uint8_t getPixel(uint16_t x, uint16_t y) const;
+	const uint8_t *getRow(uint8_t row) const { return _abRam[row]; }
+
+	uint32_t getCommandCount() const { return _commandCount; }
+	uint32_t getDataCount() const { return _dataCount; }
+	void resetCounts() { _commandCount = 0; _dataCount = 0; }
+
+	uint8_t spiTransfer(uint8_t data);
+
+private:
+	void command(uint8_t data);
+	void argument(uint8_t data);
+
+	uint8_t _csPin;
+	uint8_t _dcPin;
+	uint8_t _columnOffset;
+	uint8_t _abRam[HOST_SSD1322_ROWS][HOST_SSD1322_ROW_BYTES];
+	uint8_t _command;
+	uint8_t _argCount;
+	uint8_t _columnStart, _columnEnd, _rowStart, _rowEnd;
+	uint8_t _column, _row, _byte;
+	uint32_t _commandCount;
+	uint32_t _dataCount;
+};
+
+#endif
@@ -0,0 +1,216 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			TraceReplay.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		replay of an input trace of the gateway through the parsers of the firmware
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <math.h>
+#include "lmic/lmic.h"
+#include "HostShim.h"
+#include "TraceReplay.h"
+
+/** BLE_CLIENT.ino */
+#define IMU_ADDRESS			0x68
+#define IMU_SDA				21
+#define IMU_SCL				22
+#define IMU_INT_PIN			39
+#define IMU_ODR_HZ			200
+#define IMU_BATCH_SAMPLES	10
+
+static const char *const apSourceNames[INPUT_TRACE_SOURCE_MAX] = { "boot", "bms notify", "controller notify", "gps", "imu fifo", "lmic event" };
+
+static TraceReplay *pActive;
+
+TraceReplay::TraceReplay() : _imu(100, 2000, 0.1, 2.0, 4.0, IMU_ADDRESS, IMU_SDA, IMU_SCL)
+{
+	memset(&_tSummary, 0, sizeof(_tSummary));
+	_isImuReady = false;
+}
+
+TraceReplay::~TraceReplay()
+{
+	if (pActive == this) pActive = NULL;
+	Wire.attach(IMU_ADDRESS, NULL);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		feed all records of a trace partition image into the parsers
+* @param[in]	pImage					image of the trace partition
+* @param[in]	len						length of the image
+* @retval		false if the image holds no block of the trace
+*/
+/************************************************************************************************************************/
+bool TraceReplay::run(const uint8_t *pImage, size_t len)
+{
+	InputTraceReader reader;
+	INPUT_TRACE_RECORD_HEADER_T tRecord;
+	const uint8_t *pData;
+	uint64_t ullFirstUs = 0;
+	bool hasRecord = false;
+
+	pActive = this;
+	_bms.setInfoStatusCallback(bmsInfoStatusCallback);
+	_gps.setFixHandler(gpsFixHandler);
+
+	Wire.attach(IMU_ADDRESS, &_mpu);
+	_isImuReady = (_imu.begin() > 0) && (_imu.enableSampling(IMU_INT_PIN, IMU_ODR_HZ, IMU_BATCH_SAMPLES) > 0);
+
+	if (!reader.begin(pImage, len)) return false;
+
+	/** the virtual clock only moves forward, the trace time is added to the time after the setup */
+	uint64_t ullStartUs = hostGetTimeUs();
+
+	while (reader.next(&tRecord, &pData)) {
+		if (!hasRecord) ullFirstUs = reader.getTimeUs();
+		hasRecord = true;
+
+		hostSetTimeUs(ullStartUs + (reader.getTimeUs() - ullFirstUs));
+		replayRecord(tRecord, pData);
+		_tSummary.ullDurationUs = reader.getTimeUs() - ullFirstUs;
+	}
+
+	_tSummary.ulDropped = reader.getDroppedCount();
+	_tSummary.ulMissingBlocks = reader.getMissingBlocks();
+	_tSummary.ulBmsErrors = _bms.getErrorCount();
+	_tSummary.ulControllerErrors = _controller.getErrorCount();
+	_tSummary.ulGpsSentences = _gps.passedChecksum() + _gps.failedChecksum();
+	_tSummary.ulGpsChecksumErrors = _gps.failedChecksum();
+	_tSummary.ulImuSamples = _imu.getSampleCount();
+
+	return true;
+}
+
+void TraceReplay::replayRecord(const INPUT_TRACE_RECORD_HEADER_T &tRecord, const uint8_t *pData)
+{
+	CONTROLLER_PACKET_STRUCT_T tController;
+
+	if (tRecord.bSource >= INPUT_TRACE_SOURCE_MAX) return;
+
+	_tSummary.aulRecords[tRecord.bSource]++;
+	_tSummary.aulBytes[tRecord.bSource] += tRecord.usLength;
+
+	switch (tRecord.bSource) {
+	case INPUT_TRACE_SOURCE_BMS_NOTIFY:
+		_bms.bmsReadInfoStatus(pData, tRecord.usLength);
+		break;
+	case INPUT_TRACE_SOURCE_CONTROLLER_NOTIFY:
+		if (_controller.readParsePacket(&tController, pData, tRecord.usLength)) {
+			_tSummary.ulControllerFrames++;
+			_tSummary.ulControllerSpeed = tController.tPacket.ulSpeedKmH;
+		}
+		break;
+	case INPUT_TRACE_SOURCE_GPS:
+		_gps.encode((const char *)pData, tRecord.usLength);
+		break;
+	case INPUT_TRACE_SOURCE_IMU_FIFO:
+		replayImuFifo(pData, tRecord.usLength);
+		break;
+	case INPUT_TRACE_SOURCE_LMIC_EVENT:
+		replayLmicEvent(pData, tRecord.usLength);
+		break;
+	default:
+		break;
+	}
+}
+
+/** the burst goes back into the FIFO of the model, the detector reads it like on the device */
+void TraceReplay::replayImuFifo(const uint8_t *pData, uint16_t usLength)
+{
+	int16_t aCounts[6];
+
+	if (!_isImuReady) return;
+
+	for (uint16_t offset = 0; offset + IMPACT_FIFO_FRAME_SIZE <= usLength; offset += IMPACT_FIFO_FRAME_SIZE) {
+		for (uint8_t i = 0; i < 6; i++) aCounts[i] = (int16_t)((pData[offset + 2 * i] << 8) | pData[offset + 2 * i + 1]);
+		_mpu.pushSample(aCounts[0], aCounts[1], aCounts[2], aCounts[3], aCounts[4], aCounts[5]);
+	}
+
+	if (_imu.detector()) {
+		_tSummary.ulImpacts++;
+		_tSummary.ulImpactOnsetSample = _imu.getImpactOnsetSample();
+	}
+}
+
+/** payload of traceLmicEvent(): event, txrxFlags, dataLen, downlink bytes */
+void TraceReplay::replayLmicEvent(const uint8_t *pData, uint16_t usLength)
+{
+	if (usLength < 3) return;
+
+	switch (pData[0]) {
+	case EV_JOINED:
+		_tSummary.ulLmicJoins++;
+		break;
+	case EV_TXCOMPLETE:
+		_tSummary.ulLmicTxComplete++;
+		if (pData[1] & TXRX_ACK) _tSummary.ulLmicAcks++;
+		if (pData[2] > 0) {
+			_tSummary.ulLmicDownlinks++;
+			_tSummary.ulLmicDownlinkBytes += usLength - 3;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void TraceReplay::bmsInfoStatusCallback(const BMS_INFO_STATUS_READ_STRUCT_T *tInfoStatus)
+{
+	if (pActive == NULL) return;
+
+	/** big endian as in bmsInfoStatusCallback() of the gateway */
+	pActive->_tSummary.ulBmsFrames++;
+	pActive->_tSummary.usBmsVoltage = (uint16_t)((tInfoStatus->usTotalVoltage >> 8) | (tInfoStatus->usTotalVoltage << 8));
+	pActive->_tSummary.bBmsRsoc = tInfoStatus->bRelStateOfCharge;
+}
+
+void TraceReplay::gpsFixHandler(TinyGPSPlus &gps)
+{
+	if (pActive == NULL) return;
+
+	pActive->_tSummary.ulGpsFixes++;
+	pActive->_tSummary.lGpsLatitude = (int32_t)lround(gps.location.lat() * 1e6);
+	pActive->_tSummary.lGpsLongitude = (int32_t)lround(gps.location.lng() * 1e6);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		print the summary of the replay
+* @param[in]	pFile					output, e.g. stdout
+* @retval		none
+*/
+/************************************************************************************************************************/
+void TraceReplay::print(FILE *pFile) const
+{
+	fprintf(pFile, "trace: %.3f s, %u dropped records, %u missing blocks\n", _tSummary.ullDurationUs / 1e6,
+		_tSummary.ulDropped, _tSummary.ulMissingBlocks);
+	for (uint8_t i = 0; i < INPUT_TRACE_SOURCE_MAX; i++) {
+		fprintf(pFile, "  %-18s %8u records %10u bytes\n", apSourceNames[i], _tSummary.aulRecords[i], _tSummary.aulBytes[i]);
+	}
+	fprintf(pFile, "bms:        %u frames, %u errors, last %u0 mV %u%%\n", _tSummary.ulBmsFrames, _tSummary.ulBmsErrors,
+		_tSummary.usBmsVoltage, _tSummary.bBmsRsoc);
+	fprintf(pFile, "controller: %u frames, %u errors, last %u km/h\n", _tSummary.ulControllerFrames, _tSummary.ulControllerErrors,
+		_tSummary.ulControllerSpeed);
+	fprintf(pFile, "gps:        %u sentences, %u checksum errors, %u fixes, last %.6f %.6f\n", _tSummary.ulGpsSentences,
+		_tSummary.ulGpsChecksumErrors, _tSummary.ulGpsFixes, _tSummary.lGpsLatitude / 1e6, _tSummary.lGpsLongitude / 1e6);
+	fprintf(pFile, "imu:        %u samples, %u impacts, last onset sample %u\n", _tSummary.ulImuSamples, _tSummary.ulImpacts,
+		_tSummary.ulImpactOnsetSample);
+	fprintf(pFile, "lmic:       %u joins, %u tx complete, %u acks, %u downlinks with %u bytes\n", _tSummary.ulLmicJoins,
+		_tSummary.ulLmicTxComplete, _tSummary.ulLmicAcks, _tSummary.ulLmicDownlinks, _tSummary.ulLmicDownlinkBytes);
+}
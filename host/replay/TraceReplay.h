@@ -0,0 +1,96 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			TraceReplay.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		replay of an input trace of the gateway through the parsers of the firmware
+* @details		InputTraceReader walks a dump of the trace partition oldest record first, every record is fed into the
+*				library the gateway hands it to: the notify payloads into BMSPacketHandler and ControllerPacketHandler,
+*				the GPS bytes into TinyGPSPlus, the IMU FIFO bursts through the register model of the MPU9250 into the
+*				ImpactDetector. LMIC events are counted. The virtual clock of the shim follows the time stamps of the
+*				records, the replay itself runs as fast as the host does.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	the decoders run on across a boot record, a frame cut by the reset shows as one damaged frame
+*	-	one replay at a time, the parser callbacks have no context pointer
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __TRACE_REPLAY_H
+#define __TRACE_REPLAY_H
+
+#include <stdio.h>
+#include <InputTrace.h>
+#include <BMSPacketHandler.h>
+#include <ControllerPacketHandler.h>
+#include <TinyGPS++.h>
+#include <MPU9250_Impact.h>
+#include "HostMpu9250.h"
+
+/** result of a replay, equal for equal traces */
+typedef struct TRACE_REPLAY_SUMMARY_Ttag {
+	uint32_t	aulRecords[INPUT_TRACE_SOURCE_MAX];		//!< records per source
+	uint32_t	aulBytes[INPUT_TRACE_SOURCE_MAX];		//!< payload bytes per source
+	uint64_t	ullDurationUs;							//!< first to last record
+	uint32_t	ulDropped;								//!< records dropped by the recorder
+	uint32_t	ulMissingBlocks;
+	uint32_t	ulBmsFrames;
+	uint32_t	ulBmsErrors;
+	uint16_t	usBmsVoltage;							//!< last total voltage [10 mV]
+	uint8_t		bBmsRsoc;								//!< last relative state of charge [%]
+	uint32_t	ulControllerFrames;
+	uint32_t	ulControllerErrors;
+	uint32_t	ulControllerSpeed;						//!< last speed [km/h]
+	uint32_t	ulGpsSentences;
+	uint32_t	ulGpsChecksumErrors;
+	uint32_t	ulGpsFixes;
+	int32_t		lGpsLatitude;							//!< last fix [micro degrees]
+	int32_t		lGpsLongitude;
+	uint32_t	ulImuSamples;
+	uint32_t	ulImpacts;
+	uint32_t	ulImpactOnsetSample;					//!< running number of the sample of the last impact
+	uint32_t	ulLmicJoins;
+	uint32_t	ulLmicTxComplete;
+	uint32_t	ulLmicAcks;
+	uint32_t	ulLmicDownlinks;
+	uint32_t	ulLmicDownlinkBytes;
+} TRACE_REPLAY_SUMMARY_T;
+
+class TraceReplay
+{
+public:
+	TraceReplay();
+	~TraceReplay();
+
+	bool run(const uint8_t *pImage, size_t len);
+	const TRACE_REPLAY_SUMMARY_T &getSummary() const { return _tSummary; }
+	void print(FILE *pFile) const;
+
+private:
+	void replayRecord(const INPUT_TRACE_RECORD_HEADER_T &tRecord, const uint8_t *pData);
+	void replayImuFifo(const uint8_t *pData, uint16_t usLength);
+	void replayLmicEvent(const uint8_t *pData, uint16_t usLength);
+
+	static void bmsInfoStatusCallback(const BMS_INFO_STATUS_READ_STRUCT_T *tInfoStatus);
+	static void gpsFixHandler(TinyGPSPlus &gps);
+
+	BMSPacketHandler _bms;
+	ControllerPacketHandler _controller;
+	TinyGPSPlus _gps;
+	HostMpu9250 _mpu;
+	ImpactDetector _imu;
+	bool _isImuReady;
+	TRACE_REPLAY_SUMMARY_T _tSummary;
+};
+
+#endif
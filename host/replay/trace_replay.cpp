@@ -0,0 +1,83 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			trace_replay.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		replay runner of the input trace of the gateway
+* @details		trace_replay <image> [<image> ...]
+*
+*				Every image is a dump of the trace partition, e.g. read by
+*				esptool.py read_flash <offset of the trace partition> <size> trace.bin
+*				The records are fed through the parsers of the firmware, the summary and the host time of the replay
+*				are printed per image. Equal summaries of two firmware versions mean equal parsing of the ride.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <chrono>
+#include <vector>
+#include "TraceReplay.h"
+
+static bool readImage(const char *pPath, std::vector<uint8_t> &image)
+{
+	FILE *pFile = fopen(pPath, "rb");
+	uint8_t abChunk[4096];
+	size_t len;
+
+	if (pFile == NULL) return false;
+
+	image.clear();
+	while ((len = fread(abChunk, 1, sizeof(abChunk), pFile)) > 0) image.insert(image.end(), abChunk, abChunk + len);
+	fclose(pFile);
+
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<uint8_t> image;
+	int result = 0;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <trace partition image> [<trace partition image> ...]\n", argv[0]);
+		return 2;
+	}
+
+	for (int i = 1; i < argc; i++) {
+		TraceReplay replay;
+
+		if (!readImage(argv[i], image)) {
+			fprintf(stderr, "%s: cannot be read\n", argv[i]);
+			result = 1;
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		bool isReplayed = replay.run(image.data(), image.size());
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+		if (!isReplayed) {
+			fprintf(stderr, "%s: no trace block found\n", argv[i]);
+			result = 1;
+			continue;
+		}
+
+		printf("%s\n", argv[i]);
+		replay.print(stdout);
+		printf("replay: %.1f ms on the host, %.0f times real time\n\n", ms,
+			(ms > 0) ? replay.getSummary().ullDurationUs / 1e3 / ms : 0.0);
+	}
+
+	return result;
+}
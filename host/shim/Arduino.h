@@ -0,0 +1,112 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			Arduino.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		Arduino core shim of the host build
+* @details		Just enough of the ESP32 Arduino core to build the libraries on a Linux host: the basic types and
+*				macros, String, Print/Stream, HardwareSerial, the GPIO and interrupt functions and the time functions.
+*				Like the ESP32 core it pulls in FreeRTOS, so the libraries see the same declarations as on the target.
+*
+*				The time functions run on a virtual clock which only moves by delay(), blocking FreeRTOS calls, bus
+*				transfers of the shim and the host control functions of HostShim.h, so every run is deterministic.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	single threaded, tasks are created but never run
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_ARDUINO_H
+#define __HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <cmath>
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#define HIGH				0x1
+#define LOW					0x0
+
+#define INPUT				0x01
+#define OUTPUT				0x02
+#define INPUT_PULLUP		0x05
+#define INPUT_PULLDOWN		0x09
+
+#define RISING				0x01
+#define FALLING				0x02
+#define CHANGE				0x03
+
+#define PI					3.1415926535897932384626433832795
+#define HALF_PI				1.5707963267948966192313216916398
+#define TWO_PI				6.283185307179586476925286766559
+#define DEG_TO_RAD			0.017453292519943295769236907684886
+#define RAD_TO_DEG			57.295779513082320876798154814105
+
+#define radians(deg)		((deg)*DEG_TO_RAD)
+#define degrees(rad)		((rad)*RAD_TO_DEG)
+#define sq(x)				((x)*(x))
+#define constrain(amt, low, high)	((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define PROGMEM
+#define PSTR(s)				(s)
+#define F(s)				(s)
+#define pgm_read_byte(addr)	(*(const uint8_t *)(addr))
+#define pgm_read_word(addr)	(*(const uint16_t *)(addr))
+
+#define digitalPinToInterrupt(p)	(p)
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+#ifdef __cplusplus
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HardwareSerial.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		HardwareSerial of the host build
+* @details		The transmitted bytes go to stdout (Serial) or are kept for the test (all other ports). Received bytes
+*				are given by the test with inject().
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_HARDWARE_SERIAL_H
+#define __HOST_HARDWARE_SERIAL_H
+
+#include <deque>
+#include <vector>
+#include "Print.h"
+
+class HardwareSerial : public Stream
+{
+public:
+	HardwareSerial(int uartNr) : _uartNr(uartNr) {}
+
+	void begin(unsigned long baud, uint32_t config = 0, int8_t rxPin = -1, int8_t txPin = -1) { (void)baud; (void)config; (void)rxPin; (void)txPin; }
+	void end() {}
+
+	int available() { return (int)_rx.size(); }
+	int peek() { return _rx.empty() ? -1 : _rx.front(); }
+	int read();
+
+	size_t write(uint8_t c);
+	using Print::write;
+
+	/** host side of the port */
+	void inject(const uint8_t *pData, size_t len) { _rx.insert(_rx.end(), pData, pData + len); }
+	std::vector<uint8_t> &transmitted() { return _tx; }
+
+private:
+	int _uartNr;
+	std::deque<uint8_t> _rx;
+	std::vector<uint8_t> _tx;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif
@@ -0,0 +1,348 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostArduino.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		Arduino core, Wire, SPI, esp_timer and ESP_LOG shim of the host build
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdarg.h>
+#include "Arduino.h"
+#include "Wire.h"
+#include "SPI.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "HostShim.h"
+
+#define HOST_PINS			64
+
+static uint64_t ullTimeUs;
+static uint8_t abPinLevel[HOST_PINS];
+static void (*apIsr[HOST_PINS])(void);
+static esp_log_level_t eLogLevel = ESP_LOG_WARN;
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+TwoWire Wire(0);
+TwoWire Wire1(1);
+SPIClass SPI(3);
+
+
+uint64_t hostGetTimeUs(void) { return ullTimeUs; }
+void hostSetTimeUs(uint64_t ullNewTimeUs) { ullTimeUs = ullNewTimeUs; }
+void hostAdvanceTimeUs(uint64_t ullDeltaUs) { ullTimeUs += ullDeltaUs; }
+
+int hostTriggerInterrupt(uint8_t pin)
+{
+	if (pin >= HOST_PINS || apIsr[pin] == NULL) return 0;
+
+	apIsr[pin]();
+	return 1;
+}
+
+void hostSetPin(uint8_t pin, uint8_t level) { if (pin < HOST_PINS) abPinLevel[pin] = level; }
+uint8_t hostGetPin(uint8_t pin) { return (pin < HOST_PINS) ? abPinLevel[pin] : 0; }
+
+
+/** the target counters are 32 bit wide and wrap */
+unsigned long millis() { return (uint32_t)(ullTimeUs / 1000); }
+unsigned long micros() { return (uint32_t)ullTimeUs; }
+void delay(uint32_t ms) { ullTimeUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { ullTimeUs += us; }
+void yield() {}
+
+int64_t esp_timer_get_time(void) { return (int64_t)ullTimeUs; }
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t val) { hostSetPin(pin, val); }
+int digitalRead(uint8_t pin) { return hostGetPin(pin); }
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+	(void)mode;
+	if (pin < HOST_PINS) apIsr[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+	if (pin < HOST_PINS) apIsr[pin] = NULL;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+	return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+/** fixed sequence, a run does not depend on the host */
+static uint32_t ulRandom = 1;
+void randomSeed(unsigned long seed) { ulRandom = seed ? (uint32_t)seed : 1; }
+long random(long max)
+{
+	ulRandom ^= ulRandom << 13;
+	ulRandom ^= ulRandom >> 17;
+	ulRandom ^= ulRandom << 5;
+	return (max > 0) ? (long)(ulRandom % (uint32_t)max) : 0;
+}
+long random(long min, long max) { return (max > min) ? min + random(max - min) : min; }
+
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+	(void)tag;
+	eLogLevel = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+	va_list args;
+
+	(void)tag;
+	if (level > eLogLevel) return;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+}
+
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+	size_t n = 0;
+
+	while (size--) n += write(*buffer++);
+
+	return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+	char acBuffer[128];
+	char *pBuffer = acBuffer;
+	va_list args;
+	int len;
+
+	va_start(args, format);
+	len = vsnprintf(acBuffer, sizeof(acBuffer), format, args);
+	va_end(args);
+
+	if (len < 0) return 0;
+
+	if ((size_t)len >= sizeof(acBuffer)) {
+		pBuffer = new char[len + 1];
+		va_start(args, format);
+		vsnprintf(pBuffer, len + 1, format, args);
+		va_end(args);
+	}
+
+	len = (int)write((const uint8_t *)pBuffer, len);
+	if (pBuffer != acBuffer) delete[] pBuffer;
+
+	return len;
+}
+
+size_t Print::print(long value, int base)
+{
+	return (value < 0 && base == DEC) ? print('-') + print((unsigned long)-value, base) : print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+	return print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int digits)
+{
+	return printf("%.*f", digits, value);
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length)
+{
+	size_t count = 0;
+
+	while (count < length && available() > 0) buffer[count++] = (uint8_t)read();
+
+	return count;
+}
+
+
+int HardwareSerial::read()
+{
+	if (_rx.empty()) return -1;
+
+	int c = _rx.front();
+	_rx.pop_front();
+
+	return c;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+	if (_uartNr == 0) fputc(c, stdout);
+	else _tx.push_back(c);
+
+	return 1;
+}
+
+
+TwoWire::TwoWire(uint8_t busNum)
+{
+	(void)busNum;
+	_frequency = 100000;
+	_txAddress = 0;
+	_txLength = 0;
+	_isTransmitting = false;
+	_rxLength = 0;
+	_rxIndex = 0;
+	_transferCount = 0;
+	memset(_aAddress, 0, sizeof(_aAddress));
+	memset(_apDevice, 0, sizeof(_apDevice));
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+	(void)sda;
+	(void)scl;
+	if (frequency) _frequency = frequency;
+
+	return true;
+}
+
+void TwoWire::attach(uint8_t address, HostI2cDevice *pDevice)
+{
+	for (uint8_t i = 0; i < sizeof(_apDevice) / sizeof(_apDevice[0]); i++) {
+		if (_apDevice[i] == NULL || _aAddress[i] == address) {
+			_aAddress[i] = address;
+			_apDevice[i] = pDevice;
+			return;
+		}
+	}
+}
+
+HostI2cDevice *TwoWire::device(uint16_t address) const
+{
+	for (uint8_t i = 0; i < sizeof(_apDevice) / sizeof(_apDevice[0]); i++) {
+		if (_apDevice[i] != NULL && _aAddress[i] == address) return _apDevice[i];
+	}
+
+	return NULL;
+}
+
+void TwoWire::busTime(size_t bytes)
+{
+	/** start, address byte and stop, 9 clocks per byte */
+	ullTimeUs += ((bytes + 1) * 9 + 2) * 1000000ULL / _frequency;
+	_transferCount++;
+}
+
+void TwoWire::beginTransmission(uint16_t address)
+{
+	_txAddress = address;
+	_txLength = 0;
+	_isTransmitting = true;
+}
+
+size_t TwoWire::write(uint8_t data)
+{
+	if (!_isTransmitting || _txLength >= I2C_BUFFER_LENGTH) return 0;
+
+	_abTx[_txLength++] = data;
+
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t *pData, size_t len)
+{
+	size_t n = 0;
+
+	while (n < len && write(pData[n])) n++;
+
+	return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+	HostI2cDevice *pDevice = device(_txAddress);
+
+	(void)sendStop;
+	_isTransmitting = false;
+	busTime(_txLength);
+
+	/** 2: address not acknowledged */
+	if (pDevice == NULL) return 2;
+
+	pDevice->i2cWrite(_abTx, _txLength);
+
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint16_t address, uint8_t size, bool sendStop)
+{
+	HostI2cDevice *pDevice = device(address);
+
+	(void)sendStop;
+	_rxIndex = 0;
+	_rxLength = 0;
+
+	if (size > I2C_BUFFER_LENGTH) size = I2C_BUFFER_LENGTH;
+	busTime(size);
+
+	if (pDevice == NULL) return 0;
+
+	pDevice->i2cRead(_abRx, size);
+	_rxLength = size;
+
+	return size;
+}
+
+
+SPIClass::SPIClass(uint8_t spiBus)
+{
+	(void)spiBus;
+	_pDevice = NULL;
+	_frequency = 1000000;
+	_byteCount = 0;
+	_bitRemainder = 0;
+}
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+	/** 8 clocks, the remainder of the division is carried to the next byte */
+	_bitRemainder += 8 * 1000000;
+	ullTimeUs += _bitRemainder / _frequency;
+	_bitRemainder %= _frequency;
+	_byteCount++;
+
+	return (_pDevice != NULL) ? _pDevice->spiTransfer(data) : 0xff;
+}
+
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+	uint16_t high = transfer((uint8_t)(data >> 8));
+
+	return (uint16_t)((high << 8) | transfer((uint8_t)data));
+}
+
+void SPIClass::transfer(uint8_t *pData, uint32_t size)
+{
+	for (uint32_t i = 0; i < size; i++) pData[i] = transfer(pData[i]);
+}
+
+void SPIClass::writeBytes(const uint8_t *pData, uint32_t size)
+{
+	for (uint32_t i = 0; i < size; i++) transfer(pData[i]);
+}
@@ -0,0 +1,380 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostFreeRTOS.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		FreeRTOS shim of the host build
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "HostShim.h"
+
+struct HostTask {
+	char			acName[configMAX_TASK_NAME_LEN];
+	TaskFunction_t	pvTaskCode;
+	void			*pvParameters;
+	uint32_t		ulNotifyValue;
+};
+
+struct HostQueue {
+	UBaseType_t		uxLength;
+	UBaseType_t		uxItemSize;
+	std::deque<std::vector<uint8_t> > items;
+};
+
+struct HostEventGroup {
+	EventBits_t		uxBits;
+};
+
+static HostTask tMainTask = { "main", NULL, NULL, 0 };
+
+
+/** a blocking call that can not succeed waits for its timeout, there is nobody who could make it succeed */
+static void waitTimeout(TickType_t xTicksToWait)
+{
+	if (xTicksToWait != portMAX_DELAY) hostAdvanceTimeUs((uint64_t)xTicksToWait * portTICK_PERIOD_MS * 1000);
+}
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux)
+{
+	mux->owner = 0;
+	mux->count = 0;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+	return 0;
+}
+
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+	UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask, BaseType_t xCoreID)
+{
+	HostTask *pTask = new HostTask();
+
+	(void)usStackDepth;
+	(void)uxPriority;
+	(void)xCoreID;
+
+	strncpy(pTask->acName, pcName ? pcName : "", configMAX_TASK_NAME_LEN - 1);
+	pTask->pvTaskCode = pvTaskCode;
+	pTask->pvParameters = pvParameters;
+	pTask->ulNotifyValue = 0;
+
+	if (pvCreatedTask != NULL) *pvCreatedTask = pTask;
+
+	return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, uint32_t usStackDepth, void *pvParameters,
+	UBaseType_t uxPriority, TaskHandle_t *pvCreatedTask)
+{
+	return xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t xTask)
+{
+	if (xTask != NULL && xTask != &tMainTask) delete xTask;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	hostAdvanceTimeUs((uint64_t)xTicksToDelay * portTICK_PERIOD_MS * 1000);
+}
+
+void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+	TickType_t xWakeTime = *pxPreviousWakeTime + xTimeIncrement;
+	TickType_t xNow = xTaskGetTickCount();
+
+	if ((int32_t)(xWakeTime - xNow) > 0) vTaskDelay(xWakeTime - xNow);
+	*pxPreviousWakeTime = xWakeTime;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(hostGetTimeUs() / (portTICK_PERIOD_MS * 1000));
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+	return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return &tMainTask;
+}
+
+char *pcTaskGetTaskName(TaskHandle_t xTask)
+{
+	return (xTask != NULL) ? xTask->acName : tMainTask.acName;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+	(void)xTask;
+	return 0;
+}
+
+uint32_t hostGetTaskNotifyCount(TaskHandle_t xTask)
+{
+	return (xTask != NULL) ? xTask->ulNotifyValue : tMainTask.ulNotifyValue;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+	uint32_t ulValue = tMainTask.ulNotifyValue;
+
+	if (ulValue == 0) {
+		waitTimeout(xTicksToWait);
+		return 0;
+	}
+
+	tMainTask.ulNotifyValue = xClearCountOnExit ? 0 : ulValue - 1;
+
+	return ulValue;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t xTask, uint32_t ulValue, eNotifyAction eAction)
+{
+	HostTask *pTask = (xTask != NULL) ? xTask : &tMainTask;
+
+	switch (eAction) {
+	case eSetBits:					pTask->ulNotifyValue |= ulValue; break;
+	case eIncrement:				pTask->ulNotifyValue++; break;
+	case eSetValueWithOverwrite:	pTask->ulNotifyValue = ulValue; break;
+	case eSetValueWithoutOverwrite:
+		if (pTask->ulNotifyValue != 0) return pdFAIL;
+		pTask->ulNotifyValue = ulValue;
+		break;
+	default:						break;
+	}
+
+	return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t xTask, uint32_t ulValue, eNotifyAction eAction, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdFALSE;
+
+	return xTaskNotify(xTask, ulValue, eAction);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTask)
+{
+	return xTaskNotify(xTask, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTask, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	xTaskNotifyFromISR(xTask, 0, eIncrement, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit, uint32_t *pulNotificationValue, TickType_t xTicksToWait)
+{
+	tMainTask.ulNotifyValue &= ~ulBitsToClearOnEntry;
+
+	if (tMainTask.ulNotifyValue == 0) {
+		waitTimeout(xTicksToWait);
+		return pdFALSE;
+	}
+
+	if (pulNotificationValue != NULL) *pulNotificationValue = tMainTask.ulNotifyValue;
+	tMainTask.ulNotifyValue &= ~ulBitsToClearOnExit;
+
+	return pdTRUE;
+}
+
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+	HostQueue *pQueue = new HostQueue();
+
+	pQueue->uxLength = uxQueueLength;
+	pQueue->uxItemSize = uxItemSize;
+
+	return pQueue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount)
+{
+	QueueHandle_t xQueue = xQueueCreate(uxMaxCount, 0);
+
+	while (uxInitialCount--) xQueueSend(xQueue, NULL, 0);
+
+	return xQueue;
+}
+
+void vQueueDelete(QueueHandle_t xQueue)
+{
+	delete xQueue;
+}
+
+static BaseType_t queueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait, bool isFront)
+{
+	if (xQueue->items.size() >= xQueue->uxLength) {
+		waitTimeout(xTicksToWait);
+		return pdFAIL;
+	}
+
+	std::vector<uint8_t> item(xQueue->uxItemSize);
+	if (pvItemToQueue != NULL && xQueue->uxItemSize > 0) memcpy(item.data(), pvItemToQueue, xQueue->uxItemSize);
+
+	if (isFront) xQueue->items.push_front(item);
+	else xQueue->items.push_back(item);
+
+	return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+	return queueSend(xQueue, pvItemToQueue, xTicksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t xQueue, const void *pvItemToQueue, TickType_t xTicksToWait)
+{
+	return queueSend(xQueue, pvItemToQueue, xTicksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t xQueue, const void *pvItemToQueue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdFALSE;
+
+	return queueSend(xQueue, pvItemToQueue, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t xQueue, const void *pvItemToQueue)
+{
+	xQueue->items.clear();
+
+	return queueSend(xQueue, pvItemToQueue, 0, false);
+}
+
+static BaseType_t queueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait, bool isPeek)
+{
+	if (xQueue->items.empty()) {
+		waitTimeout(xTicksToWait);
+		return pdFAIL;
+	}
+
+	if (pvBuffer != NULL && xQueue->uxItemSize > 0) memcpy(pvBuffer, xQueue->items.front().data(), xQueue->uxItemSize);
+	if (!isPeek) xQueue->items.pop_front();
+
+	return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	return queueReceive(xQueue, pvBuffer, xTicksToWait, false);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t xQueue, void *pvBuffer, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdFALSE;
+
+	return queueReceive(xQueue, pvBuffer, 0, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t xQueue, void *pvBuffer, TickType_t xTicksToWait)
+{
+	return queueReceive(xQueue, pvBuffer, xTicksToWait, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t xQueue)
+{
+	return (UBaseType_t)xQueue->items.size();
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t xQueue)
+{
+	return xQueue->uxLength - (UBaseType_t)xQueue->items.size();
+}
+
+BaseType_t xQueueReset(QueueHandle_t xQueue)
+{
+	xQueue->items.clear();
+
+	return pdPASS;
+}
+
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+	HostEventGroup *pGroup = new HostEventGroup();
+
+	pGroup->uxBits = 0;
+
+	return pGroup;
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+	delete xEventGroup;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet)
+{
+	xEventGroup->uxBits |= uxBitsToSet;
+
+	return xEventGroup->uxBits;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToSet, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (pxHigherPriorityTaskWoken != NULL) *pxHigherPriorityTaskWoken = pdFALSE;
+	xEventGroupSetBits(xEventGroup, uxBitsToSet);
+
+	return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToClear)
+{
+	EventBits_t uxBits = xEventGroup->uxBits;
+
+	xEventGroup->uxBits &= ~uxBitsToClear;
+
+	return uxBits;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t xEventGroup)
+{
+	return xEventGroup->uxBits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup, const EventBits_t uxBitsToWaitFor, const BaseType_t xClearOnExit,
+	const BaseType_t xWaitForAllBits, TickType_t xTicksToWait)
+{
+	EventBits_t uxBits = xEventGroup->uxBits;
+	bool isSet = xWaitForAllBits ? ((uxBits & uxBitsToWaitFor) == uxBitsToWaitFor) : ((uxBits & uxBitsToWaitFor) != 0);
+
+	if (!isSet) {
+		waitTimeout(xTicksToWait);
+		return uxBits;
+	}
+
+	if (xClearOnExit) xEventGroup->uxBits &= ~uxBitsToWaitFor;
+
+	return uxBits;
+}
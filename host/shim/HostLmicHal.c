@@ -0,0 +1,139 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostLmicHal.c
+* @date			17.10.2026
+* @version		1.0
+* @brief		LMIC hal of the host build
+* @details		Replaces the Arduino hal of the LMIC library. The os ticks are taken from the virtual clock of the shim,
+*				waiting advances the clock. There is no radio, SPI reads return 0.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lmic/lmic.h"
+#include "HostShim.h"
+
+/** os_init() passes the pin map of the sketch to hal_init_ex(), there are no pins on the host */
+struct lmic_pinmap {
+	u1_t unused;
+};
+
+const struct lmic_pinmap lmic_pins = { 0 };
+
+/** callbacks of the sketch, weak so a test or the replay can provide its own */
+__attribute__((weak)) void onEvent(ev_t ev)
+{
+	(void)ev;
+}
+
+__attribute__((weak)) void os_getArtEui(u1_t *buf)
+{
+	memset(buf, 0, 8);
+}
+
+__attribute__((weak)) void os_getDevEui(u1_t *buf)
+{
+	memset(buf, 0, 8);
+}
+
+__attribute__((weak)) void os_getDevKey(u1_t *buf)
+{
+	memset(buf, 0, 16);
+}
+
+void hal_init(void)
+{
+}
+
+void hal_init_ex(const void *pContext)
+{
+	(void)pContext;
+}
+
+void hal_pin_rxtx(u1_t val)
+{
+	(void)val;
+}
+
+void hal_pin_rst(u1_t val)
+{
+	(void)val;
+}
+
+void hal_spi_write(u1_t cmd, const u1_t *buf, size_t len)
+{
+	(void)cmd;
+	(void)buf;
+	(void)len;
+}
+
+void hal_spi_read(u1_t cmd, u1_t *buf, size_t len)
+{
+	(void)cmd;
+	memset(buf, 0, len);
+}
+
+void hal_disableIRQs(void)
+{
+}
+
+void hal_enableIRQs(void)
+{
+}
+
+void hal_sleep(void)
+{
+}
+
+u4_t hal_ticks(void)
+{
+	return (u4_t)(hostGetTimeUs() >> US_PER_OSTICK_EXPONENT);
+}
+
+void hal_waitUntil(u4_t time)
+{
+	s4_t delta = (s4_t)(time - hal_ticks());
+
+	if (delta > 0) hostAdvanceTimeUs((uint64_t)delta << US_PER_OSTICK_EXPONENT);
+}
+
+u1_t hal_checkTimer(u4_t targettime)
+{
+	return (s4_t)(targettime - hal_ticks()) <= 0;
+}
+
+void hal_failed(const char *file, u2_t line)
+{
+	fprintf(stderr, "LMIC failed: %s:%u\n", file, line);
+	abort();
+}
+
+s1_t hal_getRssiCal(void)
+{
+	return 0;
+}
+
+ostime_t hal_setModuleActive(bit_t val)
+{
+	(void)val;
+	return 0;
+}
+
+bit_t hal_queryUsingTcxo(void)
+{
+	return 0;
+}
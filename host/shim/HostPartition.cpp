@@ -0,0 +1,126 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostPartition.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		esp_partition shim of the host build
+* @details		A partition is a RAM buffer, erased (0xFF) when it is created. The buffer is handed out to the tests, so
+*				they can tear or corrupt the stored data like a reset during a write would.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_partition.h"
+#include "HostShim.h"
+
+#define HOST_PARTITIONS		4
+
+typedef struct {
+	esp_partition_t tPartition;
+	uint8_t *pData;
+} HOST_PARTITION_T;
+
+static HOST_PARTITION_T atPartition[HOST_PARTITIONS];
+static uint8_t partitions;
+
+uint8_t *hostCreatePartition(const char *label, uint32_t size)
+{
+	HOST_PARTITION_T *pPartition = NULL;
+
+	for (uint8_t i = 0; i < partitions; i++) {
+		if (strcmp(atPartition[i].tPartition.label, label) == 0) pPartition = &atPartition[i];
+	}
+
+	if (pPartition == NULL) {
+		if (partitions == HOST_PARTITIONS) return NULL;
+		pPartition = &atPartition[partitions++];
+	}
+
+	free(pPartition->pData);
+	pPartition->pData = (uint8_t*)malloc(size);
+	memset(pPartition->pData, 0xFF, size);
+
+	pPartition->tPartition.type = ESP_PARTITION_TYPE_DATA;
+	pPartition->tPartition.subtype = ESP_PARTITION_SUBTYPE_ANY;
+	pPartition->tPartition.address = 0;
+	pPartition->tPartition.size = size;
+	strncpy(pPartition->tPartition.label, label, sizeof(pPartition->tPartition.label) - 1);
+	pPartition->tPartition.encrypted = false;
+
+	return pPartition->pData;
+}
+
+static uint8_t *partitionData(const esp_partition_t *partition, size_t offset, size_t size)
+{
+	for (uint8_t i = 0; i < partitions; i++) {
+		if (&atPartition[i].tPartition != partition) continue;
+		if (offset > partition->size || size > partition->size - offset) return NULL;
+
+		return atPartition[i].pData + offset;
+	}
+
+	return NULL;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char *label)
+{
+	for (uint8_t i = 0; i < partitions; i++) {
+		const esp_partition_t *pPartition = &atPartition[i].tPartition;
+
+		if (pPartition->type != type) continue;
+		if (subtype != ESP_PARTITION_SUBTYPE_ANY && pPartition->subtype != subtype) continue;
+		if (label != NULL && strcmp(pPartition->label, label) != 0) continue;
+
+		return pPartition;
+	}
+
+	return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+	uint8_t *pData = partitionData(partition, src_offset, size);
+
+	if (pData == NULL) return ESP_ERR_INVALID_SIZE;
+
+	memcpy(dst, pData, size);
+
+	return ESP_OK;
+}
+
+/** a write only clears bits */
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+	uint8_t *pData = partitionData(partition, dst_offset, size);
+
+	if (pData == NULL) return ESP_ERR_INVALID_SIZE;
+
+	for (size_t i = 0; i < size; i++) pData[i] &= ((const uint8_t*)src)[i];
+
+	return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+	uint8_t *pData = partitionData(partition, offset, size);
+
+	if (pData == NULL) return ESP_ERR_INVALID_SIZE;
+	if (offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE) return ESP_ERR_INVALID_ARG;
+
+	memset(pData, 0xFF, size);
+
+	return ESP_OK;
+}
@@ -0,0 +1,57 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostShim.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		host side control of the Arduino/FreeRTOS shim, for tests, benchmarks and the replay
+* @details		The virtual clock is the time base of millis(), micros(), the FreeRTOS ticks and esp_timer. It starts at
+*				0 and only moves by the shim itself (delays, timeouts, bus transfers) and by these functions.
+*				Data partitions for esp_partition are RAM buffers, the tests get their contents to corrupt them.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_SHIM_H
+#define __HOST_SHIM_H
+
+#include <stdint.h>
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** virtual clock in micro seconds */
+uint64_t hostGetTimeUs(void);
+void hostSetTimeUs(uint64_t ullTimeUs);
+void hostAdvanceTimeUs(uint64_t ullDeltaUs);
+
+/** call the handler attached to the pin by attachInterrupt(), false if there is none */
+int hostTriggerInterrupt(uint8_t pin);
+
+/** level of the pin as set by digitalWrite() or hostSetPin() */
+void hostSetPin(uint8_t pin, uint8_t level);
+uint8_t hostGetPin(uint8_t pin);
+
+/** pending notifications of a task */
+uint32_t hostGetTaskNotifyCount(TaskHandle_t xTask);
+
+/** data partition of esp_partition, erased, an existing partition of the label is replaced, returns the contents */
+uint8_t *hostCreatePartition(const char *label, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			HostTest.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		check macros of the host tests
+* @details		A failed check prints the location and continues, HOST_TEST_RESULT() is the exit code of the test.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_TEST_H
+#define __HOST_TEST_H
+
+#include <stdio.h>
+
+static unsigned hostTestChecks;
+static unsigned hostTestFailures;
+
+#define CHECK(cond) do { \
+		hostTestChecks++; \
+		if (!(cond)) { \
+			hostTestFailures++; \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(a, b) do { \
+		long long _a = (long long)(a), _b = (long long)(b); \
+		hostTestChecks++; \
+		if (_a != _b) { \
+			hostTestFailures++; \
+			fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+		} \
+	} while (0)
+
+#define HOST_TEST_RESULT() \
+	(printf("%u checks, %u failed\n", hostTestChecks, hostTestFailures), hostTestFailures ? 1 : 0)
+
+#endif
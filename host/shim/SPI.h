@@ -0,0 +1,91 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SPI.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		SPIClass of the host build
+* @details		The transferred bytes go to a HostSpiDevice, the chip select is left to the GPIO functions. Every transfer
+*				moves the virtual clock by the time it takes at the clock of the transaction.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_SPI_H
+#define __HOST_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0			0
+#define SPI_MODE1			1
+#define SPI_MODE2			2
+#define SPI_MODE3			3
+#define SPI_LSBFIRST		0
+#define SPI_MSBFIRST		1
+#define LSBFIRST			SPI_LSBFIRST
+#define MSBFIRST			SPI_MSBFIRST
+
+/** model of the devices on the bus */
+class HostSpiDevice
+{
+public:
+	virtual ~HostSpiDevice() {}
+
+	/** full duplex transfer of one byte */
+	virtual uint8_t spiTransfer(uint8_t data) = 0;
+};
+
+class SPISettings
+{
+public:
+	SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST, uint8_t dataMode = SPI_MODE0) : _clock(clock), _bitOrder(bitOrder), _dataMode(dataMode) {}
+
+	uint32_t _clock;
+	uint8_t _bitOrder;
+	uint8_t _dataMode;
+};
+
+class SPIClass
+{
+public:
+	SPIClass(uint8_t spiBus = 0);
+
+	void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) { (void)sck; (void)miso; (void)mosi; (void)ss; }
+	void end() {}
+
+	void beginTransaction(SPISettings settings) { _frequency = settings._clock; }
+	void endTransaction() {}
+	void setFrequency(uint32_t frequency) { _frequency = frequency; }
+	void setDataMode(uint8_t dataMode) { (void)dataMode; }
+	void setBitOrder(uint8_t bitOrder) { (void)bitOrder; }
+
+	uint8_t transfer(uint8_t data);
+	uint16_t transfer16(uint16_t data);
+	void transfer(uint8_t *pData, uint32_t size);
+	void write(uint8_t data) { transfer(data); }
+	void writeBytes(const uint8_t *pData, uint32_t size);
+
+	/** host side of the bus */
+	void attach(HostSpiDevice *pDevice) { _pDevice = pDevice; }
+	uint32_t getByteCount() const { return _byteCount; }
+
+private:
+	HostSpiDevice	*_pDevice;
+	uint32_t		_frequency;
+	uint32_t		_byteCount;
+	uint32_t		_bitRemainder;
+};
+
+extern SPIClass SPI;
+
+#endif
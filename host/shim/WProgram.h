@@ -0,0 +1,2 @@
+/* pre 1.0 name of the core header */
+#include "Arduino.h"
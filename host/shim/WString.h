@@ -0,0 +1,89 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			WString.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		Arduino String of the host build, on top of std::string
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_WSTRING_H
+#define __HOST_WSTRING_H
+
+#include <stdint.h>
+#include <string>
+
+#define DEC					10
+#define HEX					16
+#define OCT					8
+#define BIN					2
+
+class String
+{
+public:
+	String(const char *cstr = "") : _str(cstr ? cstr : "") {}
+	String(const std::string &str) : _str(str) {}
+	explicit String(char c) : _str(1, c) {}
+	explicit String(unsigned char value, unsigned char base = DEC) { _str = toString(value, base); }
+	explicit String(int value, unsigned char base = DEC) { _str = (value < 0 && base == DEC) ? "-" + toString(-(long)value, base) : toString((unsigned int)value, base); }
+	explicit String(unsigned int value, unsigned char base = DEC) { _str = toString(value, base); }
+	explicit String(long value, unsigned char base = DEC) { _str = (value < 0 && base == DEC) ? "-" + toString(-value, base) : toString((unsigned long)value, base); }
+	explicit String(unsigned long value, unsigned char base = DEC) { _str = toString(value, base); }
+
+	unsigned int length() const { return (unsigned int)_str.length(); }
+	const char *c_str() const { return _str.c_str(); }
+	char charAt(unsigned int index) const { return (index < _str.length()) ? _str[index] : 0; }
+	char operator[](unsigned int index) const { return charAt(index); }
+	char &operator[](unsigned int index) { return _str[index]; }
+
+	String &operator+=(const String &rhs) { _str += rhs._str; return *this; }
+	String &operator+=(const char *cstr) { _str += cstr; return *this; }
+	String &operator+=(char c) { _str += c; return *this; }
+	String &operator+=(unsigned char value) { _str += toString(value, DEC); return *this; }
+	String &operator+=(int value) { *this += String(value); return *this; }
+	String &operator+=(unsigned int value) { _str += toString(value, DEC); return *this; }
+	String &operator+=(long value) { *this += String(value); return *this; }
+	String &operator+=(unsigned long value) { _str += toString(value, DEC); return *this; }
+
+	bool concat(const String &rhs) { _str += rhs._str; return true; }
+	bool operator==(const String &rhs) const { return _str == rhs._str; }
+	bool operator==(const char *cstr) const { return _str == cstr; }
+	bool operator!=(const String &rhs) const { return _str != rhs._str; }
+
+	void toUpperCase() { for (size_t i = 0; i < _str.length(); i++) if (_str[i] >= 'a' && _str[i] <= 'z') _str[i] -= 'a' - 'A'; }
+	void toLowerCase() { for (size_t i = 0; i < _str.length(); i++) if (_str[i] >= 'A' && _str[i] <= 'Z') _str[i] += 'a' - 'A'; }
+
+	friend String operator+(const String &lhs, const String &rhs) { return String(lhs._str + rhs._str); }
+
+private:
+	static std::string toString(unsigned long value, unsigned char base) {
+		char buf[8 * sizeof(value) + 1];
+		char *p = &buf[sizeof(buf) - 1];
+
+		*p = '\0';
+		do {
+			unsigned char digit = value % base;
+			*--p = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+			value /= base;
+		} while (value);
+
+		return std::string(p);
+	}
+
+	std::string _str;
+};
+
+#endif
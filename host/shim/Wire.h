@@ -0,0 +1,88 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			Wire.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		TwoWire of the host build
+* @details		Transfers go to the HostI2cDevice attached to the address, an address without device is not
+*				acknowledged. Like the ESP32 core a transfer is limited to I2C_BUFFER_LENGTH bytes. Every transfer
+*				moves the virtual clock by the time it takes on the bus (9 clocks per byte plus the address).
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_WIRE_H
+#define __HOST_WIRE_H
+
+#include "Arduino.h"
+
+#define I2C_BUFFER_LENGTH	128
+
+/** model of a device on the bus */
+class HostI2cDevice
+{
+public:
+	virtual ~HostI2cDevice() {}
+
+	/** bytes of a write transfer, beginTransmission() to endTransmission() */
+	virtual void i2cWrite(const uint8_t *pData, size_t len) = 0;
+
+	/** bytes of a read transfer, has to fill all len bytes */
+	virtual void i2cRead(uint8_t *pData, size_t len) = 0;
+};
+
+class TwoWire : public Stream
+{
+public:
+	TwoWire(uint8_t busNum);
+
+	bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+	void setClock(uint32_t frequency) { _frequency = frequency; }
+	uint32_t getClock() const { return _frequency; }
+
+	void beginTransmission(uint16_t address);
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(uint16_t address, uint8_t size, bool sendStop = true);
+
+	size_t write(uint8_t data);
+	size_t write(const uint8_t *pData, size_t len);
+	int available() { return _rxLength - _rxIndex; }
+	int read() { return (_rxIndex < _rxLength) ? _abRx[_rxIndex++] : -1; }
+	int peek() { return (_rxIndex < _rxLength) ? _abRx[_rxIndex] : -1; }
+
+	/** host side of the bus */
+	void attach(uint8_t address, HostI2cDevice *pDevice);
+	uint32_t getTransferCount() const { return _transferCount; }
+
+private:
+	HostI2cDevice *device(uint16_t address) const;
+	void busTime(size_t bytes);
+
+	uint32_t		_frequency;
+	uint16_t		_txAddress;
+	uint8_t			_abTx[I2C_BUFFER_LENGTH];
+	uint8_t			_txLength;
+	bool			_isTransmitting;
+	uint8_t			_abRx[I2C_BUFFER_LENGTH];
+	uint8_t			_rxLength;
+	uint8_t			_rxIndex;
+	uint8_t			_aAddress[8];
+	HostI2cDevice	*_apDevice[8];
+	uint32_t		_transferCount;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,2 @@
+/* the libraries include the core header in either spelling */
+#include "Arduino.h"
@@ -0,0 +1,76 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			FreeRTOS.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		FreeRTOS shim of the host build
+* @details		Types and port macros of the ESP32 FreeRTOS port. The host build is single threaded: critical sections
+*				are empty, there is one core (0) and one running task (the caller). A blocking call which can not
+*				succeed moves the virtual clock by its timeout and fails, a call with portMAX_DELAY fails at once.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_FREERTOS_H
+#define __HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t			TickType_t;
+typedef int					BaseType_t;
+typedef unsigned int		UBaseType_t;
+typedef uint32_t			StackType_t;
+
+#define pdFALSE				((BaseType_t)0)
+#define pdTRUE				((BaseType_t)1)
+#define pdPASS				pdTRUE
+#define pdFAIL				pdFALSE
+
+#define configTICK_RATE_HZ			1000
+#define configMAX_TASK_NAME_LEN		16
+#define configMAX_PRIORITIES		25
+#define portMAX_DELAY				((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS			((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS			portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms)			((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+#define portNUM_PROCESSORS			1
+#define tskNO_AFFINITY				0x7fffffff
+
+typedef struct {
+	uint32_t owner;
+	uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED	{ 0, 0 }
+
+#define portENTER_CRITICAL(mux)			((void)(mux))
+#define portEXIT_CRITICAL(mux)			((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)		((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)		((void)(mux))
+#define portYIELD_FROM_ISR()
+#define portYIELD()
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux);
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
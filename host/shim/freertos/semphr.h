@@ -0,0 +1,51 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			semphr.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		FreeRTOS semaphore shim of the host build
+* @details		Semaphores are queues without item data, as in FreeRTOS. A mutex starts given, a binary semaphore taken.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	there is no priority inheritance and no owner check, which does not matter without a second task
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __HOST_FREERTOS_SEMPHR_H
+#define __HOST_FREERTOS_SEMPHR_H
+
+#include "queue.h"
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t uxMaxCount, UBaseType_t uxInitialCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define xSemaphoreCreateBinary()					xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()						xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreCreateRecursiveMutex()			xSemaphoreCreateCounting(1, 1)
+#define vSemaphoreDelete(sem)						vQueueDelete(sem)
+#define xSemaphoreTake(sem, ticks)					xQueueReceive(sem, NULL, ticks)
+#define xSemaphoreGive(sem)							xQueueSend(sem, NULL, 0)
+#define xSemaphoreTakeFromISR(sem, woken)			xQueueReceiveFromISR(sem, NULL, woken)
+#define xSemaphoreGiveFromISR(sem, woken)			xQueueSendFromISR(sem, NULL, woken)
+#define uxSemaphoreGetCount(sem)					uxQueueMessagesWaiting(sem)
+
+#endif
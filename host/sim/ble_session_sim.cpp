@@ -0,0 +1,309 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			ble_session_sim.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		simulation of the BLE sessions of BLE_CLIENT, telemetry refresh period per loop variant
+* @details		Discrete event model of the main task and the four peripherals. A run drops the motor controller
+*				for a while, the other devices stay in range. Three variants of the main task are compared:
+*
+*				-	sequential: the former loop, connect, read, disconnect, wait for the disconnect and delay(250)
+*					for one device after the other
+*				-	blocking connect: persistent sessions, but the connect of a session runs on the main task
+*				-	connect tasks: persistent sessions, the connect runs in a task of the session, the tasks take
+*					turns on the stack, the main task only polls the result
+*
+*				The refresh period of a device is the time between two telemetry updates of it. The printed table is
+*				the result, the checks at the end hold the model to the properties the design relies on.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	design model, the session state machine is a copy of serviceBLESession() and scheduleReconnect(), the sketch
+*		code itself is not run. It is no ctest target, a change of the sketch has to be made here by hand.
+*	-	the timings of the peripherals are estimates of a Bluedroid link with the default connection parameters,
+*		the comparison of the variants does not depend on their exact values
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "HostTest.h"
+
+/** connection manager of BB_BLEClient.h */
+#define BLE_TELEMETRY_CYCLE_MS			250
+#define BLE_RECONNECT_BACKOFF_MIN_MS	500
+#define BLE_RECONNECT_BACKOFF_MAX_MS	30000
+
+/** stack: a pending connect to a device out of range fails after the link establishment timeout */
+#define SIM_ESTABLISH_TIMEOUT_MS		30000
+#define SIM_SUPERVISION_TIMEOUT_MS		4000		// loss of a link is reported after the supervision timeout
+#define SIM_DISCONNECT_MS				50			// disconnect until the callback clears the connected flag
+#define SIM_MAIN_WORK_MS				5			// rest of the main task cycle, impact capture, traces, ...
+
+#define SIM_RUN_MS						120000
+#define SIM_DROP_DEVICE					2			// controller
+#define SIM_DROP_START_MS				30000
+#define SIM_DROP_END_MS					75000
+
+typedef enum SIM_LOOP_Etag {
+	SIM_LOOP_SEQUENTIAL,
+	SIM_LOOP_BLOCKING_CONNECT,
+	SIM_LOOP_CONNECT_TASKS,
+	SIM_LOOP_MAX,
+} SIM_LOOP_E;
+
+typedef enum SIM_STATE_Etag {
+	SIM_IDLE,
+	SIM_CONNECTING,
+	SIM_READY,
+	SIM_BACKOFF,
+} SIM_STATE_E;
+
+typedef struct SIM_DEVICE_Ttag {
+	const char		*pName;
+	uint32_t		ulConnectMs;			// link establishment
+	uint32_t		ulDiscoveryMs;			// service discovery and subscription, delays of connectToServer included
+	uint32_t		ulServiceMs;			// periodic action of the session on the main task
+	uint32_t		ulReadMs;				// read of the values in the former loop
+} SIM_DEVICE_T;
+
+typedef struct SIM_SESSION_Ttag {
+	SIM_STATE_E		eState;
+	uint32_t		ulBackoffTime;
+	uint32_t		ulNextAttemptTime;
+	uint32_t		ulConnectDoneTime;		// end of the connect task
+	bool			isConnectReady;			// result of the connect task
+	uint32_t		ulLinkLostTime;			// time the connected flag is cleared
+	std::vector<uint32_t> aulUpdate;		// times of the telemetry updates
+} SIM_SESSION_T;
+
+typedef struct SIM_RESULT_Ttag {
+	uint32_t		aulMeanMs[4];
+	uint32_t		aulMaxMs[4];
+	uint32_t		ulRecoverMs;			// end of the drop until the first update of the dropped device
+} SIM_RESULT_T;
+
+static const SIM_DEVICE_T aDevice[] = {
+	{ "BMS",			80,		600,	30,		60 },
+	{ "HeartyPatch",	80,		500,	0,		40 },
+	{ "Controller",		80,		500,	0,		40 },
+	{ "ESP Server",		80,		900,	60,		120 },
+};
+static const uint8_t deviceCount = sizeof(aDevice) / sizeof(aDevice[0]);
+
+static const char *apLoopName[SIM_LOOP_MAX] = { "sequential", "blocking connect", "connect tasks" };
+
+
+static bool isPresent(uint8_t device, uint32_t time)
+{
+	return device != SIM_DROP_DEVICE || time < SIM_DROP_START_MS || time >= SIM_DROP_END_MS;
+}
+
+/** end of a connect started at time, a device coming back in range during the attempt is still connected */
+static uint32_t connectEnd(uint8_t device, uint32_t time, bool *pIsReady)
+{
+	uint32_t start = time;
+
+	if (!isPresent(device, start)) start = SIM_DROP_END_MS;
+
+	*pIsReady = start < time + SIM_ESTABLISH_TIMEOUT_MS;
+	if (!*pIsReady) return time + SIM_ESTABLISH_TIMEOUT_MS;
+
+	return start + aDevice[device].ulConnectMs + aDevice[device].ulDiscoveryMs;
+}
+
+/** time the connected flag of a link opened at time is cleared */
+static uint32_t linkLost(uint8_t device, uint32_t time)
+{
+	if (device == SIM_DROP_DEVICE && time < SIM_DROP_START_MS) return SIM_DROP_START_MS + SIM_SUPERVISION_TIMEOUT_MS;
+
+	return UINT32_MAX;
+}
+
+static void scheduleReconnect(SIM_SESSION_T *pSession, uint32_t time)
+{
+	if (pSession->ulBackoffTime == 0) pSession->ulBackoffTime = BLE_RECONNECT_BACKOFF_MIN_MS;
+	else pSession->ulBackoffTime = std::min(pSession->ulBackoffTime * 2, (uint32_t)BLE_RECONNECT_BACKOFF_MAX_MS);
+
+	pSession->ulNextAttemptTime = time + pSession->ulBackoffTime;
+	pSession->eState = SIM_BACKOFF;
+}
+
+static void connectDone(uint8_t device, SIM_SESSION_T *pSession, uint32_t time)
+{
+	if (pSession->isConnectReady) {
+		pSession->eState = SIM_READY;
+		pSession->ulBackoffTime = 0;
+		pSession->ulLinkLostTime = linkLost(device, time);
+	}
+	else scheduleReconnect(pSession, time);
+}
+
+/** serviceBLESession(), returns the time the main task continues */
+static uint32_t serviceSession(SIM_LOOP_E eLoop, uint8_t device, SIM_SESSION_T *pSession, uint32_t *pStackFreeTime,
+	uint32_t time)
+{
+	switch (pSession->eState) {
+	case SIM_IDLE:
+	case SIM_BACKOFF:
+		if (time < pSession->ulNextAttemptTime) break;
+
+		if (eLoop == SIM_LOOP_BLOCKING_CONNECT) {
+			time = connectEnd(device, time, &pSession->isConnectReady);
+			connectDone(device, pSession, time);
+		}
+		else {
+			// the connect tasks take turns on the stack
+			uint32_t start = std::max(time, *pStackFreeTime);
+			pSession->ulConnectDoneTime = connectEnd(device, start, &pSession->isConnectReady);
+			*pStackFreeTime = pSession->ulConnectDoneTime;
+			pSession->eState = SIM_CONNECTING;
+		}
+		break;
+	case SIM_CONNECTING:
+		if (time < pSession->ulConnectDoneTime) break;
+
+		connectDone(device, pSession, time);
+		break;
+	case SIM_READY:
+		if (time >= pSession->ulLinkLostTime) {
+			scheduleReconnect(pSession, time);
+			break;
+		}
+
+		time += aDevice[device].ulServiceMs;
+		pSession->aulUpdate.push_back(time);
+		break;
+	}
+
+	return time;
+}
+
+/** mainTask() of the variant */
+static void runLoop(SIM_LOOP_E eLoop, SIM_SESSION_T *aSession)
+{
+	uint32_t time = 0;
+	uint32_t wakeTime = 0;
+	uint32_t stackFreeTime = 0;
+
+	while (time < SIM_RUN_MS) {
+		if (eLoop == SIM_LOOP_SEQUENTIAL) {
+			for (uint8_t i = 0; i < deviceCount; i++) {
+				bool isReady;
+
+				time = connectEnd(i, time, &isReady);
+				if (isReady) {
+					time += aDevice[i].ulReadMs;
+					aSession[i].aulUpdate.push_back(time);
+					time += SIM_DISCONNECT_MS;
+				}
+				time += 250;
+			}
+			time += SIM_MAIN_WORK_MS;
+			continue;
+		}
+
+		for (uint8_t i = 0; i < deviceCount; i++) {
+			time = serviceSession(eLoop, i, &aSession[i], &stackFreeTime, time);
+		}
+		time += SIM_MAIN_WORK_MS;
+
+		// vTaskDelayUntil(), an overrun cycle is followed by the next one without delay
+		wakeTime += BLE_TELEMETRY_CYCLE_MS;
+		time = std::max(time, wakeTime);
+	}
+}
+
+static SIM_RESULT_T simulate(SIM_LOOP_E eLoop)
+{
+	SIM_SESSION_T aSession[deviceCount];
+	SIM_RESULT_T result = { { 0 }, { 0 }, UINT32_MAX };
+
+	for (uint8_t i = 0; i < deviceCount; i++) {
+		aSession[i].eState = SIM_IDLE;
+		aSession[i].ulBackoffTime = 0;
+		aSession[i].ulNextAttemptTime = 0;
+		aSession[i].ulConnectDoneTime = 0;
+		aSession[i].isConnectReady = false;
+		aSession[i].ulLinkLostTime = UINT32_MAX;
+	}
+
+	runLoop(eLoop, aSession);
+
+	for (uint8_t i = 0; i < deviceCount; i++) {
+		const std::vector<uint32_t> &aulUpdate = aSession[i].aulUpdate;
+		uint64_t sum = 0;
+		uint32_t count = 0;
+
+		for (size_t k = 1; k < aulUpdate.size(); k++) {
+			uint32_t gap = aulUpdate[k] - aulUpdate[k - 1];
+
+			// the gap of the dropped device spans the time it was away, it is shown as the recovery time
+			if (i == SIM_DROP_DEVICE && aulUpdate[k] >= SIM_DROP_START_MS && aulUpdate[k - 1] < SIM_DROP_END_MS) {
+				if (aulUpdate[k] >= SIM_DROP_END_MS) result.ulRecoverMs = std::min(result.ulRecoverMs, aulUpdate[k] - SIM_DROP_END_MS);
+				continue;
+			}
+
+			sum += gap;
+			count++;
+			result.aulMaxMs[i] = std::max(result.aulMaxMs[i], gap);
+		}
+
+		result.aulMeanMs[i] = count ? (uint32_t)(sum / count) : UINT32_MAX;
+	}
+
+	return result;
+}
+
+int main()
+{
+	SIM_RESULT_T aResult[SIM_LOOP_MAX];
+
+	printf("%s out of range from %u to %u ms, %u ms simulated\n\n", aDevice[SIM_DROP_DEVICE].pName, SIM_DROP_START_MS,
+		SIM_DROP_END_MS, SIM_RUN_MS);
+	printf("refresh period mean/max in ms\n%-18s", "loop");
+	for (uint8_t i = 0; i < deviceCount; i++) printf(" %16s", aDevice[i].pName);
+	printf(" %16s\n", "recovery");
+
+	for (uint8_t loop = 0; loop < SIM_LOOP_MAX; loop++) {
+		aResult[loop] = simulate((SIM_LOOP_E)loop);
+
+		printf("%-18s", apLoopName[loop]);
+		for (uint8_t i = 0; i < deviceCount; i++) {
+			printf(" %8u/%7u", aResult[loop].aulMeanMs[i], aResult[loop].aulMaxMs[i]);
+		}
+		printf(" %16u\n", aResult[loop].ulRecoverMs);
+	}
+	printf("\n");
+
+	const SIM_RESULT_T &sequential = aResult[SIM_LOOP_SEQUENTIAL];
+	const SIM_RESULT_T &blocking = aResult[SIM_LOOP_BLOCKING_CONNECT];
+	const SIM_RESULT_T &tasks = aResult[SIM_LOOP_CONNECT_TASKS];
+
+	for (uint8_t i = 0; i < deviceCount; i++) {
+		// a device dropping out does not stall the others, every cycle refreshes every open link
+		if (i != SIM_DROP_DEVICE) CHECK(tasks.aulMaxMs[i] <= BLE_TELEMETRY_CYCLE_MS + 100);
+
+		CHECK(tasks.aulMeanMs[i] * 4 < sequential.aulMeanMs[i]);
+	}
+
+	// a connect on the main task to the missing device stalls all links up to the establishment timeout
+	CHECK(blocking.aulMaxMs[0] >= SIM_ESTABLISH_TIMEOUT_MS);
+	CHECK(sequential.aulMaxMs[0] >= SIM_ESTABLISH_TIMEOUT_MS);
+
+	// the pending attempt picks up the returning device
+	CHECK(tasks.ulRecoverMs <= 2 * BLE_TELEMETRY_CYCLE_MS + aDevice[SIM_DROP_DEVICE].ulConnectMs + aDevice[SIM_DROP_DEVICE].ulDiscoveryMs);
+
+	return HOST_TEST_RESULT();
+}
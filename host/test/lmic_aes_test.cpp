@@ -0,0 +1,177 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			lmic_aes_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the table driven AES backend and the cached CMAC subkeys of LMIC
+* @details		Known answers of FIPS-197 and RFC 4493, and the cached key schedules and subkeys under key changes:
+*				the network and application session keys alternate on every frame, a join brings new ones.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include "lmic/lmic.h"
+#include "HostTest.h"
+
+extern "C" void lmic_aes_encrypt(u1_t *data, u1_t *key);
+
+/** RFC 4493 */
+static const u1_t abCmacKey[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const u1_t abCmacMessage[64] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static u4_t mic(const u1_t *pKey, const u1_t *pMessage, u2_t len, const u1_t *pAux = NULL)
+{
+	u1_t abBuffer[64];
+
+	memcpy(abBuffer, pMessage, len);
+	memcpy(AESkey, pKey, 16);
+	if (pAux != NULL) memcpy(AESaux, pAux, 16);
+
+	return os_aes((pAux != NULL) ? AES_MIC : AES_MIC | AES_MICNOAUX, abBuffer, len);
+}
+
+static void testFips197()
+{
+	u1_t abKey[16], abData[16];
+	static const u1_t abExpected[16] = {
+		0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+	};
+
+	/** appendix C.1 */
+	for (u1_t i = 0; i < 16; i++) {
+		abKey[i] = i;
+		abData[i] = (u1_t)(i * 0x11);
+	}
+	lmic_aes_encrypt(abData, abKey);
+	CHECK(memcmp(abData, abExpected, 16) == 0);
+
+	/** RFC 4493 subkey generation, L = AES(K, 0) */
+	static const u1_t abL[16] = {
+		0x7d, 0xf7, 0x6b, 0x0c, 0x1a, 0xb8, 0x99, 0xb3, 0x3e, 0x42, 0xf0, 0x47, 0xb9, 0x1b, 0x54, 0x6f
+	};
+	u1_t abCmacKeyCopy[16];
+	memcpy(abCmacKeyCopy, abCmacKey, 16);
+	memset(abData, 0, 16);
+	lmic_aes_encrypt(abData, abCmacKeyCopy);
+	CHECK(memcmp(abData, abL, 16) == 0);
+
+	/** the first key again, its schedule comes from the cache */
+	for (u1_t i = 0; i < 16; i++) abData[i] = (u1_t)(i * 0x11);
+	lmic_aes_encrypt(abData, abKey);
+	CHECK(memcmp(abData, abExpected, 16) == 0);
+}
+
+/** the MIC is the first 4 bytes of the CMAC, MSB first */
+static void testRfc4493()
+{
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 0), 0xbb1d6929);
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 16), 0x070a16b4);
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 40), 0xdfa66747);
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 64), 0x51f0bebf);
+}
+
+/** the subkeys and schedules of the other key must not leak into a MIC */
+static void testKeyChanges()
+{
+	u1_t abNwkKey[16], abAppKey[16], abNewKey[16];
+	u4_t ulNwkMic, ulAppMic;
+
+	for (u1_t i = 0; i < 16; i++) {
+		abNwkKey[i] = i;
+		abAppKey[i] = (u1_t)(0x40 + i);
+		abNewKey[i] = (u1_t)(0x80 + i);
+	}
+
+	ulNwkMic = mic(abNwkKey, abCmacMessage, 40);
+	ulAppMic = mic(abAppKey, abCmacMessage, 40);
+	CHECK(ulNwkMic != ulAppMic);
+
+	for (int n = 0; n < 8; n++) {
+		CHECK_EQ(mic(abNwkKey, abCmacMessage, 40), ulNwkMic);
+		CHECK_EQ(mic(abAppKey, abCmacMessage, 40), ulAppMic);
+	}
+
+	/** a third key, then both session keys again */
+	mic(abNewKey, abCmacMessage, 33);
+	CHECK_EQ(mic(abAppKey, abCmacMessage, 40), ulAppMic);
+	CHECK_EQ(mic(abNwkKey, abCmacMessage, 40), ulNwkMic);
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 64), 0x51f0bebf);
+}
+
+/** LoRaWAN MIC with the B0 block in AESaux is the CMAC over B0 and the message */
+static void testMicWithAux()
+{
+	u1_t abB0[16] = { 0x49, 0, 0, 0, 0, 0, 0x04, 0x03, 0x02, 0x01, 0x2a, 0, 0, 0, 0, 40 };
+	u1_t abJoined[56];
+
+	memcpy(abJoined, abB0, 16);
+	memcpy(abJoined + 16, abCmacMessage, 40);
+
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 40, abB0), mic(abCmacKey, abJoined, 56));
+
+	/** B0 alone */
+	CHECK_EQ(mic(abCmacKey, abCmacMessage, 0, abB0), mic(abCmacKey, abJoined, 16));
+}
+
+/** payload CTR against the block cipher, the last byte of the counter block counts the blocks */
+static void testCtr()
+{
+	u1_t abKey[16], abCounter[16], abBuffer[40], abBlock[16];
+
+	for (u1_t i = 0; i < 16; i++) {
+		abKey[i] = (u1_t)(0x40 + i);
+		abCounter[i] = 0;
+	}
+	abCounter[0] = 0x01;
+	abCounter[15] = 0x01;
+
+	memcpy(abBuffer, abCmacMessage, sizeof(abBuffer));
+	memcpy(AESkey, abKey, 16);
+	memcpy(AESaux, abCounter, 16);
+	os_aes(AES_CTR, abBuffer, sizeof(abBuffer));
+
+	for (u1_t i = 0; i < sizeof(abBuffer); i++) {
+		if (i % 16 == 0) {
+			memcpy(abBlock, abCounter, 16);
+			abBlock[15] = (u1_t)(abCounter[15] + i / 16);
+			lmic_aes_encrypt(abBlock, abKey);
+		}
+		CHECK_EQ(abBuffer[i], abCmacMessage[i] ^ abBlock[i % 16]);
+	}
+
+	/** decrypt in place */
+	memcpy(AESkey, abKey, 16);
+	memcpy(AESaux, abCounter, 16);
+	os_aes(AES_CTR, abBuffer, sizeof(abBuffer));
+	CHECK(memcmp(abBuffer, abCmacMessage, sizeof(abBuffer)) == 0);
+}
+
+int main()
+{
+	testFips197();
+	testRfc4493();
+	testKeyChanges();
+	testMicWithAux();
+	testCtr();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,173 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			lmic_scheduler_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of os_queryNextDeadline() and of the job timing of the tickless ttn task
+* @details		The ttn task runs os_runloop_once() and then blocks in hal_waitForEvent() until the deadline of the
+*				next job, rounded down to whole ms, or a radio interrupt. Here the wait runs on the virtual clock of
+*				the shim: every job has to start at its deadline, never before and less than a ms after it, with
+*				a handful of wakeups instead of one per ms.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <Arduino.h>
+#include "lmic/lmic.h"
+#include "HostShim.h"
+#include "HostTest.h"
+
+#define TTN_MAX_SLEEP_MS		1000		// BLE_CLIENT.ino
+#define TTN_LOOP_US				20			// one pass of the loop, the virtual clock only moves on a wait
+#define JOB_COUNT				4
+
+static osjob_t aJob[JOB_COUNT];
+static ostime_t aDeadline[JOB_COUNT];
+static ostime_t aStart[JOB_COUNT];
+static uint32_t aRuns[JOB_COUNT];
+static uint32_t wakeups;
+
+static void jobCallback(osjob_t *pJob)
+{
+	uint8_t i = (uint8_t)(pJob - aJob);
+
+	aStart[i] = os_getTime();
+	aRuns[i]++;
+}
+
+static void scheduleJob(uint8_t i, ostime_t deadline)
+{
+	aDeadline[i] = deadline;
+	os_setTimedCallback(&aJob[i], deadline, jobCallback);
+}
+
+/** wait of Arduino_LMIC::hal_waitForEvent() with the radio interrupts enabled */
+static void waitForEvent(uint32_t maxWaitMs)
+{
+	ostime_t deadline;
+	uint32_t waitMs = maxWaitMs;
+
+	if (os_queryNextDeadline(&deadline)) {
+		s4_t delta = deadline - os_getTime();
+		if (delta <= 0) return;
+
+		uint32_t ms = (uint32_t)osticks2ms(delta);
+		if (ms < waitMs) waitMs = ms;
+	}
+
+	TickType_t ticks = waitMs / portTICK_PERIOD_MS;
+	if (ticks == 0) return;
+
+	ulTaskNotifyTake(pdTRUE, ticks);
+}
+
+/** loop of the ttn task until the clock reaches end */
+static void runTtnTask(ostime_t end)
+{
+	while ((s4_t)(os_getTime() - end) < 0) {
+		os_runloop_once();
+		delayMicroseconds(TTN_LOOP_US);
+		waitForEvent(TTN_MAX_SLEEP_MS);
+		wakeups++;
+	}
+}
+
+static void testQueryNextDeadline()
+{
+	ostime_t deadline = 0;
+
+	CHECK(!os_queryNextDeadline(&deadline));
+
+	scheduleJob(0, os_getTime() + ms2osticks(500));
+	scheduleJob(1, os_getTime() + ms2osticks(100));
+	CHECK(os_queryNextDeadline(&deadline));
+	CHECK_EQ(deadline, aDeadline[1]);
+
+	/** a runnable job is due now */
+	os_setCallback(&aJob[2], jobCallback);
+	CHECK(os_queryNextDeadline(&deadline));
+	CHECK_EQ(deadline, os_getTime());
+
+	os_clearCallback(&aJob[0]);
+	os_clearCallback(&aJob[1]);
+	os_clearCallback(&aJob[2]);
+	CHECK(!os_queryNextDeadline(&deadline));
+}
+
+static void testJobTiming(const char *name, uint64_t startUs)
+{
+	/** deadlines from a single tick to beyond the longest sleep, none of them on a ms boundary */
+	static const ostime_t aOffset[JOB_COUNT] = { 1, ms2osticks(3) + 7, sec2osticks(1) + 33, sec2osticks(20) + 5 };
+
+	hostSetTimeUs(startUs);
+	wakeups = 0;
+	for (uint8_t i = 0; i < JOB_COUNT; i++) {
+		aRuns[i] = 0;
+		scheduleJob(i, os_getTime() + aOffset[i]);
+	}
+
+	runTtnTask(aDeadline[JOB_COUNT - 1] + ms2osticks(10));
+
+	for (uint8_t i = 0; i < JOB_COUNT; i++) {
+		s4_t late = aStart[i] - aDeadline[i];
+
+		CHECK_EQ(aRuns[i], 1);
+		CHECK(late >= 0);
+		CHECK(late < ms2osticks(1));
+	}
+
+	/** one wakeup per TTN_MAX_SLEEP_MS and the spin over the sub ms remainder of every job, not one per ms */
+	printf("%s: %u wakeups for 20 s\n", name, wakeups);
+	CHECK(wakeups <= 20000 / TTN_MAX_SLEEP_MS + JOB_COUNT * (1 + 1000 / TTN_LOOP_US));
+}
+
+/** a radio interrupt ends the wait, the job it posts runs right away */
+static void testRadioInterrupt()
+{
+	ostime_t deadline;
+	ostime_t now;
+
+	hostSetTimeUs(0);
+	aRuns[0] = 0;
+	aRuns[1] = 0;
+	scheduleJob(0, os_getTime() + sec2osticks(10));
+
+	xTaskNotifyGive(NULL);
+	now = os_getTime();
+	waitForEvent(TTN_MAX_SLEEP_MS);
+	CHECK_EQ(os_getTime(), now);
+
+	os_setCallback(&aJob[1], jobCallback);
+	CHECK(os_queryNextDeadline(&deadline));
+	CHECK_EQ(deadline, now);
+	waitForEvent(TTN_MAX_SLEEP_MS);
+	CHECK_EQ(os_getTime(), now);
+	os_runloop_once();
+	CHECK_EQ(aRuns[1], 1);
+	CHECK_EQ(aRuns[0], 0);
+
+	os_clearCallback(&aJob[0]);
+}
+
+int main()
+{
+	testQueryNextDeadline();
+	testJobTiming("start", 0);
+
+	/** the 32 bit tick counter wraps during the run */
+	testJobTiming("tick wrap", ((uint64_t)0xFFFFFFFF - (uint64_t)sec2osticks(5)) << US_PER_OSTICK_EXPONENT);
+	testRadioInterrupt();
+
+	return HOST_TEST_RESULT();
+}
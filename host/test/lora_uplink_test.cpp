@@ -0,0 +1,310 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			lora_uplink_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the uplink selection of the lora samples against the EU868 band plan of LMIC
+* @details		DR0..DR3 are limited by the band plan, DR4 and up have no limit of their own (0xFF) and are limited by
+*				the frame buffer of LMIC, the batches never exceed LORA_BATCH_MAX_BYTES. loraSelectUplink() is checked
+*				for DR0..DR5 with 1..8 stored samples of the live stream, of the backlog and with lost link: port, length
+*				and number of samples of the frame, the frame is decoded by the reference decoders. A stream of samples
+*				every TX_INTERVAL has to reach the receiver completely and in order, single live samples as key/delta
+*				frames whose key offset matches the frame counter, also across batches and a change of the data rate.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <math.h>
+#include <vector>
+#include "lmic/lmic.h"
+#include "LoraPacketHandler.h"
+#include "HostTest.h"
+
+/** band plan of LMIC, declared like in BLE_CLIENT.ino */
+extern "C" uint8_t LMICeu868_maxFrameLen(uint8_t dr);
+
+#define TX_INTERVAL				20			// BLE_CLIENT.ino
+#define SAMPLE_TIME				1760000000
+#define BACKLOG_FRAME_LEN		(sizeof(uint32_t) + sizeof(LORA_DATA_PACKET_T))
+
+/** offsets in LORA_DATA_PACKET_T */
+#define OFFSET_LATITUDE			0
+#define OFFSET_LONGITUDE		4
+#define OFFSET_ALTITUDE			8
+#define OFFSET_BMS_VOLTAGE		12
+
+typedef struct DELIVERED_Ttag {
+	uint32_t	ulTime;								//!< sample time, 0 for key/delta frames
+	uint8_t		abPacket[LORA_CODEC_PACKET_LEN];
+} DELIVERED_T;
+
+static void setBigEndian(uint8_t *pPacket, uint8_t offset, uint8_t size, uint32_t value)
+{
+	for (uint8_t i = size; i > 0; i--) {
+		pPacket[offset + i - 1] = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+static void setFloat(uint8_t *pPacket, uint8_t offset, float fValue)
+{
+	uint32_t raw;
+	memcpy(&raw, &fValue, sizeof(raw));
+	setBigEndian(pPacket, offset, 4, raw);
+}
+
+static long scaledFloat(const uint8_t *pPacket, uint8_t offset, double scale)
+{
+	uint32_t raw = 0;
+	float fValue;
+	for (uint8_t i = 0; i < 4; i++) raw = (raw << 8) | pPacket[offset + i];
+	memcpy(&fValue, &raw, sizeof(fValue));
+	return lround((double)fValue * scale);
+}
+
+/** equal at the resolution of the codec */
+static bool isSamePacket(const uint8_t *pPacket, const uint8_t *pDecoded)
+{
+	if (scaledFloat(pPacket, OFFSET_LATITUDE, 1e6) != scaledFloat(pDecoded, OFFSET_LATITUDE, 1e6)) return false;
+	if (scaledFloat(pPacket, OFFSET_LONGITUDE, 1e6) != scaledFloat(pDecoded, OFFSET_LONGITUDE, 1e6)) return false;
+	if (scaledFloat(pPacket, OFFSET_ALTITUDE, 10) != scaledFloat(pDecoded, OFFSET_ALTITUDE, 10)) return false;
+
+	return memcmp(&pPacket[OFFSET_BMS_VOLTAGE], &pDecoded[OFFSET_BMS_VOLTAGE], LORA_CODEC_PACKET_LEN - OFFSET_BMS_VOLTAGE) == 0;
+}
+
+/** sample n of a ride, position, altitude, voltages, speed, heart rate and distance change every sample */
+static void makeRecord(TELEMETRY_RECORD_T *ptRecord, uint16_t n, uint32_t ulTime)
+{
+	LORA_DATA_PACKET_T tPacket;
+
+	memset(&tPacket, 0, sizeof(tPacket));
+	setFloat(tPacket.abPacket, OFFSET_LATITUDE, 50.833717f + n * 0.00025f);
+	setFloat(tPacket.abPacket, OFFSET_LONGITUDE, 12.927125f + n * 0.0003f);
+	setFloat(tPacket.abPacket, OFFSET_ALTITUDE, 312.4f + n * 0.7f);
+	tPacket.tPacket.usBmsTotalVoltage = __builtin_bswap16(0x0F00 - n);
+	tPacket.tPacket.usControllerTotalVoltage = __builtin_bswap16(0x0EF0 - n);
+	tPacket.tPacket.bControllerSpeedKmh = 20 + n % 5;
+	tPacket.tPacket.usControllerTotalDistance = __builtin_bswap16(100 + n);
+	tPacket.tPacket.ulRtcTimeOfStartSession = __builtin_bswap32(SAMPLE_TIME - 600);
+	tPacket.tPacket.bHeartyBpm = 110 + n % 30;
+
+	memset(ptRecord, 0, sizeof(*ptRecord));
+	ptRecord->bType = LORA_RECORD_SAMPLE;
+	ptRecord->bLength = sizeof(tPacket.abPacket);
+	ptRecord->ulTime = ulTime;
+	memcpy(ptRecord->abData, tPacket.abPacket, sizeof(tPacket.abPacket));
+}
+
+static size_t payloadLimit(uint8_t dr)
+{
+	return loraPayloadLimitOf(LMICeu868_maxFrameLen(dr), MAX_LEN_FRAME);
+}
+
+/** receiver of the uplinks, the frame counter of LMIC counts every uplink */
+class Receiver
+{
+public:
+	Receiver() : _fcnt(0), _keyFcnt(0), _isKeyValid(false) {}
+
+	bool receive(const LORA_UPLINK_T &tUplink)
+	{
+		DELIVERED_T tDelivered;
+		uint8_t keyOffset;
+
+		_fcnt++;
+		memset(&tDelivered, 0, sizeof(tDelivered));
+
+		switch (tUplink.bPort) {
+		case LORA_PORT_LIVE:
+			if (tUplink.len != LORA_CODEC_PACKET_LEN) return false;
+			memcpy(_abKey, tUplink.pFrame, LORA_CODEC_PACKET_LEN);
+			memcpy(tDelivered.abPacket, tUplink.pFrame, LORA_CODEC_PACKET_LEN);
+			_keyFcnt = _fcnt;
+			_isKeyValid = true;
+			break;
+		case LORA_PORT_DELTA:
+			if (!_isKeyValid || !LoraPacketCodec::decodeDelta(_abKey, tUplink.pFrame, tUplink.len, tDelivered.abPacket, &keyOffset)) {
+				return false;
+			}
+			if (_fcnt - keyOffset != _keyFcnt) return false;
+			break;
+		case LORA_PORT_BACKLOG:
+			if (tUplink.len != BACKLOG_FRAME_LEN) return false;
+			for (uint8_t i = 0; i < sizeof(uint32_t); i++) tDelivered.ulTime = (tDelivered.ulTime << 8) | tUplink.pFrame[i];
+			memcpy(tDelivered.abPacket, &tUplink.pFrame[sizeof(uint32_t)], LORA_CODEC_PACKET_LEN);
+			break;
+		case LORA_PORT_BATCH:
+			return LoraPacketBatch::decode(tUplink.pFrame, tUplink.len, [this](uint32_t ulTime, const uint8_t *pPacket) {
+				DELIVERED_T tSample;
+				tSample.ulTime = ulTime;
+				memcpy(tSample.abPacket, pPacket, LORA_CODEC_PACKET_LEN);
+				delivered.push_back(tSample);
+			}) == tUplink.bRecords;
+		default:
+			return false;
+		}
+
+		delivered.push_back(tDelivered);
+		return tUplink.bRecords == 1;
+	}
+
+	std::vector<DELIVERED_T> delivered;
+
+private:
+	uint32_t	_fcnt;
+	uint32_t	_keyFcnt;
+	bool		_isKeyValid;
+	uint8_t		_abKey[LORA_CODEC_PACKET_LEN];
+};
+
+/** the selected frame fits the data rate and holds the oldest samples */
+static void checkUplink(const LORA_UPLINK_T &tUplink, const TELEMETRY_RECORD_T *ptRecords, uint8_t dr)
+{
+	Receiver receiver;
+
+	CHECK(tUplink.len <= payloadLimit(dr));
+	CHECK(tUplink.bRecords >= 1);
+	CHECK(receiver.receive(tUplink));
+	CHECK_EQ(receiver.delivered.size(), tUplink.bRecords);
+
+	for (uint8_t i = 0; i < receiver.delivered.size() && i < tUplink.bRecords; i++) {
+		CHECK(isSamePacket(ptRecords[i].abData, receiver.delivered[i].abPacket));
+		if (tUplink.bPort == LORA_PORT_BATCH || tUplink.bPort == LORA_PORT_BACKLOG) {
+			CHECK_EQ(receiver.delivered[i].ulTime, ptRecords[i].ulTime);
+		}
+	}
+}
+
+static void testPayloadLimit()
+{
+	static const uint8_t abMaxFrameLen[] = { 64, 64, 64, 123, 0xFF, 0xFF };
+	static const size_t aLimit[] = { 49, 49, 49, 108, 113, 113 };
+
+	CHECK_EQ(MAX_LEN_FRAME, 128);
+
+	for (uint8_t dr = DR_SF12; dr <= DR_SF7; dr++) {
+		CHECK_EQ(LMICeu868_maxFrameLen(dr), abMaxFrameLen[dr]);
+		CHECK_EQ(payloadLimit(dr), aLimit[dr]);
+	}
+
+	/** a larger frame buffer, the batch limit applies */
+	CHECK_EQ(loraPayloadLimitOf(0xFF, 255), LORA_BATCH_MAX_BYTES);
+}
+
+/**
+* n stored samples, one every TX_INTERVAL, the newest taken right now (live), LORA_LIVE_MAX_AGE_S ago (backlog) or
+* with lost link. Samples in the batch per data rate: one sample fits at DR0..DR2, the key frame and four delta frames
+* at DR3, five delta frames at DR4/DR5. A single sample older than LORA_LIVE_MAX_AGE_S goes with its sample time.
+*/
+static void testSelection()
+{
+	static const uint8_t abBatchRecords[] = { 1, 1, 1, 5, 6, 6 };
+	TELEMETRY_RECORD_T atRecords[LORA_BATCH_MAX_RECORDS];
+	uint8_t abFrame[sizeof(uint32_t) + TELEMETRY_STORE_DATA_LEN];
+	LORA_UPLINK_T tUplink;
+	LoraPacketBatch batch;
+
+	for (uint8_t dr = DR_SF12; dr <= DR_SF7; dr++) {
+		for (uint16_t n = 1; n <= LORA_BATCH_MAX_RECORDS; n++) {
+			uint8_t expected = (n < abBatchRecords[dr]) ? n : abBatchRecords[dr];
+			uint32_t ulNow = SAMPLE_TIME + (n - 1) * TX_INTERVAL;
+			uint8_t bSinglePort = ((n - 1) * TX_INTERVAL < LORA_LIVE_MAX_AGE_S) ? LORA_PORT_LIVE : LORA_PORT_BACKLOG;
+
+			for (uint16_t i = 0; i < n; i++) makeRecord(&atRecords[i], i, SAMPLE_TIME + i * TX_INTERVAL);
+
+			/** live: held back while all samples fit and the oldest is younger than LORA_BATCH_MAX_AGE_S */
+			LoraPacketCodec codec;
+			bool isHeldBack = (expected == n) && ((n - 1) * TX_INTERVAL < LORA_BATCH_MAX_AGE_S);
+			CHECK_EQ(loraSelectUplink(atRecords, n, ulNow, true, payloadLimit(dr), codec, batch, abFrame, &tUplink), !isHeldBack);
+			if (!isHeldBack) {
+				CHECK_EQ(tUplink.bRecords, expected);
+				CHECK_EQ(tUplink.bPort, (expected > 1) ? LORA_PORT_BATCH : bSinglePort);
+				if (expected == 1) CHECK_EQ(tUplink.len, (bSinglePort == LORA_PORT_LIVE) ? LORA_CODEC_PACKET_LEN : BACKLOG_FRAME_LEN);
+				checkUplink(tUplink, atRecords, dr);
+			}
+
+			/** lost link: the probe is sent right away */
+			LoraPacketCodec probeCodec;
+			CHECK(loraSelectUplink(atRecords, n, ulNow, false, payloadLimit(dr), probeCodec, batch, abFrame, &tUplink));
+			CHECK_EQ(tUplink.bRecords, expected);
+			CHECK_EQ(tUplink.bPort, (expected > 1) ? LORA_PORT_BATCH : bSinglePort);
+			checkUplink(tUplink, atRecords, dr);
+
+			/** backlog: a single sample goes with its sample time */
+			LoraPacketCodec backlogCodec;
+			CHECK(loraSelectUplink(atRecords, n, ulNow + LORA_LIVE_MAX_AGE_S, true, payloadLimit(dr), backlogCodec, batch, abFrame,
+				&tUplink));
+			CHECK_EQ(tUplink.bRecords, expected);
+			CHECK_EQ(tUplink.bPort, (expected > 1) ? LORA_PORT_BATCH : LORA_PORT_BACKLOG);
+			if (expected == 1) CHECK_EQ(tUplink.len, BACKLOG_FRAME_LEN);
+			checkUplink(tUplink, atRecords, dr);
+		}
+	}
+}
+
+/**
+* a sample every TX_INTERVAL with an uplink right after it, DR5 for the first half, DR0 for the second. Every sample has
+* to arrive once and in order, the samples sent alone are key/delta frames, never backlog frames.
+*/
+static void testStream()
+{
+	const uint16_t samples = 48;
+	std::vector<TELEMETRY_RECORD_T> store;
+	uint8_t abFrame[sizeof(uint32_t) + TELEMETRY_STORE_DATA_LEN];
+	uint16_t auPorts[LORA_PORT_BATCH + 1] = { 0 };
+	LORA_UPLINK_T tUplink;
+	LoraPacketCodec codec;
+	LoraPacketBatch batch;
+	Receiver receiver;
+
+	for (uint16_t n = 0; n < samples; n++) {
+		uint32_t ulNow = SAMPLE_TIME + n * TX_INTERVAL;
+		uint8_t dr = (n < samples / 2) ? DR_SF7 : DR_SF12;
+		TELEMETRY_RECORD_T tRecord;
+
+		makeRecord(&tRecord, n, ulNow);
+		store.push_back(tRecord);
+
+		uint16_t records = (store.size() < LORA_BATCH_MAX_RECORDS) ? store.size() : LORA_BATCH_MAX_RECORDS;
+		if (!loraSelectUplink(store.data(), records, ulNow, true, payloadLimit(dr), codec, batch, abFrame, &tUplink)) continue;
+
+		CHECK(tUplink.len <= payloadLimit(dr));
+		CHECK(receiver.receive(tUplink));
+		auPorts[tUplink.bPort]++;
+		store.erase(store.begin(), store.begin() + tUplink.bRecords);
+	}
+
+	printf("stream: %u key, %u delta, %u backlog, %u batch frames\n", auPorts[LORA_PORT_LIVE], auPorts[LORA_PORT_DELTA],
+		auPorts[LORA_PORT_BACKLOG], auPorts[LORA_PORT_BATCH]);
+
+	CHECK_EQ(receiver.delivered.size() + store.size(), samples);
+	for (uint16_t n = 0; n < receiver.delivered.size(); n++) {
+		TELEMETRY_RECORD_T tRecord;
+		makeRecord(&tRecord, n, SAMPLE_TIME + n * TX_INTERVAL);
+		CHECK(isSamePacket(tRecord.abData, receiver.delivered[n].abPacket));
+	}
+
+	CHECK_EQ(auPorts[LORA_PORT_BACKLOG], 0);
+	CHECK(auPorts[LORA_PORT_BATCH] > 0);
+	CHECK(auPorts[LORA_PORT_DELTA] > auPorts[LORA_PORT_LIVE]);
+}
+
+int main()
+{
+	testPayloadLimit();
+	testSelection();
+	testStream();
+
+	return HOST_TEST_RESULT();
+}
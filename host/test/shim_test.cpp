@@ -0,0 +1,132 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			shim_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		test of the Arduino/FreeRTOS shim of the host build
+* @details		The virtual clock, the blocking timeouts and the bus models the other tests rely on.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+#include "HostShim.h"
+#include "HostTest.h"
+
+class EchoDevice : public HostI2cDevice
+{
+public:
+	uint8_t last;
+	void i2cWrite(const uint8_t *pData, size_t len) { if (len) last = pData[len - 1]; }
+	void i2cRead(uint8_t *pData, size_t len) { memset(pData, last, len); }
+};
+
+static void testClock()
+{
+	hostSetTimeUs(0);
+	delay(5);
+	CHECK_EQ(millis(), 5);
+	CHECK_EQ(micros(), 5000);
+	CHECK_EQ(xTaskGetTickCount(), 5);
+	vTaskDelay(pdMS_TO_TICKS(10));
+	CHECK_EQ(esp_timer_get_time(), 15000);
+
+	/** the Arduino counters are 32 bit wide */
+	hostSetTimeUs(0x100000000ULL + 7);
+	CHECK_EQ(micros(), 7);
+	hostSetTimeUs(0);
+}
+
+static void testQueueAndSemaphore()
+{
+	QueueHandle_t xQueue = xQueueCreate(2, sizeof(uint32_t));
+	SemaphoreHandle_t xMutex = xSemaphoreCreateMutex();
+	SemaphoreHandle_t xBinary = xSemaphoreCreateBinary();
+	uint32_t value = 1;
+
+	CHECK(xQueueSend(xQueue, &value, 0) == pdPASS);
+	value = 2;
+	CHECK(xQueueSendToFront(xQueue, &value, 0) == pdPASS);
+	CHECK(xQueueSend(xQueue, &value, 0) == pdFAIL);
+	CHECK_EQ(uxQueueMessagesWaiting(xQueue), 2);
+	CHECK(xQueueReceive(xQueue, &value, 0) == pdPASS);
+	CHECK_EQ(value, 2);
+	CHECK(xQueueReceive(xQueue, &value, 0) == pdPASS);
+	CHECK_EQ(value, 1);
+
+	/** a failed blocking call waits for its timeout */
+	hostSetTimeUs(0);
+	CHECK(xQueueReceive(xQueue, &value, pdMS_TO_TICKS(20)) == pdFAIL);
+	CHECK_EQ(millis(), 20);
+
+	CHECK(xSemaphoreTake(xMutex, 0) == pdTRUE);
+	CHECK(xSemaphoreTake(xMutex, 0) == pdFALSE);
+	CHECK(xSemaphoreGive(xMutex) == pdTRUE);
+	CHECK(xSemaphoreTake(xBinary, 0) == pdFALSE);
+
+	vQueueDelete(xQueue);
+	vSemaphoreDelete(xMutex);
+	vSemaphoreDelete(xBinary);
+}
+
+static void testNotifyAndEvents()
+{
+	EventGroupHandle_t xEvents = xEventGroupCreate();
+
+	xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+	CHECK_EQ(hostGetTaskNotifyCount(NULL), 2);
+	CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 2);
+	CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 0);
+
+	xEventGroupSetBits(xEvents, 0x05);
+	CHECK_EQ(xEventGroupWaitBits(xEvents, 0x01, pdTRUE, pdFALSE, 0), 0x05);
+	CHECK_EQ(xEventGroupGetBits(xEvents), 0x04);
+	vEventGroupDelete(xEvents);
+}
+
+static void testWire()
+{
+	EchoDevice device;
+
+	Wire.begin(21, 22, 400000);
+	CHECK_EQ(Wire.endTransmission(), 2);
+
+	Wire.attach(0x42, &device);
+	hostSetTimeUs(0);
+	Wire.beginTransmission(0x42);
+	Wire.write(0x5a);
+	CHECK_EQ(Wire.endTransmission(), 0);
+	CHECK_EQ(Wire.requestFrom(0x42, 3), 3);
+	CHECK_EQ(Wire.available(), 3);
+	CHECK_EQ(Wire.read(), 0x5a);
+
+	/** 2 + 4 bytes with address at 400 kHz */
+	CHECK_EQ(micros(), (((1 + 1) * 9 + 2) * 1000000ULL / 400000) + (((3 + 1) * 9 + 2) * 1000000ULL / 400000));
+	Wire.attach(0x42, NULL);
+}
+
+int main()
+{
+	testClock();
+	testQueueAndSemaphore();
+	testNotifyAndEvents();
+	testWire();
+
+	return HOST_TEST_RESULT();
+}
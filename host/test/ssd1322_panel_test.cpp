@@ -0,0 +1,135 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			ssd1322_panel_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the SSD1322 256x64 driver of U8g2 against the panel model
+* @details		The driver expands the tiles of a draw request row by row and streams them in one burst per column
+*				window. Whatever the position, count and repeat of a request, the panel RAM has to show exactly the
+*				pixels of the tiles sent, every pixel at full gray, with one column window and one write to RAM
+*				per tile row of the request.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <U8g2lib.h>
+#include "HostSsd1322.h"
+#include "HostTest.h"
+
+#define CS_PIN				15
+#define DC_PIN				2
+#define WIDTH				256
+#define HEIGHT				64
+#define TILE_COLUMNS		(WIDTH / 8)
+#define TILE_ROWS			(HEIGHT / 8)
+#define REQUESTS			2000
+
+static uint8_t abShadow[HEIGHT][WIDTH];
+
+/** pixels of the panel which differ from the shadow */
+static uint32_t comparePanel(const HostSsd1322 &panel)
+{
+	uint32_t mismatches = 0;
+
+	for (uint16_t y = 0; y < HEIGHT; y++) {
+		for (uint16_t x = 0; x < WIDTH; x++) {
+			if (panel.getPixel(x, y) != abShadow[y][x]) mismatches++;
+		}
+	}
+
+	return mismatches;
+}
+
+/** a tile is 8 columns, lsb is the top pixel */
+static void shadowTile(uint8_t col, uint8_t row, const uint8_t *pTile)
+{
+	for (uint8_t i = 0; i < 8; i++) {
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			abShadow[row * 8 + bit][col * 8 + i] = ((pTile[i] >> bit) & 1) ? 0x0f : 0x00;
+		}
+	}
+}
+
+static void testFullBuffer(U8G2 &u8g2, HostSsd1322 &panel)
+{
+	uint8_t *pBuffer = u8g2.getBufferPtr();
+
+	for (uint8_t frame = 0; frame < 4; frame++) {
+		for (uint16_t i = 0; i < TILE_ROWS * TILE_COLUMNS * 8; i++) pBuffer[i] = (frame == 0) ? 0xFF : (uint8_t)random(256);
+
+		for (uint8_t row = 0; row < TILE_ROWS; row++) {
+			for (uint8_t col = 0; col < TILE_COLUMNS; col++) shadowTile(col, row, &pBuffer[(row * TILE_COLUMNS + col) * 8]);
+		}
+
+		panel.resetCounts();
+		u8g2.sendBuffer();
+
+		CHECK_EQ(comparePanel(panel), 0);
+		/** row address, column window and write to RAM per tile row */
+		CHECK_EQ(panel.getCommandCount(), 3 * TILE_ROWS);
+		CHECK_EQ(panel.getDataCount(), WIDTH * HEIGHT / 2);
+	}
+}
+
+/** random requests of the display callback, including repeats of the same tiles */
+static void testDrawTileRequests(U8G2 &u8g2, HostSsd1322 &panel)
+{
+	u8x8_t *pU8x8 = u8g2.getU8x8();
+	uint8_t abTiles[TILE_COLUMNS * 8];
+	uint32_t mismatches = 0;
+	uint32_t commandMismatches = 0;
+
+	for (uint16_t n = 0; n < REQUESTS; n++) {
+		u8x8_tile_t tTile;
+		uint8_t repeat = (n % 4 == 0) ? (uint8_t)random(2, 5) : 1;
+		uint8_t cnt = (uint8_t)random(1, TILE_COLUMNS / repeat + 1);
+
+		tTile.x_pos = (uint8_t)random(0, TILE_COLUMNS - cnt * repeat + 1);
+		tTile.y_pos = (uint8_t)random(TILE_ROWS);
+		tTile.cnt = cnt;
+		tTile.tile_ptr = abTiles;
+		for (uint16_t i = 0; i < cnt * 8; i++) abTiles[i] = (uint8_t)random(256);
+
+		for (uint8_t r = 0; r < repeat; r++) {
+			for (uint8_t i = 0; i < cnt; i++) shadowTile(tTile.x_pos + r * cnt + i, tTile.y_pos, &abTiles[i * 8]);
+		}
+
+		panel.resetCounts();
+		/** row address once, column window and write to RAM per repeat */
+		pU8x8->display_cb(pU8x8, U8X8_MSG_DISPLAY_DRAW_TILE, repeat, &tTile);
+
+		if (panel.getCommandCount() != (uint32_t)(1 + 2 * repeat)) commandMismatches++;
+		mismatches += comparePanel(panel);
+	}
+
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(commandMismatches, 0);
+}
+
+int main()
+{
+	U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI u8g2(U8G2_R0, CS_PIN, DC_PIN, U8X8_PIN_NONE);
+	HostSsd1322 panel(CS_PIN, DC_PIN);
+
+	randomSeed(15);
+	SPI.attach(&panel);
+	u8g2.begin();
+
+	testFullBuffer(u8g2, panel);
+	testDrawTileRequests(u8g2, panel);
+
+	SPI.attach(NULL);
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,288 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			trace_replay_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the input trace recorder and of the replay through the parsers of the firmware
+* @details		A ten second ride (BMS and controller notifications, NMEA epochs, IMU FIFO bursts with one impact,
+*				LMIC join and uplinks) is recorded by InputTrace onto a partition of the shim and replayed: every
+*				record, frame, fix and impact has to come out as it went in, the damaged BMS frame and NMEA sentence
+*				as errors. The checked-in data/sample_trace.bin is the same ride, its replay has to give the same
+*				summary.
+*
+*				trace_replay_test --write-sample data/sample_trace.bin records the sample again.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "lmic/lmic.h"
+#include "HostShim.h"
+#include "HostTest.h"
+#include "TraceReplay.h"
+
+#define PARTITION_LABEL		"trace"
+#define PARTITION_SIZE		(16 * INPUT_TRACE_SECTOR_SIZE)
+#define SAMPLE_TRACE		"data/sample_trace.bin"
+
+#define RIDE_SECONDS		10
+#define TICK_MS				10
+#define ONE_G				2048		// counts per g at the 16 g range
+#define IMU_BURST_FRAMES	10			// 200 Hz, read every 50 ms
+#define IMPACT_SAMPLE		1200		// 6 s into the ride
+#define DAMAGED_BMS_SECOND	4
+#define DAMAGED_GPS_SECOND	7
+#define GPS_CHUNK			64			// GPS_ENCODE_CHUNK of BLE_CLIENT.ino
+#define BLE_NOTIFY_LEN		20			// payload of a notification at the default MTU
+
+static uint32_t aulRecorded[INPUT_TRACE_SOURCE_MAX];
+static uint32_t aulRecordedBytes[INPUT_TRACE_SOURCE_MAX];
+
+static void recordInput(InputTrace &trace, uint8_t bSource, const void *pData, uint16_t usLength)
+{
+	CHECK(trace.record(bSource, pData, usLength));
+	aulRecorded[bSource]++;
+	aulRecordedBytes[bSource] += usLength;
+	trace.process();
+}
+
+static void recordImuBurst(InputTrace &trace, uint32_t &sample)
+{
+	uint8_t abBurst[IMU_BURST_FRAMES * IMPACT_FIFO_FRAME_SIZE];
+
+	for (uint8_t f = 0; f < IMU_BURST_FRAMES; f++, sample++) {
+		const int16_t aCounts[6] = { (int16_t)((int16_t)(sample % 3) - 1), 0, (int16_t)((sample == IMPACT_SAMPLE) ? 6 * ONE_G : ONE_G), 1, 2, 3 };
+
+		for (uint8_t i = 0; i < 6; i++) {
+			abBurst[f * IMPACT_FIFO_FRAME_SIZE + 2 * i] = (uint8_t)((uint16_t)aCounts[i] >> 8);
+			abBurst[f * IMPACT_FIFO_FRAME_SIZE + 2 * i + 1] = (uint8_t)aCounts[i];
+		}
+	}
+
+	recordInput(trace, INPUT_TRACE_SOURCE_IMU_FIFO, abBurst, sizeof(abBurst));
+}
+
+/** 0xAA, voltage, distance, speed and erps little endian, 0x85 */
+static void recordControllerFrame(InputTrace &trace, uint32_t second)
+{
+	const uint32_t ulSpeed = 20 + second;
+	uint8_t abFrame[12] = { 0xAA, 40, (uint8_t)second };
+
+	memcpy(&abFrame[3], &ulSpeed, sizeof(ulSpeed));
+	memset(&abFrame[7], 0, 4);
+	abFrame[11] = 0x85;
+
+	recordInput(trace, INPUT_TRACE_SOURCE_CONTROLLER_NOTIFY, abFrame, sizeof(abFrame));
+}
+
+/** info status response, split into notifications */
+static void recordBmsFrame(InputTrace &trace, uint32_t second)
+{
+	BMS_INFO_STATUS_READ_STRUCT_T tInfoStatus;
+	std::vector<uint8_t> frame;
+	const uint8_t *pPayload = (const uint8_t *)&tInfoStatus;
+	uint16_t usVoltage = (uint16_t)(5200 - second);
+	uint16_t sum = sizeof(tInfoStatus);
+
+	memset(&tInfoStatus, 0, sizeof(tInfoStatus));
+	tInfoStatus.usTotalVoltage = (uint16_t)((usVoltage >> 8) | (usVoltage << 8));
+	tInfoStatus.bRelStateOfCharge = (uint8_t)(90 - second);
+
+	frame.push_back(0xDD);
+	frame.push_back(BMSRegister::BMS_REG_INFO_STATUS);
+	frame.push_back(0x00);
+	frame.push_back((uint8_t)sizeof(tInfoStatus));
+	for (uint8_t i = 0; i < sizeof(tInfoStatus); i++) {
+		frame.push_back(pPayload[i]);
+		sum += pPayload[i];
+	}
+	sum = (uint16_t)(~sum + 1);
+	if (second == DAMAGED_BMS_SECOND) sum ^= 0x01;
+	frame.push_back((uint8_t)(sum >> 8));
+	frame.push_back((uint8_t)sum);
+	frame.push_back(0x77);
+
+	for (size_t offset = 0; offset < frame.size(); offset += BLE_NOTIFY_LEN) {
+		uint16_t len = (uint16_t)std::min((size_t)BLE_NOTIFY_LEN, frame.size() - offset);
+		recordInput(trace, INPUT_TRACE_SOURCE_BMS_NOTIFY, &frame[offset], len);
+	}
+}
+
+static void appendSentence(std::string &log, const char *body, bool isDamaged)
+{
+	uint8_t checksum = 0;
+	char acTail[8];
+
+	for (const char *p = body; *p; p++) checksum ^= (uint8_t)*p;
+	if (isDamaged) checksum ^= 0x01;
+	snprintf(acTail, sizeof(acTail), "*%02X\r\n", checksum);
+
+	log += '$';
+	log += body;
+	log += acTail;
+}
+
+/** GGA and RMC of one epoch, read in chunks like encodeGPS() */
+static void recordGpsEpoch(InputTrace &trace, uint32_t second)
+{
+	std::string log;
+	char acBody[128];
+	double lat = 5238.4743 + second * 0.0011, lon = 1330.6377 + second * 0.0017;
+
+	snprintf(acBody, sizeof(acBody), "GPGGA,1200%02u.000,%.4f,N,%09.4f,E,1,10,1.14,35.0,M,47.0,M,,", second, lat, lon);
+	appendSentence(log, acBody, false);
+	snprintf(acBody, sizeof(acBody), "GPRMC,1200%02u.000,A,%.4f,N,%09.4f,E,12.00,54.70,171026,,,A", second, lat, lon);
+	appendSentence(log, acBody, second == DAMAGED_GPS_SECOND);
+
+	for (size_t offset = 0; offset < log.size(); offset += GPS_CHUNK) {
+		uint16_t len = (uint16_t)std::min((size_t)GPS_CHUNK, log.size() - offset);
+		recordInput(trace, INPUT_TRACE_SOURCE_GPS, &log[offset], len);
+	}
+}
+
+/** payload of traceLmicEvent() */
+static void recordLmicEvent(InputTrace &trace, uint8_t ev, uint8_t txrxFlags, const uint8_t *pDownlink, uint8_t dataLen)
+{
+	uint8_t abEvent[3 + 16] = { ev, txrxFlags, dataLen };
+
+	if (dataLen > 0) memcpy(&abEvent[3], pDownlink, dataLen);
+	recordInput(trace, INPUT_TRACE_SOURCE_LMIC_EVENT, abEvent, (uint16_t)(3 + dataLen));
+}
+
+/** the ride on a fresh partition, returns the written part of the partition */
+static std::vector<uint8_t> recordRide()
+{
+	static const uint8_t abDownlink[4] = { 0x01, 0x02, 0x03, 0x04 };
+	uint8_t *pFlash = hostCreatePartition(PARTITION_LABEL, PARTITION_SIZE);
+	InputTrace trace;
+	uint32_t sample = 0;
+
+	memset(aulRecorded, 0, sizeof(aulRecorded));
+	memset(aulRecordedBytes, 0, sizeof(aulRecordedBytes));
+
+	hostSetTimeUs(0);
+	CHECK(trace.begin(PARTITION_LABEL, INPUT_TRACE_MASK_ALL));
+	aulRecorded[INPUT_TRACE_SOURCE_BOOT]++;
+
+	for (uint32_t t = 0; t < RIDE_SECONDS * 1000; t += TICK_MS) {
+		uint32_t second = t / 1000;
+
+		if (t % 50 == 0) recordImuBurst(trace, sample);
+		if (t % 100 == 0) recordControllerFrame(trace, second);
+		if (t % 1000 == 300) recordBmsFrame(trace, second);
+		if (t % 1000 == 500) recordGpsEpoch(trace, second);
+		if (t == 1000) recordLmicEvent(trace, EV_JOINED, 0, NULL, 0);
+		if (t == 3000) recordLmicEvent(trace, EV_TXCOMPLETE, 0, NULL, 0);
+		if (t == 8000) recordLmicEvent(trace, EV_TXCOMPLETE, TXRX_ACK, abDownlink, sizeof(abDownlink));
+
+		hostAdvanceTimeUs(TICK_MS * 1000);
+	}
+
+	CHECK(trace.flush());
+	CHECK_EQ(trace.getDroppedCount(), 0);
+	CHECK(trace.getWrittenBlocks() * INPUT_TRACE_BLOCK_SIZE < PARTITION_SIZE);
+
+	return std::vector<uint8_t>(pFlash, pFlash + trace.getWrittenBlocks() * INPUT_TRACE_BLOCK_SIZE);
+}
+
+/** everything recorded comes out of the parsers */
+static void checkRide(const TRACE_REPLAY_SUMMARY_T &tSummary)
+{
+	for (uint8_t i = 0; i < INPUT_TRACE_SOURCE_MAX; i++) {
+		CHECK_EQ(tSummary.aulRecords[i], aulRecorded[i]);
+		CHECK_EQ(tSummary.aulBytes[i], aulRecordedBytes[i]);
+	}
+	CHECK_EQ(tSummary.ullDurationUs, (RIDE_SECONDS * 1000 - 50) * 1000);
+	CHECK_EQ(tSummary.ulDropped, 0);
+	CHECK_EQ(tSummary.ulMissingBlocks, 0);
+
+	CHECK_EQ(tSummary.ulBmsFrames, RIDE_SECONDS - 1);
+	CHECK_EQ(tSummary.ulBmsErrors, 1);
+	CHECK_EQ(tSummary.usBmsVoltage, 5200 - (RIDE_SECONDS - 1));
+	CHECK_EQ(tSummary.bBmsRsoc, 90 - (RIDE_SECONDS - 1));
+
+	CHECK_EQ(tSummary.ulControllerFrames, RIDE_SECONDS * 10);
+	CHECK_EQ(tSummary.ulControllerErrors, 0);
+	CHECK_EQ(tSummary.ulControllerSpeed, 20 + RIDE_SECONDS - 1);
+
+	/** GGA and RMC of every epoch have a fix, but the damaged RMC */
+	CHECK_EQ(tSummary.ulGpsSentences, 2 * RIDE_SECONDS);
+	CHECK_EQ(tSummary.ulGpsChecksumErrors, 1);
+	CHECK_EQ(tSummary.ulGpsFixes, 2 * RIDE_SECONDS - 1);
+	CHECK(abs(tSummary.lGpsLatitude - 52641403) <= 1);
+	CHECK(abs(tSummary.lGpsLongitude - 13510883) <= 1);
+
+	CHECK_EQ(tSummary.ulImuSamples, RIDE_SECONDS * 200);
+	CHECK_EQ(tSummary.ulImpacts, 1);
+	CHECK_EQ(tSummary.ulImpactOnsetSample, IMPACT_SAMPLE);
+
+	CHECK_EQ(tSummary.ulLmicJoins, 1);
+	CHECK_EQ(tSummary.ulLmicTxComplete, 2);
+	CHECK_EQ(tSummary.ulLmicAcks, 1);
+	CHECK_EQ(tSummary.ulLmicDownlinks, 1);
+	CHECK_EQ(tSummary.ulLmicDownlinkBytes, 4);
+}
+
+static void testRecordAndReplay(const std::vector<uint8_t> &image)
+{
+	TraceReplay replay;
+
+	CHECK(replay.run(image.data(), image.size()));
+	replay.print(stdout);
+	checkRide(replay.getSummary());
+
+	/** nothing but erased flash */
+	std::vector<uint8_t> erased(4 * INPUT_TRACE_BLOCK_SIZE, 0xFF);
+	TraceReplay empty;
+	CHECK(!empty.run(erased.data(), erased.size()));
+}
+
+/** the checked-in sample, recorded by this test, replays to the same summary */
+static void testSample()
+{
+	std::vector<uint8_t> image;
+	FILE *pFile = fopen(SAMPLE_TRACE, "rb");
+	uint8_t abChunk[4096];
+	size_t len;
+
+	CHECK(pFile != NULL);
+	if (pFile == NULL) return;
+	while ((len = fread(abChunk, 1, sizeof(abChunk), pFile)) > 0) image.insert(image.end(), abChunk, abChunk + len);
+	fclose(pFile);
+
+	TraceReplay replay;
+	CHECK(replay.run(image.data(), image.size()));
+	checkRide(replay.getSummary());
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<uint8_t> image = recordRide();
+
+	if (argc == 3 && strcmp(argv[1], "--write-sample") == 0) {
+		FILE *pFile = fopen(argv[2], "wb");
+
+		CHECK(pFile != NULL && fwrite(image.data(), 1, image.size(), pFile) == image.size());
+		if (pFile != NULL) fclose(pFile);
+		printf("%s: %u bytes\n", argv[2], (unsigned)image.size());
+		return HOST_TEST_RESULT();
+	}
+
+	testRecordAndReplay(image);
+	testSample();
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,308 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			u8g2_glyph_cache_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the glyph index and the decoded glyph cache of U8g2
+* @details		drawStr() takes its glyphs from the index built by setFont() and draws them from the cache, either as
+*				a blit into the tile buffer or as replayed runs. A reference decoder walks the glyph list of the font
+*				and draws every pixel of the bitstream with drawPixel() on a second display, both buffers have to be
+*				equal for every rotation, font direction, font mode and draw color, inside and across a clip window
+*				and the pages of a page buffer, with a cold cache and with more glyphs than the cache holds.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include <U8g2lib.h>
+#include "HostSsd1322.h"
+#include "HostTest.h"
+
+#define CS_PIN				15
+#define DC_PIN				2
+#define BUFFER_SIZE			(256 * 64 / 8)
+#define FONT_HEADER_LEN		23
+
+static const u8g2_cb_t *const apRotation[4] = { U8G2_R0, U8G2_R1, U8G2_R2, U8G2_R3 };
+
+/** the dashboard strings, the whole printable range and a code the font does not have */
+static const char *const apText[] = {
+	"Vbms: ", "52.38", "V", "Session:", "017min", "11:42", "PM", "128", "bpm",
+	" !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~",
+	"a\x7f" "b"
+};
+
+/** bitstream of a glyph, lsb first */
+struct GlyphReader {
+	const uint8_t *pData;
+	uint8_t bitPos;
+
+	uint8_t getUnsigned(uint8_t bits)
+	{
+		uint8_t value = 0;
+
+		for (uint8_t i = 0; i < bits; i++) {
+			if ((*pData >> bitPos) & 1) value |= (uint8_t)(1 << i);
+			if (++bitPos == 8) {
+				bitPos = 0;
+				pData++;
+			}
+		}
+
+		return value;
+	}
+
+	int8_t getSigned(uint8_t bits)
+	{
+		return (int8_t)(getUnsigned(bits) - (1 << (bits - 1)));
+	}
+};
+
+/** linear walk over the glyph list, the jump byte is the size of a glyph */
+static const uint8_t *findGlyph(const uint8_t *pFont, uint8_t encoding)
+{
+	const uint8_t *pGlyph = pFont + FONT_HEADER_LEN;
+
+	while (pGlyph[1] != 0) {
+		if (pGlyph[0] == encoding) return pGlyph + 2;
+		pGlyph += pGlyph[1];
+	}
+
+	return NULL;
+}
+
+/** offset of the font direction */
+static void addVector(int16_t &x, int16_t &y, int16_t dx, int16_t dy, uint8_t dir)
+{
+	switch (dir) {
+	case 0:	x += dx; y += dy; break;
+	case 1:	x -= dy; y += dx; break;
+	case 2:	x -= dx; y -= dy; break;
+	default: x += dy; y -= dx; break;
+	}
+}
+
+/** pixel by pixel, the background only in solid mode */
+static int8_t drawReferenceGlyph(U8G2 &ref, const uint8_t *pFont, int16_t penX, int16_t penY, uint8_t encoding, uint8_t dir, bool isTransparent, uint8_t color)
+{
+	const uint8_t *pGlyph = findGlyph(pFont, encoding);
+	GlyphReader reader;
+
+	if (pGlyph == NULL) return 0;
+
+	reader.pData = pGlyph;
+	reader.bitPos = 0;
+
+	uint8_t w = reader.getUnsigned(pFont[4]);
+	uint8_t h = reader.getUnsigned(pFont[5]);
+	int8_t x = reader.getSigned(pFont[6]);
+	int8_t y = reader.getSigned(pFont[7]);
+	int8_t d = reader.getSigned(pFont[8]);
+
+	if (w == 0) return d;
+
+	int16_t originX = penX;
+	int16_t originY = penY;
+	addVector(originX, originY, x, -(h + y), dir);
+
+	uint8_t lx = 0;
+	uint8_t ly = 0;
+
+	while (ly < h) {
+		uint8_t a = reader.getUnsigned(pFont[2]);
+		uint8_t b = reader.getUnsigned(pFont[3]);
+
+		do {
+			for (uint8_t run = 0; run < 2; run++) {
+				bool isForeground = (run == 1);
+
+				for (uint8_t n = isForeground ? b : a; n > 0; n--) {
+					if (isForeground || !isTransparent) {
+						int16_t px = originX;
+						int16_t py = originY;
+
+						addVector(px, py, lx, ly, dir);
+						ref.setDrawColor(isForeground ? color : (color == 0 ? 1 : 0));
+						ref.drawPixel((u8g2_uint_t)px, (u8g2_uint_t)py);
+					}
+					if (++lx == w) {
+						lx = 0;
+						ly++;
+					}
+				}
+			}
+		} while (reader.getUnsigned(1) != 0);
+	}
+
+	ref.setDrawColor(color);
+
+	return d;
+}
+
+static void drawReferenceStr(U8G2 &ref, int16_t x, int16_t y, const char *pText, uint8_t dir, bool isTransparent, uint8_t color)
+{
+	for (; *pText != '\0'; pText++) {
+		int8_t d = drawReferenceGlyph(ref, u8g2_font_helvR12_tr, x, y, (uint8_t)*pText, dir, isTransparent, color);
+		addVector(x, y, d, 0, dir);
+	}
+}
+
+/** a dirty background, so that the background pixels of solid mode and the xor of color 2 show */
+static void fillPattern(U8G2 &u8g2)
+{
+	uint8_t *pBuffer = u8g2.getBufferPtr();
+
+	for (uint16_t i = 0; i < BUFFER_SIZE; i++) pBuffer[i] = (uint8_t)(i * 0x9D + 0x35);
+}
+
+static void setupDisplay(U8G2 &u8g2, uint8_t rotation, uint8_t dir, bool isTransparent, uint8_t color)
+{
+	u8g2.setDisplayRotation(apRotation[rotation]);
+	u8g2.setFont(u8g2_font_helvR12_tr);
+	u8g2.setFontDirection(dir);
+	u8g2.setFontMode(isTransparent ? 1 : 0);
+	u8g2.setDrawColor(color);
+}
+
+/** pen positions which keep most glyphs inside but cut some at the border, by rotation and direction */
+static void penPosition(U8G2 &u8g2, uint8_t line, uint8_t dir, int16_t &x, int16_t &y)
+{
+	int16_t w = u8g2.getDisplayWidth();
+	int16_t h = u8g2.getDisplayHeight();
+
+	switch (dir) {
+	case 0:	x = (int16_t)(line * 7 % 23) - 3; y = (int16_t)(15 + line * 17 % (h - 10)); break;
+	case 1:	x = (int16_t)(w - 15 - line * 17 % (w - 10)); y = (int16_t)(line * 7 % 23) - 3; break;
+	case 2:	x = (int16_t)(w + 3 - line * 7 % 23); y = (int16_t)(h - 15 - line * 17 % (h - 10)); break;
+	default: x = (int16_t)(15 + line * 17 % (w - 10)); y = (int16_t)(h + 3 - line * 7 % 23); break;
+	}
+}
+
+static void drawAll(U8G2 &u8g2, uint8_t dir)
+{
+	for (uint8_t line = 0; line < sizeof(apText) / sizeof(apText[0]); line++) {
+		int16_t x, y;
+
+		penPosition(u8g2, line, dir, x, y);
+		u8g2.drawStr((u8g2_uint_t)x, (u8g2_uint_t)y, apText[line]);
+	}
+}
+
+static void drawAllReference(U8G2 &ref, uint8_t dir, bool isTransparent, uint8_t color)
+{
+	for (uint8_t line = 0; line < sizeof(apText) / sizeof(apText[0]); line++) {
+		int16_t x, y;
+
+		penPosition(ref, line, dir, x, y);
+		drawReferenceStr(ref, x, y, apText[line], dir, isTransparent, color);
+	}
+}
+
+static void testFullBuffer(U8G2 &u8g2, U8G2 &ref)
+{
+	uint32_t mismatches = 0;
+
+	for (uint8_t rotation = 0; rotation < 4; rotation++) {
+		for (uint8_t dir = 0; dir < 4; dir++) {
+			for (uint8_t mode = 0; mode < 2; mode++) {
+				for (uint8_t color = 0; color < 3; color++) {
+					for (uint8_t clip = 0; clip < 2; clip++) {
+						setupDisplay(u8g2, rotation, dir, mode != 0, color);
+						setupDisplay(ref, rotation, dir, mode != 0, color);
+						if (clip) {
+							/** the glyphs are cut on all four edges of the window */
+							u8g2_uint_t x1 = (u8g2_uint_t)(u8g2.getDisplayWidth() * 2 / 3);
+							u8g2_uint_t y1 = (u8g2_uint_t)(u8g2.getDisplayHeight() * 2 / 3);
+							u8g2.setClipWindow(5, 6, x1, y1);
+							ref.setClipWindow(5, 6, x1, y1);
+						} else {
+							u8g2.setMaxClipWindow();
+							ref.setMaxClipWindow();
+						}
+
+						fillPattern(ref);
+						drawAllReference(ref, dir, mode != 0, color);
+
+						/** cold cache, then the same frame from the warm cache */
+						u8g2_ClearGlyphCache(u8g2.getU8g2());
+						for (uint8_t pass = 0; pass < 2; pass++) {
+							fillPattern(u8g2);
+							drawAll(u8g2, dir);
+							if (memcmp(u8g2.getBufferPtr(), ref.getBufferPtr(), BUFFER_SIZE) != 0) {
+								printf("R%u dir %u mode %u color %u clip %u pass %u differs\n", rotation, dir, mode, color, clip, pass);
+								mismatches++;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	CHECK_EQ(mismatches, 0);
+	u8g2.setMaxClipWindow();
+	ref.setMaxClipWindow();
+}
+
+/** the glyphs straddle the pages, each page has to match its rows of the full buffer */
+static void testPageBuffer(U8G2 &page, U8G2 &ref)
+{
+	uint32_t mismatches = 0;
+	uint32_t pages = 0;
+
+	for (uint8_t rotation = 0; rotation < 4; rotation++) {
+		for (uint8_t mode = 0; mode < 2; mode++) {
+			setupDisplay(page, rotation, 0, mode != 0, 1);
+			setupDisplay(ref, rotation, 0, mode != 0, 1);
+
+			ref.clearBuffer();
+			drawAllReference(ref, 0, mode != 0, 1);
+
+			page.firstPage();
+			do {
+				u8g2_t *pU8g2 = page.getU8g2();
+				uint16_t len = (uint16_t)pU8g2->tile_buf_height * page.getBufferTileWidth() * 8;
+				uint16_t offset = (uint16_t)pU8g2->tile_curr_row * page.getBufferTileWidth() * 8;
+
+				drawAll(page, 0);
+				if (memcmp(page.getBufferPtr(), ref.getBufferPtr() + offset, len) != 0) mismatches++;
+				pages++;
+			} while (page.nextPage());
+		}
+	}
+
+	printf("page buffer: %u pages\n", pages);
+	CHECK_EQ(pages, 4 * 2 * 8);
+	CHECK_EQ(mismatches, 0);
+}
+
+int main()
+{
+	U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI u8g2(U8G2_R0, CS_PIN, DC_PIN, U8X8_PIN_NONE);
+	U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI ref(U8G2_R0, CS_PIN, DC_PIN, U8X8_PIN_NONE);
+	U8G2_SSD1322_NHD_256X64_1_4W_HW_SPI page(U8G2_R0, CS_PIN, DC_PIN, U8X8_PIN_NONE);
+	HostSsd1322 panel(CS_PIN, DC_PIN);
+
+	SPI.attach(&panel);
+	u8g2.begin();
+	ref.begin();
+	page.begin();
+
+	testFullBuffer(u8g2, ref);
+	testPageBuffer(page, ref);
+
+	SPI.attach(NULL);
+
+	return HOST_TEST_RESULT();
+}
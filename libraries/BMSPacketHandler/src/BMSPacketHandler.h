@@ -26,8 +26,13 @@
 
 #if defined(ARDUINO) && ARDUINO >= 100
 	#include "arduino.h"
-#else
+#elif defined(ARDUINO)
 	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+	class HardwareSerial;
 #endif
 
 #if defined (__STDC__)
@@ -38,10 +43,29 @@
 #endif
 
 #include <string>
+#include <SerialFrameDecoder.h>
 #include "BMSSerialPacket.h"
 
 #define BMS_MAX_BUFFER_LEN (uint8_t)40
 
+/** xiaoxiang BMS frame: 0xDD, register, status, length, payload, two's complement sum (MSB first), 0x77 */
+struct BMSFrameTraits {
+	static const uint8_t header = 0xDD;
+	static const uint8_t suffix = 0x77;
+	static const uint8_t preambleLength = 2;
+	static const bool hasLengthField = true;
+	static const uint8_t payloadLength = sizeof(BMS_PACKET_STRUCT_T) - 7;
+	typedef TwosComplementSum16 Checksum;
+
+	/** preamble is register and status, status 0x00 means no error */
+	static bool isPreambleValid(const uint8_t *preamble) { return preamble[1] == 0x00; }
+};
+
+typedef SerialFrameDecoder<BMSFrameTraits, BMS_PACKET_STRUCT_T> BMSFrameDecoder;
+
+/** callback for every complete and validated info status frame, the pointer is only valid during the call */
+typedef void (*BMS_INFO_STATUS_CALLBACK_T)(const BMS_INFO_STATUS_READ_STRUCT_T *tInfoStatus);
+
 typedef __PACKED_PRE enum BMS_ERROR_Etag {
 	ERR_BMS_OK,								//!< 0x00
 	ERR_BMS_CHECKSUM,						//!< 0x01
@@ -55,28 +79,27 @@ class BMSPacketHandler
 {
  public:
 
-	 typedef __PACKED_PRE enum SERIAL_BMS_PROCESS_STATEtag {
-		 SP_STATE_READ_HEADER,
-		 SP_STATE_READ_REGISTER,
-		 SP_STATE_CHECK_ERROR,
-		 SP_STATE_READ_PAYLOAD_LENGTH,
-		 SP_STATE_READ_PAYLOAD,
-		 SP_STATE_MSB_CHECKSUM,
-		 SP_STATE_LSB_CHECKSUM,
-		 SP_STATE_READ_SUFFIX,
-	 } __PACKED_POST SERIAL_BMS_PROCESS_STATE_t;
-
 	 BMSPacketHandler();
 	 BMSPacketHandler(HardwareSerial *port);
 	 virtual ~BMSPacketHandler();
 	 
 	 uint8_t setSerialPacket(BMS_PACKET_STRUCT_T *tSerialWritePacket, uint8_t mode, uint8_t cmdID, uint8_t len, uint8_t * val);
+#if defined(ARDUINO)
 	 void sendSerialPacket(BMS_PACKET_STRUCT_T *tSerialWritePacket, uint8_t len);
 	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket);
-	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket, uint8_t *data, uint8_t len);
-	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket, std::string data);
-	 void bmsReadInfoStatus(uint8_t *pData, uint8_t len);
-	 bool bmsReadInfoStatus(BMS_PACKET_STRUCT_T *tPacket, uint8_t *pData, uint8_t len);
+#endif
+	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket, const uint8_t *data, size_t len);
+	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket, const std::string &data);
+	 BMS_ERROR_E readSerialPacket(BMS_PACKET_STRUCT_T *tSerialReadPacket, ByteSpan data);
+	 void setInfoStatusCallback(BMS_INFO_STATUS_CALLBACK_T callback);
+	 uint8_t bmsReadInfoStatus(const uint8_t *pData, size_t len);
+	 bool bmsReadInfoStatus(BMS_PACKET_STRUCT_T *tPacket, const uint8_t *pData, size_t len);
+	 BMS_ERROR_E parseByte(uint8_t data);
+	 void resetParser();
+
+	 uint32_t getFrameCount() const { return _rxDecoder.getFrameCount() + _inPlaceFrameCount; }
+	 uint32_t getInPlaceFrameCount() const { return _inPlaceFrameCount; }
+	 uint32_t getErrorCount() const { return _rxDecoder.getErrorCount(); }
 
 private:
 	friend class BLEClient;
@@ -85,11 +108,11 @@ private:
 
 	HardwareSerial *_serPort;
 
-	const uint8_t bmsHeader = 0xDD;
-	const uint8_t bmsSuffix = 0x77;
-	bool blPacket2Parse;
-	uint8_t lastPacketLength = 0;
-	uint8_t abBMSReadPacket[BMS_MAX_BUFFER_LEN];
+	/** incremental parser state, kept across calls so a frame may be split into any number of fragments */
+	BMS_PACKET_STRUCT_T _rxPacket;
+	BMSFrameDecoder _rxDecoder;
+	BMS_INFO_STATUS_CALLBACK_T _infoStatusCallback;
+	uint32_t _inPlaceFrameCount;
 };
 
 #endif
@@ -26,8 +26,13 @@
 
 #if defined(ARDUINO) && ARDUINO >= 100
 	#include "arduino.h"
-#else
+#elif defined(ARDUINO)
 	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+	class HardwareSerial;
 #endif
 
 #if defined (__STDC__)
@@ -38,10 +43,25 @@
 #endif
 
 #include <string>
+#include <SerialFrameDecoder.h>
 #include "ControllerSerialPacket.h"
 
 #define CONTROLLER_MAX_BUFFER_LEN (uint8_t)40
 
+/** motor controller frame: 0xAA, 10 byte payload, 0x85, no checksum */
+struct ControllerFrameTraits {
+	static const uint8_t header = 0xAA;
+	static const uint8_t suffix = 0x85;
+	static const uint8_t preambleLength = 0;
+	static const bool hasLengthField = false;
+	static const uint8_t payloadLength = 10;
+	typedef NoChecksum Checksum;
+
+	static bool isPreambleValid(const uint8_t *) { return true; }
+};
+
+typedef SerialFrameDecoder<ControllerFrameTraits, CONTROLLER_PACKET_STRUCT_T> ControllerFrameDecoder;
+
 typedef __PACKED_PRE enum CONTROLLER_ERROR_Etag {
 	ERR_CONTROLLER_OK,								//!< 0x00
 	ERR_CONTROLLER_CHECKSUM,						//!< 0x01
@@ -55,21 +75,22 @@ class ControllerPacketHandler
 {
  public:
 
-	 typedef __PACKED_PRE enum SERIAL_PROCESS_STATEtag {
-		 SP_STATE_READ_HEADER,
-		 SP_STATE_READ_PAYLOAD,
-		 SP_STATE_READ_SUFFIX,
-	 } __PACKED_POST SERIAL_CONTROLLER_PROCESS_STATE_t;
-
 	 ControllerPacketHandler();
 	 ControllerPacketHandler(HardwareSerial *port);
 	 virtual ~ControllerPacketHandler();
 	 
+#if defined(ARDUINO)
 	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket);
-	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket, uint8_t *data, uint8_t len);
-	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket, std::string data);
-	 void readParsePacket(uint8_t *pData, uint8_t len);
-	 bool readParsePacket(CONTROLLER_PACKET_STRUCT_T *readPacket, uint8_t *pData, uint8_t len);
+#endif
+	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket, const uint8_t *data, size_t len);
+	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket, const std::string &data);
+	 CONTROLLER_ERROR_E readSerialPacket(CONTROLLER_PACKET_STRUCT_T *tSerialReadPacket, ByteSpan data);
+	 void readParsePacket(const uint8_t *pData, size_t len);
+	 bool readParsePacket(CONTROLLER_PACKET_STRUCT_T *readPacket, const uint8_t *pData, size_t len);
+	 void resetParser();
+
+	 uint32_t getFrameCount() const { return _rxDecoder.getFrameCount(); }
+	 uint32_t getErrorCount() const { return _rxDecoder.getErrorCount(); }
 
 private:
 	friend class BLEClient;
@@ -78,11 +99,9 @@ private:
 
 	HardwareSerial *_serPort;
 
-	const uint8_t controllerHeader = 0xAA;
-	const uint8_t controllerSuffix = 0x85;
-	bool blPacket2Parse;
-	uint8_t abControllerReadPacket[CONTROLLER_MAX_BUFFER_LEN];
-	uint8_t lastPacketLength = 0;
+	/** incremental parser state, kept across calls so a frame may be split into any number of fragments */
+	CONTROLLER_PACKET_STRUCT_T _rxPacket;
+	ControllerFrameDecoder _rxDecoder;
 };
 
 #endif
@@ -0,0 +1,189 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			damage_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the incremental rendering and the damage mask of DisplayScene
+* @details		Every frame the buffer rendered by the scene has to match a full redraw of the same content, and every
+*				tile that differs from the frame sent before has to be in the damage mask, in all four rotations. The text
+*				widgets use the synthetic stand-in of u8g2_font_helvR12_tr of the host build.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <DisplayScene.h>
+#include "HostTest.h"
+
+#define FRAMES				200
+
+/** the buffer of the 256x64 panel, 8 tile rows of 32 tiles */
+#define TILE_ROWS			8
+#define TILE_COLUMNS		32
+#define BUFFER_LEN			(TILE_ROWS * TILE_COLUMNS * 8)
+
+static const uint8_t abIconFrame[] = { 0xFF, 0x81, 0x81, 0xFF, 0xFF, 0x81, 0x81, 0xFF };
+static const uint8_t abIconCross[] = { 0x18, 0x18, 0xFF, 0xFF, 0x18, 0x18, 0xFF, 0xFF };
+
+typedef U8G2_SSD1322_NHD_256X64_F_4W_HW_SPI DISPLAY_T;
+
+/** every changed tile has to be damaged, returns the number of damaged tiles */
+static uint32_t checkDamage(const uint8_t *pPrevious, const uint8_t *pBuffer, const uint32_t *pulDamage, uint32_t &missed)
+{
+	uint32_t tiles = 0;
+
+	for (uint8_t row = 0; row < TILE_ROWS; row++) {
+		for (uint8_t col = 0; col < TILE_COLUMNS; col++) {
+			uint16_t offset = ((uint16_t)row * TILE_COLUMNS + col) * 8;
+			bool isChanged = memcmp(&pPrevious[offset], &pBuffer[offset], 8) != 0;
+			bool isDamaged = (pulDamage[row] >> col) & 1;
+
+			if (isChanged && !isDamaged) missed++;
+			if (isDamaged) tiles++;
+		}
+	}
+
+	return tiles;
+}
+
+static void testIcons(const char *name, const u8g2_cb_t *pRotation)
+{
+	DISPLAY_T u8g2(pRotation, U8X8_PIN_NONE, U8X8_PIN_NONE);
+	DISPLAY_T full(pRotation, U8X8_PIN_NONE, U8X8_PIN_NONE);
+	DisplayScene scene(u8g2);
+	IconWidget a(0, 4, 16, 16), b(20, 100, 24, 8), c(40, 200, 24, 40), d(34, 145, 30, 30);
+	uint8_t abPrevious[BUFFER_LEN];
+	uint32_t aulDamage[TILE_ROWS];
+	uint32_t tiles = 0, missed = 0, mismatches = 0;
+
+	scene.add(a);
+	scene.add(b);
+	scene.add(c);
+	scene.add(d);
+	memset(abPrevious, 0, sizeof(abPrevious));
+
+	for (uint16_t f = 0; f < FRAMES; f++) {
+		const uint8_t *pA = (f % 3) ? abIconFrame : abIconCross;
+		const uint8_t *pB = (f % 5) ? abIconCross : abIconFrame;
+		const uint8_t *pC = (f % 7) ? abIconFrame : abIconCross;
+		const uint8_t *pD = (f & 1) ? abIconFrame : abIconCross;
+
+		a.setIcon(8, 8, pA);
+		b.setIcon(8, 8, pB);
+		c.setIcon(8, 8, pC);
+		d.setIcon(8, 8, pD);
+		scene.render();
+		CHECK_EQ(scene.takeDamage(aulDamage, TILE_ROWS), TILE_ROWS);
+
+		full.clearBuffer();
+		full.drawXBMP(0, 4, 8, 8, pA);
+		full.drawXBMP(20, 100, 8, 8, pB);
+		full.drawXBMP(40, 200, 8, 8, pC);
+		full.drawXBMP(34, 145, 8, 8, pD);
+
+		if (memcmp(u8g2.getBufferPtr(), full.getBufferPtr(), BUFFER_LEN) != 0) mismatches++;
+		tiles += checkDamage(abPrevious, u8g2.getBufferPtr(), aulDamage, missed);
+		memcpy(abPrevious, u8g2.getBufferPtr(), BUFFER_LEN);
+	}
+
+	printf("%s: %.1f of %u tiles per frame\n", name, (double)tiles / FRAMES, TILE_ROWS * TILE_COLUMNS);
+
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(missed, 0);
+	CHECK(tiles < (uint32_t)FRAMES * TILE_ROWS * TILE_COLUMNS / 4);
+}
+
+/** numbers getting shorter and longer, the old digits have to be cleared */
+static void testText(const char *name, const u8g2_cb_t *pRotation)
+{
+	DISPLAY_T u8g2(pRotation, U8X8_PIN_NONE, U8X8_PIN_NONE);
+	DISPLAY_T full(pRotation, U8X8_PIN_NONE, U8X8_PIN_NONE);
+	DisplayScene scene(u8g2);
+	TextWidget label(0, 16, 0, u8g2_font_helvR12_tr, "Vbms: ");
+	NumberWidget fixed(0, 32, 50, u8g2_font_helvR12_tr, "%.2f");
+	NumberWidget free(2, 52, 0, u8g2_font_helvR12_tr, "%d");
+	uint8_t abPrevious[BUFFER_LEN];
+	uint32_t aulDamage[TILE_ROWS];
+	uint32_t missed = 0, mismatches = 0;
+	char acFixed[16], acFree[16];
+
+	scene.add(label);
+	scene.add(fixed);
+	scene.add(free);
+	memset(abPrevious, 0, sizeof(abPrevious));
+
+	for (uint16_t f = 0; f < FRAMES; f++) {
+		int32_t value = (f % 4 == 0) ? 7 : (int32_t)(f * 37 % 100000);
+
+		fixed.setValue(38.0 + (f % 40) * 0.05);
+		free.setValue(value);
+		scene.render();
+		scene.takeDamage(aulDamage, TILE_ROWS);
+
+		snprintf(acFixed, sizeof(acFixed), "%.2f", 38.0 + (f % 40) * 0.05);
+		snprintf(acFree, sizeof(acFree), "%d", (int)value);
+		full.clearBuffer();
+		full.setFont(u8g2_font_helvR12_tr);
+		full.drawStr(0, 16, "Vbms: ");
+		full.drawStr(0, 32, acFixed);
+		full.drawStr(2, 52, acFree);
+
+		if (memcmp(u8g2.getBufferPtr(), full.getBufferPtr(), BUFFER_LEN) != 0) mismatches++;
+		checkDamage(abPrevious, u8g2.getBufferPtr(), aulDamage, missed);
+		memcpy(abPrevious, u8g2.getBufferPtr(), BUFFER_LEN);
+	}
+
+	printf("%s: text frames checked\n", name);
+
+	CHECK_EQ(mismatches, 0);
+	CHECK_EQ(missed, 0);
+}
+
+/** after invalidate() the whole panel is sent once, an unchanged frame sends nothing */
+static void testInvalidate()
+{
+	DISPLAY_T u8g2(U8G2_R1, U8X8_PIN_NONE, U8X8_PIN_NONE);
+	DisplayScene scene(u8g2);
+	IconWidget icon(0, 0, 8, 8);
+	uint32_t aulDamage[TILE_ROWS];
+
+	scene.add(icon);
+	icon.setIcon(8, 8, abIconFrame);
+	CHECK(scene.render());
+	scene.takeDamage(aulDamage, TILE_ROWS);
+
+	CHECK(!scene.render());
+	CHECK_EQ(scene.getDamagedTiles(), 0);
+
+	icon.setIcon(8, 8, abIconFrame);
+	CHECK(!scene.render());
+
+	scene.invalidate();
+	CHECK(scene.render());
+	CHECK_EQ(scene.getDamagedTiles(), TILE_ROWS * TILE_COLUMNS);
+	scene.takeDamage(aulDamage, TILE_ROWS);
+	for (uint8_t row = 0; row < TILE_ROWS; row++) CHECK_EQ(aulDamage[row], 0xFFFFFFFF);
+}
+
+int main()
+{
+	testIcons("R0", U8G2_R0);
+	testIcons("R1", U8G2_R1);
+	testIcons("R2", U8G2_R2);
+	testIcons("R3", U8G2_R3);
+	testText("R0", U8G2_R0);
+	testText("R1", U8G2_R1);
+	testInvalidate();
+
+	return HOST_TEST_RESULT();
+}
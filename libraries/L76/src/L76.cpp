@@ -11,6 +11,11 @@ boolean I2CGPS::begin(TwoWire &wirePort, uint32_t i2cSpeed, uint8_t sdapin, uint
 
 	_head = 0; //Reset the location holder
 	_tail = 0;
+	_lastByte = 0;
+
+	_busTimeUs = 0;
+	_bytesRead = 0;
+	_readCount = 0;
 
 	//Ping the module to see if it responds
 	_i2cPort->beginTransmission(L76_ADDR);
@@ -24,31 +29,42 @@ boolean I2CGPS::begin(TwoWire &wirePort, uint32_t i2cSpeed, uint8_t sdapin, uint
 }
 
 //Polls the GPS module to see if new data is available
-//Reads a 255 byte packet from GPS module
-//If new data is there, appends it to the gpsData array
-//Function requires 26ms @ 100kHz I2C, 9ms @ 400kHz I2C so call sparingly
+//Reads chunks of L76_READ_CHUNK bytes until the module sends its idle filler (a line feed which
+//does not end a sentence) or the gpsData array is full, new data is appended to the gpsData array
+//An idle poll takes one chunk, <1ms @ 400kHz I2C, a full 255 byte packet took 26ms @ 100kHz I2C
 void I2CGPS::check()
 {
-	//TODO: Re-write this function to be less tied to Arduino's 32 byte limit
-	//Maybe pass a maxRead during .begin()
-
-	for (uint8_t x = 0; x < MAX_PACKET_SIZE; x++)
+	for (uint8_t chunk = 0; chunk < L76_MAX_CHUNKS; chunk++)
 	{
-		if (x % 32 == 0) //Arduino can only Wire.read() in 32 byte chunks. Yay.
-			_i2cPort->requestFrom(L76_ADDR, 32); //Request 32 more bytes
+		//Bytes which don't fit stay in the module until the next poll
+		if (MAX_PACKET_SIZE - 1 - count() < L76_READ_CHUNK) break;
 
-		uint8_t incoming = _i2cPort->read();
-		if (incoming != 0x0A)
-		{
-			//Record this byte
-			gpsData[_head++] = incoming;
-			_head %= MAX_PACKET_SIZE; //Wrap variable
+		uint32_t startUs = micros();
+		uint8_t received = _i2cPort->requestFrom(L76_ADDR, L76_READ_CHUNK);
+		_busTimeUs += micros() - startUs;
+		_bytesRead += received;
+		_readCount++;
 
-			if (_printDebug == true && _head == _tail)
-				_debugSerial->println(F("Buffer overrun"));
+		boolean isIdle = (received == 0);
+
+		for (uint8_t x = 0; x < received; x++)
+		{
+			uint8_t incoming = _i2cPort->read();
+			if (incoming != L76_IDLE_FILLER)
+			{
+				//Record this byte
+				gpsData[_head++] = incoming;
+				_head %= MAX_PACKET_SIZE; //Wrap variable
+			}
+			else if (_lastByte != '\r')
+			{
+				isIdle = true; //Module buffer is empty, the rest of the chunk is filler
+			}
+			_lastByte = incoming;
 		}
-	}
 
+		if (isIdle) break;
+	}
 }
 
 //Returns # of available bytes that can be read
@@ -61,6 +77,12 @@ uint8_t I2CGPS::available()
 		check(); //Check to module to see if new I2C bytes are available
 	}
 
+	return (count());
+}
+
+//Returns # of bytes in the gpsData array
+uint8_t I2CGPS::count()
+{
 	//Return new data count
 	if (_head > _tail) return (_head - _tail);
 	if (_tail > _head) return (MAX_PACKET_SIZE - _tail + _head);
@@ -81,6 +103,27 @@ uint8_t I2CGPS::read(void)
 		return (0); //No new data
 }
 
+//Copies up to len available bytes from the gpsData array into buffer
+//Returns the number of bytes copied, does not poll the module
+uint8_t I2CGPS::read(char *buffer, uint8_t len)
+{
+	uint8_t copied = 0;
+
+	while (copied < len && _tail != _head)
+	{
+		//Contiguous part up to the head or the end of the array
+		uint8_t run = (_head > _tail) ? (_head - _tail) : (MAX_PACKET_SIZE - _tail);
+		if (run > len - copied) run = len - copied;
+
+		memcpy(buffer + copied, &gpsData[_tail], run);
+		copied += run;
+		_tail += run;
+		if (_tail == MAX_PACKET_SIZE) _tail = 0; //Wrap variable
+	}
+
+	return (copied);
+}
+
 //Enables serial printing of local error messages
 void I2CGPS::enableDebugging(Stream &debugPort)
 {
@@ -113,32 +156,51 @@ boolean I2CGPS::sendMTKpacket(String command)
 	}
 
 	//Arduino can only Wire.write() in 32 byte chunks. Yay.
-	for (uint8_t chunk = 0; chunk < 7; chunk++) //8 chunks * 32 = 256 bytes total so we need to shave one
+	//Only the chunks of the command are sent, a short command does not wait for empty chunks
+	for (uint16_t offset = 0; offset < command.length(); offset += 32)
 	{
 		_i2cPort->beginTransmission(L76_ADDR);
-		for (uint8_t x = 0; x < 32; x++) //Send out 32 bytes
+		for (uint16_t x = offset; x < offset + 32 && x < command.length(); x++) //Send out up to 32 bytes
 		{
-			if ((chunk * 32 + x) == command.length()) break; //We're done!
-			_i2cPort->write(command[(chunk * 32) + x]);
+			_i2cPort->write(command[x]);
 		}
 		_i2cPort->endTransmission();
 
 		delay(10); //Slave requires 10 ms to process incoming bytes
 	}
 
-	//Send final 31 bytes
-	if (command.length() > (7 * 32)) //Do we have more than 224 bytes? Then send last 31
+	return(true);
+}
+
+//Select the NMEA sentences the module outputs: RMC and GGA every n-th fix (0 = off), all others off
+//Less output means less data to read over I2C
+boolean I2CGPS::setNmeaOutput(uint8_t rmcRate, uint8_t ggaRate)
+{
+	//GLL, RMC, VTG, GGA, GSA, GSV, 12 reserved, MCHN
+	String dataField = ",0,";
+	dataField += rmcRate;
+	dataField += ",0,";
+	dataField += ggaRate;
+	dataField += ",0,0,0,0,0,0,0,0,0,0,0,0,0,0,0";
+
+	return (sendMTKpacket(createMTKpacket(314, dataField)));
+}
+
+//Set the position fix interval of the module, 100ms (10Hz) to 10000ms
+boolean I2CGPS::setFixInterval(uint16_t intervalMs)
+{
+	if (intervalMs < 100 || intervalMs > 10000)
 	{
-		_i2cPort->beginTransmission(L76_ADDR);
-		for (uint8_t x = 0; x < 31; x++) //Write any remaining bytes up to 255
-		{
-			if ((7 * 32 + x) == command.length()) break; //We're done!
-			_i2cPort->write(command[(7 * 32) + x]);
-		}
-		_i2cPort->endTransmission();
+		if (_printDebug == true)
+			_debugSerial->println(F("Fix interval out of range!"));
+
+		return (false);
 	}
 
-	return(true);
+	String dataField = ",";
+	dataField += intervalMs;
+
+	return (sendMTKpacket(createMTKpacket(220, dataField)));
 }
 
 //Given a packetType and any settings, return string that is a full
@@ -186,8 +248,9 @@ String I2CGPS::calcCRCforMTK(String sentence)
 		crc ^= sentence[x]; //XOR this byte with all the others
 
 	String output = "";
-	if (crc < 10) output += "0"; //Append leading zero if needed
+	if (crc < 0x10) output += "0"; //Append leading zero if needed
 	output += String(crc, HEX);
+	output.toUpperCase(); //NMEA checksums are upper case hex
 
 	return (output);
 }
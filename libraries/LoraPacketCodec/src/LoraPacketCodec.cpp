@@ -0,0 +1,320 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			LoraPacketCodec.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		key/delta frame encoder and reference decoder for the 29 byte lora data packet
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <string.h>
+#include <math.h>
+#include "LoraPacketCodec.h"
+
+typedef enum FIELD_KIND_Etag {
+	KIND_BYTE,								// raw byte, sent unchanged
+	KIND_UINT,								// big endian integer, zigzag varint delta
+	KIND_FLOAT,								// big endian float, zigzag varint delta of the scaled value
+} FIELD_KIND_E;
+
+typedef struct FIELD_Ttag {
+	uint8_t		bOffset;					// offset in LORA_DATA_PACKET_T
+	uint8_t		bSize;
+	uint8_t		bKind;
+	int32_t		lScale;						// fixed point scale of a float field
+} FIELD_T;
+
+/* layout of LORA_DATA_STRUCT_T, in LORA_CODEC_FIELD_E order */
+static const FIELD_T fields[LORA_FIELD_MAX] = {
+	{ 0,	4,	KIND_FLOAT,	1000000 },		// ulGpsLatitude
+	{ 4,	4,	KIND_FLOAT,	1000000 },		// ulGpsLongitude
+	{ 16,	1,	KIND_BYTE,	0 },			// bControllerSpeedKmh
+	{ 23,	1,	KIND_BYTE,	0 },			// bHeartyBpm
+	{ 12,	2,	KIND_UINT,	0 },			// usBmsTotalVoltage
+	{ 14,	2,	KIND_UINT,	0 },			// usControllerTotalVoltage
+	{ 8,	4,	KIND_FLOAT,	10 },			// ulGpsAltitude
+	{ 17,	2,	KIND_UINT,	0 },			// usControllerTotalDistance
+	{ 19,	4,	KIND_UINT,	0 },			// ulRtcTimeOfStartSession
+	{ 24,	1,	KIND_BYTE,	0 },			// bMpuFlags
+	{ 25,	4,	KIND_UINT,	0 },			// ulMpuCrashTime
+};
+
+static uint32_t readBigEndian(const uint8_t *p, uint8_t size)
+{
+	uint32_t value = 0;
+	for (uint8_t i = 0; i < size; i++) value = (value << 8) | p[i];
+	return value;
+}
+
+static void writeBigEndian(uint8_t *p, uint8_t size, uint32_t value)
+{
+	for (uint8_t i = size; i > 0; i--) {
+		p[i - 1] = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+size_t LoraPacketCodec::writeVarint(uint8_t *p, uint32_t value)
+{
+	size_t len = 0;
+	while (value >= 0x80) {
+		p[len++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	p[len++] = (uint8_t)value;
+	return len;
+}
+
+bool LoraPacketCodec::readVarint(const uint8_t *p, size_t len, size_t &idx, uint32_t &value)
+{
+	value = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7) {
+		if (idx >= len) return false;
+		uint8_t data = p[idx++];
+		value |= (uint32_t)(data & 0x7F) << shift;
+		if (!(data & 0x80)) return true;
+	}
+	return false;
+}
+
+LoraPacketCodec::LoraPacketCodec(uint8_t keyInterval)
+{
+	_keyInterval = keyInterval ? keyInterval : 1;
+	_frameCount = 0;
+	_encodedBytes = 0;
+	reset();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		make the next frame a key frame, e.g. after a join, a lost link or an uplink of another format
+* @retval		none
+*/
+/************************************************************************************************************************/
+void LoraPacketCodec::reset()
+{
+	_keyOffset = 0;
+	_isKeyValid = false;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		count an uplink of another format (batch or backlog frame), it advances the frame counter between the
+*				key frame and the next delta frame. The next frame is a key frame once the key interval is reached.
+* @retval		none
+*/
+/************************************************************************************************************************/
+void LoraPacketCodec::skip()
+{
+	if (_isKeyValid && _keyOffset < 0xFF) _keyOffset++;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the value of a field as integer, floats are scaled to their fixed point unit
+* @param[in]	pPacket					pointer to the packet
+* @param[in]	field					field index
+* @param[out]	value					value of the field
+* @retval		false if a float is not representable in fixed point
+*/
+/************************************************************************************************************************/
+bool LoraPacketCodec::fieldValue(const uint8_t *pPacket, uint8_t field, int32_t &value)
+{
+	const FIELD_T *pField = &fields[field];
+	uint32_t raw = readBigEndian(&pPacket[pField->bOffset], pField->bSize);
+
+	if (pField->bKind != KIND_FLOAT) {
+		value = (int32_t)raw;
+		return true;
+	}
+
+	float fValue;
+	memcpy(&fValue, &raw, sizeof(fValue));
+
+	double scaled = (double)fValue * pField->lScale;
+	if (!(scaled > -2.0e9 && scaled < 2.0e9)) return false;
+
+	value = (int32_t)lround(scaled);
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		encode a packet as key or delta frame, a delta frame which is not smaller than the packet is sent as
+*				key frame
+* @param[in]	pPacket					pointer to the packet, LORA_CODEC_PACKET_LEN bytes
+* @param[out]	pFrame					pointer to the frame, at least LORA_CODEC_PACKET_LEN bytes
+* @param[out]	isKeyFrame				true for a key frame (port LORA_CODEC_PORT_KEY), else LORA_CODEC_PORT_DELTA
+* @retval		frame length
+*/
+/************************************************************************************************************************/
+size_t LoraPacketCodec::encode(const uint8_t *pPacket, uint8_t *pFrame, bool &isKeyFrame)
+{
+	uint8_t abValues[LORA_FIELD_MAX * 5];
+	size_t valueLen = 0;
+	size_t len = 0;
+	uint32_t mask = 0;
+	int32_t value, keyValue;
+
+	isKeyFrame = !_isKeyValid || (_keyOffset + 1 >= _keyInterval);
+
+	for (uint8_t field = 0; field < LORA_FIELD_MAX && !isKeyFrame; field++) {
+		const FIELD_T *pField = &fields[field];
+
+		if (!fieldValue(pPacket, field, value) || !fieldValue(_abKey, field, keyValue)) {
+			isKeyFrame = true;
+			break;
+		}
+		if (value == keyValue) continue;
+
+		mask |= 1UL << field;
+		if (pField->bKind == KIND_BYTE) abValues[valueLen++] = pPacket[pField->bOffset];
+		else valueLen += writeVarint(&abValues[valueLen], zigzag((int32_t)((uint32_t)value - (uint32_t)keyValue)));
+	}
+
+	if (!isKeyFrame) {
+		pFrame[len++] = _keyOffset + 1;
+		len += writeVarint(&pFrame[len], mask);
+
+		if (len + valueLen >= LORA_CODEC_PACKET_LEN) isKeyFrame = true;
+	}
+
+	if (isKeyFrame) {
+		memcpy(_abKey, pPacket, LORA_CODEC_PACKET_LEN);
+		memcpy(pFrame, pPacket, LORA_CODEC_PACKET_LEN);
+		_keyOffset = 0;
+		_isKeyValid = true;
+		len = LORA_CODEC_PACKET_LEN;
+	}
+	else {
+		memcpy(&pFrame[len], abValues, valueLen);
+		len += valueLen;
+		_keyOffset++;
+	}
+
+	_frameCount++;
+	_encodedBytes += len;
+
+	return len;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		reference decoder of a delta frame
+* @param[in]	pKey					pointer to the key frame the delta refers to
+* @param[in]	pFrame					pointer to the delta frame
+* @param[in]	len						length of the delta frame
+* @param[out]	pPacket					pointer to the decoded packet, LORA_CODEC_PACKET_LEN bytes
+* @param[out]	pKeyOffset				number of uplinks since the key frame, may be nullptr
+* @retval		true if the frame is valid
+*/
+/************************************************************************************************************************/
+bool LoraPacketCodec::decodeDelta(const uint8_t *pKey, const uint8_t *pFrame, size_t len, uint8_t *pPacket, uint8_t *pKeyOffset)
+{
+	size_t idx = 1;
+	uint32_t mask, delta;
+	int32_t keyValue;
+
+	if (len < 2 || pFrame[0] == 0) return false;
+	if (!readVarint(pFrame, len, idx, mask) || (mask >> LORA_FIELD_MAX)) return false;
+
+	memcpy(pPacket, pKey, LORA_CODEC_PACKET_LEN);
+
+	for (uint8_t field = 0; field < LORA_FIELD_MAX; field++) {
+		const FIELD_T *pField = &fields[field];
+
+		if (!(mask & (1UL << field))) continue;
+
+		if (pField->bKind == KIND_BYTE) {
+			if (idx >= len) return false;
+			pPacket[pField->bOffset] = pFrame[idx++];
+			continue;
+		}
+
+		if (!readVarint(pFrame, len, idx, delta) || !fieldValue(pKey, field, keyValue)) return false;
+
+		uint32_t value = (uint32_t)keyValue + (uint32_t)unzigzag(delta);
+
+		if (pField->bKind == KIND_FLOAT) {
+			float fValue = (float)((double)(int32_t)value / pField->lScale);
+			memcpy(&value, &fValue, sizeof(value));
+		}
+		writeBigEndian(&pPacket[pField->bOffset], pField->bSize, value);
+	}
+
+	if (pKeyOffset != nullptr) *pKeyOffset = pFrame[0];
+
+	return idx == len;
+}
+
+LoraPacketBatch::LoraPacketBatch() : _codec(0xFF)
+{
+	begin(LORA_BATCH_MAX_LEN);
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		start a new batch
+* @param[in]	maxLength				largest frame length, e.g. the payload limit of the current data rate
+* @retval		none
+*/
+/************************************************************************************************************************/
+void LoraPacketBatch::begin(size_t maxLength)
+{
+	_codec.reset();
+	_maxLength = (maxLength < LORA_BATCH_MAX_LEN) ? maxLength : LORA_BATCH_MAX_LEN;
+	_length = LORA_BATCH_HEADER_LEN;
+	_count = 0;
+	_lastTime = 0;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add a sample to the batch, the batch is closed once a sample does not fit anymore
+* @param[in]	ulTime					sample time (epoch)
+* @param[in]	pPacket					pointer to the packet, LORA_CODEC_PACKET_LEN bytes
+* @retval		true if the sample has been added
+*/
+/************************************************************************************************************************/
+bool LoraPacketBatch::add(uint32_t ulTime, const uint8_t *pPacket)
+{
+	uint8_t abEntry[5 + 1 + LORA_CODEC_PACKET_LEN];
+	size_t len;
+	bool isKeyFrame;
+
+	if (_count == 0) {
+		for (uint8_t i = 0; i < LORA_BATCH_HEADER_LEN; i++) _abFrame[i] = (uint8_t)(ulTime >> (24 - 8 * i));
+		_lastTime = ulTime;
+	}
+
+	len = LoraPacketCodec::writeVarint(abEntry, LoraPacketCodec::zigzag((int32_t)(ulTime - _lastTime)));
+	size_t frameLen = _codec.encode(pPacket, &abEntry[len + 1], isKeyFrame);
+	abEntry[len++] = (uint8_t)frameLen;
+	len += frameLen;
+
+	if (_length + len > _maxLength) {
+		/** closed, the next batch starts with a new key frame */
+		_maxLength = _length;
+		return false;
+	}
+
+	memcpy(&_abFrame[_length], abEntry, len);
+	_length += len;
+	_lastTime = ulTime;
+	_count++;
+
+	return true;
+}
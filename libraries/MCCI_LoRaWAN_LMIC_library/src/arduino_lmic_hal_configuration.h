@@ -90,6 +90,18 @@ public:
 
 bool hal_init_with_pinmap(const HalPinmap_t *pPinmap);
 
+#if defined(ESP32)
+// task notified (xTaskNotifyGive) on every radio DIO interrupt, so it can
+// block instead of polling os_runloop_once(). nullptr disables the wakeup,
+// without LMIC_USE_INTERRUPTS the task is never notified.
+void hal_set_irq_task(void *pTask);
+
+// block the calling task until the next LMIC job is due, a radio interrupt
+// occurred or maxWaitMs passed. Call it without holding any lock the other
+// tasks need, the idle task (and light sleep, if enabled) runs meanwhile.
+void hal_waitForEvent(uint32_t maxWaitMs);
+#endif
+
 }; // end namespace Arduino_LMIC
 
 #endif
@@ -8,6 +8,10 @@
 #define HIGH_G 4
 #define EXTREME_G 7
 
+#define USER_CTRL_FIFO_EN	0x40
+#define USER_CTRL_FIFO_RST	0x04
+
+ImpactDetector* ImpactDetector::_isrInstance = NULL;
 
 float ImpactDetector::calcAbsAccel(AccelVector vec) {
 	return sqrt(
@@ -26,7 +30,7 @@ float ImpactDetector::calcAbsGravityForce(float absAccel) {
 }
 
 
-ImpactDetector::ImpactDetector() : MPU9250(Wire, 0x68)
+ImpactDetector::ImpactDetector() : MPU9250FIFO(Wire, 0x68)
 {
 	this->_tick = 0;
 	this->_impactAccel = 0.0f;
@@ -54,7 +58,7 @@ ImpactDetector::ImpactDetector() : MPU9250(Wire, 0x68)
 }
 
 ImpactDetector::ImpactDetector(int pollRate, int duration, float lowGThreshold, float highGThreshold, float extremeGThreshold)
-	: MPU9250(Wire, 0x68), _highGThreshold(highGThreshold), _extremeGThreshold(extremeGThreshold)
+	: MPU9250FIFO(Wire, 0x68), _highGThreshold(highGThreshold), _extremeGThreshold(extremeGThreshold)
 {
 	if (pollRate > 1000) {
 		this->_pollRate = 1000;
@@ -102,7 +106,7 @@ ImpactDetector::ImpactDetector(int pollRate, int duration, float lowGThreshold,
 }
 
 ImpactDetector::ImpactDetector(int pollRate, int duration, float lowGThreshold, float highGThreshold, float extremeGThreshold, uint8_t address, uint8_t sda, uint8_t scl)
-	: MPU9250(Wire, address, sda, scl), _highGThreshold(highGThreshold), _extremeGThreshold(extremeGThreshold)
+	: MPU9250FIFO(Wire, address, sda, scl), _highGThreshold(highGThreshold), _extremeGThreshold(extremeGThreshold)
 {
 	if (pollRate > 1000) {
 		this->_pollRate = 1000;
@@ -149,40 +153,225 @@ ImpactDetector::ImpactDetector(int pollRate, int duration, float lowGThreshold,
 	this->_curAbsGravityForce = 0.0f;
 }
 
+/* data ready interrupt of the MPU9250, wakes the notify task every _batchSamples samples */
+void IRAM_ATTR ImpactDetector::dataReadyIsr()
+{
+	ImpactDetector* imu = _isrInstance;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if ((imu == NULL) || (imu->_notifyTask == NULL)) {
+		return;
+	}
+
+	if (++imu->_pendingSamples >= imu->_batchSamples) {
+		imu->_pendingSamples = 0;
+		vTaskNotifyGiveFromISR(imu->_notifyTask, &xHigherPriorityTaskWoken);
+		if (xHigherPriorityTaskWoken == pdTRUE) {
+			portYIELD_FROM_ISR();
+		}
+	}
+}
+
+/*
+* sample accel and gyro into the FIFO at a fixed output data rate (1 kHz / (1 + srd))
+* and raise the data ready interrupt on intPin. The notify task is woken every batchSamples samples.
+*/
+int ImpactDetector::enableSampling(uint8_t intPin, uint16_t odrHz, uint8_t batchSamples)
+{
+	if ((odrHz < 4) || (odrHz > 1000)) {
+		return -1;
+	}
+
+	if (this->setSrd((uint8_t)(1000 / odrHz - 1)) < 0) {
+		return -2;
+	}
+
+	this->_odrHz = 1000 / (this->_srd + 1);
+	this->_samplePeriodUs = 1000000UL / this->_odrHz;
+	this->_batchSamples = (batchSamples == 0) ? 1 : batchSamples;
+
+	// accel and gyro only, magnetometer and temperature are not needed for the detection
+	if (this->enableFifo(true, true, false, false) < 0) {
+		return -3;
+	}
+
+	if (this->resetFifo() < 0) {
+		return -4;
+	}
+
+	if (this->enableDataReadyInterrupt() < 0) {
+		return -5;
+	}
+
+	_isrInstance = this;
+	_intPin = intPin;
+	pinMode(intPin, INPUT);
+	attachInterrupt(digitalPinToInterrupt(intPin), dataReadyIsr, RISING);
+	return 1;
+}
+
+/* task which is notified by the data ready interrupt */
+void ImpactDetector::setNotifyTask(TaskHandle_t task)
+{
+	this->_notifyTask = task;
+}
+
+/* handler which gets every raw FIFO sample, e.g. to record the samples around an impact */
+void ImpactDetector::setSampleHandler(ImpactSampleHandler handler)
+{
+	this->_sampleHandler = handler;
+}
+
+/* handler which gets every raw FIFO burst, e.g. to record the sensor input for a replay */
+void ImpactDetector::setFifoHandler(ImpactFifoHandler handler)
+{
+	this->_fifoHandler = handler;
+}
+
+/*
+* stop the sampling and switch to the low power wake on motion mode. The interrupt is latched, so a
+* level wakeup (e.g. ESP32 ext0 deep sleep wakeup) sees the motion even after the 50us pulse.
+* enableSampling() (after begin()) has to be called again to resume the detection.
+*/
+int ImpactDetector::enableMotionWake(float womThresh_mg, LpAccelOdr odr)
+{
+	uint8_t status;
+
+	if (_intPin >= 0) {
+		detachInterrupt(digitalPinToInterrupt(_intPin));
+	}
+	_isrInstance = NULL;
+	_pendingSamples = 0;
+
+	if (this->enableWakeOnMotion(womThresh_mg, odr) < 0) {
+		return -1;
+	}
+
+	if (this->writeRegister(INT_PIN_CFG, IMPACT_INT_LATCH_EN) < 0) {
+		return -2;
+	}
+
+	// clear a motion which was latched during the configuration
+	if (this->readRegisters(IMPACT_INT_STATUS, 1, &status) < 0) {
+		return -3;
+	}
+	return 1;
+}
+
+/* discard the FIFO content, e.g. after an overflow where the frame alignment is lost */
+int ImpactDetector::resetFifo()
+{
+	// the reset bit clears itself, so the read back of this write always fails
+	this->writeRegister(USER_CTRL, USER_CTRL_FIFO_RST | I2C_MST_EN);
+
+	if (this->writeRegister(USER_CTRL, USER_CTRL_FIFO_EN | I2C_MST_EN) < 0) {
+		return -1;
+	}
+	return 1;
+}
+
+/*
+* read all complete frames from the FIFO in bursts of IMPACT_FIFO_BURST_FRAMES frames and
+* run the detection over each sample. Returns true if an impact was detected in this batch.
+*/
 boolean ImpactDetector::detector()
 {
-	long cur_tick = millis();
-	this->readSensor();
+	bool impact = false;
+	size_t frames;
+	size_t burst;
+	int16_t counts[6];
+
+	if (this->readRegisters(FIFO_COUNT, 2, _buffer) < 0) {
+		return false;
+	}
+	_fifoSize = (((uint16_t)(_buffer[0] & 0x1F)) << 8) + (((uint16_t)_buffer[1]));
+
+	// the FIFO was full, the oldest bytes got overwritten and the frames are no longer aligned
+	if (_fifoSize > IMPACT_FIFO_SIZE - (IMPACT_FIFO_SIZE % IMPACT_FIFO_FRAME_SIZE)) {
+		this->_fifoOverflowCount++;
+		this->_sampleTimeUs += (uint32_t)(IMPACT_FIFO_SIZE / IMPACT_FIFO_FRAME_SIZE) * this->_samplePeriodUs;
+		this->resetFifo();
+		return false;
+	}
+
+	frames = _fifoSize / IMPACT_FIFO_FRAME_SIZE;
+
+	while (frames > 0) {
+		burst = (frames > IMPACT_FIFO_BURST_FRAMES) ? IMPACT_FIFO_BURST_FRAMES : frames;
+
+		if (this->readRegisters(FIFO_READ, (uint8_t)(burst * IMPACT_FIFO_FRAME_SIZE), this->_fifoBurst) < 0) {
+			return impact;
+		}
+
+		if (this->_fifoHandler != NULL) {
+			this->_fifoHandler(this->_fifoBurst, burst * IMPACT_FIFO_FRAME_SIZE);
+		}
+
+		for (size_t i = 0; i < burst; i++) {
+			const uint8_t* frame = &this->_fifoBurst[i * IMPACT_FIFO_FRAME_SIZE];
+			for (size_t j = 0; j < 6; j++) {
+				counts[j] = (((int16_t)frame[2 * j]) << 8) | frame[2 * j + 1];
+			}
+			if (this->_sampleHandler != NULL) {
+				this->_sampleHandler(this->_sampleCount, counts);
+			}
+			if (this->detectSample(counts)) {
+				impact = true;
+			}
+		}
+		frames -= burst;
+	}
+	return impact;
+}
+
+/* run the detection for one FIFO sample (ax, ay, az, gx, gy, gz in counts) */
+bool ImpactDetector::detectSample(const int16_t* counts)
+{
+	this->_sampleCount++;
+	this->_sampleTimeUs += this->_samplePeriodUs;
+	uint32_t cur_tick = this->_sampleTimeUs / 1000;
 
 	AccelVector accelVector = { 0.0f, 0.0f, 0.0f };
-	accelVector[0] = this->getAccelX_mss();
-	accelVector[1] = this->getAccelY_mss();
-	accelVector[2] = this->getAccelZ_mss();
+	accelVector[0] = (((float)(tX[0] * counts[0] + tX[1] * counts[1] + tX[2] * counts[2]) * _accelScale) - _axb) * _axs;
+	accelVector[1] = (((float)(tY[0] * counts[0] + tY[1] * counts[1] + tY[2] * counts[2]) * _accelScale) - _ayb) * _ays;
+	accelVector[2] = (((float)(tZ[0] * counts[0] + tZ[1] * counts[1] + tZ[2] * counts[2]) * _accelScale) - _azb) * _azs;
 	float absAccel = this->calcAbsAccel(accelVector);
 	float absG = this->calcAbsGravityForce(absAccel);
 
 	GyroVector gyroVector = { 0.0f, 0.0f, 0.0f };
-	gyroVector[0] = this->getGyroX_rads();
-	gyroVector[1] = this->getGyroY_rads();
-	gyroVector[2] = this->getGyroZ_rads();
+	gyroVector[0] = ((float)(tX[0] * counts[3] + tX[1] * counts[4] + tX[2] * counts[5]) * _gyroScale) - _gxb;
+	gyroVector[1] = ((float)(tY[0] * counts[3] + tY[1] * counts[4] + tY[2] * counts[5]) * _gyroScale) - _gyb;
+	gyroVector[2] = ((float)(tZ[0] * counts[3] + tZ[1] * counts[4] + tZ[2] * counts[5]) * _gyroScale) - _gzb;
 	float absGyro = this->calcAbsGyro(gyroVector);
 
-
-	// potential Impact detected
-	if ((this->_potImpact == true) && (cur_tick - this->_tick > this->_duration)) {
-		if (absG < this->_lowGThreshold) {
-			this->_potImpact = false;
-			this->_lastImpact[0] = this->_curAbsGravityForce;
-			this->_lastImpact[1] = this->_curAbsAccel;
-			this->_lastImpact[2] = this->_curAbsGyro;
-			return true;
+	// potential Impact detected, keep the peak of the impact window
+	if (this->_potImpact == true) {
+		if (absG > this->_curAbsGravityForce) {
+			this->_curAccelVector = accelVector;
+			this->_curAbsAccel = absAccel;
+			this->_curAbsGravityForce = absG;
+			this->_curGyroVector = gyroVector;
+			this->_curAbsGyro = absGyro;
 		}
-		else if (absG < this->_highGThreshold) {
-			this->_potImpact = false;
+
+		if (cur_tick - this->_tick > (uint32_t)this->_duration) {
+			if (absG < this->_lowGThreshold) {
+				this->_potImpact = false;
+				this->_lastImpact[0] = this->_curAbsGravityForce;
+				this->_lastImpact[1] = this->_curAbsAccel;
+				this->_lastImpact[2] = this->_curAbsGyro;
+				return true;
+			}
+			else if (absG < this->_highGThreshold) {
+				this->_potImpact = false;
+			}
 		}
+		return false;
 	}
 
-	else if ((cur_tick - this->_tick) > this->_pollRate) {
+	// every sample is checked, the poll rate only sets how often the current/last values are updated
+	bool isPeak = (absG > this->_highGThreshold);
+	if (isPeak || ((cur_tick - this->_tick) > (uint32_t)this->_pollRate)) {
 		this->_tick = cur_tick;
 
 		this->_lastAccelVector = this->_curAccelVector;
@@ -195,22 +384,56 @@ boolean ImpactDetector::detector()
 		this->_curGyroVector = gyroVector;
 		this->_lastAbsGyro = this->_curAbsGyro;
 		this->_curAbsGyro = absGyro;
+	}
 
-		if (absG >= this->_extremeGThreshold) {
-			this->_potImpact = true;
+	if (absG >= this->_extremeGThreshold) {
+		this->_potImpact = true;
+		this->_impactOnsetSample = this->_sampleCount - 1;
 
-			this->_lastImpact[0] = absG;
-			this->_lastImpact[1] = absAccel;
-			this->_lastImpact[2] = absGyro;
-			return true;
-		}
-		else if (absG > this->_highGThreshold) {
-			this->_potImpact = true;
-		}
+		this->_lastImpact[0] = absG;
+		this->_lastImpact[1] = absAccel;
+		this->_lastImpact[2] = absGyro;
+		return true;
+	}
+	else if (isPeak) {
+		this->_potImpact = true;
+		this->_impactOnsetSample = this->_sampleCount - 1;
 	}
 	return false;
 }
 
+uint16_t ImpactDetector::getSampleRate(void) {
+	return this->_odrHz;
+}
+
+uint32_t ImpactDetector::getSampleCount(void) {
+	return this->_sampleCount;
+}
+
+uint32_t ImpactDetector::getFifoOverflowCount(void) {
+	return this->_fifoOverflowCount;
+}
+
+/* true while a potential impact is evaluated */
+bool ImpactDetector::isImpactPending(void) {
+	return this->_potImpact;
+}
+
+/* running number of the first sample above the high G threshold of the current or last impact */
+uint32_t ImpactDetector::getImpactOnsetSample(void) {
+	return this->_impactOnsetSample;
+}
+
+/* m/s^2 per accel count */
+float ImpactDetector::getAccelScale(void) {
+	return this->_accelScale;
+}
+
+/* rad/s per gyro count */
+float ImpactDetector::getGyroScale(void) {
+	return this->_gyroScale;
+}
+
 void ImpactDetector::setHighGThreshold(float a) {
 	if ((this->_lowGThreshold < a) && (this->_extremeGThreshold > a)) {
 		this->_highGThreshold = a;
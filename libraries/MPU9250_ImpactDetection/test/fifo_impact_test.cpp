@@ -0,0 +1,133 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			fifo_impact_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the FIFO and data ready interrupt sampling of the ImpactDetector
+* @details		The register model of the MPU9250 sits on the I2C bus of the shim, every sample is pushed into its
+*				FIFO and raises the data ready interrupt on pin 39. A single 6 g sample between two polls has to be
+*				detected whatever the poll interval, the task has to be woken once per batch, the FIFO has to be read
+*				in bursts of the Wire buffer and a FIFO overflow has to be counted and recovered from.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <MPU9250_Impact.h>
+#include "HostMpu9250.h"
+#include "HostShim.h"
+#include "HostTest.h"
+
+#define INT_PIN				39
+#define ODR_HZ				200
+#define BATCH_SAMPLES		10
+#define ONE_G				2048		// counts per g at the 16 g range
+
+/** one sample into the FIFO and its data ready interrupt */
+static void pushSample(HostMpu9250 &mpu, int16_t az)
+{
+	mpu.pushSample(0, 0, az, 1, 2, 3);
+	hostTriggerInterrupt(INT_PIN);
+}
+
+static void testEnableSampling(ImpactDetector &imu, HostMpu9250 &mpu)
+{
+	CHECK_EQ(imu.enableSampling(INT_PIN, 3, BATCH_SAMPLES), -1);
+	CHECK_EQ(imu.enableSampling(INT_PIN, ODR_HZ, BATCH_SAMPLES), 1);
+	CHECK_EQ(imu.getSampleRate(), ODR_HZ);
+	CHECK_EQ(mpu.getFifoLevel(), 0);
+}
+
+/** the task is woken once per batch, not per sample */
+static void testBatchNotify(ImpactDetector &imu, HostMpu9250 &mpu)
+{
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+	imu.setNotifyTask(task);
+	ulTaskNotifyTake(pdTRUE, 0);
+
+	for (uint8_t i = 0; i < BATCH_SAMPLES - 1; i++) pushSample(mpu, ONE_G);
+	CHECK_EQ(hostGetTaskNotifyCount(task), 0);
+	pushSample(mpu, ONE_G);
+	CHECK_EQ(hostGetTaskNotifyCount(task), 1);
+
+	for (uint8_t i = 0; i < 3 * BATCH_SAMPLES; i++) pushSample(mpu, ONE_G);
+	CHECK_EQ(ulTaskNotifyTake(pdTRUE, 0), 4);
+
+	uint32_t samples = imu.getSampleCount();
+	CHECK(!imu.detector());
+	CHECK_EQ(imu.getSampleCount(), samples + 4 * BATCH_SAMPLES);
+	CHECK_EQ(mpu.getFifoLevel(), 0);
+}
+
+/** one 6 g sample, the polls as late as the i2c task gets the bus */
+static void testSingleSample(ImpactDetector &imu, HostMpu9250 &mpu, uint8_t pollSamples)
+{
+	const uint16_t samples = 2000;
+	const uint16_t peak = 777;
+	uint32_t first = imu.getSampleCount();
+	uint32_t impacts = 0;
+
+	for (uint16_t t = 0; t < samples; t++) {
+		pushSample(mpu, (t == peak) ? 6 * ONE_G : ONE_G);
+		if (t % pollSamples == pollSamples - 1) impacts += imu.detector();
+	}
+	impacts += imu.detector();
+
+	printf("poll every %u samples: %u impacts, max burst %u bytes\n", pollSamples, impacts, (unsigned)mpu.getMaxBurst());
+
+	CHECK_EQ(impacts, 1);
+	CHECK_EQ(imu.getSampleCount(), first + samples);
+	CHECK_EQ(imu.getImpactOnsetSample(), first + peak);
+	CHECK(imu.getLastImpact()[0] > 5.5f && imu.getLastImpact()[0] < 6.5f);
+	CHECK(mpu.getMaxBurst() <= IMPACT_FIFO_BURST_FRAMES * IMPACT_FIFO_FRAME_SIZE);
+	CHECK_EQ(imu.getFifoOverflowCount(), 0);
+}
+
+/** a poll later than the FIFO holds loses the samples, it is counted and the next poll starts aligned */
+static void testOverflow(ImpactDetector &imu, HostMpu9250 &mpu)
+{
+	uint32_t samples = imu.getSampleCount();
+
+	for (uint8_t i = 0; i < 50; i++) pushSample(mpu, ONE_G);
+	CHECK(!imu.detector());
+	CHECK_EQ(imu.getFifoOverflowCount(), 1);
+	CHECK_EQ(imu.getSampleCount(), samples);
+	CHECK_EQ(mpu.getFifoLevel(), 0);
+
+	/** a full FIFO of whole frames is no overflow */
+	for (uint8_t i = 0; i < IMPACT_FIFO_SIZE / IMPACT_FIFO_FRAME_SIZE; i++) pushSample(mpu, (i == 20) ? 6 * ONE_G : ONE_G);
+	CHECK(imu.detector());
+	CHECK_EQ(imu.getFifoOverflowCount(), 1);
+	CHECK_EQ(imu.getSampleCount(), samples + IMPACT_FIFO_SIZE / IMPACT_FIFO_FRAME_SIZE);
+	CHECK_EQ(imu.getImpactOnsetSample(), samples + 20);
+}
+
+int main()
+{
+	static const uint8_t abPollSamples[] = { 1, BATCH_SAMPLES, 30, 41 };
+	HostMpu9250 mpu;
+	ImpactDetector imu(100, 2000, 0.1, 2.0, 4.0, 0x68, 21, 22);
+
+	Wire.attach(0x68, &mpu);
+	CHECK(imu.begin() > 0);
+
+	testEnableSampling(imu, mpu);
+	testBatchNotify(imu, mpu);
+	for (uint8_t i = 0; i < sizeof(abPollSamples); i++) testSingleSample(imu, mpu, abPollSamples[i]);
+	testOverflow(imu, mpu);
+
+	Wire.attach(0x68, NULL);
+
+	return HOST_TEST_RESULT();
+}
@@ -0,0 +1,110 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SpanTrace.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		span and instant event tracing of the FreeRTOS tasks, dumped as Chrome trace JSON
+* @details		Every event (begin/end of a span, instant event) is written with the calling task, a span id and an
+*				argument into the ring of the core it runs on. A slot of the ring is reserved by an atomic increment of
+*				the write index, so tasks preempting each other on one core never wait for each other. The rings keep
+*				the last SPAN_TRACE_RING_EVENTS events per core, older events are overwritten.
+*
+*				dump() writes the rings in the Chrome trace event format (JSON array, one event per line), which can
+*				be loaded as is into chrome://tracing or Perfetto. Every core is shown as a process, every task as a
+*				thread of it, so waits on a semaphore show up as spans of the waiting task.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	not to be called from an ISR
+*	-	the time stamps are taken from esp_timer (micro seconds), the cycle counter stops in the light sleep and
+*		changes its rate with the CPU frequency
+*	-	recording is paused while dump() runs, the rings are empty afterwards
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __SPAN_TRACE_PUBLIC_H
+#define __SPAN_TRACE_PUBLIC_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#elif defined(ARDUINO)
+	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define SPAN_TRACE_RING_EVENTS		512			//!< events per core, power of two
+#define SPAN_TRACE_CORES			2
+#define SPAN_TRACE_MAX_TASKS		16			//!< tasks told apart in a dump
+
+typedef enum SPAN_TRACE_TYPE_Etag {
+	SPAN_TRACE_BEGIN,
+	SPAN_TRACE_END,
+	SPAN_TRACE_INSTANT,
+} SPAN_TRACE_TYPE_E;
+
+typedef struct SPAN_TRACE_EVENT_Ttag {
+	uint32_t		ulTimeUs;
+	TaskHandle_t	xTask;
+	uint8_t			bType;						//!< see SPAN_TRACE_TYPE_E
+	uint8_t			bId;						//!< index into the names given to begin()
+	uint16_t		usArg;						//!< shown as "arg" of the event
+} SPAN_TRACE_EVENT_T;
+
+class SpanTrace
+{
+public:
+
+	SpanTrace();
+
+	void begin(const char * const *names, uint8_t nameCount);
+	void setEnabled(bool isEnabled) { _isEnabled = isEnabled; }
+	bool isEnabled() const { return _isEnabled; }
+
+	void beginSpan(uint8_t bId, uint16_t usArg = 0) { if (_isEnabled) add(SPAN_TRACE_BEGIN, bId, usArg); }
+	void endSpan(uint8_t bId) { if (_isEnabled) add(SPAN_TRACE_END, bId, 0); }
+	void instant(uint8_t bId, uint16_t usArg = 0) { if (_isEnabled) add(SPAN_TRACE_INSTANT, bId, usArg); }
+
+	void dump(Print &out);
+
+	uint32_t getOverwrittenCount() const { return _ulOverwrittenCount; }
+
+private:
+	void add(uint8_t bType, uint8_t bId, uint16_t usArg);
+	uint8_t taskIndex(TaskHandle_t xTask, TaskHandle_t *axTasks, uint8_t *pbTaskCount);
+
+	SPAN_TRACE_EVENT_T	_atRing[SPAN_TRACE_CORES][SPAN_TRACE_RING_EVENTS];
+	uint32_t			_aulHead[SPAN_TRACE_CORES];			//!< events written to the ring of the core
+	const char * const	*_pNames;
+	uint8_t				_bNameCount;
+	volatile bool		_isEnabled;
+	uint32_t			_ulOverwrittenCount;				//!< events lost before a dump
+};
+
+/** span of a scope, e.g. SpanScope span(trace, SPAN_ID); */
+class SpanScope
+{
+public:
+	SpanScope(SpanTrace &trace, uint8_t bId, uint16_t usArg = 0) : _trace(trace), _bId(bId) { _trace.beginSpan(bId, usArg); }
+	~SpanScope() { _trace.endSpan(_bId); }
+
+private:
+	SpanTrace	&_trace;
+	uint8_t		_bId;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			SpiBusArbiter.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		priority arbitration of a shared SPI bus
+* @details		Every user of the bus belongs to a priority class. The bus itself is a FreeRTOS mutex, the arbiter adds
+*				the classes on top of it:
+*				-	a class does not get the bus while a more important class is waiting for it
+*				-	a bulk user splits its transfer into chunks and calls isPreemptRequested() at every chunk boundary,
+*					if it returns true it hands the bus over with yield() and continues afterwards
+*				So a radio access waits at most for one chunk of the display flush, independent of the display load.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	the bus is not recursive, a task must not acquire it twice
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __SPI_BUS_ARBITER_PUBLIC_H
+#define __SPI_BUS_ARBITER_PUBLIC_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#elif defined(ARDUINO)
+	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+#endif
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+typedef enum SPI_BUS_CLASS_Etag {
+	SPI_BUS_CLASS_RADIO,					//!< time critical, e.g. the lora radio
+	SPI_BUS_CLASS_DISPLAY,					//!< bulk transfers, preemptible at chunk boundaries
+	SPI_BUS_CLASS_MAX,
+} SPI_BUS_CLASS_E;
+
+class SpiBusArbiter
+{
+public:
+
+	SpiBusArbiter();
+
+	bool begin();
+	bool acquire(SPI_BUS_CLASS_E busClass, TickType_t timeout);
+	bool release(SPI_BUS_CLASS_E busClass);
+	bool isPreemptRequested(SPI_BUS_CLASS_E busClass) const;
+	bool yield(SPI_BUS_CLASS_E busClass);
+
+	uint32_t getMaxWaitUs(SPI_BUS_CLASS_E busClass) const { return _aulMaxWaitUs[busClass]; }
+	uint32_t getPreemptCount() const { return _ulPreemptCount; }
+
+private:
+	void setWaiting(SPI_BUS_CLASS_E busClass, int8_t delta);
+
+	SemaphoreHandle_t	_xMutex;
+	volatile uint8_t	_bOwner;							//!< class of the bus owner, SPI_BUS_CLASS_MAX if free
+	portMUX_TYPE		_xMux;
+	volatile uint8_t	_abWaiting[SPI_BUS_CLASS_MAX];		//!< tasks waiting for the bus per class
+	uint32_t			_aulMaxWaitUs[SPI_BUS_CLASS_MAX];	//!< longest time to get the bus per class
+	uint32_t			_ulPreemptCount;					//!< number of chunk boundaries the bus was handed over
+};
+
+#endif
@@ -0,0 +1,476 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			TelemetryStore.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		store-and-forward buffer for timestamped telemetry records
+* @details
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#if defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#elif defined(ESP_PLATFORM)
+#include "esp_log.h"
+static const char* LOG_TAG = "TelemetryStore";
+#else
+#include <stdio.h>
+static const char* LOG_TAG = "TelemetryStore";
+#define ESP_LOGE(tag, format, ...)	fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)	fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+#endif
+
+#include "TelemetryStore.h"
+
+#define SECTOR_FULL		((uint16_t)TELEMETRY_STORE_SECTOR_RECORDS)
+
+
+TelemetryStore::TelemetryStore()
+{
+	_ramTail = 0;
+	_ramCount = 0;
+#if defined(ESP32)
+	_partition = nullptr;
+#endif
+	_firstSector = 0;
+	_sectorCount = 0;
+	_writeSector = 0;
+	_writeSlot = SECTOR_FULL;
+	_readSector = 0;
+	_readSlot = 0;
+	_sequence = 0;
+	_flashCount = 0;
+	_droppedCount = 0;
+}
+
+TelemetryStore::~TelemetryStore()
+{
+
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		attach the flash region and recover the records of the last run
+* @param[in]	partitionLabel			label of the data partition
+* @param[in]	firstSector				first sector of the region within the partition
+* @param[in]	sectorCount				number of sectors of the region
+* @retval		true if the flash region is available, else the store works on RAM only
+*/
+/************************************************************************************************************************/
+bool TelemetryStore::begin(const char *partitionLabel, uint16_t firstSector, uint16_t sectorCount)
+{
+	_sectorCount = 0;
+	_flashCount = 0;
+
+#if defined(ESP32)
+	_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel);
+
+	if (_partition == nullptr || sectorCount == 0 || (uint32_t)(firstSector + sectorCount) * TELEMETRY_STORE_SECTOR_SIZE > _partition->size) {
+		ESP_LOGE(LOG_TAG, "Partition %s not usable, records are kept in RAM only", partitionLabel);
+		return false;
+	}
+
+	_firstSector = firstSector;
+	_sectorCount = sectorCount;
+
+	mount();
+
+	ESP_LOGI(LOG_TAG, "%s: %d records recovered from flash", partitionLabel, _flashCount);
+
+	return true;
+#else
+	(void)partitionLabel;
+	(void)firstSector;
+	(void)sectorCount;
+	return false;
+#endif
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		add a record, the oldest records are moved to flash (or dropped without flash) if the RAM ring is full
+* @param[in]	bType					record type
+* @param[in]	ulTime					time stamp of the record
+* @param[in]	pData					pointer to the payload
+* @param[in]	bLength					length of the payload, up to TELEMETRY_STORE_DATA_LEN
+* @retval		true if the record has been stored
+*/
+/************************************************************************************************************************/
+bool TelemetryStore::push(uint8_t bType, uint32_t ulTime, const void *pData, uint8_t bLength)
+{
+	if (bLength > TELEMETRY_STORE_DATA_LEN) return false;
+
+	if (_ramCount == TELEMETRY_STORE_RAM_RECORDS) {
+		if (!hasFlash() || !spill(TELEMETRY_STORE_SPILL_RECORDS)) {
+			/** no space left, drop the oldest record */
+			_ramTail = (_ramTail + 1) % TELEMETRY_STORE_RAM_RECORDS;
+			_ramCount--;
+			_droppedCount++;
+		}
+	}
+
+	TELEMETRY_RECORD_T *pRecord = &_ram[(_ramTail + _ramCount) % TELEMETRY_STORE_RAM_RECORDS];
+
+	pRecord->bState = TELEMETRY_RECORD_WRITTEN;
+	pRecord->bType = bType;
+	pRecord->bLength = bLength;
+	pRecord->ulTime = ulTime;
+	memcpy(pRecord->abData, pData, bLength);
+	memset(&pRecord->abData[bLength], 0, TELEMETRY_STORE_DATA_LEN - bLength);
+	pRecord->bCrc = crc8(pRecord);
+
+	_ramCount++;
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the oldest record without removing it
+* @param[out]	pRecord					pointer to the record
+* @retval		true if a record is available
+*/
+/************************************************************************************************************************/
+bool TelemetryStore::peek(TELEMETRY_RECORD_T *pRecord)
+{
+	/** corrupted records are skipped, behind them the RAM ring follows, a read error keeps the order */
+	if (_flashCount && flashPeek(pRecord)) return true;
+	if (_flashCount || !_ramCount) return false;
+
+	memcpy(pRecord, &_ram[_ramTail], sizeof(TELEMETRY_RECORD_T));
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		get the oldest records without removing them, e.g. to forward several records at once
+* @param[out]	pRecords				pointer to the records
+* @param[in]	maxRecords				maximum number of records
+* @retval		number of records, oldest first
+*/
+/************************************************************************************************************************/
+uint16_t TelemetryStore::peek(TELEMETRY_RECORD_T *pRecords, uint16_t maxRecords)
+{
+	uint16_t records = 0;
+
+	/** skip corrupted records at the read position, so the records match the following pop() calls */
+	if (_flashCount && !flashPeek(&pRecords[0]) && _flashCount) return 0;
+
+	uint16_t sector = _readSector;
+	uint16_t slot = _readSlot;
+	uint32_t flashRecords = _flashCount;
+
+	while (records < maxRecords && flashRecords) {
+		if (!flashRead(slotAddress(sector, slot), &pRecords[records], sizeof(TELEMETRY_RECORD_T))) return records;
+
+		/** a corrupted record in between ends the run, it is skipped once it is the oldest */
+		if (pRecords[records].bState != TELEMETRY_RECORD_WRITTEN || pRecords[records].bCrc != crc8(&pRecords[records])) return records;
+
+		records++;
+		flashRecords--;
+		if (++slot >= SECTOR_FULL) {
+			sector = (sector + 1) % _sectorCount;
+			slot = 0;
+		}
+	}
+
+	for (uint16_t i = 0; records < maxRecords && i < _ramCount; i++) {
+		memcpy(&pRecords[records++], &_ram[(_ramTail + i) % TELEMETRY_STORE_RAM_RECORDS], sizeof(TELEMETRY_RECORD_T));
+	}
+
+	return records;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		remove the oldest record, call after it has been forwarded
+* @retval		none
+*/
+/************************************************************************************************************************/
+void TelemetryStore::pop()
+{
+	TELEMETRY_RECORD_T tRecord;
+
+	/** skip corrupted records, they have not been forwarded */
+	if (_flashCount && flashPeek(&tRecord)) {
+		flashPop();
+	}
+	else if (!_flashCount && _ramCount) {
+		_ramTail = (_ramTail + 1) % TELEMETRY_STORE_RAM_RECORDS;
+		_ramCount--;
+	}
+}
+
+void TelemetryStore::pop(uint16_t records)
+{
+	while (records-- && !isEmpty()) pop();
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		move all RAM records to flash, e.g. before a reset or deep sleep
+* @retval		true if the RAM ring is empty afterwards
+*/
+/************************************************************************************************************************/
+bool TelemetryStore::flush()
+{
+	if (!hasFlash()) return _ramCount == 0;
+
+	return spill(_ramCount);
+}
+
+bool TelemetryStore::spill(uint16_t records)
+{
+	while (records-- && _ramCount) {
+		if (!flashAppend(&_ram[_ramTail])) return false;
+
+		_ramTail = (_ramTail + 1) % TELEMETRY_STORE_RAM_RECORDS;
+		_ramCount--;
+	}
+
+	return true;
+}
+
+bool TelemetryStore::flashAppend(const TELEMETRY_RECORD_T *pRecord)
+{
+	if (_writeSlot >= SECTOR_FULL) {
+		if (!startSector((_writeSector + 1) % _sectorCount)) return false;
+	}
+
+	if (!flashWrite(slotAddress(_writeSector, _writeSlot), pRecord, sizeof(TELEMETRY_RECORD_T))) return false;
+
+	_writeSlot++;
+	_flashCount++;
+
+	return true;
+}
+
+bool TelemetryStore::flashPeek(TELEMETRY_RECORD_T *pRecord)
+{
+	while (_flashCount) {
+		if (!flashRead(slotAddress(_readSector, _readSlot), pRecord, sizeof(TELEMETRY_RECORD_T))) return false;
+
+		if (pRecord->bState == TELEMETRY_RECORD_WRITTEN && pRecord->bCrc == crc8(pRecord)) return true;
+
+		/** torn write (reset during the write), skip the record */
+		ESP_LOGE(LOG_TAG, "Corrupted record in sector %d slot %d skipped", _readSector, _readSlot);
+		_droppedCount++;
+		flashPop();
+	}
+
+	return false;
+}
+
+void TelemetryStore::flashPop()
+{
+	uint8_t bState = TELEMETRY_RECORD_CONSUMED;
+
+	/** clearing the state byte needs no erase */
+	flashWrite(slotAddress(_readSector, _readSlot), &bState, sizeof(bState));
+
+	if (++_readSlot >= SECTOR_FULL) {
+		_readSector = (_readSector + 1) % _sectorCount;
+		_readSlot = 0;
+	}
+
+	_flashCount--;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		erase the next sector of the log and start writing into it, the oldest records are dropped if the log
+*				wrapped around to unconsumed records
+* @param[in]	sector					sector index within the region
+* @retval		true if the sector is ready
+*/
+/************************************************************************************************************************/
+bool TelemetryStore::startSector(uint16_t sector)
+{
+	TELEMETRY_SECTOR_HEADER_T tHeader;
+	uint32_t ulEraseCount = 0;
+
+	if (_flashCount && _readSector == sector) {
+		/** log is full, the sector holds the oldest records */
+		uint16_t dropped = 0;
+		uint8_t bState;
+
+		for (uint16_t slot = _readSlot; slot < SECTOR_FULL; slot++) {
+			if (flashRead(slotAddress(sector, slot), &bState, sizeof(bState)) && bState == TELEMETRY_RECORD_WRITTEN) dropped++;
+		}
+
+		if (dropped > _flashCount) dropped = _flashCount;
+		_flashCount -= dropped;
+		_droppedCount += dropped;
+		_readSector = (sector + 1) % _sectorCount;
+		_readSlot = 0;
+
+		ESP_LOGE(LOG_TAG, "Log full, %d records dropped", dropped);
+	}
+
+	if (flashRead(slotAddress(sector, 0) - sizeof(tHeader), &tHeader, sizeof(tHeader)) && tHeader.ulMagic == TELEMETRY_STORE_SECTOR_MAGIC) {
+		ulEraseCount = tHeader.ulEraseCount;
+	}
+
+	if (!flashErase(sector)) return false;
+
+	tHeader.ulMagic = TELEMETRY_STORE_SECTOR_MAGIC;
+	tHeader.ulSequence = _sequence++;
+	tHeader.ulEraseCount = ulEraseCount + 1;
+	tHeader.ulReserved = 0xFFFFFFFF;
+
+	if (!flashWrite(slotAddress(sector, 0) - sizeof(tHeader), &tHeader, sizeof(tHeader))) return false;
+
+	_writeSector = sector;
+	_writeSlot = 0;
+
+	/** nothing left to read, the next record is read from where it is written */
+	if (!_flashCount) {
+		_readSector = sector;
+		_readSlot = 0;
+	}
+
+	return true;
+}
+
+/************************************************************************************************************************/
+/*!
+* @brief		recover write position, read position and number of unconsumed records from the flash log
+* @retval		none
+*/
+/************************************************************************************************************************/
+void TelemetryStore::mount()
+{
+	TELEMETRY_SECTOR_HEADER_T tHeader;
+	bool isFound = false;
+	bool isReadFound = false;
+	uint8_t bState;
+
+	_flashCount = 0;
+	_writeSlot = SECTOR_FULL;
+
+	/** the write sector has the highest sequence number */
+	for (uint16_t sector = 0; sector < _sectorCount; sector++) {
+		if (!flashRead(slotAddress(sector, 0) - sizeof(tHeader), &tHeader, sizeof(tHeader))) continue;
+		if (tHeader.ulMagic != TELEMETRY_STORE_SECTOR_MAGIC) continue;
+
+		if (!isFound || (int32_t)(tHeader.ulSequence - _sequence) >= 0) {
+			_sequence = tHeader.ulSequence;
+			_writeSector = sector;
+			isFound = true;
+		}
+	}
+
+	if (!isFound) {
+		/** empty log, the first record starts sector 0 */
+		_sequence = 0;
+		_writeSector = _sectorCount - 1;
+		_readSector = 0;
+		_readSlot = 0;
+		return;
+	}
+
+	_sequence++;
+
+	for (uint16_t slot = 0; slot < SECTOR_FULL; slot++) {
+		if (flashRead(slotAddress(_writeSector, slot), &bState, sizeof(bState)) && bState == TELEMETRY_RECORD_ERASED) {
+			_writeSlot = slot;
+			break;
+		}
+	}
+
+	/** sectors are written round-robin, the oldest sector follows the write sector */
+	for (uint16_t i = 1; i <= _sectorCount; i++) {
+		uint16_t sector = (_writeSector + i) % _sectorCount;
+		uint16_t lastSlot = (sector == _writeSector) ? _writeSlot : SECTOR_FULL;
+
+		if (!flashRead(slotAddress(sector, 0) - sizeof(tHeader), &tHeader, sizeof(tHeader))) continue;
+		if (tHeader.ulMagic != TELEMETRY_STORE_SECTOR_MAGIC) continue;
+
+		for (uint16_t slot = 0; slot < lastSlot; slot++) {
+			if (!flashRead(slotAddress(sector, slot), &bState, sizeof(bState)) || bState != TELEMETRY_RECORD_WRITTEN) continue;
+
+			if (!isReadFound) {
+				_readSector = sector;
+				_readSlot = slot;
+				isReadFound = true;
+			}
+			_flashCount++;
+		}
+	}
+
+	if (!isReadFound) {
+		_readSector = (_writeSlot >= SECTOR_FULL) ? (_writeSector + 1) % _sectorCount : _writeSector;
+		_readSlot = (_writeSlot >= SECTOR_FULL) ? 0 : _writeSlot;
+	}
+}
+
+uint32_t TelemetryStore::slotAddress(uint16_t sector, uint16_t slot) const
+{
+	return (uint32_t)(_firstSector + sector) * TELEMETRY_STORE_SECTOR_SIZE + sizeof(TELEMETRY_SECTOR_HEADER_T) + (uint32_t)slot * sizeof(TELEMETRY_RECORD_T);
+}
+
+bool TelemetryStore::flashRead(uint32_t address, void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_read(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool TelemetryStore::flashWrite(uint32_t address, const void *pData, size_t len)
+{
+#if defined(ESP32)
+	return esp_partition_write(_partition, address, pData, len) == ESP_OK;
+#else
+	(void)address;
+	(void)pData;
+	(void)len;
+	return false;
+#endif
+}
+
+bool TelemetryStore::flashErase(uint16_t sector)
+{
+#if defined(ESP32)
+	return esp_partition_erase_range(_partition, (uint32_t)(_firstSector + sector) * TELEMETRY_STORE_SECTOR_SIZE, TELEMETRY_STORE_SECTOR_SIZE) == ESP_OK;
+#else
+	(void)sector;
+	return false;
+#endif
+}
+
+uint8_t TelemetryStore::crc8(const TELEMETRY_RECORD_T *pRecord)
+{
+	/** crc over everything behind the crc byte and the type/length in front of it */
+	const uint8_t *p = &pRecord->bType;
+	uint8_t crc = 0;
+
+	for (size_t i = 0; i < sizeof(TELEMETRY_RECORD_T) - 1; i++) {
+		if (&p[i] == &pRecord->bCrc) continue;
+
+		crc ^= p[i];
+		for (uint8_t bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+		}
+	}
+
+	return crc;
+}
@@ -0,0 +1,144 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			TelemetryStore.h
+* @date			17.10.2026
+* @version		1.0
+* @brief		store-and-forward buffer for timestamped telemetry records
+* @details		Records are kept in a fixed RAM ring. When the ring is full the oldest records are moved to a flash
+*				region that is written as a log: sectors are used round-robin (wear levelling), records are only
+*				appended and marked as consumed by clearing their state byte, a sector is erased when the log wraps
+*				around to it. All records in flash are older than the records in RAM, so peek() always returns the
+*				oldest record of the whole store.
+*
+*	Flash sector layout:
+*
+*	Offset			| Content
+*	----------------|---------------------------------------------------------------------------------------------
+*	0				| TELEMETRY_SECTOR_HEADER_T (magic, sequence number, erase count)
+*	16 + n * 40		| TELEMETRY_RECORD_T n
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*	-	an instance is not thread safe, it has to be owned by one task
+*	-	without a flash partition (or on other platforms) the store works on the RAM ring only
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#ifndef __TELEMETRY_STORE_PUBLIC_H
+#define __TELEMETRY_STORE_PUBLIC_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#elif defined(ARDUINO)
+	#include "WProgram.h"
+#else
+	#include <stdint.h>
+	#include <stddef.h>
+	#include <string.h>
+#endif
+
+#if defined (__STDC__)
+#if !defined(__PACKED_PRE) || !defined(__PACKED_POST)
+#define __PACKED_PRE
+#define __PACKED_POST	__attribute__ ((packed))
+#endif
+#endif
+
+#if defined(ESP32)
+#include "esp_partition.h"
+#endif
+
+#define TELEMETRY_STORE_DATA_LEN		32			//!< maximum payload of one record
+#define TELEMETRY_STORE_RAM_RECORDS		64			//!< records kept in RAM before spilling to flash
+#define TELEMETRY_STORE_SPILL_RECORDS	16			//!< records moved to flash at once when the RAM ring is full
+#define TELEMETRY_STORE_SECTOR_SIZE		4096		//!< flash erase unit
+#define TELEMETRY_STORE_SECTOR_MAGIC	0x544C4D31	//!< "TLM1"
+
+typedef enum TELEMETRY_RECORD_STATE_Etag {
+	TELEMETRY_RECORD_ERASED		= 0xFF,				//!< slot not written yet
+	TELEMETRY_RECORD_WRITTEN	= 0xFE,				//!< record valid and not yet forwarded
+	TELEMETRY_RECORD_CONSUMED	= 0x00,				//!< record forwarded
+} TELEMETRY_RECORD_STATE_E;
+
+typedef __PACKED_PRE struct TELEMETRY_RECORD_Ttag {
+	uint8_t		bState;								//!< flash state, see TELEMETRY_RECORD_STATE_E
+	uint8_t		bType;								//!< record type, defined by the user of the store
+	uint8_t		bLength;							//!< used length of abData
+	uint8_t		bCrc;								//!< crc8 over type, length, time and data
+	uint32_t	ulTime;								//!< time stamp of the record (epoch)
+	uint8_t		abData[TELEMETRY_STORE_DATA_LEN];
+} __PACKED_POST TELEMETRY_RECORD_T;
+
+typedef __PACKED_PRE struct TELEMETRY_SECTOR_HEADER_Ttag {
+	uint32_t	ulMagic;
+	uint32_t	ulSequence;							//!< increases with every started sector, the highest is the write sector
+	uint32_t	ulEraseCount;						//!< number of erase cycles of this sector
+	uint32_t	ulReserved;
+} __PACKED_POST TELEMETRY_SECTOR_HEADER_T;
+
+#define TELEMETRY_STORE_SECTOR_RECORDS	((TELEMETRY_STORE_SECTOR_SIZE - sizeof(TELEMETRY_SECTOR_HEADER_T)) / sizeof(TELEMETRY_RECORD_T))
+
+class TelemetryStore
+{
+ public:
+
+	 TelemetryStore();
+	 virtual ~TelemetryStore();
+
+	 bool begin(const char *partitionLabel, uint16_t firstSector, uint16_t sectorCount);
+	 bool push(uint8_t bType, uint32_t ulTime, const void *pData, uint8_t bLength);
+	 bool peek(TELEMETRY_RECORD_T *pRecord);
+	 uint16_t peek(TELEMETRY_RECORD_T *pRecords, uint16_t maxRecords);
+	 void pop();
+	 void pop(uint16_t records);
+	 bool flush();
+
+	 uint32_t count() const { return _ramCount + _flashCount; }
+	 bool isEmpty() const { return count() == 0; }
+	 bool hasFlash() const { return _sectorCount > 0; }
+	 uint32_t getDroppedCount() const { return _droppedCount; }
+
+private:
+	 bool spill(uint16_t records);
+	 bool flashAppend(const TELEMETRY_RECORD_T *pRecord);
+	 bool flashPeek(TELEMETRY_RECORD_T *pRecord);
+	 void flashPop();
+	 bool startSector(uint16_t sector);
+	 void mount();
+	 uint32_t slotAddress(uint16_t sector, uint16_t slot) const;
+	 bool flashRead(uint32_t address, void *pData, size_t len);
+	 bool flashWrite(uint32_t address, const void *pData, size_t len);
+	 bool flashErase(uint16_t sector);
+	 static uint8_t crc8(const TELEMETRY_RECORD_T *pRecord);
+
+	/** RAM ring, oldest record at _ramTail */
+	TELEMETRY_RECORD_T _ram[TELEMETRY_STORE_RAM_RECORDS];
+	uint16_t _ramTail;
+	uint16_t _ramCount;
+
+	/** flash log, region of _sectorCount sectors starting at _firstSector of the partition */
+#if defined(ESP32)
+	const esp_partition_t *_partition;
+#endif
+	uint16_t _firstSector;
+	uint16_t _sectorCount;
+	uint16_t _writeSector;
+	uint16_t _writeSlot;
+	uint16_t _readSector;
+	uint16_t _readSlot;
+	uint32_t _sequence;
+	uint32_t _flashCount;
+
+	uint32_t _droppedCount;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/************************************************************************************************************************/
+/*!
+* @copyright	Zentrum zur Foerderung eingebetteter Systeme e.V.
+* @author		agent
+* @file			corrupt_record_test.cpp
+* @date			17.10.2026
+* @version		1.0
+* @brief		host test of the flash log of TelemetryStore with corrupted records
+* @details		The flash log runs on a partition of the shim. Records torn by a reset are skipped and counted as
+*				dropped, peek() and pop() continue with the next record in flash or, behind the flash log, in the RAM
+*				ring. The records have to come out oldest first and each of them once.
+*
+* Changes:
+*	Date       | Description
+*	-----------|------------------------------------------------------------------------
+*	2026-10-17 | initial version
+*
+* @note
+*
+* @warning
+*
+*/
+/************************************************************************************************************************/
+
+#include <vector>
+#include <TelemetryStore.h>
+#include "HostShim.h"
+#include "HostTest.h"
+
+#define PARTITION_LABEL		"telemetry"
+#define PARTITION_SECTORS	4
+
+/** records 0 .. TELEMETRY_STORE_SPILL_RECORDS - 1 are spilled into the first sector */
+#define PUSH_RECORDS		(TELEMETRY_STORE_RAM_RECORDS + 1)
+
+static uint8_t *pFlash;
+
+static void startStore(TelemetryStore &store)
+{
+	pFlash = hostCreatePartition(PARTITION_LABEL, PARTITION_SECTORS * TELEMETRY_STORE_SECTOR_SIZE);
+	CHECK(store.begin(PARTITION_LABEL, 0, PARTITION_SECTORS));
+}
+
+static void pushRecords(TelemetryStore &store, uint32_t ulFirst, uint32_t records)
+{
+	for (uint32_t ulTime = ulFirst; ulTime < ulFirst + records; ulTime++) {
+		CHECK(store.push(1, ulTime, &ulTime, sizeof(ulTime)));
+	}
+}
+
+/** torn write of a record in the first sector */
+static void corruptRecord(uint16_t slot)
+{
+	pFlash[sizeof(TELEMETRY_SECTOR_HEADER_T) + slot * sizeof(TELEMETRY_RECORD_T) + offsetof(TELEMETRY_RECORD_T, ulTime)] ^= 0x01;
+}
+
+/** time stamps of all records, peek() and pop() one by one */
+static std::vector<uint32_t> drain(TelemetryStore &store)
+{
+	std::vector<uint32_t> times;
+	TELEMETRY_RECORD_T tRecord;
+
+	while (times.size() <= PUSH_RECORDS && store.peek(&tRecord)) {
+		times.push_back(tRecord.ulTime);
+		store.pop();
+	}
+
+	return times;
+}
+
+/** all records in flash corrupted, the RAM ring follows right away */
+static void testCorruptFlashLog()
+{
+	TelemetryStore store;
+	TELEMETRY_RECORD_T tRecord;
+	TELEMETRY_RECORD_T atRecord[8];
+
+	startStore(store);
+	pushRecords(store, 0, PUSH_RECORDS);
+	CHECK_EQ(store.count(), PUSH_RECORDS);
+
+	for (uint16_t slot = 0; slot < TELEMETRY_STORE_SPILL_RECORDS; slot++) corruptRecord(slot);
+
+	CHECK(store.peek(&tRecord));
+	CHECK_EQ(tRecord.ulTime, TELEMETRY_STORE_SPILL_RECORDS);
+	CHECK_EQ(store.count(), PUSH_RECORDS - TELEMETRY_STORE_SPILL_RECORDS);
+	CHECK_EQ(store.getDroppedCount(), TELEMETRY_STORE_SPILL_RECORDS);
+
+	store.pop();
+	CHECK_EQ(store.peek(atRecord, 8), 8);
+	for (uint8_t i = 0; i < 8; i++) CHECK_EQ(atRecord[i].ulTime, TELEMETRY_STORE_SPILL_RECORDS + 1 + i);
+}
+
+/** the same with the batch peek() first */
+static void testCorruptFlashLogBatch()
+{
+	TelemetryStore store;
+	TELEMETRY_RECORD_T atRecord[8];
+
+	startStore(store);
+	pushRecords(store, 0, PUSH_RECORDS);
+
+	for (uint16_t slot = 0; slot < TELEMETRY_STORE_SPILL_RECORDS; slot++) corruptRecord(slot);
+
+	CHECK_EQ(store.peek(atRecord, 8), 8);
+	for (uint8_t i = 0; i < 8; i++) CHECK_EQ(atRecord[i].ulTime, TELEMETRY_STORE_SPILL_RECORDS + i);
+
+	store.pop(8);
+	CHECK_EQ(drain(store).size(), PUSH_RECORDS - TELEMETRY_STORE_SPILL_RECORDS - 8);
+	CHECK(store.isEmpty());
+}
+
+/** a corrupted record in between is skipped once it is the oldest */
+static void testCorruptRecordInBetween()
+{
+	TelemetryStore store;
+	TELEMETRY_RECORD_T atRecord[TELEMETRY_STORE_SPILL_RECORDS];
+	std::vector<uint32_t> times;
+
+	startStore(store);
+	pushRecords(store, 0, PUSH_RECORDS);
+	corruptRecord(5);
+
+	/** the batch ends in front of it */
+	CHECK_EQ(store.peek(atRecord, TELEMETRY_STORE_SPILL_RECORDS), 5);
+
+	times = drain(store);
+	CHECK_EQ(times.size(), PUSH_RECORDS - 1);
+	for (uint32_t i = 0, ulTime = 0; i < times.size(); i++, ulTime++) {
+		if (ulTime == 5) ulTime++;
+		CHECK_EQ(times[i], ulTime);
+	}
+	CHECK_EQ(store.getDroppedCount(), 1);
+	CHECK(store.isEmpty());
+}
+
+/** records recovered after a reset, the last one torn, the records pushed after the reset follow */
+static void testCorruptAfterMount()
+{
+	TelemetryStore store;
+	TelemetryStore storeAfterReset;
+	std::vector<uint32_t> times;
+
+	startStore(store);
+	pushRecords(store, 0, PUSH_RECORDS);
+	CHECK(store.flush());
+	corruptRecord(PUSH_RECORDS - 1);
+
+	CHECK(storeAfterReset.begin(PARTITION_LABEL, 0, PARTITION_SECTORS));
+	CHECK_EQ(storeAfterReset.count(), PUSH_RECORDS);
+	pushRecords(storeAfterReset, 100, 2);
+
+	times = drain(storeAfterReset);
+	CHECK_EQ(times.size(), PUSH_RECORDS + 1);
+	if (times.size() == PUSH_RECORDS + 1) {
+		CHECK_EQ(times[PUSH_RECORDS - 2], PUSH_RECORDS - 2);
+		CHECK_EQ(times[PUSH_RECORDS - 1], 100);
+		CHECK_EQ(times[PUSH_RECORDS], 101);
+	}
+	CHECK(storeAfterReset.isEmpty());
+}
+
+int main()
+{
+	testCorruptFlashLog();
+	testCorruptFlashLogBatch();
+	testCorruptRecordInBetween();
+	testCorruptAfterMount();
+
+	return HOST_TEST_RESULT();
+}
@@ -338,6 +338,76 @@ static u8g2_uint_t u8g2_add_vector_x(u8g2_uint_t dx, int8_t x, int8_t y, uint8_t
 
 
 
+/*
+  Description:
+    Draw one horizontal line of the glyph at local position lx/ly.
+    The line must not cross the right edge of the glyph.
+  Args:
+    lx, ly: 				Local position inside the glyph
+    len: 					Length of the line
+    is_foreground			foreground/background?
+    u8g2->font_decode.target_x		X position
+    u8g2->font_decode.target_y		Y position
+    u8g2->font_decode.is_transparent	Transparent mode
+  Return:
+    -
+  Calls:
+    u8g2_DrawHVLine()
+  Called by:
+    u8g2_font_decode_len()
+    u8g2_font_draw_cached_glyph()
+*/
+static void u8g2_font_decode_draw_line(u8g2_t *u8g2, uint8_t lx, uint8_t ly, uint8_t len, uint8_t is_foreground)
+{
+  /* target position on the screen */
+  u8g2_uint_t x, y;
+  
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  
+  /* get target position */
+  x = decode->target_x;
+  y = decode->target_y;
+
+  /* apply rotation */
+#ifdef U8G2_WITH_FONT_ROTATION
+  x = u8g2_add_vector_x(x, lx, ly, decode->dir);
+  y = u8g2_add_vector_y(y, lx, ly, decode->dir);
+#else
+  x += lx;
+  y += ly;
+#endif
+  
+  /* draw foreground and background (if required) */
+  if ( is_foreground )
+  {
+    u8g2->draw_color = decode->fg_color;			/* draw_color will be restored later */
+    u8g2_DrawHVLine(u8g2, 
+      x, 
+      y, 
+      len, 
+#ifdef U8G2_WITH_FONT_ROTATION
+      /* dir */ decode->dir
+#else
+      0
+#endif
+    );
+  }
+  else if ( decode->is_transparent == 0 )    
+  {
+    u8g2->draw_color = decode->bg_color;			/* draw_color will be restored later */
+    u8g2_DrawHVLine(u8g2, 
+      x, 
+      y, 
+      len, 
+#ifdef U8G2_WITH_FONT_ROTATION
+      /* dir */ decode->dir
+#else
+      0
+#endif
+    );   
+  }
+}
+
 /*
   Description:
     Draw a run-length area of the glyph. "len" can have any size and the line
@@ -351,7 +421,7 @@ static u8g2_uint_t u8g2_add_vector_x(u8g2_uint_t dx, int8_t x, int8_t y, uint8_t
   Return:
     -
   Calls:
-    u8g2_Draw90Line()
+    u8g2_font_decode_draw_line()
   Called by:
     u8g2_font_decode_glyph()
 */
@@ -366,9 +436,6 @@ void u8g2_font_decode_len(u8g2_t *u8g2, uint8_t len, uint8_t is_foreground)
   /* local coordinates of the glyph */
   uint8_t lx,ly;
   
-  /* target position on the screen */
-  u8g2_uint_t x, y;
-  
   u8g2_font_decode_t *decode = &(u8g2->font_decode);
   
   cnt = len;
@@ -391,50 +458,7 @@ void u8g2_font_decode_len(u8g2_t *u8g2, uint8_t len, uint8_t is_foreground)
     
     
     /* now draw the line, but apply the rotation around the glyph target position */
-    //u8g2_font_decode_draw_pixel(u8g2, lx,ly,current, is_foreground);
-
-    /* get target position */
-    x = decode->target_x;
-    y = decode->target_y;
-
-    /* apply rotation */
-#ifdef U8G2_WITH_FONT_ROTATION
-    x = u8g2_add_vector_x(x, lx, ly, decode->dir);
-    y = u8g2_add_vector_y(y, lx, ly, decode->dir);
-#else
-    x += lx;
-    y += ly;
-#endif
-    
-    /* draw foreground and background (if required) */
-    if ( is_foreground )
-    {
-      u8g2->draw_color = decode->fg_color;			/* draw_color will be restored later */
-      u8g2_DrawHVLine(u8g2, 
-	x, 
-	y, 
-	current, 
-#ifdef U8G2_WITH_FONT_ROTATION
-	/* dir */ decode->dir
-#else
-	0
-#endif
-      );
-    }
-    else if ( decode->is_transparent == 0 )    
-    {
-      u8g2->draw_color = decode->bg_color;			/* draw_color will be restored later */
-      u8g2_DrawHVLine(u8g2, 
-	x, 
-	y, 
-	current, 
-#ifdef U8G2_WITH_FONT_ROTATION
-	/* dir */ decode->dir
-#else
-	0
-#endif
-      );   
-    }
+    u8g2_font_decode_draw_line(u8g2, lx, ly, current, is_foreground);
     
     /* check, whether the end of the run length code has been reached */
     if ( cnt < rem )
@@ -470,6 +494,294 @@ static void u8g2_font_setup_decode(u8g2_t *u8g2, const uint8_t *glyph_data)
 }
 
 
+#ifdef U8G2_WITH_GLYPH_CACHE
+
+/*
+  Description:
+    Remove all glyphs from the glyph cache.
+    Only required if font data in RAM is modified.
+*/
+void u8g2_ClearGlyphCache(u8g2_t *u8g2)
+{
+  uint8_t i;
+  for( i = 0; i < U8G2_GLYPH_CACHE_SIZE; i++ )
+    u8g2->glyph_cache[i].glyph_data = NULL;
+  u8g2->glyph_cache_clock = 0;
+}
+
+/*
+  Description:
+    Set "len" bits of the cached glyph, starting at the current local position.
+    Same wrapping as u8g2_font_decode_len().
+*/
+static void u8g2_font_cache_decode_len(u8g2_t *u8g2, u8g2_glyph_cache_entry_t *entry, uint8_t len, uint8_t is_foreground)
+{
+  uint8_t cnt = len;
+  uint8_t rem, current;
+  uint8_t lx, ly;
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  
+  lx = decode->x;
+  ly = decode->y;
+  
+  for(;;)
+  {
+    rem = decode->glyph_width;
+    rem -= lx;
+    current = rem;
+    if ( cnt < rem )
+      current = cnt;
+    
+    if ( is_foreground && current > 0 && ly < U8G2_GLYPH_CACHE_MAX_HEIGHT )
+      entry->rows[ly] |= (uint16_t)(((1UL<<current)-1) << lx);
+    
+    if ( cnt < rem )
+      break;
+    cnt -= rem;
+    lx = 0;
+    ly++;
+  }
+  lx += cnt;
+  
+  decode->x = lx;
+  decode->y = ly;
+}
+
+/*
+  Description:
+    Return the cache entry for the glyph. On a cache miss, the least recently used 
+    entry is replaced by the decoded glyph.
+  Return:
+    Cache entry or NULL, if the glyph is too large for the cache. 
+    In this case u8g2->font_decode is set up for the glyph header.
+*/
+static u8g2_glyph_cache_entry_t *u8g2_font_get_cached_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
+{
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  u8g2_glyph_cache_entry_t *entry;
+  u8g2_glyph_cache_entry_t *victim;
+  uint8_t i, a, b;
+  
+  u8g2->glyph_cache_clock++;
+  
+  victim = u8g2->glyph_cache;
+  for( i = 0; i < U8G2_GLYPH_CACHE_SIZE; i++ )
+  {
+    entry = u8g2->glyph_cache+i;
+    if ( entry->glyph_data == glyph_data )
+    {
+      entry->last_use = u8g2->glyph_cache_clock;
+      return entry;
+    }
+    if ( entry->glyph_data == NULL )
+      victim = entry;
+    else if ( victim->glyph_data != NULL && (uint16_t)(u8g2->glyph_cache_clock - entry->last_use) > (uint16_t)(u8g2->glyph_cache_clock - victim->last_use) )
+      victim = entry;
+  }
+  
+  u8g2_font_setup_decode(u8g2, glyph_data);
+  if ( decode->glyph_width > 16 || decode->glyph_height > U8G2_GLYPH_CACHE_MAX_HEIGHT )
+    return NULL;
+  
+  entry = victim;
+  entry->glyph_data = glyph_data;
+  entry->last_use = u8g2->glyph_cache_clock;
+  entry->glyph_width = decode->glyph_width;
+  entry->glyph_height = decode->glyph_height;
+  entry->x = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_x);
+  entry->y = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_y);
+  entry->delta_x = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_delta_x);
+  for( i = 0; i < U8G2_GLYPH_CACHE_MAX_HEIGHT; i++ )
+    entry->rows[i] = 0;
+  
+  if ( decode->glyph_width > 0 )
+  {
+    /* same decode loop as in u8g2_font_decode_glyph() */
+    decode->x = 0;
+    decode->y = 0;
+    for(;;)
+    {
+      a = u8g2_font_decode_get_unsigned_bits(decode, u8g2->font_info.bits_per_0);
+      b = u8g2_font_decode_get_unsigned_bits(decode, u8g2->font_info.bits_per_1);
+      do
+      {
+	u8g2_font_cache_decode_len(u8g2, entry, a, 0);
+	u8g2_font_cache_decode_len(u8g2, entry, b, 1);
+      } while( u8g2_font_decode_get_unsigned_bits(decode, 1) != 0 );
+
+      if ( decode->y >= decode->glyph_height )
+	break;
+    }
+  }
+  return entry;
+}
+
+/*
+  Description:
+    Draw a cached glyph line by line. Foreground and background runs 
+    are drawn exactly like the RLE decoder would draw them.
+*/
+static void u8g2_font_draw_cached_glyph(u8g2_t *u8g2, const u8g2_glyph_cache_entry_t *entry)
+{
+  uint8_t lx, ly, start, bit;
+  uint8_t w = entry->glyph_width;
+  uint16_t row;
+  
+  for( ly = 0; ly < (uint8_t)entry->glyph_height; ly++ )
+  {
+    row = entry->rows[ly];
+    if ( row == 0 && u8g2->font_decode.is_transparent != 0 )
+      continue;
+    lx = 0;
+    while( lx < w )
+    {
+      start = lx;
+      bit = row & 1;
+      do
+      {
+	row >>= 1;
+	lx++;
+      } while( lx < w && (row & 1) == bit );
+      u8g2_font_decode_draw_line(u8g2, start, ly, lx - start, bit);
+    }
+  }
+}
+
+/*
+  Description:
+    Apply "n" bits of a vertical pixel run directly to a vertical_top_lsb
+    tile buffer at display position xd/yd. Bit 0 of "bits" is the top pixel.
+    Uses the same color rules as u8g2_ll_hvline_vertical_top_lsb().
+*/
+static void u8g2_font_blit_vertical_run(u8g2_t *u8g2, u8g2_uint_t xd, u8g2_uint_t yd, uint32_t bits, uint8_t n)
+{
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  uint16_t offset;
+  uint8_t *ptr;
+  uint8_t shift, m;
+  uint32_t fg, all;
+  
+  yd -= u8g2->pixel_curr_row;
+  shift = yd & 7;
+  offset = yd;
+  offset &= ~7;
+  offset *= u8g2_GetU8x8(u8g2)->display_info->tile_width;
+  ptr = u8g2->tile_buf_ptr + offset + xd;
+  
+  all = ((1UL<<n)-1) << shift;
+  fg = (bits << shift) & all;
+  if ( decode->is_transparent != 0 )
+    all = fg;
+  
+  while( all != 0 )
+  {
+    m = (uint8_t)fg;
+    if ( decode->fg_color <= 1 )
+      *ptr |= m;
+    if ( decode->fg_color != 1 )
+      *ptr ^= m;
+    m = (uint8_t)(all & ~fg);
+    if ( decode->bg_color <= 1 )
+      *ptr |= m;
+    if ( decode->bg_color != 1 )
+      *ptr ^= m;
+    ptr += u8g2->pixel_buf_width;
+    fg >>= 8;
+    all >>= 8;
+  }
+}
+
+static uint32_t u8g2_font_get_cached_column(const u8g2_glyph_cache_entry_t *entry, uint8_t lx)
+{
+  uint32_t col = 0;
+  uint8_t ly = entry->glyph_height;
+  while( ly > 0 )
+  {
+    ly--;
+    col <<= 1;
+    col |= (entry->rows[ly] >> lx) & 1;
+  }
+  return col;
+}
+
+static uint32_t u8g2_font_reverse_bits(uint32_t v, uint8_t n)
+{
+  uint32_t r = 0;
+  while( n > 0 )
+  {
+    r <<= 1;
+    r |= v & 1;
+    v >>= 1;
+    n--;
+  }
+  return r;
+}
+
+/*
+  Description:
+    Copy a cached glyph directly into the tile buffer. This is only done for
+    the vertical_top_lsb buffer layout, font direction 0 and if the glyph is
+    completly inside the current page and clip window.
+    Each glyph row (R1, R3) or glyph column (R0, R2) is one vertical run
+    in the tile buffer.
+  Return:
+    0, if the glyph has to be drawn with u8g2_font_draw_cached_glyph()
+*/
+static uint8_t u8g2_font_blit_cached_glyph(u8g2_t *u8g2, const u8g2_glyph_cache_entry_t *entry)
+{
+  u8g2_font_decode_t *decode = &(u8g2->font_decode);
+  u8g2_uint_t tx = decode->target_x;
+  u8g2_uint_t ty = decode->target_y;
+  uint8_t w = entry->glyph_width;
+  uint8_t h = entry->glyph_height;
+  uint8_t i;
+  
+  if ( u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb )
+    return 0;
+#ifdef U8G2_WITH_FONT_ROTATION
+  if ( decode->dir != 0 )
+    return 0;
+#endif
+#ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if ( u8g2->is_page_clip_window_intersection == 0 )
+    return 0;
+#endif
+  if ( tx < u8g2->user_x0 || tx >= u8g2->user_x1 || w > u8g2->user_x1 - tx )
+    return 0;
+  if ( ty < u8g2->user_y0 || ty >= u8g2->user_y1 || h > u8g2->user_y1 - ty )
+    return 0;
+  
+  if ( u8g2->cb == &u8g2_cb_r0 )
+  {
+    for( i = 0; i < w; i++ )
+      u8g2_font_blit_vertical_run(u8g2, tx+i, ty, u8g2_font_get_cached_column(entry, i), h);
+  }
+  else if ( u8g2->cb == &u8g2_cb_r1 )
+  {
+    for( i = 0; i < h; i++ )
+      u8g2_font_blit_vertical_run(u8g2, u8g2->height-1-ty-i, tx, entry->rows[i], w);
+  }
+  else if ( u8g2->cb == &u8g2_cb_r2 )
+  {
+    for( i = 0; i < w; i++ )
+      u8g2_font_blit_vertical_run(u8g2, u8g2->width-1-tx-i, u8g2->height-ty-h, 
+	u8g2_font_reverse_bits(u8g2_font_get_cached_column(entry, i), h), h);
+  }
+  else if ( u8g2->cb == &u8g2_cb_r3 )
+  {
+    for( i = 0; i < h; i++ )
+      u8g2_font_blit_vertical_run(u8g2, ty+i, u8g2->width-tx-w, 
+	u8g2_font_reverse_bits(entry->rows[i], w), w);
+  }
+  else
+  {
+    return 0;
+  }
+  return 1;
+}
+
+#endif /* U8G2_WITH_GLYPH_CACHE */
+
 /*
   Description:
     Decode and draw a glyph.
@@ -491,13 +803,29 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
   int8_t d;
   int8_t h;
   u8g2_font_decode_t *decode = &(u8g2->font_decode);
-    
-  u8g2_font_setup_decode(u8g2, glyph_data);
-  h = u8g2->font_decode.glyph_height;
+#ifdef U8G2_WITH_GLYPH_CACHE
+  u8g2_glyph_cache_entry_t *entry;
   
-  x = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_x);
-  y = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_y);
-  d = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_delta_x);
+  entry = u8g2_font_get_cached_glyph(u8g2, glyph_data);
+  if ( entry != NULL )
+  {
+    decode->glyph_width = entry->glyph_width;
+    decode->glyph_height = entry->glyph_height;
+    decode->fg_color = u8g2->draw_color;
+    decode->bg_color = (decode->fg_color == 0 ? 1 : 0);
+    x = entry->x;
+    y = entry->y;
+    d = entry->delta_x;
+  }
+  else
+#endif /* U8G2_WITH_GLYPH_CACHE */
+  {
+    u8g2_font_setup_decode(u8g2, glyph_data);
+    x = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_x);
+    y = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_char_y);
+    d = u8g2_font_decode_get_signed_bits(decode, u8g2->font_info.bits_per_delta_x);
+  }
+  h = u8g2->font_decode.glyph_height;
   
   if ( decode->glyph_width > 0 )
   {
@@ -556,6 +884,15 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
     }
 #endif /* U8G2_WITH_INTERSECTION */
    
+#ifdef U8G2_WITH_GLYPH_CACHE
+    if ( entry != NULL )
+    {
+      if ( u8g2_font_blit_cached_glyph(u8g2, entry) == 0 )
+	u8g2_font_draw_cached_glyph(u8g2, entry);
+    }
+    else
+#endif /* U8G2_WITH_GLYPH_CACHE */
+    {
     /* reset local x/y position */
     decode->x = 0;
     decode->y = 0;
@@ -574,6 +911,7 @@ int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data)
       if ( decode->y >= h )
 	break;
     }
+    }
     
     /* restore the u8g2 draw color, because this is modified by the decode algo */
     u8g2->draw_color = decode->fg_color;
@@ -597,6 +935,16 @@ const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding)
   
   if ( encoding <= 255 )
   {
+#ifdef U8G2_WITH_GLYPH_INDEX
+    if ( encoding >= U8G2_GLYPH_INDEX_FIRST && encoding < U8G2_GLYPH_INDEX_FIRST+U8G2_GLYPH_INDEX_CNT )
+    {
+      uint16_t pos = u8g2->glyph_index[encoding-U8G2_GLYPH_INDEX_FIRST];
+      if ( pos == U8G2_GLYPH_INDEX_NONE )
+	return NULL;
+      if ( pos != U8G2_GLYPH_INDEX_UNKNOWN )
+	return font+pos+1;	/* pos is offset + 1, skip encoding and glyph size */
+    }
+#endif
     if ( encoding >= 'a' )
     {
       font += u8g2->font_info.start_pos_lower_a;
@@ -1026,6 +1374,43 @@ void u8g2_SetFontPosCenter(u8g2_t *u8g2)
 
 /*===============================================*/
 
+#ifdef U8G2_WITH_GLYPH_INDEX
+/*
+  Description:
+    Walk once through the glyph list of the current font and store
+    "offset + 1" of the glyphs U8G2_GLYPH_INDEX_FIRST..U8G2_GLYPH_INDEX_FIRST+U8G2_GLYPH_INDEX_CNT-1.
+    The offset is relative to the first glyph. Glyphs beyond 64K are marked
+    as U8G2_GLYPH_INDEX_UNKNOWN and are found by the linear search.
+*/
+static void u8g2_font_build_glyph_index(u8g2_t *u8g2)
+{
+  const uint8_t *start = u8g2->font + U8G2_FONT_DATA_STRUCT_SIZE;
+  const uint8_t *font = start;
+  uint8_t encoding;
+  uint8_t i;
+  
+  for( i = 0; i < U8G2_GLYPH_INDEX_CNT; i++ )
+    u8g2->glyph_index[i] = U8G2_GLYPH_INDEX_NONE;
+  
+  for(;;)
+  {
+    if ( u8x8_pgm_read( font + 1 ) == 0 )
+      break;
+    if ( (size_t)(font - start) >= U8G2_GLYPH_INDEX_UNKNOWN-1 )
+    {
+      for( i = 0; i < U8G2_GLYPH_INDEX_CNT; i++ )
+	if ( u8g2->glyph_index[i] == U8G2_GLYPH_INDEX_NONE )
+	  u8g2->glyph_index[i] = U8G2_GLYPH_INDEX_UNKNOWN;
+      break;
+    }
+    encoding = u8x8_pgm_read( font );
+    if ( encoding >= U8G2_GLYPH_INDEX_FIRST && encoding < U8G2_GLYPH_INDEX_FIRST+U8G2_GLYPH_INDEX_CNT )
+      u8g2->glyph_index[encoding-U8G2_GLYPH_INDEX_FIRST] = (uint16_t)(font - start) + 1;
+    font += u8x8_pgm_read( font + 1 );
+  }
+}
+#endif
+
 void u8g2_SetFont(u8g2_t *u8g2, const uint8_t  *font)
 {
   if ( u8g2->font != font )
@@ -1036,6 +1421,9 @@ void u8g2_SetFont(u8g2_t *u8g2, const uint8_t  *font)
 //#endif 
     u8g2->font = font;
     u8g2_read_font_info(&(u8g2->font_info), font);
+#ifdef U8G2_WITH_GLYPH_INDEX
+    u8g2_font_build_glyph_index(u8g2);
+#endif
     u8g2_UpdateRefHeight(u8g2);
     /* u8g2_SetFontPosBaseline(u8g2); */ /* removed with issue 195 */
   }